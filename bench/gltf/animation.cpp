@@ -0,0 +1,384 @@
+#include "gltf/animation.hpp"
+#include "gltf/detail/animation/interpolation.hpp"
+#include "gltf/node.hpp"
+
+#include <algorithm>
+#include <array>
+#include <benchmark/benchmark.h>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <ranges>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace
+{
+	// Synthetic glTF animations. Every channel has its own sampler with evenly spaced keyframes over
+	// `duration`, and channels cycle through the translation, rotation and scale of their target node.
+	struct Synthetic_animations
+	{
+		static constexpr float duration = 10.0f;
+
+		tinygltf::Model model;
+		std::vector<gltf::Animation> animations;
+		std::vector<uint32_t> targets;  // Sorted unique target nodes of all animations
+
+		Synthetic_animations(
+			uint32_t node_count,
+			uint32_t animation_count,
+			uint32_t channel_count,
+			uint32_t keyframe_count,
+			const std::string& interpolation
+		) noexcept
+		{
+			model.nodes.resize(node_count);
+			model.buffers.emplace_back();
+
+			const bool cubic = interpolation == "CUBICSPLINE";
+			const auto value_count = cubic ? keyframe_count * 3 : keyframe_count;
+
+			std::vector<float> times(keyframe_count);
+			for (const auto [idx, time] : times | std::views::enumerate)
+				time = duration * float(idx) / float(keyframe_count - 1);
+			const auto time_accessor = add_accessor(times, TINYGLTF_TYPE_SCALAR, keyframe_count);
+
+			// Three channels per target node, targets spread evenly over the scene
+			const auto target_count = (animation_count * channel_count + 2) / 3;
+			const auto target_stride = std::max(node_count / target_count, 1u);
+
+			for (const auto animation_index : std::views::iota(0u, animation_count))
+			{
+				tinygltf::Animation animation;
+
+				for (const auto channel_index : std::views::iota(0u, channel_count))
+				{
+					const auto global_index = animation_index * channel_count + channel_index;
+					const auto path = global_index % 3;
+					const auto phase = float(global_index) * 0.37f;
+
+					std::vector<float> values;
+					for (const auto value_index : std::views::iota(0u, value_count))
+					{
+						// Cubic keyframes are (in-tangent, value, out-tangent) triplets
+						const auto key = cubic ? value_index / 3 : value_index;
+						const auto t = times[key] + phase;
+						const bool tangent = cubic && value_index % 3 != 1;
+
+						if (path == 1)
+						{
+							const auto axis = glm::normalize(glm::vec3(0.2f, 1.0f, 0.4f));
+							const auto rotation = glm::angleAxis(t, axis);
+							values.append_range(
+								tangent ? std::array{0.0f, 0.0f, 0.0f, 0.0f}
+										: std::array{rotation.x, rotation.y, rotation.z, rotation.w}
+							);
+						}
+						else
+						{
+							const auto base = path == 0 ? 0.0f : 1.0f;
+							const auto wave = std::sin(t);
+							values.append_range(
+								tangent ? std::array{std::cos(t), 0.0f, 0.0f}
+										: std::array{base + wave, base, base + 0.5f * wave * wave}
+							);
+						}
+					}
+
+					tinygltf::AnimationSampler sampler;
+					sampler.input = time_accessor;
+					sampler.output = add_accessor(
+						values,
+						path == 1 ? TINYGLTF_TYPE_VEC4 : TINYGLTF_TYPE_VEC3,
+						value_count
+					);
+					sampler.interpolation = interpolation;
+					animation.samplers.push_back(sampler);
+
+					tinygltf::AnimationChannel channel;
+					channel.sampler = static_cast<int>(channel_index);
+					channel.target_node = static_cast<int>(global_index / 3 * target_stride % node_count);
+					channel.target_path = path == 0 ? "translation" : path == 1 ? "rotation" : "scale";
+					animation.channels.push_back(channel);
+				}
+
+				auto animation_result = gltf::Animation::from_tinygltf(model, animation);
+				assert(animation_result.has_value());
+				animations.push_back(std::move(*animation_result));
+			}
+
+			for (const auto& animation : animations) targets.append_range(animation.get_target_nodes());
+			std::ranges::sort(targets);
+			targets.erase(std::ranges::unique(targets).begin(), targets.end());
+		}
+
+	  private:
+
+		// Append float data to the buffer and create an accessor over it
+		int add_accessor(std::span<const float> data, int type, size_t count) noexcept
+		{
+			auto& buffer = model.buffers[0].data;
+			const auto offset = buffer.size();
+			buffer.resize(offset + data.size_bytes());
+			std::memcpy(buffer.data() + offset, data.data(), data.size_bytes());
+
+			tinygltf::BufferView buffer_view;
+			buffer_view.buffer = 0;
+			buffer_view.byteOffset = offset;
+			buffer_view.byteLength = data.size_bytes();
+			model.bufferViews.push_back(buffer_view);
+
+			tinygltf::Accessor accessor;
+			accessor.bufferView = static_cast<int>(model.bufferViews.size() - 1);
+			accessor.componentType = TINYGLTF_COMPONENT_TYPE_FLOAT;
+			accessor.type = type;
+			accessor.count = count;
+			model.accessors.push_back(accessor);
+
+			return static_cast<int>(model.accessors.size() - 1);
+		}
+	};
+
+	// A large scene with a few animations: 3 animations of 96 channels, 64 keyframes each
+	Synthetic_animations make_large_scene(benchmark::State& state) noexcept
+	{
+		return {static_cast<uint32_t>(state.range(0)), 3, 96, 64, "LINEAR"};
+	}
+
+	// Evaluate the animations into the sparse override set, then visit the overrides as composition does
+	void apply_sparse_overrides(benchmark::State& state)
+	{
+		const auto scene = make_large_scene(state);
+		gltf::Transform_override_set overrides(scene.targets);
+		float time = 0.0f;
+
+		for (auto _ : state)
+		{
+			overrides.clear();
+			for (const auto& animation : scene.animations) animation.apply(overrides, time);
+
+			size_t overridden = 0;
+			for (const auto& override : overrides.get_overrides()) overridden += override.has_override();
+			benchmark::DoNotOptimize(overridden);
+
+			time = std::fmod(time + 1.0f / 60.0f, Synthetic_animations::duration);
+		}
+
+		state.counters["targets"] = double(scene.targets.size());
+	}
+
+	// The same evaluation, plus the per-node reset and scan of a dense override vector over the scene
+	void apply_dense_overrides(benchmark::State& state)
+	{
+		const auto scene = make_large_scene(state);
+		gltf::Transform_override_set overrides(scene.targets);
+		std::vector<gltf::Node::Transform_override> dense_overrides(scene.model.nodes.size());
+		float time = 0.0f;
+
+		for (auto _ : state)
+		{
+			std::ranges::fill(dense_overrides, gltf::Node::Transform_override());
+			overrides.clear();
+			for (const auto& animation : scene.animations) animation.apply(overrides, time);
+
+			for (const auto [node_index, override] :
+				 std::views::zip(overrides.get_nodes(), overrides.get_overrides()))
+				dense_overrides[node_index] = override;
+
+			size_t overridden = 0;
+			for (const auto& override : dense_overrides) overridden += override.has_override();
+			benchmark::DoNotOptimize(overridden);
+
+			time = std::fmod(time + 1.0f / 60.0f, Synthetic_animations::duration);
+		}
+
+		state.counters["targets"] = double(scene.targets.size());
+	}
+
+	/* Interpolation Kernels */
+
+	namespace animation = gltf::detail::animation;
+
+	constexpr size_t kernel_channel_count = 8192;
+
+	///
+	/// @brief Random keyframe segments of `kernel_channel_count` channels, gathered into batches
+	///
+	/// @param spread How far segment ends stray from their starts, 0.2 gives keyframes around 10 degrees
+	/// apart as sampled from motion capture, 2 gives unrelated keyframes
+	///
+	template <size_t Components>
+	std::vector<animation::Segment_batch<Components>> make_segment_batches(float spread) noexcept
+	{
+		using Value = glm::vec<Components, float>;
+
+		std::mt19937 generator(42);
+		std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+
+		const auto random_value = [&] {
+			Value value;
+			for (const auto component : std::views::iota(0zu, Components))
+				value[component] = distribution(generator);
+			return value;
+		};
+
+		constexpr auto batch_count = kernel_channel_count / animation::batch_size;
+		std::vector<animation::Segment_batch<Components>> batches(batch_count);
+		for (auto& batch : batches)
+			for (const auto lane : std::views::iota(0zu, animation::batch_size))
+			{
+				auto a = random_value(), b = a + spread * random_value();
+				if constexpr (Components == 4)
+				{
+					a = glm::normalize(a);
+					b = glm::normalize(b);
+				}
+
+				const auto a_out_tangent = random_value(), b_in_tangent = random_value();
+				for (const auto component : std::views::iota(0zu, Components))
+				{
+					batch.a[component][lane] = a[component];
+					batch.b[component][lane] = b[component];
+					batch.a_out_tangent[component][lane] = a_out_tangent[component];
+					batch.b_in_tangent[component][lane] = b_in_tangent[component];
+				}
+
+				batch.factor[lane] = (distribution(generator) + 1.0f) * 0.5f;
+				batch.duration[lane] = 1.0f / 30.0f;
+			}
+
+		return batches;
+	}
+
+	template <size_t Components>
+	glm::vec<Components, float> get_lane(
+		const std::array<std::array<float, animation::batch_size>, Components>& lanes,
+		size_t lane
+	) noexcept
+	{
+		glm::vec<Components, float> value;
+		for (const auto component : std::views::iota(0zu, Components))
+			value[component] = lanes[component][lane];
+		return value;
+	}
+
+	// Slerp spread of the benchmark argument, 0 => Close keyframes, 1 => Unrelated keyframes
+	float get_slerp_spread(const benchmark::State& state) noexcept
+	{
+		return state.range(0) == 0 ? 0.2f : 2.0f;
+	}
+
+	// AVX slerp, 8 channels per call
+	void slerp_batched(benchmark::State& state)
+	{
+		auto batches = make_segment_batches<4>(get_slerp_spread(state));
+
+		for (auto _ : state)
+		{
+			for (auto& batch : batches) animation::interpolate_linear(batch);
+			benchmark::DoNotOptimize(batches.data());
+		}
+
+		state.SetItemsProcessed(state.iterations() * kernel_channel_count);
+	}
+
+	// `glm::slerp` per channel, on the same segments
+	void slerp_scalar(benchmark::State& state)
+	{
+		const auto batches = make_segment_batches<4>(get_slerp_spread(state));
+		std::vector<glm::quat> results(kernel_channel_count);
+
+		for (auto _ : state)
+		{
+			auto result = results.begin();
+			for (const auto& batch : batches)
+				for (const auto lane : std::views::iota(0zu, animation::batch_size))
+				{
+					const auto a = get_lane(batch.a, lane), b = get_lane(batch.b, lane);
+					*result++ = glm::slerp(
+						glm::quat::wxyz(a.w, a.x, a.y, a.z),
+						glm::quat::wxyz(b.w, b.x, b.y, b.z),
+						batch.factor[lane]
+					);
+				}
+			benchmark::DoNotOptimize(results.data());
+		}
+
+		state.SetItemsProcessed(state.iterations() * kernel_channel_count);
+	}
+
+	// AVX cubic Hermite spline of vectors, 8 channels per call
+	void hermite_batched(benchmark::State& state)
+	{
+		auto batches = make_segment_batches<3>(1.0f);
+
+		for (auto _ : state)
+		{
+			for (auto& batch : batches) animation::interpolate_cubic_spline(batch);
+			benchmark::DoNotOptimize(batches.data());
+		}
+
+		state.SetItemsProcessed(state.iterations() * kernel_channel_count);
+	}
+
+	// Cubic Hermite spline per channel with `glm::vec3`, on the same segments
+	void hermite_scalar(benchmark::State& state)
+	{
+		const auto batches = make_segment_batches<3>(1.0f);
+		std::vector<glm::vec3> results(kernel_channel_count);
+
+		for (auto _ : state)
+		{
+			auto result = results.begin();
+			for (const auto& batch : batches)
+				for (const auto lane : std::views::iota(0zu, animation::batch_size))
+				{
+					const float t = batch.factor[lane], t2 = t * t, t3 = t2 * t;
+					const float duration = batch.duration[lane];
+
+					*result++ = (2.0f * t3 - 3.0f * t2 + 1.0f) * get_lane(batch.a, lane)
+						+ (t3 - 2.0f * t2 + t) * duration * get_lane(batch.a_out_tangent, lane)
+						+ (-2.0f * t3 + 3.0f * t2) * get_lane(batch.b, lane)
+						+ (t3 - t2) * duration * get_lane(batch.b_in_tangent, lane);
+				}
+			benchmark::DoNotOptimize(results.data());
+		}
+
+		state.SetItemsProcessed(state.iterations() * kernel_channel_count);
+	}
+
+	/* Animation Library */
+
+	// Hundreds of animations with thousands of channels in total, all playing at once with cursors
+	void apply_animation_library(benchmark::State& state)
+	{
+		const auto interpolation = state.range(0) == 0 ? "LINEAR" : "CUBICSPLINE";
+		const Synthetic_animations library(10000, 256, 24, 32, interpolation);
+		gltf::Transform_override_set overrides(library.targets);
+		std::vector<gltf::Animation_cursor> cursors(library.animations.size());
+		float time = 0.0f;
+
+		for (auto _ : state)
+		{
+			overrides.clear();
+			for (const auto [animation, cursor] : std::views::zip(library.animations, cursors))
+				animation.apply(overrides, time, cursor);
+			benchmark::DoNotOptimize(overrides.get_overrides().data());
+
+			time = std::fmod(time + 1.0f / 60.0f, Synthetic_animations::duration);
+		}
+
+		state.SetLabel(interpolation);
+		state.SetItemsProcessed(state.iterations() * 256 * 24);
+	}
+}
+
+BENCHMARK(apply_sparse_overrides)->Arg(10000)->Arg(100000)->Arg(1000000)->Unit(benchmark::kMicrosecond);
+BENCHMARK(apply_dense_overrides)->Arg(10000)->Arg(100000)->Arg(1000000)->Unit(benchmark::kMicrosecond);
+BENCHMARK(slerp_batched)->Arg(0)->Arg(1)->Unit(benchmark::kMicrosecond);
+BENCHMARK(slerp_scalar)->Arg(0)->Arg(1)->Unit(benchmark::kMicrosecond);
+BENCHMARK(hermite_batched)->Unit(benchmark::kMicrosecond);
+BENCHMARK(hermite_scalar)->Unit(benchmark::kMicrosecond);
+BENCHMARK(apply_animation_library)->Arg(0)->Arg(1)->Unit(benchmark::kMicrosecond);
\ No newline at end of file
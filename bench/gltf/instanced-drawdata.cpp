@@ -0,0 +1,174 @@
+#include "gltf/model.hpp"
+#include "util/frame-arena.hpp"
+
+#include <array>
+#include <benchmark/benchmark.h>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <glm/gtc/matrix_transform.hpp>
+#include <ranges>
+#include <vector>
+
+namespace
+{
+	constexpr uint32_t node_count = 32;  // Nodes of the model, each drawing a mesh
+	constexpr uint32_t pose_count = 4;   // Distinct animation states, shared by the instances
+
+	///
+	/// @brief Synthetic prop, a binary tree of nodes with one or two primitives each
+	/// @details The "Sway" animation moves every fourth node, the rest stay in their rest pose. Meshes have
+	/// no backing buffers, see `gltf::Model::from_tinygltf_headless()`.
+	///
+	gltf::Model make_model() noexcept
+	{
+		tinygltf::Model model;
+		model.meshes.resize(2);
+		model.nodes.resize(node_count);
+		model.scenes.emplace_back().nodes = {0};
+
+		for (const auto idx : std::views::iota(0u, node_count))
+		{
+			auto& node = model.nodes[idx];
+			node.mesh = static_cast<int>(idx % 2);
+			node.translation = {0.5 * double(idx % 3), 1.0, 0.25 * double(idx % 5)};
+			if (idx > 0) model.nodes[(idx - 1) / 2].children.push_back(static_cast<int>(idx));
+		}
+
+		// Two keyframes of translation, shared by all channels
+		const std::array<float, 2> times = {0.0f, 1.0f};
+		const std::array<float, 6> translations = {0.0f, 1.0f, 0.0f, 0.5f, 1.0f, 0.0f};
+
+		auto& buffer = model.buffers.emplace_back().data;
+		buffer.resize(sizeof(times) + sizeof(translations));
+		std::memcpy(buffer.data(), times.data(), sizeof(times));
+		std::memcpy(buffer.data() + sizeof(times), translations.data(), sizeof(translations));
+
+		for (const auto& [offset, size, type] : {
+				 std::tuple{size_t(0), sizeof(times), TINYGLTF_TYPE_SCALAR},
+				 std::tuple{sizeof(times), sizeof(translations), TINYGLTF_TYPE_VEC3}
+			 })
+		{
+			tinygltf::BufferView buffer_view;
+			buffer_view.buffer = 0;
+			buffer_view.byteOffset = offset;
+			buffer_view.byteLength = size;
+			model.bufferViews.push_back(buffer_view);
+
+			tinygltf::Accessor accessor;
+			accessor.bufferView = static_cast<int>(model.bufferViews.size() - 1);
+			accessor.componentType = TINYGLTF_COMPONENT_TYPE_FLOAT;
+			accessor.type = type;
+			accessor.count = 2;
+			model.accessors.push_back(accessor);
+		}
+
+		tinygltf::Animation animation;
+		animation.name = "Sway";
+
+		for (uint32_t target = 0; target < node_count; target += 4)
+		{
+			tinygltf::AnimationSampler sampler;
+			sampler.input = 0;
+			sampler.output = 1;
+			animation.samplers.push_back(sampler);
+
+			tinygltf::AnimationChannel channel;
+			channel.sampler = static_cast<int>(animation.samplers.size() - 1);
+			channel.target_node = static_cast<int>(target);
+			channel.target_path = "translation";
+			animation.channels.push_back(channel);
+		}
+
+		model.animations.push_back(animation);
+
+		const auto make_primitive = [](const glm::vec3& position_min, const glm::vec3& position_max) {
+			gltf::Primitive_gpu primitive{};
+			primitive.index_count = 36;
+			primitive.position_min = position_min;
+			primitive.position_max = position_max;
+			primitive.rigged = false;
+			return primitive;
+		};
+
+		std::vector<gltf::Mesh_gpu> meshes(2);
+		meshes[0].primitives.push_back(make_primitive(glm::vec3(-0.5f), glm::vec3(0.5f)));
+		meshes[1].primitives.push_back(make_primitive({-0.2f, 0.0f, -0.2f}, {0.2f, 1.0f, 0.2f}));
+		meshes[1].primitives.push_back(make_primitive({-0.6f, 0.9f, -0.6f}, {0.6f, 1.2f, 0.6f}));
+
+		auto result = gltf::Model::from_tinygltf_headless(model, std::move(meshes));
+		assert(result.has_value());
+		return std::move(*result);
+	}
+
+	// Animation keys of each pose, instances cycle through them
+	const std::array<std::array<gltf::Animation_key, 1>, pose_count> pose_keys = {
+		std::array{gltf::Animation_key{.animation = 0u, .time = 0.0f}},
+		std::array{gltf::Animation_key{.animation = 0u, .time = 0.25f}},
+		std::array{gltf::Animation_key{.animation = 0u, .time = 0.5f}},
+		std::array{gltf::Animation_key{.animation = 0u, .time = 0.75f}}
+	};
+
+	// Instances on a square grid, rotated about Y
+	std::vector<gltf::Model_instance> make_instances(uint32_t count) noexcept
+	{
+		const auto side = static_cast<uint32_t>(std::ceil(std::sqrt(float(count))));
+
+		std::vector<gltf::Model_instance> instances;
+		instances.reserve(count);
+
+		for (const auto idx : std::views::iota(0u, count))
+		{
+			const auto position = glm::vec3(float(idx % side), 0.0f, float(idx / side)) * 4.0f;
+			const auto transform = glm::rotate(
+				glm::translate(glm::mat4(1.0f), position),
+				0.37f * float(idx),
+				glm::vec3(0.0f, 1.0f, 0.0f)
+			);
+			instances.push_back({.model_transform = transform, .animation = pose_keys[idx % pose_count]});
+		}
+
+		return instances;
+	}
+
+	// All instances at once, each pose evaluated once and placed per instance
+	void instanced(benchmark::State& state)
+	{
+		const auto model = make_model();
+		const auto instances = make_instances(static_cast<uint32_t>(state.range(0)));
+		util::Linear_arena arena;
+
+		for (auto _ : state)
+		{
+			arena.reset();
+			const auto drawdata = model.generate_instanced_drawdata(instances, {}, {}, {}, &arena);
+			benchmark::DoNotOptimize(drawdata.primitive_drawcalls.data());
+		}
+
+		state.SetItemsProcessed(state.iterations() * int64_t(instances.size()));
+	}
+
+	// One `generate_drawdata()` per instance, as done for separately placed models
+	void per_instance(benchmark::State& state)
+	{
+		const auto model = make_model();
+		const auto instances = make_instances(static_cast<uint32_t>(state.range(0)));
+		util::Linear_arena arena;
+
+		for (auto _ : state)
+		{
+			arena.reset();
+			for (const auto& instance : instances)
+			{
+				const auto drawdata =
+					model.generate_drawdata(instance.model_transform, instance.animation, {}, {}, &arena);
+				benchmark::DoNotOptimize(drawdata.primitive_drawcalls.data());
+			}
+		}
+
+		state.SetItemsProcessed(state.iterations() * int64_t(instances.size()));
+	}
+}
+
+BENCHMARK(instanced)->RangeMultiplier(8)->Range(64, 4096)->Unit(benchmark::kMicrosecond);
+BENCHMARK(per_instance)->RangeMultiplier(8)->Range(64, 4096)->Unit(benchmark::kMicrosecond);
\ No newline at end of file
@@ -0,0 +1,133 @@
+#include "gltf/detail/animation/sampler.hpp"
+
+#include <algorithm>
+#include <benchmark/benchmark.h>
+#include <cmath>
+#include <random>
+#include <ranges>
+#include <vector>
+
+namespace
+{
+	using gltf::detail::animation::Keyframe_times;
+	using gltf::detail::animation::Sampler_cursor;
+
+	constexpr uint32_t sampler_count = 1024;
+	constexpr float frame_time = 1.0f / 60.0f;
+
+	// Keyframe times of many samplers, unevenly spaced around 30 keys per second as exported by DCC tools
+	struct Sampler_set
+	{
+		std::vector<Keyframe_times> samplers;
+		std::vector<Sampler_cursor> cursors;
+		float duration = 0.0f;
+
+		explicit Sampler_set(uint32_t keyframe_count) noexcept :
+			cursors(sampler_count)
+		{
+			for (const auto sampler_index : std::views::iota(0u, sampler_count))
+			{
+				std::vector<float> times(keyframe_count);
+				float time = 0.0f;
+				for (const auto [idx, keyframe_time] : times | std::views::enumerate)
+				{
+					keyframe_time = time;
+					time += (1.0f + 0.5f * std::sin(float(idx + sampler_index) * 0.7f)) / 30.0f;
+				}
+
+				duration = std::max(duration, times.back());
+				samplers.emplace_back(std::move(times));
+			}
+		}
+	};
+
+	// Times visited by a playback running at 60 FPS, or by random seeks across the clip
+	std::vector<float> make_query_times(const Sampler_set& set, bool seek) noexcept
+	{
+		std::mt19937 generator(42);
+		std::uniform_real_distribution<float> distribution(0.0f, set.duration);
+
+		return std::views::iota(0u, 4096u)
+			| std::views::transform([&](uint32_t frame) {
+				   return seek ? distribution(generator) : std::fmod(float(frame) * frame_time, set.duration);
+			   })
+			| std::ranges::to<std::vector>();
+	}
+
+	// Locate all samplers at each query time, with cursors, with the segment table, or by binary search
+	enum class Strategy
+	{
+		Cursor,
+		Table,
+		Binary_search
+	};
+
+	template <Strategy S>
+	void run_locate(benchmark::State& state, bool seek)
+	{
+		Sampler_set set(static_cast<uint32_t>(state.range(0)));
+		const auto query_times = make_query_times(set, seek);
+		size_t query_index = 0;
+
+		for (auto _ : state)
+		{
+			const auto time = query_times[query_index++ % query_times.size()];
+			uint32_t segment_sum = 0;
+
+			for (const auto [sampler, cursor] : std::views::zip(set.samplers, set.cursors))
+			{
+				if constexpr (S == Strategy::Cursor)
+					segment_sum += sampler.locate(time, &cursor).first;
+				else if constexpr (S == Strategy::Table)
+					segment_sum += sampler.locate(time, nullptr).first;
+				else
+				{
+					const auto times = sampler.get_times();
+					const auto upper = std::ranges::upper_bound(times, time);
+					segment_sum += static_cast<uint32_t>(std::distance(times.begin(), upper));
+				}
+			}
+
+			benchmark::DoNotOptimize(segment_sum);
+		}
+
+		state.SetItemsProcessed(state.iterations() * sampler_count);
+	}
+
+	void locate_playback_cursor(benchmark::State& state)
+	{
+		run_locate<Strategy::Cursor>(state, false);
+	}
+
+	void locate_playback_table(benchmark::State& state)
+	{
+		run_locate<Strategy::Table>(state, false);
+	}
+
+	void locate_playback_binary_search(benchmark::State& state)
+	{
+		run_locate<Strategy::Binary_search>(state, false);
+	}
+
+	void locate_seek_cursor(benchmark::State& state)
+	{
+		run_locate<Strategy::Cursor>(state, true);
+	}
+
+	void locate_seek_table(benchmark::State& state)
+	{
+		run_locate<Strategy::Table>(state, true);
+	}
+
+	void locate_seek_binary_search(benchmark::State& state)
+	{
+		run_locate<Strategy::Binary_search>(state, true);
+	}
+}
+
+BENCHMARK(locate_playback_cursor)->Arg(16)->Arg(256)->Arg(4096)->Unit(benchmark::kMicrosecond);
+BENCHMARK(locate_playback_table)->Arg(16)->Arg(256)->Arg(4096)->Unit(benchmark::kMicrosecond);
+BENCHMARK(locate_playback_binary_search)->Arg(16)->Arg(256)->Arg(4096)->Unit(benchmark::kMicrosecond);
+BENCHMARK(locate_seek_cursor)->Arg(16)->Arg(256)->Arg(4096)->Unit(benchmark::kMicrosecond);
+BENCHMARK(locate_seek_table)->Arg(16)->Arg(256)->Arg(4096)->Unit(benchmark::kMicrosecond);
+BENCHMARK(locate_seek_binary_search)->Arg(16)->Arg(256)->Arg(4096)->Unit(benchmark::kMicrosecond);
\ No newline at end of file
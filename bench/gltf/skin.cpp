@@ -0,0 +1,137 @@
+#include "gltf/skin.hpp"
+
+#include <benchmark/benchmark.h>
+#include <glm/gtc/matrix_transform.hpp>
+#include <ranges>
+#include <vector>
+
+namespace
+{
+	constexpr uint32_t joints_per_character = 64;
+	constexpr uint32_t primitives_per_character = 4;
+
+	// A crowd of characters, each with its own humanoid-sized skin and joint nodes
+	struct Crowd
+	{
+		gltf::Skin_list skins;
+		std::vector<glm::mat4> inverse_bind_matrices;  // Same as `skins`, as 4x4 matrices
+		std::vector<glm::mat4> node_world_matrices;
+		std::vector<uint32_t> all_skins;
+
+		explicit Crowd(uint32_t character_count) noexcept
+		{
+			for (const auto character : std::views::iota(0u, character_count))
+			{
+				skins.skin_offsets.emplace_back(skins.joints.size(), joints_per_character);
+
+				for (const auto joint : std::views::iota(0u, joints_per_character))
+				{
+					const auto node_index = static_cast<uint32_t>(node_world_matrices.size());
+					const auto angle = float((character * 31 + joint) % 360) * 0.01745f;
+					const auto axis = glm::normalize(glm::vec3(0.2f, 1.0f, 0.4f));
+					const auto height = float(joint) * 0.05f;
+
+					node_world_matrices.push_back(
+						glm::translate(glm::mat4(1.0f), glm::vec3(float(character), height, 0.0f))
+						* glm::mat4_cast(glm::angleAxis(angle, axis))
+					);
+
+					const auto inverse_bind = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, -height, 0.0f));
+					inverse_bind_matrices.push_back(inverse_bind);
+					skins.inverse_bind_matrices.push_back(graphics::Affine_matrix::from(inverse_bind));
+					skins.joints.push_back(node_index);
+				}
+
+				all_skins.push_back(character);
+			}
+		}
+	};
+
+	// Palettes of all skins with `compose_gathered`, reading world matrices in place
+	void palette_gathered(benchmark::State& state)
+	{
+		const Crowd crowd(static_cast<uint32_t>(state.range(0)));
+		std::vector<graphics::Affine_matrix> output(crowd.skins.joints.size());
+
+		for (auto _ : state)
+		{
+			crowd.skins.compute_joint_matrices(crowd.node_world_matrices, crowd.all_skins, output);
+			benchmark::DoNotOptimize(output.data());
+		}
+
+		state.SetItemsProcessed(state.iterations() * int64_t(output.size()));
+	}
+
+	// Palettes of all skins with a 4x4 product per joint converted to 3x4, as before `compose_gathered`
+	void palette_mat4(benchmark::State& state)
+	{
+		const Crowd crowd(static_cast<uint32_t>(state.range(0)));
+		std::vector<graphics::Affine_matrix> output(crowd.skins.joints.size());
+
+		for (auto _ : state)
+		{
+			for (const auto [joint, inverse_bind, matrix] :
+				 std::views::zip(crowd.skins.joints, crowd.inverse_bind_matrices, output))
+				matrix = graphics::Affine_matrix::from(crowd.node_world_matrices[joint] * inverse_bind);
+			benchmark::DoNotOptimize(output.data());
+		}
+
+		state.SetItemsProcessed(state.iterations() * int64_t(output.size()));
+	}
+
+	///
+	/// @brief Mark, merge and pack the joint ranges drawn in a frame, the CPU side of the upload scatter
+	/// @details Every `range(1)`-th character is drawn. The G-buffer marks each primitive in draw order,
+	/// then the shadow cascades mark them again. The "ranges" counter is the number of copy commands the
+	/// scatter issues.
+	///
+	template <gltf::Skinning_mode Mode>
+	void pack_used(benchmark::State& state)
+	{
+		const auto character_count = static_cast<uint32_t>(state.range(0));
+		const auto drawn_stride = static_cast<uint32_t>(state.range(1));
+		const Crowd crowd(character_count);
+
+		gltf::Deferred_skinning_resource resource(
+			crowd.skins.compute_joint_matrices(crowd.node_world_matrices, crowd.all_skins),
+			Mode
+		);
+		std::vector<std::byte> upload(resource.get_joint_stride() * crowd.skins.joints.size());
+
+		for (auto _ : state)
+		{
+			resource.reset(Mode);
+
+			for ([[maybe_unused]] const auto view : std::views::iota(0, 2))
+				for (const auto character : std::views::iota(0u, character_count / drawn_stride))
+				{
+					const auto offset = character * drawn_stride * joints_per_character;
+					for (uint32_t primitive = 0; primitive < primitives_per_character; primitive++)
+						resource.mark_used(offset, joints_per_character);
+				}
+
+			resource.merge_used_ranges();
+			resource.pack_used_ranges(upload);
+			benchmark::DoNotOptimize(upload.data());
+		}
+
+		state.counters["ranges"] = double(resource.used_ranges.size());
+		state.counters["uploaded"] = double(resource.get_used_joint_count());
+		state.SetItemsProcessed(state.iterations() * int64_t(resource.get_used_joint_count()));
+	}
+
+	void pack_used_matrix(benchmark::State& state)
+	{
+		pack_used<gltf::Skinning_mode::Matrix>(state);
+	}
+
+	void pack_used_dual_quaternion(benchmark::State& state)
+	{
+		pack_used<gltf::Skinning_mode::Dual_quaternion>(state);
+	}
+}
+
+BENCHMARK(palette_gathered)->Arg(24)->Arg(48)->Arg(96)->Unit(benchmark::kMicrosecond);
+BENCHMARK(palette_mat4)->Arg(24)->Arg(48)->Arg(96)->Unit(benchmark::kMicrosecond);
+BENCHMARK(pack_used_matrix)->ArgsProduct({{24, 48, 96}, {1, 2}})->Unit(benchmark::kMicrosecond);
+BENCHMARK(pack_used_dual_quaternion)->ArgsProduct({{24, 48, 96}, {1, 2}})->Unit(benchmark::kMicrosecond);
\ No newline at end of file
@@ -0,0 +1,136 @@
+#include "graphics/affine.hpp"
+
+#include <benchmark/benchmark.h>
+#include <glm/gtc/matrix_transform.hpp>
+#include <optional>
+#include <ranges>
+#include <vector>
+
+namespace
+{
+	// A node hierarchy laid out like a loaded model: each node has up to 8 children, indices are in
+	// topological order, and every 100th node drives an animated subtree
+	struct Node_tree
+	{
+		graphics::Trs_arrays trs;
+		std::vector<std::optional<uint32_t>> parents;
+		std::vector<graphics::Affine_matrix> local_matrices;
+		std::vector<glm::mat4> rest_world_matrices;
+		std::vector<uint32_t> animated_nodes;  // In topological order
+
+		explicit Node_tree(uint32_t count) noexcept
+		{
+			std::vector<bool> animated(count, false);
+
+			for (const auto i : std::views::iota(0u, count))
+			{
+				const auto angle = float(i % 360) * 0.01745f;
+				trs.push_back(
+					glm::vec3(float(i % 7), 0.5f, -float(i % 5)),
+					glm::angleAxis(angle, glm::normalize(glm::vec3(0.3f, 1.0f, 0.2f))),
+					glm::vec3(1.0f + float(i % 3) * 0.1f)
+				);
+
+				parents.push_back(i == 0 ? std::nullopt : std::optional((i - 1) / 8));
+				animated[i] = (i % 100 == 50) || (parents[i].has_value() && animated[*parents[i]]);
+				if (animated[i]) animated_nodes.push_back(i);
+			}
+
+			local_matrices.resize(count);
+			graphics::compose_trs(trs, local_matrices);
+
+			std::vector<graphics::Affine_matrix> world_matrices(count);
+			for (const auto i : std::views::iota(0u, count))
+				world_matrices[i] = parents[i].has_value() ? world_matrices[*parents[i]] * local_matrices[i]
+														   : local_matrices[i];
+
+			rest_world_matrices.reserve(count);
+			for (const auto& world_matrix : world_matrices)
+				rest_world_matrices.push_back(world_matrix.to_mat4());
+		}
+	};
+
+	// Batched T*R*S composition, 8 transforms per iteration
+	void compose_trs_batched(benchmark::State& state)
+	{
+		const Node_tree tree(static_cast<uint32_t>(state.range(0)));
+		std::vector<graphics::Affine_matrix> output(tree.trs.size());
+
+		for (auto _ : state)
+		{
+			graphics::compose_trs(tree.trs, output);
+			benchmark::DoNotOptimize(output.data());
+		}
+
+		state.SetItemsProcessed(state.iterations() * state.range(0));
+	}
+
+	// Per-node `translate * mat4_cast * scale`, as before the affine path
+	void compose_trs_glm(benchmark::State& state)
+	{
+		const Node_tree tree(static_cast<uint32_t>(state.range(0)));
+		std::vector<glm::mat4> output(tree.trs.size());
+
+		for (auto _ : state)
+		{
+			for (const auto [idx, matrix] : output | std::views::enumerate)
+				matrix = glm::translate(glm::mat4(1.0f), tree.trs.get_translation(idx))
+					* glm::mat4_cast(tree.trs.get_rotation(idx))
+					* glm::scale(glm::mat4(1.0f), tree.trs.get_scale(idx));
+			benchmark::DoNotOptimize(output.data());
+		}
+
+		state.SetItemsProcessed(state.iterations() * state.range(0));
+	}
+
+	// Accumulate affine world matrices over all nodes and convert every one of them to `glm::mat4`
+	void world_matrices_all_nodes(benchmark::State& state)
+	{
+		const Node_tree tree(static_cast<uint32_t>(state.range(0)));
+		std::vector<graphics::Affine_matrix> world_matrices(tree.parents.size());
+		std::vector<glm::mat4> output(tree.parents.size());
+
+		for (auto _ : state)
+		{
+			for (const auto [idx, parent] : tree.parents | std::views::enumerate)
+				world_matrices[idx] = parent.has_value() ? world_matrices[*parent] * tree.local_matrices[idx]
+														 : tree.local_matrices[idx];
+
+			for (const auto [world_matrix, matrix] : std::views::zip(world_matrices, output))
+				matrix = world_matrix.to_mat4();
+			benchmark::DoNotOptimize(output.data());
+		}
+
+		state.counters["updated"] = double(tree.parents.size());
+		state.SetItemsProcessed(state.iterations() * state.range(0));
+	}
+
+	// Copy the rest world matrices and recompute only the animated subtrees
+	void world_matrices_animated_nodes(benchmark::State& state)
+	{
+		const Node_tree tree(static_cast<uint32_t>(state.range(0)));
+		std::vector<glm::mat4> output(tree.parents.size());
+
+		for (auto _ : state)
+		{
+			std::ranges::copy(tree.rest_world_matrices, output.begin());
+
+			for (const auto node_index : tree.animated_nodes)
+			{
+				const auto local_matrix = tree.local_matrices[node_index].to_mat4();
+				output[node_index] = tree.parents[node_index].has_value()
+					? output[*tree.parents[node_index]] * local_matrix
+					: local_matrix;
+			}
+			benchmark::DoNotOptimize(output.data());
+		}
+
+		state.counters["updated"] = double(tree.animated_nodes.size());
+		state.SetItemsProcessed(state.iterations() * state.range(0));
+	}
+}
+
+BENCHMARK(compose_trs_batched)->Arg(100000)->Unit(benchmark::kMicrosecond);
+BENCHMARK(compose_trs_glm)->Arg(100000)->Unit(benchmark::kMicrosecond);
+BENCHMARK(world_matrices_all_nodes)->Arg(100000)->Unit(benchmark::kMicrosecond);
+BENCHMARK(world_matrices_animated_nodes)->Arg(100000)->Unit(benchmark::kMicrosecond);
\ No newline at end of file
@@ -0,0 +1,120 @@
+#include "graphics/camera/projection/perspective.hpp"
+#include "render/drawdata/gbuffer.hpp"
+
+#include <benchmark/benchmark.h>
+#include <cmath>
+#include <glm/gtc/matrix_transform.hpp>
+#include <vector>
+
+namespace
+{
+	// A field of identical props on a square grid, with the camera at one edge looking across it
+	struct Prop_field
+	{
+		gltf::Material_cache materials{{}, gltf::Material_gpu{}};
+		std::vector<gltf::Primitive_instance> instances;
+		gltf::Drawdata flattened{.material_cache = materials.ref()};  // One node, thus one drawcall, per prop
+		gltf::Drawdata instanced{.material_cache = materials.ref()};  // One instanced node for all props
+
+		glm::mat4 camera_matrix;
+		glm::vec3 eye_position;
+
+		explicit Prop_field(uint32_t count) noexcept
+		{
+			const auto side = static_cast<uint32_t>(std::ceil(std::sqrt(float(count))));
+			const auto geometry_buffer = reinterpret_cast<SDL_GPUBuffer*>(uintptr_t(16));  // Never used
+			const auto primitive = gltf::Primitive_mesh_binding{
+				.vertex_buffer_binding = {.buffer = geometry_buffer, .offset = 0},
+				.index_buffer_binding = {.buffer = geometry_buffer, .offset = 0},
+				.index_count = 1200,
+				.first_index = 0,
+				.vertex_offset = 0
+			};
+
+			glm::vec3 field_min(std::numeric_limits<float>::max());
+			glm::vec3 field_max(std::numeric_limits<float>::lowest());
+
+			for (const auto i : std::views::iota(0u, count))
+			{
+				const auto position = glm::vec3(float(i % side) * 3.0f, 0.0f, -float(i / side) * 3.0f);
+				const auto transform = glm::translate(glm::mat4(1.0f), position);
+				const auto instance = gltf::Primitive_instance{
+					.world_transform = transform,
+					.world_position_min = position - 0.5f,
+					.world_position_max = position + 0.5f
+				};
+
+				instances.push_back(instance);
+				field_min = glm::min(field_min, instance.world_position_min);
+				field_max = glm::max(field_max, instance.world_position_max);
+
+				flattened.primitive_drawcalls.push_back(
+					gltf::Primitive_drawcall{
+						.world_position_min = instance.world_position_min,
+						.world_position_max = instance.world_position_max,
+						.material_index = std::nullopt,
+						.transform_or_joint_matrix_offset = transform,
+						.primitive = primitive
+					}
+				);
+			}
+
+			instanced.primitive_drawcalls.push_back(
+				gltf::Primitive_drawcall{
+					.world_position_min = field_min,
+					.world_position_max = field_max,
+					.material_index = std::nullopt,
+					.transform_or_joint_matrix_offset = glm::mat4(1.0f),
+					.primitive = primitive,
+					.instances = instances
+				}
+			);
+
+			// Roughly half of the field is in view
+			eye_position = glm::vec3(float(side) * 1.5f, 4.0f, 10.0f);
+			const auto target = glm::vec3(float(side) * 3.0f, 0.0f, -float(side) * 1.5f);
+			const auto projection = graphics::camera::projection::Perspective{
+				.fov_y = glm::radians(60.0f),
+				.near_plane = 0.1f,
+				.far_plane = std::nullopt
+			};
+			camera_matrix = glm::mat4(projection.matrix_reverse_z(16.0f / 9.0f))
+				* glm::lookAt(eye_position, target, glm::vec3(0.0f, 1.0f, 0.0f));
+		}
+	};
+
+	// Per-frame G-buffer drawdata generation: culling, sorting, batching and instance data
+	void run_gbuffer(benchmark::State& state, const Prop_field& field, const gltf::Drawdata& drawdata)
+	{
+		render::drawdata::Gbuffer gbuffer;
+
+		for (auto _ : state)
+		{
+			gbuffer.reset(field.camera_matrix, field.eye_position);
+			gbuffer.append(drawdata, nullptr, true);
+			gbuffer.sort();
+			gbuffer.batch(true);
+			benchmark::DoNotOptimize(gbuffer.instances.size());
+		}
+
+		state.counters["drawcalls"] = double(gbuffer.get_drawcall_count());
+		state.counters["draws"] = double(gbuffer.batches.size());
+		state.counters["instances"] = double(gbuffer.instances.size());
+		state.SetItemsProcessed(state.iterations() * state.range(0));
+	}
+
+	void gbuffer_flattened_props(benchmark::State& state)
+	{
+		const Prop_field field(static_cast<uint32_t>(state.range(0)));
+		run_gbuffer(state, field, field.flattened);
+	}
+
+	void gbuffer_instanced_props(benchmark::State& state)
+	{
+		const Prop_field field(static_cast<uint32_t>(state.range(0)));
+		run_gbuffer(state, field, field.instanced);
+	}
+}
+
+BENCHMARK(gbuffer_flattened_props)->Arg(1000)->Arg(10000)->Arg(100000)->Unit(benchmark::kMicrosecond);
+BENCHMARK(gbuffer_instanced_props)->Arg(1000)->Arg(10000)->Arg(100000)->Unit(benchmark::kMicrosecond);
\ No newline at end of file
@@ -0,0 +1,10 @@
+-- CPU Benchmarks, run with `xmake run bench` in release mode
+target("bench")
+	set_kind("binary")
+	set_default(false)
+	set_languages("c++23")
+
+	add_files("**.cpp")
+	add_packages("benchmark")
+
+	add_deps("render")
\ No newline at end of file
@@ -1,11 +1,12 @@
 #pragma once
 
-#include "detail/animation/channel-def.hpp"
+#include "detail/animation/channels.hpp"
+#include "detail/animation/sampler.hpp"
 #include "gltf/node.hpp"
 #include "util/error.hpp"
 
 #include <expected>
-#include <memory>
+#include <string_view>
 #include <utility>
 #include <variant>
 #include <vector>
@@ -14,10 +15,36 @@ namespace gltf
 {
 	struct Animation_key
 	{
-		std::variant<uint32_t, std::string> animation;
+		std::variant<uint32_t, std::string_view> animation;  // Index or name, names must outlive the key
 		float time;
+
+		bool operator==(const Animation_key&) const noexcept = default;
+	};
+
+	// Load-time animation compression settings, see `detail::animation::Compressed_sampler`
+	struct Animation_compression_config
+	{
+		uint32_t min_keyframes = 32;            // Samplers with fewer keyframes stay at full precision
+		float translation_tolerance = 0.0005f;  // Max error of removed translation keys, in units
+		float rotation_tolerance = 0.001f;      // Max error of removed rotation keys, in radians
+		float scale_tolerance = 0.0005f;        // Max error of removed scale keys
+	};
+
+	///
+	/// @brief Playback state of an animation instance
+	/// @details Caches the keyframe segment of every channel, so that evaluating the animation at increasing
+	/// times only steps forward through the keyframes. Sized by `Animation::apply()` on first use, laid out
+	/// as the translation, rotation and scale channel tables.
+	///
+	struct Animation_cursor
+	{
+		std::vector<detail::animation::Sampler_cursor> channels;
 	};
 
+	///
+	/// @brief A glTF animation
+	/// @details Channels are stored in flat tables per target path, see `detail::animation::Channel_table`.
+	///
 	class Animation
 	{
 	  public:
@@ -27,34 +54,76 @@ namespace gltf
 		///
 		/// @param model TinyGLTF model
 		/// @param animation TinyGLTF animation
+		/// @param compression Compression settings, `nullopt` => Keep all samplers at full precision
 		/// @return Created animation or error
 		///
 		static std::expected<Animation, util::Error> from_tinygltf(
 			const tinygltf::Model& model,
-			const tinygltf::Animation& animation
+			const tinygltf::Animation& animation,
+			const std::optional<Animation_compression_config>& compression = std::nullopt
 		) noexcept;
 
 		///
 		/// @brief Apply the animation at the given time to node transform overrides
 		///
-		/// @param overrides Node transform overrides
+		/// @param overrides Node transform overrides, should contain the target nodes
 		/// @param time Absolute timestamp
 		///
-		void apply(std::span<Node::Transform_override> overrides, float time) const noexcept;
+		void apply(Transform_override_set& overrides, float time) const noexcept;
+
+		///
+		/// @brief Apply the animation at the given time, starting from the cached keyframes of a cursor
+		///
+		/// @param overrides Node transform overrides, should contain the target nodes
+		/// @param time Absolute timestamp
+		/// @param cursor Playback state of this animation, updated
+		///
+		void apply(Transform_override_set& overrides, float time, Animation_cursor& cursor) const noexcept;
+
+		///
+		/// @brief Get the nodes targeted by any channel of the animation
+		///
+		/// @return List of node indices, may contain duplicates
+		///
+		std::vector<uint32_t> get_target_nodes() const noexcept;
+
+		// Sampler memory and error of an animation after load-time compression
+		struct Compression_statistics
+		{
+			size_t original_size = 0;            // Sampler memory before compression, in bytes
+			size_t compressed_size = 0;          // Sampler memory after compression, in bytes
+			uint32_t compressed_channels = 0;    // Channels stored compressed
+			float max_translation_error = 0.0f;  // In units
+			float max_rotation_error = 0.0f;     // In radians
+			float max_scale_error = 0.0f;
+		};
+
+		const Compression_statistics& get_compression_statistics() const noexcept
+		{
+			return compression_statistics;
+		}
 
 		// Name of the animation, can be none
 		std::optional<std::string> name;
 
 	  private:
 
-		std::vector<std::unique_ptr<detail::animation::Channel>> channels;
+		detail::animation::Channel_table<glm::vec3> translation_channels;
+		detail::animation::Channel_table<glm::quat> rotation_channels;
+		detail::animation::Channel_table<glm::vec3> scale_channels;
+
+		Compression_statistics compression_statistics;
 
 		Animation(
 			std::optional<std::string> name,
-			std::vector<std::unique_ptr<detail::animation::Channel>> channels
+			detail::animation::Channel_table<glm::vec3> translation_channels,
+			detail::animation::Channel_table<glm::quat> rotation_channels,
+			detail::animation::Channel_table<glm::vec3> scale_channels
 		) :
 			name(std::move(name)),
-			channels(std::move(channels))
+			translation_channels(std::move(translation_channels)),
+			rotation_channels(std::move(rotation_channels)),
+			scale_channels(std::move(scale_channels))
 		{}
 
 	  public:
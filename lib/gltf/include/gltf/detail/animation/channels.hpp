@@ -1,55 +1,119 @@
 #pragma once
 
-#include "channel-def.hpp"
+#include "compressed-sampler.hpp"
+#include "gltf/node.hpp"
+#include "interpolation.hpp"
 #include "sampler.hpp"
 
+#include <array>
+#include <optional>
+#include <span>
+#include <utility>
+#include <vector>
+
 namespace gltf::detail::animation
 {
-	class Translation_channel : public Channel
+	///
+	/// @brief Flat table of all channels of an animation targeting one transform path
+	/// @details Channels are grouped by storage (full precision, then compressed) and interpolation mode.
+	/// Applying the table locates the keyframes of every channel, gathers them into `Segment_batch` lanes
+	/// and interpolates `batch_size` channels per kernel call, so each group runs as one loop without
+	/// virtual dispatch.
+	///
+	/// @tparam T Value type, `glm::vec3` for translation and scale, `glm::quat` for rotation
+	///
+	template <typename T>
+	class Channel_table
 	{
-		uint32_t target_node;
-		Sampler<glm::vec3> sampler;
-
 	  public:
 
-		// Note: No out-of-bound check for `target_node`
-		Translation_channel(uint32_t target_node, Sampler<glm::vec3> sampler) :
-			target_node(target_node),
-			sampler(std::move(sampler))
-		{}
+		// Transform override member written by the table
+		using Path = std::optional<T> Node::Transform_override::*;
 
-		void apply(std::span<Node::Transform_override> overrides, float time) const noexcept override;
-	};
+		Channel_table() = default;
 
-	class Rotation_channel : public Channel
-	{
-		uint32_t target_node;
-		Sampler<glm::quat> sampler;
+		///
+		/// @brief Create a channel table
+		/// @note No out-of-bound check for target nodes
+		///
+		/// @param path Transform override member to write
+		/// @param channels Target node and sampler of each full precision channel
+		/// @param compressed_channels Target node and sampler of each compressed channel
+		///
+		Channel_table(
+			Path path,
+			std::vector<std::pair<uint32_t, Sampler<T>>> channels,
+			std::vector<std::pair<uint32_t, Compressed_sampler<T>>> compressed_channels = {}
+		) noexcept;
 
-	  public:
+		///
+		/// @brief Apply all channels at the given time to node transform overrides
+		/// @note Targets outside the override set are skipped
+		///
+		/// @param overrides Node transform overrides
+		/// @param time Absolute timestamp
+		/// @param cursors Sampler cursor of each channel, `nullptr` => Look up the keyframes from scratch
+		///
+		void apply(Transform_override_set& overrides, float time, Sampler_cursor* cursors) const noexcept;
 
-		// Note: No out-of-bound check for `target_node`
-		Rotation_channel(uint32_t target_node, Sampler<glm::quat> sampler) :
-			target_node(target_node),
-			sampler(std::move(sampler))
-		{}
+		size_t size() const noexcept { return target_nodes.size(); }
 
-		void apply(std::span<Node::Transform_override> overrides, float time) const noexcept override;
-	};
+		// Get the target node of each channel, in table order
+		std::span<const uint32_t> get_target_nodes() const noexcept { return target_nodes; }
 
-	class Scale_channel : public Channel
-	{
-		uint32_t target_node;
-		Sampler<glm::vec3> sampler;
+		// Get the memory held by the samplers, in bytes
+		size_t get_memory_size() const noexcept;
 
-	  public:
+		Channel_table(const Channel_table&) = delete;
+		Channel_table(Channel_table&&) = default;
+		Channel_table& operator=(const Channel_table&) = delete;
+		Channel_table& operator=(Channel_table&&) = default;
+
+	  private:
+
+		static constexpr size_t components = std::same_as<T, glm::quat> ? 4 : 3;
+
+		Path path = nullptr;
+		std::vector<uint32_t> target_nodes;  // Full precision channels first, then compressed channels
+		std::vector<Sampler<T>> samplers;
+		std::vector<Compressed_sampler<T>> compressed_samplers;
 
-		// Note: No out-of-bound check for `target_node`
-		Scale_channel(uint32_t target_node, Sampler<glm::vec3> sampler) :
-			target_node(target_node),
-			sampler(std::move(sampler))
-		{}
+		// End of the step, linear and cubic groups in `samplers`, in this order
+		std::array<uint32_t, 3> group_ends{};
 
-		void apply(std::span<Node::Transform_override> overrides, float time) const noexcept override;
+		// End of the step and linear groups in `compressed_samplers`, in this order
+		std::array<uint32_t, 2> compressed_group_ends{};
+
+		///
+		/// @brief Apply the step channels in `[begin, end)` of a sampler array
+		///
+		/// @param samplers Full precision or compressed samplers
+		/// @param channel_offset Channel index of the first sampler, for target nodes and cursors
+		///
+		template <typename S>
+		void apply_step(
+			Transform_override_set& overrides,
+			float time,
+			Sampler_cursor* cursors,
+			std::span<const S> samplers,
+			uint32_t channel_offset,
+			uint32_t begin,
+			uint32_t end
+		) const noexcept;
+
+		// Apply the linear or cubic channels in `[begin, end)` of a sampler array in batches
+		template <bool Cubic, typename S>
+		void apply_batched(
+			Transform_override_set& overrides,
+			float time,
+			Sampler_cursor* cursors,
+			std::span<const S> samplers,
+			uint32_t channel_offset,
+			uint32_t begin,
+			uint32_t end
+		) const noexcept;
 	};
+
+	extern template class Channel_table<glm::vec3>;
+	extern template class Channel_table<glm::quat>;
 }
\ No newline at end of file
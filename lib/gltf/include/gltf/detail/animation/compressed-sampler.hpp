@@ -0,0 +1,147 @@
+#pragma once
+
+#include "sampler.hpp"
+#include "util/inline.hpp"
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <optional>
+#include <type_traits>
+#include <vector>
+
+namespace gltf::detail::animation
+{
+	///
+	/// @brief Unit quaternion packed into 48 bits with the smallest-three encoding
+	/// @details The largest component is dropped and its index stored in 2 bits, the sign is folded into the
+	/// other three components as `q` and `-q` are the same rotation. The remaining components lie within
+	/// `[-1/sqrt(2), 1/sqrt(2)]` and are stored in 15 bits each.
+	///
+	struct Packed_quat
+	{
+		uint16_t data[3];
+
+		static Packed_quat pack(const glm::quat& quat) noexcept;
+
+		FORCE_INLINE glm::quat unpack() const noexcept
+		{
+			static constexpr float inv_max = 1.0f / 32767.0f;
+
+			auto bits = (uint64_t(data[0]) << 32) | (uint64_t(data[1]) << 16) | uint64_t(data[2]);
+			const auto largest = uint32_t(bits >> 45);
+
+			std::array<float, 4> components;
+			float sum_squared = 0.0f;
+
+			for (int component = 3; component >= 0; component--)
+			{
+				if (uint32_t(component) == largest) continue;
+
+				const auto quantized = float(bits & 0x7FFF);
+				bits >>= 15;
+
+				components[component] = (quantized * inv_max * 2.0f - 1.0f) * glm::one_over_root_two<float>();
+				sum_squared += components[component] * components[component];
+			}
+
+			components[largest] = std::sqrt(std::max(0.0f, 1.0f - sum_squared));
+
+			return glm::quat::wxyz(components[3], components[0], components[1], components[2]);
+		}
+	};
+
+	static_assert(sizeof(Packed_quat) == 6);
+
+	// Vector quantized to 16 bits per component within the value range of its sampler
+	struct Packed_vec3
+	{
+		uint16_t data[3];
+	};
+
+	static_assert(sizeof(Packed_vec3) == 6);
+
+	///
+	/// @brief Compressed animation sampler, decompressed per keyframe on access
+	/// @details Keys that interpolating (or stepping) between their neighbours reproduces within a
+	/// tolerance are removed, the remaining values are quantized: rotations with `Packed_quat`, translations
+	/// and scales with `Packed_vec3`. Only linear and step samplers are compressed, cubic splines keep full
+	/// precision.
+	///
+	/// @tparam T Value type, `glm::vec3` or `glm::quat`
+	///
+	template <typename T>
+	class Compressed_sampler
+	{
+		using Packed = std::conditional_t<std::same_as<T, glm::quat>, Packed_quat, Packed_vec3>;
+
+		// Keys removed are checked over windows of at most this many keys, bounding compression time
+		static constexpr uint32_t max_removal_window = 256;
+
+		Interpolation interpolation;
+		Keyframe_times times;
+		std::vector<Packed> values;
+
+		// Vector only, value = `range_min + packed * range_scale`
+		glm::vec3 range_min{0.0f};
+		glm::vec3 range_scale{0.0f};
+
+		// Max error at the original keys, and at their midpoints for linear rotations. In units for vectors
+		// and radians for rotations.
+		float max_error = 0.0f;
+
+		Compressed_sampler() = default;
+
+	  public:
+
+		///
+		/// @brief Compress a sampler
+		///
+		/// @param sampler Source sampler
+		/// @param tolerance Error tolerance for key removal, in units for vectors and radians for rotations
+		/// @return Compressed sampler, or `nullopt` if the sampler can't be compressed (cubic spline)
+		///
+		static std::optional<Compressed_sampler> compress(
+			const Sampler<T>& sampler,
+			float tolerance
+		) noexcept;
+
+		// Locate the keyframes surrounding a time, see `Keyframe_times::locate()`
+		FORCE_INLINE Sampler_segment locate(float time, Sampler_cursor* cursor) const noexcept
+		{
+			return times.locate(time, cursor);
+		}
+
+		Interpolation get_interpolation() const noexcept { return interpolation; }
+
+		FORCE_INLINE T get_value(uint32_t index) const noexcept
+		{
+			if constexpr (std::same_as<T, glm::quat>)
+				return values[index].unpack();
+			else
+			{
+				const auto& [x, y, z] = values[index].data;
+				return range_min + glm::vec3(float(x), float(y), float(z)) * range_scale;
+			}
+		}
+
+		// Get the max measured error, in units for vectors and radians for rotations
+		float get_max_error() const noexcept { return max_error; }
+
+		// Get the memory held, in bytes
+		size_t get_memory_size() const noexcept
+		{
+			return times.get_memory_size() + values.size() * sizeof(Packed);
+		}
+
+		Compressed_sampler(const Compressed_sampler&) = delete;
+		Compressed_sampler(Compressed_sampler&&) = default;
+		Compressed_sampler& operator=(const Compressed_sampler&) = delete;
+		Compressed_sampler& operator=(Compressed_sampler&&) = default;
+	};
+
+	extern template class Compressed_sampler<glm::vec3>;
+	extern template class Compressed_sampler<glm::quat>;
+}
\ No newline at end of file
@@ -1,82 +1,85 @@
 #pragma once
 
+#include <array>
+#include <cstddef>
 #include <glm/glm.hpp>
 #include <glm/gtc/quaternion.hpp>
 
 namespace gltf::detail::animation
 {
+	// Channels interpolated together by the batch kernels, one AVX register per component
+	inline constexpr size_t batch_size = 8;
+
+	///
+	/// @brief Keyframe segments of a batch of channels, one array per scalar component
+	/// @details Channels are gathered into lanes before interpolating and scattered back after. Lanes past
+	/// the channel count must hold finite values, e.g. copies of another lane.
 	///
-	/// @brief Linear interpolation between two values
-	/// @note The input must satisfy `at <= t <= bt`
-	/// @tparam T Type of value
-	/// @param a Keyframe A
-	/// @param b Keyframe B
-	/// @param at Timestamp of A
-	/// @param bt Timestamp of B
-	/// @param t Absolute timestamp
-	/// @return Interpolated value
+	/// @tparam Components Component count of the value type, 3 for vectors and 4 for quaternions (x, y, z, w)
 	///
-	template <typename T>
-	T interpolate_linear(const T& a, const T& b, float at, float bt, float t) noexcept
+	template <size_t Components>
+	struct Segment_batch
 	{
-		assert(at <= t && t <= bt);
-		return glm::mix(a, b, (t - at) / (bt - at));
-	}
+		using Lanes = std::array<float, batch_size>;
 
-	template <>
-	glm::quat interpolate_linear(
-		const glm::quat& a,
-		const glm::quat& b,
-		float at,
-		float bt,
-		float t
-	) noexcept;
+		alignas(32) std::array<Lanes, Components> a;              // Values at the segment start
+		alignas(32) std::array<Lanes, Components> b;              // Values at the segment end
+		alignas(32) std::array<Lanes, Components> a_out_tangent;  // Cubic only
+		alignas(32) std::array<Lanes, Components> b_in_tangent;   // Cubic only
+		alignas(32) Lanes factor;                                 // Normalized time in the segment
+		alignas(32) Lanes duration;                               // Segment duration, cubic only
 
-	// Cubic Spline Keyframe
-	template <typename T>
-	struct Cubic_keyframe
-	{
-		T in_tangent;
-		T value;
-		T out_tangent;
+		alignas(32) std::array<Lanes, Components> result;
+
+		// Fill lanes `[count, batch_size)` with copies of lane 0
+		void pad(size_t count) noexcept;
 	};
 
 	///
-	/// @brief Interpolates between two cubic spline keyframes
+	/// @brief Linear interpolation of vectors
 	///
-	/// @tparam T Type of value
-	/// @param a Keyframe A
-	/// @param b Keyframe B
-	/// @param at Absolute timestamp of A
-	/// @param bt Absolute timestamp of B
-	/// @param t Absolute timestamp
-	/// @return Interpolated value
+	/// @param batch Batch, `result = mix(a, b, factor)`
 	///
-	template <typename T>
-	T interpolate_cubic_spline(
-		const Cubic_keyframe<T>& a,
-		const Cubic_keyframe<T>& b,
-		float at,
-		float bt,
-		float t
-	) noexcept
-	{
-		assert(at <= t && t <= bt);
+	void interpolate_linear(Segment_batch<3>& batch) noexcept;
 
-		const float td = bt - at;        // Time duration
-		const float tn = (t - at) / td;  // Normalized segment time
+	///
+	/// @brief Spherical linear interpolation of quaternions, taking the shortest path
+	/// @details Keyframes less than 120 degrees apart are weighted by a polynomial series within 5e-7 of the
+	/// exact weights, wider ones fall back to scalar trigonometry.
+	///
+	/// @param batch Batch, `result = slerp(a, b, factor)`
+	///
+	void interpolate_linear(Segment_batch<4>& batch) noexcept;
 
-		const float t2 = tn * tn;  // tn^2
-		const float t3 = t2 * tn;  // tn^3
+	///
+	/// @brief Cubic Hermite spline interpolation of vectors
+	///
+	/// @param batch Batch, tangents are scaled by `duration`
+	///
+	void interpolate_cubic_spline(Segment_batch<3>& batch) noexcept;
+
+	///
+	/// @brief Cubic Hermite spline interpolation of quaternions, normalized after
+	///
+	/// @param batch Batch, tangents are scaled by `duration`
+	///
+	void interpolate_cubic_spline(Segment_batch<4>& batch) noexcept;
 
-		const T val = (2 * t3 - 3 * t2 + 1) * a.value
-			+ (t3 - 2 * t2 + tn) * td * a.out_tangent
-			+ (-2 * t3 + 3 * t2) * b.value
-			+ (t3 - t2) * td * b.in_tangent;
+	template <size_t Components>
+	void Segment_batch<Components>::pad(size_t count) noexcept
+	{
+		for (size_t lane = count; lane < batch_size; lane++)
+		{
+			for (size_t component = 0; component < Components; component++)
+			{
+				a[component][lane] = a[component][0];
+				b[component][lane] = b[component][0];
+				a_out_tangent[component][lane] = a_out_tangent[component][0];
+				b_in_tangent[component][lane] = b_in_tangent[component][0];
+			}
 
-		if constexpr (std::same_as<T, glm::quat>)
-			return glm::normalize(val);
-		else
-			return val;
+			factor[lane] = factor[0];
+			duration[lane] = duration[0];
+		}
 	}
 }
\ No newline at end of file
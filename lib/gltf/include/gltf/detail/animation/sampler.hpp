@@ -3,12 +3,12 @@
 #include <algorithm>
 #include <optional>
 #include <ranges>
+#include <span>
 #include <tiny_gltf.h>
 #include <variant>
 #include <vector>
 
 #include "gltf/accessor.hpp"
-#include "interpolation.hpp"
 #include "util/error.hpp"
 #include "util/inline.hpp"
 
@@ -30,35 +30,145 @@ namespace gltf::detail::animation
 	///
 	std::optional<Interpolation> parse_interpolation(const std::string& str) noexcept;
 
-	// Animation sampler for a specific type T
+	///
+	/// @brief Sort keyframe timestamps
+	///
+	/// @param timestamps Keyframe timestamps, sorted in place. Equal times keep their relative order.
+	/// @return Original keyframe index of each sorted timestamp
+	///
+	std::vector<uint32_t> sort_keyframes(std::vector<float>& timestamps) noexcept;
+
+	///
+	/// @brief Gather keyframe values in sorted order
+	///
+	/// @param values Keyframe values, `stride` elements per keyframe
+	/// @param order Original keyframe indices from `sort_keyframes()`
+	/// @param stride Elements per keyframe
+	/// @param offset Element to gather within a keyframe
+	/// @return Gathered values
+	///
+	template <typename T>
+	std::vector<T> gather_keyframes(
+		const std::vector<T>& values,
+		std::span<const uint32_t> order,
+		size_t stride = 1,
+		size_t offset = 0
+	) noexcept
+	{
+		const auto get_value = [&values, stride, offset](uint32_t idx) {
+			return values[idx * stride + offset];
+		};
+
+		return order | std::views::transform(get_value) | std::ranges::to<std::vector>();
+	}
+
+	// Cached keyframe segment of a sampler, owned by whoever plays the animation
+	struct Sampler_cursor
+	{
+		uint32_t segment = 0;
+	};
+
+	// Keyframes surrounding a sampled time
+	struct Sampler_segment
+	{
+		uint32_t first;   // Keyframe at or before the time
+		uint32_t second;  // Keyframe after the time
+		float factor;     // Normalized time between the keyframes
+		float duration;   // Time between the keyframes
+	};
+
+	///
+	/// @brief Sorted keyframe times of a sampler
+	/// @details `locate()` resolves the segment `[times[i], times[i + 1])` containing a time, with three
+	/// strategies:
+	/// - With a cursor, the cached segment is checked first and walked forward a few keyframes, which is
+	///   amortized O(1) for animations played forward
+	/// - With a segment table, the time is mapped to a uniform time cell, which stores the first segment
+	///   overlapping the cell
+	/// - Otherwise, binary search over the keyframe times
+	///
+	class Keyframe_times
+	{
+		// Samplers with fewer keyframes use binary search, which is as fast as the table there
+		static constexpr size_t segment_table_min_keyframes = 16;
+
+		// Forward steps taken from the cursor before falling back to a lookup
+		static constexpr uint32_t cursor_max_steps = 4;
+
+		std::vector<float> times;
+
+		// Uniform segment table over `[times.front(), times.back()]`, empty if not built
+		std::vector<uint32_t> segment_table;
+		float segment_table_scale = 0.0f;  // Cells per second
+
+		// Find the segment containing `time`, `times.front() < time < times.back()`
+		uint32_t find_segment(float time) const noexcept;
+
+	  public:
+
+		Keyframe_times() = default;
+
+		///
+		/// @brief Create keyframe times, building the segment table for samplers with enough keyframes
+		///
+		/// @param times Keyframe times, sorted and non-empty
+		///
+		explicit Keyframe_times(std::vector<float> times) noexcept;
+
+		///
+		/// @brief Locate the keyframes surrounding a time
+		///
+		/// @param time Absolute timestamp
+		/// @param cursor Cursor to start from and update, `nullptr` => Look up from scratch
+		/// @return Keyframe segment, both keyframes are equal if the time is out of the keyframe range
+		///
+		Sampler_segment locate(float time, Sampler_cursor* cursor) const noexcept;
+
+		size_t size() const noexcept { return times.size(); }
+
+		std::span<const float> get_times() const noexcept { return times; }
+
+		// Get the memory held, in bytes
+		size_t get_memory_size() const noexcept
+		{
+			return times.size() * sizeof(float) + segment_table.size() * sizeof(uint32_t);
+		}
+	};
+
+	///
+	/// @brief Animation sampler for a specific type T
+	/// @details Keyframe times, values and cubic tangents are stored in separate arrays
+	///
 	template <typename T>
 	class Sampler
 	{
 		// Interpolation method
 		Interpolation interpolation;
 
-		// Keyframes stored as (time, value) pairs
-		std::variant<
-			std::vector<std::pair<float, T>>,
-			std::vector<std::pair<float, detail::animation::Cubic_keyframe<T>>>
-		>
-			keyframes;
+		// Keyframe times, sorted
+		Keyframe_times times;
 
-		Sampler(std::vector<std::pair<float, T>> keyframes, Interpolation interpolation) :
-			interpolation(interpolation),
-			keyframes(std::move(keyframes))
-		{
-			assert(interpolation == Interpolation::Linear || interpolation == Interpolation::Step);
-		}
+		// Keyframe values, in the order of `times`
+		std::vector<T> values;
+
+		// Cubic spline tangents, in the order of `times`. Empty for other interpolation modes.
+		std::vector<T> in_tangents, out_tangents;
 
 		Sampler(
-			std::vector<std::pair<float, detail::animation::Cubic_keyframe<T>>> keyframes,
-			Interpolation interpolation
-		) :
+			Interpolation interpolation,
+			std::vector<float> times,
+			std::vector<T> values,
+			std::vector<T> in_tangents = {},
+			std::vector<T> out_tangents = {}
+		) noexcept :
 			interpolation(interpolation),
-			keyframes(std::move(keyframes))
+			times(std::move(times)),
+			values(std::move(values)),
+			in_tangents(std::move(in_tangents)),
+			out_tangents(std::move(out_tangents))
 		{
-			assert(interpolation == Interpolation::Cubic);
+			assert(this->times.size() == this->values.size());
+			assert((interpolation == Interpolation::Cubic) == !this->in_tangents.empty());
 		}
 
 	  public:
@@ -68,7 +178,32 @@ namespace gltf::detail::animation
 			const tinygltf::AnimationSampler& sampler
 		) noexcept;
 
-		T operator[](float time) const noexcept;
+		// Locate the keyframes surrounding a time, see `Keyframe_times::locate()`
+		FORCE_INLINE Sampler_segment locate(float time, Sampler_cursor* cursor) const noexcept
+		{
+			return times.locate(time, cursor);
+		}
+
+		Interpolation get_interpolation() const noexcept { return interpolation; }
+
+		std::span<const float> get_times() const noexcept { return times.get_times(); }
+
+		std::span<const T> get_values() const noexcept { return values; }
+
+		FORCE_INLINE T get_value(uint32_t index) const noexcept { return values[index]; }
+
+		// Cubic only
+		FORCE_INLINE T get_in_tangent(uint32_t index) const noexcept { return in_tangents[index]; }
+
+		// Cubic only
+		FORCE_INLINE T get_out_tangent(uint32_t index) const noexcept { return out_tangents[index]; }
+
+		// Get the memory held, in bytes
+		size_t get_memory_size() const noexcept
+		{
+			const auto value_count = values.size() + in_tangents.size() + out_tangents.size();
+			return times.get_memory_size() + value_count * sizeof(T);
+		}
 
 		Sampler(const Sampler&) = delete;
 		Sampler(Sampler&&) = default;
@@ -76,62 +211,42 @@ namespace gltf::detail::animation
 		Sampler& operator=(Sampler&&) = default;
 	};
 
-	template <typename T>
-	FORCE_INLINE inline T Sampler<T>::operator[](float time) const noexcept
+	FORCE_INLINE inline Sampler_segment Keyframe_times::locate(
+		float time,
+		Sampler_cursor* cursor
+	) const noexcept
 	{
-		switch (interpolation)
-		{
-		case Interpolation::Linear:
-		case Interpolation::Step:
-		{
-			using Vec_type = std::vector<std::pair<float, T>>;
-			assert((std::holds_alternative<Vec_type>(keyframes)));
-			const auto& keyframe_vec = std::get<Vec_type>(keyframes);
-
-			const auto upper = std::ranges::upper_bound(keyframe_vec, time, {}, &std::pair<float, T>::first);
-			if (upper == keyframe_vec.begin()) return upper->second;
-			if (upper == keyframe_vec.end()) return std::prev(upper)->second;
-
-			const auto lower = std::prev(upper);
-			if (interpolation == Interpolation::Step) return lower->second;
-
-			return detail::animation::interpolate_linear(
-				lower->second,
-				upper->second,
-				lower->first,
-				upper->first,
-				time
-			);
-		}
+		const auto last = static_cast<uint32_t>(times.size()) - 1;
 
-		case Interpolation::Cubic:
+		if (time <= times.front()) return {.first = 0, .second = 0, .factor = 0.0f, .duration = 0.0f};
+		if (time >= times.back()) return {.first = last, .second = last, .factor = 0.0f, .duration = 0.0f};
+
+		uint32_t segment;
+		if (cursor == nullptr)
+			segment = find_segment(time);
+		else
 		{
-			using Vec_type = std::vector<std::pair<float, detail::animation::Cubic_keyframe<T>>>;
-			assert((std::holds_alternative<Vec_type>(keyframes)));
-			const auto& keyframe_vec = std::get<Vec_type>(keyframes);
-
-			const auto upper = std::ranges::upper_bound(
-				keyframe_vec,
-				time,
-				{},
-				&std::pair<float, detail::animation::Cubic_keyframe<T>>::first
-			);
-			if (upper == keyframe_vec.begin()) return upper->second.value;
-			if (upper == keyframe_vec.end()) return std::prev(upper)->second.value;
-
-			const auto lower = std::prev(upper);
-			return detail::animation::interpolate_cubic_spline(
-				lower->second,
-				upper->second,
-				lower->first,
-				upper->first,
-				time
-			);
-		}
+			// Walk forward from the cached segment, rewinds and long jumps fall back to a lookup
+			segment = cursor->segment;
+			if (segment < last && times[segment] <= time)
+			{
+				for (uint32_t step = 0; step < cursor_max_steps && times[segment + 1] <= time; step++)
+					segment++;
+				if (times[segment + 1] <= time) segment = find_segment(time);
+			}
+			else
+				segment = find_segment(time);
 
-		default:
-			std::unreachable();
+			cursor->segment = segment;
 		}
+
+		const float duration = times[segment + 1] - times[segment];
+		return {
+			.first = segment,
+			.second = segment + 1,
+			.factor = (time - times[segment]) / duration,
+			.duration = duration
+		};
 	}
 
 	template <typename T>
@@ -159,7 +274,7 @@ namespace gltf::detail::animation
 
 		auto timestamps_result = extract_from_accessor<float>(model, model.accessors[sampler.input]);
 		if (!timestamps_result) return timestamps_result.error().forward("Extract timestamps failed");
-		const auto timestamps = std::move(*timestamps_result);
+		auto timestamps = std::move(*timestamps_result);
 
 		auto values_result = extract_from_accessor<T>(model, model.accessors[sampler.output]);
 		if (!values_result) return values_result.error().forward("Extract values failed");
@@ -182,19 +297,8 @@ namespace gltf::detail::animation
 					)
 				);
 
-			auto keyframes =
-				std::views::zip_transform(
-					[](float timestamp, const T& value) -> std::pair<float, T> {
-						return std::make_pair(timestamp, value);
-					},
-					timestamps,
-					values
-				)
-				| std::ranges::to<std::vector<std::pair<float, T>>>();
-
-			std::ranges::sort(keyframes, {}, &std::pair<float, T>::first);
-
-			return Sampler<T>(std::move(keyframes), interpolation);
+			const auto order = sort_keyframes(timestamps);
+			return Sampler<T>(interpolation, std::move(timestamps), gather_keyframes(values, order));
 		}
 		case Interpolation::Cubic:
 		{
@@ -210,22 +314,15 @@ namespace gltf::detail::animation
 					)
 				);
 
-			std::vector<std::pair<float, detail::animation::Cubic_keyframe<T>>> keyframes;
-			keyframes.reserve(timestamps.size());
-
-			for (const auto idx : std::views::iota(0u, timestamps.size()))
-			{
-				detail::animation::Cubic_keyframe<T> keyframe;
-				keyframe.in_tangent = values[idx * 3 + 0];
-				keyframe.value = values[idx * 3 + 1];
-				keyframe.out_tangent = values[idx * 3 + 2];
-
-				keyframes.emplace_back(timestamps[idx], keyframe);
-			}
-
-			std::ranges::sort(keyframes, {}, &std::pair<float, detail::animation::Cubic_keyframe<T>>::first);
-
-			return Sampler<T>(std::move(keyframes), interpolation);
+			// Cubic keyframes are stored as (in-tangent, value, out-tangent) triplets
+			const auto order = sort_keyframes(timestamps);
+			return Sampler<T>(
+				interpolation,
+				std::move(timestamps),
+				gather_keyframes(values, order, 3, 1),
+				gather_keyframes(values, order, 3, 0),
+				gather_keyframes(values, order, 3, 2)
+			);
 		}
 		default:
 			std::unreachable();
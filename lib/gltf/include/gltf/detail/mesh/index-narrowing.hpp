@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace gltf::detail::mesh
+{
+	// Largest vertex count addressable with 16-bit indices, the last vertex has index 65535
+	constexpr size_t max_16bit_vertex_count = 65536;
+
+	///
+	/// @brief Narrowing of index lists to 16 bits, with the index data statistics of `Mesh_buffers`
+	/// @details A list is narrowed when all its vertices are addressable with 16 bits. Narrowed lists are
+	/// padded to an even count by repeating the last index, so that they fill whole 4-byte words: buffer
+	/// copies need 4-byte aligned offsets and sizes. The padding is never drawn, draws use the original
+	/// index count. Holds no GPU resource.
+	///
+	class Index_narrowing
+	{
+	  public:
+
+		// Whether lists referencing `vertex_count` vertices can use 16-bit indices
+		static bool can_narrow(size_t vertex_count) noexcept
+		{
+			return vertex_count <= max_16bit_vertex_count;
+		}
+
+		///
+		/// @brief Narrow an index list if its vertex count allows, and account its index data
+		///
+		/// @param indices Index list
+		/// @param vertex_count Vertex count of the primitive the list indexes
+		/// @return Narrowed list padded to an even count, or `nullopt` if the list stays 32-bit
+		///
+		std::optional<std::vector<uint16_t>> narrow(
+			std::span<const uint32_t> indices,
+			size_t vertex_count
+		) noexcept;
+
+		// Get the index data of all lists in their final width, including padding
+		uint64_t get_index_bytes() const noexcept { return index_bytes; }
+
+		// Get the index data saved by narrowing, compared to all lists in 32 bits
+		uint64_t get_index_bytes_saved() const noexcept { return index_bytes_saved; }
+
+	  private:
+
+		uint64_t index_bytes = 0;
+		uint64_t index_bytes_saved = 0;
+	};
+}
\ No newline at end of file
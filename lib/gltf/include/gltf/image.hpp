@@ -7,6 +7,7 @@
 #pragma once
 
 #include "gpu/texture.hpp"
+#include "graphics/util/upload-batcher.hpp"
 #include <glm/glm.hpp>
 #include <tiny_gltf.h>
 
@@ -34,13 +35,14 @@ namespace gltf
 	/// compression/mipmapping is not possible due to NPOT/Non-BC-Compatible dimensions, the
 	/// compression/mipmapping steps will be skipped.
 	///
+	/// @param batcher Upload batcher, the texture is valid after it is flushed
 	/// @param image Image data
 	/// @param compress_mode Compression mode
 	/// @param srgb Whether to use sRGB format
 	/// @return Created GPU texture or error
 	///
 	std::expected<gpu::Texture, util::Error> create_color_texture_from_image(
-		SDL_GPUDevice* device,
+		graphics::Upload_batcher& batcher,
 		const tinygltf::Image& image,
 		Color_compress_mode compress_mode,
 		bool srgb,
@@ -53,12 +55,13 @@ namespace gltf
 	/// compression/mipmapping is not possible due to NPOT/Non-BC-Compatible dimensions, the
 	/// compression/mipmapping steps will be skipped.
 	///
+	/// @param batcher Upload batcher, the texture is valid after it is flushed
 	/// @param image Image data
 	/// @param compress_mode Compression mode
 	/// @return Created GPU texture or error
 	///
 	std::expected<gpu::Texture, util::Error> create_normal_texture_from_image(
-		SDL_GPUDevice* device,
+		graphics::Upload_batcher& batcher,
 		const tinygltf::Image& image,
 		Normal_compress_mode compress_mode,
 		const std::string& name
@@ -213,7 +213,7 @@ namespace gltf
 
 		// Worker thread for loading an image
 		static std::expected<Image_entry, util::Error> load_image_thread(
-			SDL_GPUDevice* device,
+			graphics::Upload_batcher& batcher,
 			const tinygltf::Image& image,
 			const Image_config& image_config,
 			Image_refcount refcount
@@ -244,6 +244,8 @@ namespace gltf
 
 		Material_list() = default;
 
+		friend class Model;  // Headless models hold an empty list
+
 		/*===== Acquire =====*/
 
 		///
@@ -6,10 +6,12 @@
 #pragma once
 
 #include "gpu/buffer.hpp"
+#include "graphics/util/upload-batcher.hpp"
 #include "util/inline.hpp"
 
 #include <glm/glm.hpp>
 #include <optional>
+#include <span>
 #include <tiny_gltf.h>
 #include <vector>
 
@@ -59,6 +61,26 @@ namespace gltf
 		static Rigged_shadow_vertex from_rigged_vertex(const Rigged_vertex& vertex) noexcept;
 	};
 
+	///
+	/// @brief Mesh-space bounds of the vertices each joint influences, for joints with any influence
+	/// @details A skinned vertex is a weighted mix of its position under each influencing joint, so it stays
+	/// inside the union of the joint bounds transformed by their joint matrices.
+	///
+	struct Joint_bounds
+	{
+		std::vector<uint32_t> joints;  // Joint indices in the skin, ascending
+		std::vector<glm::vec3> position_min;
+		std::vector<glm::vec3> position_max;
+
+		///
+		/// @brief Compute joint bounds of rigged vertices
+		///
+		/// @param vertices Rigged vertices
+		/// @return Joint bounds
+		///
+		static Joint_bounds from_vertices(std::span<const Rigged_shadow_vertex> vertices) noexcept;
+	};
+
 	// Primitive Mesh Data
 	struct Primitive
 	{
@@ -97,6 +119,7 @@ namespace gltf
 		std::optional<uint32_t> material;
 
 		glm::vec3 position_min, position_max;
+		Joint_bounds joint_bounds;
 
 		///
 		/// @brief Create a `Rigged_primitive` from a `tinygltf::Primitive`, performing validation
@@ -111,6 +134,24 @@ namespace gltf
 		) noexcept;
 	};
 
+	// Low-poly CPU-side geometry for software occlusion culling
+	struct Occluder_mesh
+	{
+		static constexpr size_t max_triangle_count = 256;
+		static constexpr float max_simplify_error = 0.01f;  // Relative to the mesh extent
+
+		std::vector<glm::vec3> positions;
+		std::vector<uint32_t> indices;
+
+		///
+		/// @brief Generate an occluder mesh from a primitive, simplifying it when needed
+		///
+		/// @param primitive CPU-side primitive
+		/// @return Occluder mesh, or `nullopt` if it can't be simplified under `max_triangle_count`
+		///
+		static std::optional<Occluder_mesh> from_primitive(const Primitive& primitive) noexcept;
+	};
+
 	// Plain raw data for drawing a primitive
 	struct Primitive_mesh_binding
 	{
@@ -118,44 +159,71 @@ namespace gltf
 		SDL_GPUBufferBinding index_buffer_binding;
 		SDL_GPUBufferBinding shadow_vertex_buffer_binding;
 		SDL_GPUBufferBinding shadow_index_buffer_binding;
+		SDL_GPUIndexElementSize index_element_size;
+		SDL_GPUIndexElementSize shadow_index_element_size;
 		uint32_t index_count;
+		uint32_t first_index;          // First index in the index buffer
+		int32_t vertex_offset;         // Base vertex, added to each index
+		uint32_t shadow_first_index;   // First index in the shadow index buffer
+		int32_t shadow_vertex_offset;  // Base vertex in the shadow vertex buffer
 		bool rigged;
 	};
 
+	// Range of a primitive's vertices or indices in a shared buffer
+	struct Geometry_range
+	{
+		SDL_GPUBuffer* buffer;
+		uint32_t first;  // First vertex or index
+	};
+
+	// Location of a primitive's geometry in the shared buffers
+	struct Primitive_geometry
+	{
+		Geometry_range vertices;
+		Geometry_range indices;
+		Geometry_range shadow_vertices;
+		Geometry_range shadow_indices;
+		SDL_GPUIndexElementSize index_element_size;
+		SDL_GPUIndexElementSize shadow_index_element_size;
+	};
+
 	// Primitive Mesh Data for GPU
 	struct Primitive_gpu
 	{
 		uint32_t index_count;
-
-		gpu::Buffer vertex_buffer;
-		gpu::Buffer index_buffer;
-		gpu::Buffer shadow_vertex_buffer;
-		gpu::Buffer shadow_index_buffer;
+		Primitive_geometry geometry;  // Buffers are owned by `Mesh_buffers`
 
 		std::optional<uint32_t> material;
 		glm::vec3 position_min, position_max;
 		bool rigged;
 
+		std::optional<Occluder_mesh> occluder = std::nullopt;  // Only for non-rigged primitives
+		Joint_bounds joint_bounds;                             // Only for rigged primitives
+
 		///
-		/// @brief Create a `Primitive_gpu` from a `Primitive`, uploading data to the GPU
+		/// @brief Create a `Primitive_gpu` from a `Primitive` placed in shared buffers
 		///
 		/// @param primitive CPU-side primitive
-		/// @return GPU-side primitive, or error on failure
+		/// @param geometry Location of the uploaded geometry
+		/// @param occluder Occluder mesh of the primitive
+		/// @return GPU-side primitive
 		///
-		static std::expected<Primitive_gpu, util::Error> from_primitive(
-			SDL_GPUDevice* device,
-			const Primitive& primitive
+		static Primitive_gpu from_primitive(
+			const Primitive& primitive,
+			const Primitive_geometry& geometry,
+			std::optional<Occluder_mesh> occluder
 		) noexcept;
 
 		///
-		/// @brief Create a `Primitive_gpu` from a `Rigged_primitive`, uploading data to the GPU
+		/// @brief Create a `Primitive_gpu` from a `Rigged_primitive` placed in shared buffers
 		///
 		/// @param primitive CPU-side rigged primitive
-		/// @return GPU-side primitive, or error on failure
+		/// @param geometry Location of the uploaded geometry
+		/// @return GPU-side primitive
 		///
-		static std::expected<Primitive_gpu, util::Error> from_rigged_primitive(
-			SDL_GPUDevice* device,
-			const Rigged_primitive& primitive
+		static Primitive_gpu from_rigged_primitive(
+			const Rigged_primitive& primitive,
+			const Primitive_geometry& geometry
 		) noexcept;
 
 		///
@@ -165,11 +233,17 @@ namespace gltf
 		FORCE_INLINE std::tuple<Primitive_mesh_binding, glm::vec3, glm::vec3> gen_drawdata() const noexcept
 		{
 			return {
-				{.vertex_buffer_binding = {.buffer = vertex_buffer, .offset = 0},
-				 .index_buffer_binding = {.buffer = index_buffer, .offset = 0},
-				 .shadow_vertex_buffer_binding = {.buffer = shadow_vertex_buffer, .offset = 0},
-				 .shadow_index_buffer_binding = {.buffer = shadow_index_buffer, .offset = 0},
+				{.vertex_buffer_binding = {.buffer = geometry.vertices.buffer, .offset = 0},
+				 .index_buffer_binding = {.buffer = geometry.indices.buffer, .offset = 0},
+				 .shadow_vertex_buffer_binding = {.buffer = geometry.shadow_vertices.buffer, .offset = 0},
+				 .shadow_index_buffer_binding = {.buffer = geometry.shadow_indices.buffer, .offset = 0},
+				 .index_element_size = geometry.index_element_size,
+				 .shadow_index_element_size = geometry.shadow_index_element_size,
 				 .index_count = index_count,
+				 .first_index = geometry.indices.first,
+				 .vertex_offset = int32_t(geometry.vertices.first),
+				 .shadow_first_index = geometry.shadow_indices.first,
+				 .shadow_vertex_offset = int32_t(geometry.shadow_vertices.first),
 				 .rigged = rigged},
 				position_min,
 				position_max
@@ -182,6 +256,7 @@ namespace gltf
 	{
 		std::vector<Primitive> primitives;
 		std::vector<Rigged_primitive> rigged_primitives;
+		std::vector<std::optional<Occluder_mesh>> occluders;  // One per entry of `primitives`
 
 		///
 		/// @brief Parse a `tinygltf::Mesh` into a `Mesh`
@@ -200,16 +275,40 @@ namespace gltf
 	struct Mesh_gpu
 	{
 		std::vector<Primitive_gpu> primitives;
+	};
+
+	///
+	/// @brief Vertex and index buffers shared by all primitives of a model
+	/// @details Each vertex format has its own buffers, so that base vertices count whole vertices. Index
+	/// lists are narrowed to 16 bits when their vertex count allows, and each index width has its own
+	/// buffers. All ranges are placed before any buffer is created, so buffers are sized exactly. Buffers
+	/// are split at `max_buffer_size`, a range never spans two buffers.
+	///
+	struct Mesh_buffers
+	{
+		static constexpr uint32_t max_buffer_size = 64 * 1024 * 1024;
+
+		struct Statistics
+		{
+			uint32_t primitives = 0;         // Primitives, including rigged ones
+			uint32_t primitives_16bit = 0;   // Primitives drawn with 16-bit indices
+			uint64_t index_bytes = 0;        // Index data of all lists, including shadow lists and padding
+			uint64_t index_bytes_saved = 0;  // Index data saved by narrowing, compared to all 32-bit
+		};
+
+		std::vector<gpu::Buffer> buffers;
+		Statistics statistics;
 
 		///
-		/// @brief Upload a `Mesh` to GPU, creating `Mesh_gpu`
+		/// @brief Pack meshes into shared buffers, uploading their geometry
 		///
-		/// @param mesh CPU-side mesh
-		/// @return GPU-side mesh, or error on failure
+		/// @param batcher Upload batcher, buffers are valid after it is flushed
+		/// @param meshes CPU-side meshes
+		/// @return Shared buffers and GPU-side meshes in the order of `meshes`, or error on failure
 		///
-		static std::expected<Mesh_gpu, util::Error> from_mesh(
-			SDL_GPUDevice* device,
-			const Mesh& mesh
+		static std::expected<std::pair<Mesh_buffers, std::vector<Mesh_gpu>>, util::Error> from_meshes(
+			graphics::Upload_batcher& batcher,
+			std::span<const Mesh> meshes
 		) noexcept;
 	};
 }
\ No newline at end of file
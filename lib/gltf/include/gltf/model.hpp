@@ -8,17 +8,31 @@
 #include "animation.hpp"
 #include "gltf/light.hpp"
 #include "gltf/skin.hpp"
+#include "graphics/affine.hpp"
 #include "material.hpp"
 #include "mesh.hpp"
 #include "node.hpp"
+#include "util/fork-join.hpp"
 
 #include <atomic>
 #include <cstdint>
+#include <limits>
+#include <memory>
+#include <memory_resource>
+#include <string_view>
 #include <unordered_map>
 #include <variant>
 
 namespace gltf
 {
+	// World transform and bound of an `EXT_mesh_gpu_instancing` instance
+	struct Primitive_instance
+	{
+		glm::mat4 world_transform;
+		glm::vec3 world_position_min;  // Bound of the whole mesh, shared by all primitives of the node
+		glm::vec3 world_position_max;
+	};
+
 	// Drawcall for a non-rigged primitive
 	struct Primitive_drawcall
 	{
@@ -26,10 +40,18 @@ namespace gltf
 		glm::vec3 world_position_max;
 		std::optional<uint32_t> material_index;
 		std::variant<glm::mat4, uint32_t> transform_or_joint_matrix_offset;
+		uint32_t joint_count = 0;  // Rigged only, joint matrices used from the offset
 		Primitive_mesh_binding primitive;
 
+		// GPU instances, referencing `Drawdata::instances`. Empty => A single instance at the world
+		// transform. Otherwise the world transform is the node's, and the world bound covers all instances.
+		std::span<const Primitive_instance> instances;
+
 		float emissive_multiplier = 1.0f;
 
+		// Rigged, or driven by an animation. Dynamic drawcalls may move between frames.
+		bool is_dynamic = false;
+
 		FORCE_INLINE bool is_rigged() const noexcept
 		{
 			return std::holds_alternative<uint32_t>(transform_or_joint_matrix_offset);
@@ -46,12 +68,27 @@ namespace gltf
 		}
 	};
 
+	// Occluder geometry for software occlusion culling
+	struct Occluder_drawcall
+	{
+		std::span<const glm::vec3> positions;
+		std::span<const uint32_t> indices;
+		glm::mat4 world_transform;
+	};
+
+	// Drawdata of a model, containers use the memory resource passed to the generating call
 	struct Drawdata
 	{
 		// Drawcall list
-		std::vector<Primitive_drawcall> primitive_drawcalls;
+		std::pmr::vector<Primitive_drawcall> primitive_drawcalls;
 
-		std::vector<glm::mat4> node_matrices;
+		// Occluder list, tagged occluder nodes and large opaque primitives
+		std::pmr::vector<Occluder_drawcall> occluders;
+
+		std::pmr::vector<glm::mat4> node_matrices;
+
+		// Instances of all instanced nodes, referenced by the drawcalls
+		std::pmr::vector<Primitive_instance> instances;
 
 		// Joint matrices
 		std::shared_ptr<Deferred_skinning_resource> deferred_skin_resource;
@@ -60,6 +97,81 @@ namespace gltf
 		Material_cache::Ref material_cache;
 	};
 
+	// One placement of a model, see `Model::generate_instanced_drawdata()`
+	struct Model_instance
+	{
+		glm::mat4 model_transform;
+		std::span<const Animation_key> animation = {};  // Empty => Rest pose
+	};
+
+	///
+	/// @brief Persistent world transforms and drawcalls of a model, updated incrementally
+	/// @details Kept by the caller across frames, see `Model::generate_drawdata()`. Nodes whose animation
+	/// overrides changed mark their subtrees dirty, and only those are recomputed along with their instances
+	/// and drawcall bounds; static nodes keep their cached world matrices and bounds. Rigged drawcalls are
+	/// refreshed whenever any node moved, as their bounds follow the joints. A changed model transform
+	/// rebuilds everything.
+	///
+	/// The generated drawdata lives in the cache too. Its node matrices, instances and joint palette are the
+	/// cached state itself, and only the drawcalls of recomputed nodes are patched into its drawcall list.
+	/// The list is refiltered when hidden nodes or emission overrides change. A steady frame allocates
+	/// nothing.
+	///
+	class Transform_cache
+	{
+	  public:
+
+		// Drop all cached state, the next update rebuilds everything
+		void invalidate() noexcept { valid = false; }
+
+		// Get the number of nodes whose world matrix was recomputed by the last update
+		size_t get_updated_node_count() const noexcept { return updated_node_count; }
+
+	  private:
+
+		friend class Model;
+
+		bool valid = false;
+		glm::mat4 model_transform;
+
+		Transform_override_set overrides;                 // Applied overrides
+		Transform_override_set scratch_overrides;         // Overrides being evaluated
+		std::vector<Animation_cursor> animation_cursors;  // Playback state of each animation
+		std::vector<bool> dirty;                          // Dirty flags, cleared between updates
+		std::vector<uint32_t> dirty_nodes;                // Nodes whose overrides changed
+		std::vector<uint32_t> stack;                      // Subtree traversal stack
+
+		// Generated drawdata, holds the world matrices, instances and joint palette of all nodes
+		std::optional<Drawdata> drawdata;
+
+		std::vector<Primitive_drawcall> drawcalls;    // Renderable nodes in topological order
+		std::vector<uint32_t> drawcall_nodes;         // Node of each drawcall
+		std::vector<uint32_t> node_drawcall_offsets;  // First drawcall of each node
+		std::vector<uint32_t> rigged_nodes;           // Renderable rigged nodes
+		std::vector<uint32_t> rigged_skins;           // Skins of renderable rigged nodes
+		std::vector<Occluder_drawcall> occluders;     // Occluders regardless of hidden nodes
+		std::vector<uint32_t> occluder_nodes;         // Node of each occluder
+		std::vector<uint32_t> patched_nodes;          // Nodes whose drawcalls the last update recomputed
+
+		static constexpr uint32_t no_drawcall = std::numeric_limits<uint32_t>::max();
+
+		bool refilter = true;                                        // Drawcall list must be rebuilt
+		std::vector<uint32_t> hidden_nodes;                          // Hidden nodes of the drawdata
+		std::vector<std::pair<uint32_t, float>> emission_overrides;  // Emission overrides of the drawdata
+		std::vector<bool> hidden;                                    // Hidden flag of each node
+		std::vector<float> emission_values;                          // Emission multiplier of each node
+		std::vector<uint32_t> filtered_drawcall_offsets;             // First drawdata drawcall per node
+
+		size_t updated_node_count = 0;
+
+		// Get the joint palette of all skins, stored in the drawdata's skinning resource
+		std::span<graphics::Affine_matrix> get_joint_matrices() noexcept
+		{
+			if (!drawdata.has_value() || drawdata->deferred_skin_resource == nullptr) return {};
+			return drawdata->deferred_skin_resource->joint_matrices_data;
+		}
+	};
+
 	class Model
 	{
 	  private:
@@ -67,6 +179,7 @@ namespace gltf
 		/*===== Resources =====*/
 
 		Material_list material_list;        // List of materials
+		Mesh_buffers mesh_buffers;          // Shared geometry buffers of all meshes
 		std::vector<Mesh_gpu> meshes;       // List of meshes
 		std::vector<Node> nodes;            // List of nodes
 		std::vector<Animation> animations;  // List of animations
@@ -79,12 +192,55 @@ namespace gltf
 		std::vector<uint32_t> node_topo_order;                // Topological order of node indices
 		std::vector<std::optional<uint32_t>> node_parents;    // Parent index for each node
 		std::vector<bool> renderable_nodes;                   // If node is renderable (children of root)
+		std::vector<bool> occluder_nodes;                     // If node is a tagged occluder proxy
+		std::vector<bool> animated_nodes;                     // If node or its ancestor is animated
+		std::vector<size_t> node_instance_offsets;            // Offset of each node's instances in drawdata
+		size_t instance_count = 0;                            // Total instance count of instanced nodes
 		size_t primitive_count;                               // Total primitive count
 		std::unique_ptr<Material_cache> material_bind_cache;  // Material bind cache
-		std::unordered_map<std::string, uint32_t> animation_name_map;  // Map of animation name to index
+
+		// Sorted unique target nodes of all animations, the node set of override sets
+		std::vector<uint32_t> animation_targets;
+
+		// Animated nodes in topological order, the only nodes whose world transform can leave the rest pose
+		std::vector<uint32_t> animated_topo_order;
+
+		// Rest TRS of each node in structure-of-arrays form, identity for matrix nodes
+		graphics::Trs_arrays rest_trs;
+
+		// Rest local matrix of each node, composed from `rest_trs` or taken from the node matrix
+		std::vector<graphics::Affine_matrix> rest_local_matrices;
+
+		// Rest world matrix of each node under an identity model transform
+		std::vector<glm::mat4> rest_world_matrices;
+
+		// Transparent string hash, names are looked up by `std::string_view`
+		struct Name_hash
+		{
+			using is_transparent = void;
+
+			size_t operator()(std::string_view name) const noexcept
+			{
+				return std::hash<std::string_view>()(name);
+			}
+		};
+
+		// Map of animation name to index
+		std::unordered_map<std::string, uint32_t, Name_hash, std::equal_to<>> animation_name_map;
+
+		std::unique_ptr<util::Fork_join_pool> parallel_pool;  // Workers for instanced drawdata generation
+
+		// Joint palette format of generated drawdata
+		Skinning_mode skinning_mode = Skinning_mode::Matrix;
 
 	  public:
 
+		// Nodes with this name prefix are occluder proxies, used for occlusion culling but never drawn
+		static constexpr std::string_view occluder_node_prefix = "Occluder-";
+
+		// Minimum world-space size on two axes for a primitive to be used as an occluder automatically
+		static constexpr float min_occluder_extent = 1.0f;
+
 		enum class Load_stage
 		{
 			Node,
@@ -107,6 +263,7 @@ namespace gltf
 		/// @param tinygltf_model Tinygltf model
 		/// @param sampler_config Sampler creation config
 		/// @param image_config Image compression config
+		/// @param animation_compression Animation compression config, `nullopt` => Keep full precision
 		/// @param progress Progress reference for loading progress (optional)
 		/// @return Loaded Model or Error
 		///
@@ -115,9 +272,28 @@ namespace gltf
 			const tinygltf::Model& tinygltf_model,
 			const Sampler_config& sampler_config,
 			const Material_list::Image_config& image_config,
+			const std::optional<Animation_compression_config>& animation_compression,
 			const std::optional<std::reference_wrapper<std::atomic<Load_progress>>>& progress = std::nullopt
 		) noexcept;
 
+		///
+		/// @brief Load model from tinygltf model without a GPU device, for tests and benchmarks
+		/// @details Nodes, lights, animations and skins are loaded as in `from_tinygltf()`. Meshes are taken
+		/// as given, their geometry needs no backing buffers. Materials aren't loaded, so primitives can't
+		/// reference any. Drawdata is generated exactly as for a loaded model, but the model can't be
+		/// rendered.
+		///
+		/// @param tinygltf_model Tinygltf model, its meshes only validate the mesh indices of nodes
+		/// @param meshes One mesh for each mesh of `tinygltf_model`, without material indices
+		/// @param animation_compression Animation compression config, `nullopt` => Keep full precision
+		/// @return Loaded Model or Error
+		///
+		static std::expected<Model, util::Error> from_tinygltf_headless(
+			const tinygltf::Model& tinygltf_model,
+			std::vector<Mesh_gpu> meshes,
+			const std::optional<Animation_compression_config>& animation_compression = std::nullopt
+		) noexcept;
+
 		///
 		/// @brief Generate drawdata for the model
 		/// @warning The life span of the returned drawdata is shorter than the life span of the model
@@ -126,15 +302,68 @@ namespace gltf
 		/// @param animation Animation keys to apply
 		/// @param emission_overrides Overrides for emissive factors (node_index, multiplier)
 		/// @param hidden_nodes List of node indices to hide
+		/// @param resource Memory resource for the drawdata and temporaries, e.g. a frame arena
 		/// @return Drawdata, where drawcall's matrix denotes `Model->World` transform
 		///
 		Drawdata generate_drawdata(
+			const glm::mat4& model_transform,
+			std::span<const Animation_key> animation,
+			std::span<const std::pair<uint32_t, float>> emission_overrides,
+			std::span<const uint32_t> hidden_nodes,
+			std::pmr::memory_resource* resource = std::pmr::get_default_resource()
+		) const noexcept;
+
+		///
+		/// @brief Generate drawdata for the model, reusing world transforms from the last frame
+		/// @details Equivalent to the uncached overload. Only subtrees of nodes whose animation overrides
+		/// changed are recomputed, and only their drawcalls are patched into the drawdata kept in the cache.
+		/// Hidden nodes and emission overrides are compared with the last call, the drawcall list is
+		/// refiltered only when they differ.
+		/// @note Whether a non-tagged occluder is large enough is decided when the cache is rebuilt
+		/// @warning The returned drawdata is owned by the cache and valid until its next update. Its skinning
+		/// resource is reused across frames, so the drawdata of one frame must be rendered before the next
+		/// update.
+		///
+		/// @param cache Transform cache of this model, kept across frames
+		/// @param model_transform Root model transform matrix
+		/// @param animation Animation keys to apply
+		/// @param emission_overrides Overrides for emissive factors (node_index, multiplier)
+		/// @param hidden_nodes List of node indices to hide
+		/// @return Drawdata, where drawcall's matrix denotes `Model->World` transform
+		///
+		const Drawdata& generate_drawdata(
+			Transform_cache& cache,
 			const glm::mat4& model_transform,
 			std::span<const Animation_key> animation,
 			std::span<const std::pair<uint32_t, float>> emission_overrides,
 			std::span<const uint32_t> hidden_nodes
 		) const noexcept;
 
+		///
+		/// @brief Generate combined drawdata for many placements of the model
+		/// @details Instances with equal animation keys share one pose evaluation, each instance then only
+		/// applies its model transform. Instances whose bound is outside the frustum are culled as a whole.
+		/// Poses and placement run in parallel on the model's worker pool, poses allocate from `resource`
+		/// through a lock.
+		/// @warning The life span of the returned drawdata is shorter than the life span of the model
+		///
+		/// @param instances Model instances
+		/// @param frustum_planes Frustum planes to cull instances against, empty => No culling
+		/// @param emission_overrides Overrides for emissive factors (node_index, multiplier), all instances
+		/// @param hidden_nodes List of node indices to hide, all instances
+		/// @param resource Memory resource for the drawdata and temporaries, e.g. a frame arena
+		/// @return Drawdata of all visible instances. `node_matrices` holds `get_node_count()` matrices per
+		/// instance in order, including culled instances. Bounds are the pose's bounds transformed by the
+		/// model transform.
+		///
+		Drawdata generate_instanced_drawdata(
+			std::span<const Model_instance> instances,
+			std::span<const glm::vec4> frustum_planes,
+			std::span<const std::pair<uint32_t, float>> emission_overrides,
+			std::span<const uint32_t> hidden_nodes,
+			std::pmr::memory_resource* resource = std::pmr::get_default_resource()
+		) const noexcept;
+
 		///
 		/// @brief Get the list of animations
 		///
@@ -150,6 +379,59 @@ namespace gltf
 		///
 		std::optional<uint32_t> find_node_by_name(const std::string& name) const noexcept;
 
+		///
+		/// @brief Find all nodes whose name starts with a prefix
+		///
+		/// @param prefix Name prefix
+		/// @return List of (node_index, name) pairs
+		///
+		std::vector<std::pair<uint32_t, std::string>> find_nodes_by_prefix(
+			std::string_view prefix
+		) const noexcept;
+
+		///
+		/// @brief Get the local-space bound of the mesh attached to a node
+		///
+		/// @param node_index Index of the node
+		/// @return Local AABB (min, max), or `nullopt` if the node has no mesh or is rigged
+		///
+		std::optional<std::pair<glm::vec3, glm::vec3>> get_node_local_bound(
+			uint32_t node_index
+		) const noexcept;
+
+		///
+		/// @brief Get the number of nodes
+		///
+		/// @return Node count
+		///
+		size_t get_node_count() const noexcept { return nodes.size(); }
+
+		///
+		/// @brief Get the number of `EXT_mesh_gpu_instancing` instances
+		///
+		/// @return Instance count of all instanced nodes
+		///
+		size_t get_instance_count() const noexcept { return instance_count; }
+
+		///
+		/// @brief Get the statistics of the shared geometry buffers, gathered on loading
+		///
+		/// @return Primitive and index data statistics
+		///
+		const Mesh_buffers::Statistics& get_mesh_statistics() const noexcept
+		{
+			return mesh_buffers.statistics;
+		}
+
+		///
+		/// @brief Set the joint palette format of drawdata generated afterwards
+		///
+		/// @param mode Skinning mode, see `Skinning_mode`
+		///
+		void set_skinning_mode(Skinning_mode mode) noexcept { skinning_mode = mode; }
+
+		Skinning_mode get_skinning_mode() const noexcept { return skinning_mode; }
+
 		///
 		/// @brief Get (node_index, Light) by name
 		///
@@ -171,28 +453,135 @@ namespace gltf
 		// be called after `compute_topo_order()`.
 		void compute_renderable_nodes() noexcept;
 
+		// Find tagged occluder nodes and exclude them from rendering, must be called after
+		// `compute_renderable_nodes()`.
+		void compute_occluder_nodes() noexcept;
+
+		// Find animation targets and nodes whose world transform is driven by any animation, must be called
+		// after `compute_topo_order()`.
+		void compute_animated_nodes() noexcept;
+
+		// Lay out the instances of instanced nodes in drawdata, in node order
+		void compute_instance_offsets() noexcept;
+
+		// Store rest TRS in structure-of-arrays form and compose the rest local and world matrices, must be
+		// called after `compute_topo_order()`.
+		void compute_rest_transforms() noexcept;
+
+		// Compute all accelerating structures above in order, except the material bind cache
+		std::expected<void, util::Error> compute_structures() noexcept;
+
 		/*===== Render Stage =====*/
 
+		// Model-space drawdata of one animation state, shared by all instances in that state
+		struct Pose
+		{
+			std::pmr::vector<glm::mat4> node_matrices;
+			std::pmr::vector<Primitive_instance> instances;
+			std::pmr::vector<Primitive_drawcall> drawcalls;
+			std::pmr::vector<Occluder_drawcall> occluders;
+			std::pmr::vector<graphics::Affine_matrix> joint_matrices;
+			glm::vec3 bound_min = glm::vec3(std::numeric_limits<float>::max());
+			glm::vec3 bound_max = glm::vec3(std::numeric_limits<float>::lowest());
+		};
+
+		// Evaluate a pose in model space
+		Pose compute_pose(
+			std::span<const Animation_key> animation,
+			std::span<const std::pair<uint32_t, float>> emission_overrides,
+			std::span<const uint32_t> hidden_nodes,
+			std::pmr::memory_resource* resource
+		) const noexcept;
+
+		// Resolve the animation index of a key
+		std::optional<uint32_t> find_animation(const Animation_key& key) const noexcept;
+
 		// Compute node transform overrides from animation keys
-		std::vector<Node::Transform_override> compute_node_overrides(
-			std::span<const Animation_key> animation
+		Transform_override_set compute_node_overrides(
+			std::span<const Animation_key> animation,
+			std::pmr::memory_resource* resource
 		) const noexcept;
 
-		// Compute world matrices for all nodes
-		std::vector<glm::mat4> compute_node_world_matrices(
+		// Compute the local matrix of a node with overrides applied
+		graphics::Affine_matrix compute_local_matrix(
+			uint32_t node_index,
+			const Transform_override_set& overrides
+		) const noexcept;
+
+		// Compute world matrices for all nodes, overridden local matrices are composed in a batch. The model
+		// transform must be affine. Under an identity model transform, only animated nodes are recomputed and
+		// the rest are copied from `rest_world_matrices`.
+		std::pmr::vector<glm::mat4> compute_node_world_matrices(
 			const glm::mat4& model_transform,
-			std::span<const Node::Transform_override> node_overrides
+			const Transform_override_set& node_overrides,
+			std::pmr::memory_resource* resource
+		) const noexcept;
+
+		// Compute world transforms and bounds of all instances, laid out by `node_instance_offsets`
+		std::pmr::vector<Primitive_instance> compute_instances(
+			std::span<const glm::mat4> node_world_matrices,
+			std::pmr::memory_resource* resource
 		) const noexcept;
 
-		// Generate drawcalls from world matrices
-		std::vector<Primitive_drawcall> compute_drawcalls(
-			const std::vector<glm::mat4>& node_world_matrices,
+		// Generate drawcalls from world matrices, `joint_matrices` must cover the skins of drawn rigged nodes
+		std::pmr::vector<Primitive_drawcall> compute_drawcalls(
+			std::span<const glm::mat4> node_world_matrices,
+			std::span<const Primitive_instance> instances,
+			std::span<const graphics::Affine_matrix> joint_matrices,
 			std::span<const std::pair<uint32_t, float>> emission_overrides,
-			std::span<const uint32_t> hidden_nodes
+			std::span<const uint32_t> hidden_nodes,
+			std::pmr::memory_resource* resource
+		) const noexcept;
+
+		// Compute world transforms and bounds of the instances of one node
+		void compute_node_instances(
+			uint32_t node_index,
+			const glm::mat4& world_matrix,
+			std::span<Primitive_instance> output
+		) const noexcept;
+
+		// Generate the drawcalls of one node, `output` holds one drawcall per primitive of its mesh. Rigged
+		// bounds read the node's skin from `joint_matrices`, laid out as `Skin_list::compute_joint_matrices`.
+		void compute_node_drawcalls(
+			uint32_t node_index,
+			std::span<const glm::mat4> node_world_matrices,
+			std::span<const Primitive_instance> instances,
+			std::span<const graphics::Affine_matrix> joint_matrices,
+			float emissive_multiplier,
+			std::span<Primitive_drawcall> output
+		) const noexcept;
+
+		// Collect occluders from world matrices, optionally with the node of each occluder
+		std::pmr::vector<Occluder_drawcall> compute_occluders(
+			std::span<const glm::mat4> node_world_matrices,
+			std::span<const uint32_t> hidden_nodes,
+			std::pmr::memory_resource* resource,
+			std::pmr::vector<uint32_t>* occluder_node_indices = nullptr
+		) const noexcept;
+
+		// Find skins used by drawn rigged nodes, joint matrices of other skins are skipped
+		std::pmr::vector<uint32_t> compute_used_skins(
+			std::span<const uint32_t> hidden_nodes,
+			std::pmr::memory_resource* resource
+		) const noexcept;
+
+		// Recompute all cached state of a transform cache
+		void rebuild_transform_cache(
+			Transform_cache& cache,
+			const glm::mat4& model_transform,
+			std::span<const Animation_key> animation
+		) const noexcept;
+
+		// Update a transform cache, recomputing only the subtrees of nodes whose overrides changed
+		void update_transform_cache(
+			Transform_cache& cache,
+			const glm::mat4& model_transform,
+			std::span<const Animation_key> animation
 		) const noexcept;
 
 		Model(
 			Material_list material_list,
+			Mesh_buffers mesh_buffers,
 			std::vector<Mesh_gpu> meshes,
 			std::vector<Node> nodes,
 			std::vector<Animation> animations,
@@ -11,7 +11,9 @@
 #include <expected>
 #include <glm/glm.hpp>
 #include <glm/gtc/quaternion.hpp>
+#include <memory_resource>
 #include <optional>
+#include <span>
 #include <tiny_gltf.h>
 #include <variant>
 #include <vector>
@@ -33,6 +35,8 @@ namespace gltf
 			{
 				return translation.has_value() || rotation.has_value() || scale.has_value();
 			}
+
+			bool operator==(const Transform_override&) const noexcept = default;
 		};
 
 		// Node transform, under its parent's coordinate system
@@ -79,6 +83,10 @@ namespace gltf
 		std::variant<Transform, glm::mat4> transform = Transform{};
 		std::optional<uint32_t> light = std::nullopt;
 
+		// Local transforms of `EXT_mesh_gpu_instancing` instances, applied after the node transform. Empty =>
+		// Not instanced.
+		std::vector<glm::mat4> instances;
+
 		// TODO: Weights, Name
 
 		///
@@ -120,4 +128,56 @@ namespace gltf
 			}
 		}
 	};
+
+	///
+	/// @brief Sparse node transform overrides over a fixed set of nodes
+	/// @details Only nodes that animations may target get an entry, so applying animations and reading the
+	/// overrides scale with the animated nodes rather than the scene.
+	///
+	class Transform_override_set
+	{
+	  public:
+
+		Transform_override_set() = default;
+
+		///
+		/// @brief Create an empty override set
+		///
+		/// @param nodes Sorted unique node indices that may be overridden, must outlive the set
+		/// @param resource Memory resource for the overrides
+		///
+		explicit Transform_override_set(
+			std::span<const uint32_t> nodes,
+			std::pmr::memory_resource* resource = std::pmr::get_default_resource()
+		) noexcept :
+			nodes(nodes),
+			overrides(nodes.size(), resource)
+		{}
+
+		///
+		/// @brief Find the override of a node
+		///
+		/// @param node_index Node index
+		/// @return Override, or `nullptr` if the node isn't in the set
+		///
+		Node::Transform_override* find(uint32_t node_index) noexcept;
+
+		const Node::Transform_override* find(uint32_t node_index) const noexcept;
+
+		// Reset all overrides, keeping the node set
+		void clear() noexcept;
+
+		// Get the node indices, sorted
+		std::span<const uint32_t> get_nodes() const noexcept { return nodes; }
+
+		// Get the overrides, in the order of `get_nodes()`
+		std::span<const Node::Transform_override> get_overrides() const noexcept { return overrides; }
+
+		std::span<Node::Transform_override> get_overrides() noexcept { return overrides; }
+
+	  private:
+
+		std::span<const uint32_t> nodes;
+		std::pmr::vector<Node::Transform_override> overrides;
+	};
 };
\ No newline at end of file
@@ -2,19 +2,38 @@
 
 #include "gpu/buffer.hpp"
 #include "gpu/copy-pass.hpp"
+#include "graphics/affine.hpp"
 #include "graphics/util/buffer-pool.hpp"
+#include "graphics/util/upload-ring.hpp"
 #include "util/error.hpp"
 #include "util/inline.hpp"
 
 #include <SDL3/SDL_gpu.h>
 #include <glm/glm.hpp>
+#include <memory_resource>
+#include <span>
 #include <tiny_gltf.h>
 
 namespace gltf
 {
+	///
+	/// @brief Joint palette format uploaded to the skinning shaders
+	/// @details
+	/// - `Matrix`: 3x4 affine matrices (48 bytes per joint), blended linearly. Any affine joint transform.
+	/// - `Dual_quaternion`: unit dual quaternions (32 bytes per joint), blended with dual quaternion linear
+	/// blending. Joint scale and shear are dropped, volume is preserved around twisting joints. Vertices
+	/// bound to one joint match `Matrix` within float rounding when the joint is rigid; blended vertices
+	/// differ by design.
+	///
+	enum class Skinning_mode
+	{
+		Matrix,
+		Dual_quaternion
+	};
+
 	struct Skin
 	{
-		std::span<const glm::mat4> inverse_bind_matrices;
+		std::span<const graphics::Affine_matrix> inverse_bind_matrices;
 		std::span<const uint32_t> joints;
 		uint32_t offset;
 	};
@@ -22,7 +41,7 @@ namespace gltf
 	// Collection of skins
 	struct Skin_list
 	{
-		std::vector<glm::mat4> inverse_bind_matrices;
+		std::vector<graphics::Affine_matrix> inverse_bind_matrices;
 		std::vector<uint32_t> joints;
 
 		// Skin binding (offset, length) by skin index
@@ -30,8 +49,34 @@ namespace gltf
 
 		static std::expected<Skin_list, util::Error> from_tinygltf(const tinygltf::Model& model) noexcept;
 
-		std::vector<glm::mat4> compute_joint_matrices(
-			const std::vector<glm::mat4>& node_world_matrices
+		///
+		/// @brief Compute joint matrices as 3x4 affine matrices, the layout uploaded to the skinning shaders
+		/// @note The result always holds all joints, so skin offsets stay valid. Joints of skins not listed
+		/// are left unset.
+		///
+		/// @param node_world_matrices World matrices of all nodes
+		/// @param skins Skins to compute
+		/// @param resource Memory resource of the result
+		/// @return Joint matrices of all skins
+		///
+		std::pmr::vector<graphics::Affine_matrix> compute_joint_matrices(
+			std::span<const glm::mat4> node_world_matrices,
+			std::span<const uint32_t> skins,
+			std::pmr::memory_resource* resource = std::pmr::get_default_resource()
+		) const noexcept;
+
+		///
+		/// @brief Compute joint matrices of the listed skins into an existing buffer
+		/// @note Joints of skins not listed are left untouched
+		///
+		/// @param node_world_matrices World matrices of all nodes
+		/// @param skins Skins to compute
+		/// @param output Joint matrices of all skins, must hold `joints.size()` matrices
+		///
+		void compute_joint_matrices(
+			std::span<const glm::mat4> node_world_matrices,
+			std::span<const uint32_t> skins,
+			std::span<graphics::Affine_matrix> output
 		) const noexcept;
 
 		FORCE_INLINE Skin operator[](size_t idx) const noexcept
@@ -50,14 +95,21 @@ namespace gltf
 	/// @details
 	/// - Holds resource for deferred skinning computation. The external renderer and the drawdata
 	/// unit share this resource
-	/// - Responsible for preparing and uploading GPU buffers for skin computation
+	/// - Responsible for preparing and uploading GPU buffers for skin computation. Only joint ranges marked
+	/// with `mark_used()` are uploaded, skins whose drawcalls are all culled cost no transfer.
 	///
 	struct Deferred_skinning_resource
 	{
-		std::vector<glm::mat4> joint_matrices_data;
+		std::pmr::vector<graphics::Affine_matrix> joint_matrices_data;
 
-		// Initialize at render time, see `prepare_gpu_buffers`
-		std::shared_ptr<gpu::Transfer_buffer> upload_buffer = nullptr;
+		// Palette format of the GPU buffer, the data is converted when packing
+		Skinning_mode mode;
+
+		// Joint ranges (offset, count) to upload, merged and sorted by `prepare_gpu_buffers`
+		std::vector<std::pair<uint32_t, uint32_t>> used_ranges;
+
+		// Packed used ranges in the upload ring. Initialize at render time, see `prepare_gpu_buffers`
+		std::optional<graphics::Upload_ring::Allocation> upload_allocation = std::nullopt;
 
 		// Initialize at render time, see `prepare_gpu_buffers`
 		std::shared_ptr<gpu::Buffer> joint_matrices_buffer = nullptr;
@@ -66,20 +118,71 @@ namespace gltf
 		/// @brief Constructs a skinning resource with joint matrices data
 		///
 		/// @param joint_matrices_data Computed joint matrices data, see `Skin_list::compute_joint_matrices`
+		/// @param mode Palette format of the GPU buffer
 		///
-		Deferred_skinning_resource(std::vector<glm::mat4> joint_matrices_data) :
-			joint_matrices_data(std::move(joint_matrices_data))
+		Deferred_skinning_resource(
+			std::pmr::vector<graphics::Affine_matrix> joint_matrices_data,
+			Skinning_mode mode = Skinning_mode::Matrix
+		) :
+			joint_matrices_data(std::move(joint_matrices_data)),
+			mode(mode)
 		{}
 
 		///
-		/// @brief Acquire GPU buffers for skin computation
+		/// @brief Mark the joint range of a drawcall that will be drawn
+		/// @note Must be called before `prepare_gpu_buffers`
+		///
+		/// @param offset Joint matrix offset of the drawcall
+		/// @param count Joint count of the drawcall's skin
+		///
+		FORCE_INLINE void mark_used(uint32_t offset, uint32_t count) noexcept
+		{
+			// Drawcalls of one skin are mostly consecutive
+			if (!used_ranges.empty() && used_ranges.back() == std::make_pair(offset, count)) return;
+			used_ranges.emplace_back(offset, count);
+		}
+
+		///
+		/// @brief Drop the used ranges and GPU state of the last frame, so a resource kept across frames
+		/// can be marked and prepared again
+		///
+		/// @param mode Palette format of the next upload
+		///
+		void reset(Skinning_mode mode) noexcept;
+
+		// Get the number of joints uploaded, valid after `prepare_gpu_buffers`
+		size_t get_used_joint_count() const noexcept;
+
+		// Get the size of one joint in the GPU buffer, in bytes
+		size_t get_joint_stride() const noexcept
+		{
+			return mode == Skinning_mode::Dual_quaternion ? sizeof(graphics::Dual_quaternion)
+														  : sizeof(graphics::Affine_matrix);
+		}
+
+		///
+		/// @brief Sort the used ranges, clamp them to the palette and merge overlapping or adjacent ones
+		/// @note Called by `prepare_gpu_buffers`
+		///
+		void merge_used_ranges() noexcept;
+
+		///
+		/// @brief Pack the joints of the used ranges back to back, in the palette format of `mode`
+		///
+		/// @param data Output, must hold `get_joint_stride() * get_used_joint_count()` bytes
+		///
+		void pack_used_ranges(std::span<std::byte> data) const noexcept;
+
+		///
+		/// @brief Acquire GPU buffers for skin computation, and write the used ranges to the upload ring
 		///
 		/// @param buffer_pool Buffer Pool
+		/// @param upload_ring Upload ring of the frame
 		/// @return Void on success, or error on failure
 		///
 		std::expected<void, util::Error> prepare_gpu_buffers(
 			graphics::Buffer_pool& buffer_pool,
-			graphics::Transfer_buffer_pool& transfer_pool
+			graphics::Upload_ring& upload_ring
 		) noexcept;
 
 		///
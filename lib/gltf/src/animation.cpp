@@ -1,13 +1,44 @@
 #include "gltf/animation.hpp"
 
-#include "gltf/detail/animation/channels.hpp"
+#include <algorithm>
+#include <utility>
 
 namespace gltf
 {
-	static std::expected<std::unique_ptr<detail::animation::Channel>, util::Error> parse_channel(
+	namespace
+	{
+		// Target node and sampler of each channel
+		template <typename T>
+		using Channel_list = std::vector<std::pair<uint32_t, detail::animation::Sampler<T>>>;
+
+		// Target node and compressed sampler of each channel
+		template <typename T>
+		using Compressed_channel_list =
+			std::vector<std::pair<uint32_t, detail::animation::Compressed_sampler<T>>>;
+
+		// Parsed channels of an animation, grouped by target path
+		struct Parsed_channels
+		{
+			Channel_list<glm::vec3> translation;
+			Channel_list<glm::quat> rotation;
+			Channel_list<glm::vec3> scale;
+		};
+
+		template <typename T>
+		size_t get_memory_size(const Channel_list<T>& channels) noexcept
+		{
+			size_t size = 0;
+			for (const auto& [_, sampler] : channels) size += sampler.get_memory_size();
+
+			return size;
+		}
+	}
+
+	static std::expected<void, util::Error> parse_channel(
 		const tinygltf::Model& model,
 		const tinygltf::AnimationChannel& channel,
-		const tinygltf::AnimationSampler& sampler
+		const tinygltf::AnimationSampler& sampler,
+		Parsed_channels& parsed_channels
 	) noexcept
 	{
 		/* Check Target Index */
@@ -24,42 +55,75 @@ namespace gltf
 		{
 			auto sampler_result = detail::animation::Sampler<glm::vec3>::from_tinygltf(model, sampler);
 			if (!sampler_result) return sampler_result.error().forward("Parse translation sampler failed");
-			return std::make_unique<detail::animation::Translation_channel>(
-				target_node,
-				std::move(*sampler_result)
-			);
+			parsed_channels.translation.emplace_back(target_node, std::move(*sampler_result));
 		}
 		else if (channel_target == "rotation")
 		{
 			auto sampler_result = detail::animation::Sampler<glm::quat>::from_tinygltf(model, sampler);
 			if (!sampler_result) return sampler_result.error().forward("Parse rotation sampler failed");
-			return std::make_unique<detail::animation::Rotation_channel>(
-				target_node,
-				std::move(*sampler_result)
-			);
+			parsed_channels.rotation.emplace_back(target_node, std::move(*sampler_result));
 		}
 		else if (channel_target == "scale")
 		{
 			auto sampler_result = detail::animation::Sampler<glm::vec3>::from_tinygltf(model, sampler);
 			if (!sampler_result) return sampler_result.error().forward("Parse scale sampler failed");
-			return std::make_unique<detail::animation::Scale_channel>(
-				target_node,
-				std::move(*sampler_result)
-			);
+			parsed_channels.scale.emplace_back(target_node, std::move(*sampler_result));
 		}
 		else
 			return util::Error(
 				std::format("Unknown or unsupported animation channel target path: {}", channel_target)
 			);
+
+		return {};
+	}
+
+	///
+	/// @brief Move compressible channels out of a channel list and compress them
+	///
+	/// @param channels Full precision channels, compressed channels are removed
+	/// @param config Compression settings
+	/// @param tolerance Error tolerance of the channel path
+	/// @param max_error Max error of the compressed channels, updated
+	/// @return Compressed channels
+	///
+	template <typename T>
+	static Compressed_channel_list<T> compress_channels(
+		Channel_list<T>& channels,
+		const Animation_compression_config& config,
+		float tolerance,
+		float& max_error
+	) noexcept
+	{
+		Channel_list<T> remaining_channels;
+		Compressed_channel_list<T> compressed_channels;
+
+		for (auto& [target_node, sampler] : channels)
+		{
+			auto compressed = sampler.get_times().size() >= config.min_keyframes
+				? detail::animation::Compressed_sampler<T>::compress(sampler, tolerance)
+				: std::nullopt;
+
+			if (!compressed.has_value())
+			{
+				remaining_channels.emplace_back(target_node, std::move(sampler));
+				continue;
+			}
+
+			max_error = std::max(max_error, compressed->get_max_error());
+			compressed_channels.emplace_back(target_node, std::move(*compressed));
+		}
+
+		channels = std::move(remaining_channels);
+		return compressed_channels;
 	}
 
 	std::expected<Animation, util::Error> Animation::from_tinygltf(
 		const tinygltf::Model& model,
-		const tinygltf::Animation& animation
+		const tinygltf::Animation& animation,
+		const std::optional<Animation_compression_config>& compression
 	) noexcept
 	{
-		std::vector<std::unique_ptr<detail::animation::Channel>> channels;
-		channels.reserve(animation.channels.size());
+		Parsed_channels parsed_channels;
 
 		for (const auto& channel : animation.channels)
 		{
@@ -67,20 +131,100 @@ namespace gltf
 			if (sampler_index < 0 || std::cmp_greater_equal(sampler_index, animation.samplers.size()))
 				return util::Error("Invalid sampler index for animation channel");
 
-			auto channel_result = parse_channel(model, channel, animation.samplers[sampler_index]);
-			if (!channel_result) return channel_result.error().forward("Parse animation channel failed");
+			const auto& sampler = animation.samplers[sampler_index];
+			auto parse_result = parse_channel(model, channel, sampler, parsed_channels);
+			if (!parse_result) return parse_result.error().forward("Parse animation channel failed");
+		}
+
+		/* Compress */
+
+		Compression_statistics statistics;
+
+		statistics.original_size = get_memory_size(parsed_channels.translation)
+			+ get_memory_size(parsed_channels.rotation)
+			+ get_memory_size(parsed_channels.scale);
+
+		Compressed_channel_list<glm::vec3> compressed_translation, compressed_scale;
+		Compressed_channel_list<glm::quat> compressed_rotation;
+
+		if (compression.has_value())
+		{
+			compressed_translation = compress_channels(
+				parsed_channels.translation,
+				*compression,
+				compression->translation_tolerance,
+				statistics.max_translation_error
+			);
+			compressed_rotation = compress_channels(
+				parsed_channels.rotation,
+				*compression,
+				compression->rotation_tolerance,
+				statistics.max_rotation_error
+			);
+			compressed_scale = compress_channels(
+				parsed_channels.scale,
+				*compression,
+				compression->scale_tolerance,
+				statistics.max_scale_error
+			);
 
-			channels.push_back(std::move(*channel_result));
+			statistics.compressed_channels = static_cast<uint32_t>(
+				compressed_translation.size() + compressed_rotation.size() + compressed_scale.size()
+			);
 		}
 
-		return Animation(
+		Animation result(
 			animation.name.empty() ? std::nullopt : std::optional<std::string>(animation.name),
-			std::move(channels)
+			{&Node::Transform_override::translation,
+			 std::move(parsed_channels.translation),
+			 std::move(compressed_translation)},
+			{&Node::Transform_override::rotation,
+			 std::move(parsed_channels.rotation),
+			 std::move(compressed_rotation)},
+			{&Node::Transform_override::scale, std::move(parsed_channels.scale), std::move(compressed_scale)}
 		);
+
+		statistics.compressed_size = result.translation_channels.get_memory_size()
+			+ result.rotation_channels.get_memory_size()
+			+ result.scale_channels.get_memory_size();
+		result.compression_statistics = statistics;
+
+		return result;
+	}
+
+	void Animation::apply(Transform_override_set& overrides, float time) const noexcept
+	{
+		translation_channels.apply(overrides, time, nullptr);
+		rotation_channels.apply(overrides, time, nullptr);
+		scale_channels.apply(overrides, time, nullptr);
 	}
 
-	void Animation::apply(std::span<Node::Transform_override> overrides, float time) const noexcept
+	void Animation::apply(
+		Transform_override_set& overrides,
+		float time,
+		Animation_cursor& cursor
+	) const noexcept
 	{
-		for (const auto& channel : channels) channel->apply(overrides, time);
+		cursor.channels.resize(
+			translation_channels.size() + rotation_channels.size() + scale_channels.size()
+		);
+
+		auto* const translation_cursors = cursor.channels.data();
+		auto* const rotation_cursors = translation_cursors + translation_channels.size();
+		auto* const scale_cursors = rotation_cursors + rotation_channels.size();
+
+		translation_channels.apply(overrides, time, translation_cursors);
+		rotation_channels.apply(overrides, time, rotation_cursors);
+		scale_channels.apply(overrides, time, scale_cursors);
+	}
+
+	std::vector<uint32_t> Animation::get_target_nodes() const noexcept
+	{
+		std::vector<uint32_t> target_nodes;
+		target_nodes.append_range(translation_channels.get_target_nodes());
+		target_nodes.append_range(rotation_channels.get_target_nodes());
+		target_nodes.append_range(scale_channels.get_target_nodes());
+
+		return target_nodes;
 	}
 }
\ No newline at end of file
@@ -1,19 +1,244 @@
 #include "gltf/detail/animation/channels.hpp"
 
+#include <algorithm>
+#include <cassert>
+#include <ranges>
+
 namespace gltf::detail::animation
 {
-	void Translation_channel::apply(std::span<Node::Transform_override> overrides, float time) const noexcept
+	namespace
+	{
+		// Evaluation order of interpolation modes in a channel table
+		constexpr uint32_t get_group(Interpolation interpolation) noexcept
+		{
+			switch (interpolation)
+			{
+			case Interpolation::Step:
+				return 0;
+			case Interpolation::Linear:
+				return 1;
+			case Interpolation::Cubic:
+				return 2;
+			default:
+				std::unreachable();
+			}
+		}
+
+		FORCE_INLINE inline std::array<float, 3> to_components(const glm::vec3& value) noexcept
+		{
+			return {value.x, value.y, value.z};
+		}
+
+		FORCE_INLINE inline std::array<float, 4> to_components(const glm::quat& value) noexcept
+		{
+			return {value.x, value.y, value.z, value.w};
+		}
+
+		template <typename T, size_t Components>
+		FORCE_INLINE inline void set_lane(
+			std::array<std::array<float, batch_size>, Components>& lanes,
+			size_t lane,
+			const T& value
+		) noexcept
+		{
+			const auto components = to_components(value);
+			for (size_t component = 0; component < Components; component++)
+				lanes[component][lane] = components[component];
+		}
+
+		FORCE_INLINE inline glm::vec3 get_result(const Segment_batch<3>& batch, size_t lane) noexcept
+		{
+			return {batch.result[0][lane], batch.result[1][lane], batch.result[2][lane]};
+		}
+
+		FORCE_INLINE inline glm::quat get_result(const Segment_batch<4>& batch, size_t lane) noexcept
+		{
+			return glm::quat::wxyz(
+				batch.result[3][lane],
+				batch.result[0][lane],
+				batch.result[1][lane],
+				batch.result[2][lane]
+			);
+		}
+
+		///
+		/// @brief Sort channels into groups and split them into target nodes and samplers
+		///
+		/// @param channels Channels to sort
+		/// @param target_nodes Target nodes, appended
+		/// @param samplers Samplers, appended
+		/// @param group_ends End of each group in `samplers`
+		///
+		template <typename S, size_t N>
+		void split_channels(
+			std::vector<std::pair<uint32_t, S>> channels,
+			std::vector<uint32_t>& target_nodes,
+			std::vector<S>& samplers,
+			std::array<uint32_t, N>& group_ends
+		) noexcept
+		{
+			std::ranges::stable_sort(channels, {}, [](const auto& channel) {
+				return get_group(channel.second.get_interpolation());
+			});
+
+			samplers.reserve(channels.size());
+
+			for (auto& [target_node, sampler] : channels)
+			{
+				assert(get_group(sampler.get_interpolation()) < N);
+
+				target_nodes.push_back(target_node);
+				samplers.push_back(std::move(sampler));
+			}
+
+			// Count channels per group, then accumulate into group ends
+			for (const auto& sampler : samplers) group_ends[get_group(sampler.get_interpolation())]++;
+			for (const auto group : std::views::iota(1zu, N)) group_ends[group] += group_ends[group - 1];
+		}
+	}
+
+	template <typename T>
+	Channel_table<T>::Channel_table(
+		Path path,
+		std::vector<std::pair<uint32_t, Sampler<T>>> channels,
+		std::vector<std::pair<uint32_t, Compressed_sampler<T>>> compressed_channels
+	) noexcept :
+		path(path)
+	{
+		target_nodes.reserve(channels.size() + compressed_channels.size());
+
+		split_channels(std::move(channels), target_nodes, samplers, group_ends);
+		split_channels(
+			std::move(compressed_channels),
+			target_nodes,
+			compressed_samplers,
+			compressed_group_ends
+		);
+	}
+
+	template <typename T>
+	size_t Channel_table<T>::get_memory_size() const noexcept
+	{
+		size_t size = 0;
+		for (const auto& sampler : samplers) size += sampler.get_memory_size();
+		for (const auto& sampler : compressed_samplers) size += sampler.get_memory_size();
+
+		return size;
+	}
+
+	template <typename T>
+	void Channel_table<T>::apply(
+		Transform_override_set& overrides,
+		float time,
+		Sampler_cursor* cursors
+	) const noexcept
 	{
-		overrides[target_node].translation = sampler[time];
+		const auto sampler_span = std::span<const Sampler<T>>(samplers);
+		apply_step(overrides, time, cursors, sampler_span, 0, 0, group_ends[0]);
+		apply_batched<false>(overrides, time, cursors, sampler_span, 0, group_ends[0], group_ends[1]);
+		apply_batched<true>(overrides, time, cursors, sampler_span, 0, group_ends[1], group_ends[2]);
+
+		// Compressed samplers have no cubic group
+		const auto compressed_span = std::span<const Compressed_sampler<T>>(compressed_samplers);
+		const auto compressed_offset = static_cast<uint32_t>(samplers.size());
+		apply_step(overrides, time, cursors, compressed_span, compressed_offset, 0, compressed_group_ends[0]);
+		apply_batched<false>(
+			overrides,
+			time,
+			cursors,
+			compressed_span,
+			compressed_offset,
+			compressed_group_ends[0],
+			compressed_group_ends[1]
+		);
 	}
 
-	void Rotation_channel::apply(std::span<Node::Transform_override> overrides, float time) const noexcept
+	template <typename T>
+	template <typename S>
+	void Channel_table<T>::apply_step(
+		Transform_override_set& overrides,
+		float time,
+		Sampler_cursor* cursors,
+		std::span<const S> samplers,
+		uint32_t channel_offset,
+		uint32_t begin,
+		uint32_t end
+	) const noexcept
 	{
-		overrides[target_node].rotation = sampler[time];
+		for (const auto index : std::views::iota(begin, end))
+		{
+			const auto channel = channel_offset + index;
+
+			auto* const override = overrides.find(target_nodes[channel]);
+			if (override == nullptr) continue;
+
+			const auto& sampler = samplers[index];
+			const auto segment = sampler.locate(time, cursors != nullptr ? &cursors[channel] : nullptr);
+			override->*path = sampler.get_value(segment.first);
+		}
 	}
 
-	void Scale_channel::apply(std::span<Node::Transform_override> overrides, float time) const noexcept
+	template <typename T>
+	template <bool Cubic, typename S>
+	void Channel_table<T>::apply_batched(
+		Transform_override_set& overrides,
+		float time,
+		Sampler_cursor* cursors,
+		std::span<const S> samplers,
+		uint32_t channel_offset,
+		uint32_t begin,
+		uint32_t end
+	) const noexcept
 	{
-		overrides[target_node].scale = sampler[time];
+		Segment_batch<components> batch{};
+		std::array<std::optional<T>*, batch_size> outputs;
+		size_t lane_count = 0;
+
+		const auto flush = [&] {
+			batch.pad(lane_count);
+
+			if constexpr (Cubic)
+				interpolate_cubic_spline(batch);
+			else
+				interpolate_linear(batch);
+
+			for (const auto lane : std::views::iota(0zu, lane_count))
+				*outputs[lane] = get_result(batch, lane);
+			lane_count = 0;
+		};
+
+		for (const auto index : std::views::iota(begin, end))
+		{
+			const auto channel = channel_offset + index;
+
+			auto* const override = overrides.find(target_nodes[channel]);
+			if (override == nullptr) continue;
+
+			const auto& sampler = samplers[index];
+			const auto segment = sampler.locate(time, cursors != nullptr ? &cursors[channel] : nullptr);
+
+			/* Gather */
+
+			const auto lane = lane_count++;
+			set_lane(batch.a, lane, sampler.get_value(segment.first));
+			set_lane(batch.b, lane, sampler.get_value(segment.second));
+			batch.factor[lane] = segment.factor;
+			batch.duration[lane] = segment.duration;
+
+			if constexpr (Cubic)
+			{
+				set_lane(batch.a_out_tangent, lane, sampler.get_out_tangent(segment.first));
+				set_lane(batch.b_in_tangent, lane, sampler.get_in_tangent(segment.second));
+			}
+
+			outputs[lane] = &(override->*path);
+
+			if (lane_count == batch_size) flush();
+		}
+
+		if (lane_count > 0) flush();
 	}
+
+	template class Channel_table<glm::vec3>;
+	template class Channel_table<glm::quat>;
 }
\ No newline at end of file
@@ -0,0 +1,226 @@
+#include "gltf/detail/animation/compressed-sampler.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <ranges>
+
+namespace gltf::detail::animation
+{
+	Packed_quat Packed_quat::pack(const glm::quat& quat) noexcept
+	{
+		const std::array components = {quat.x, quat.y, quat.z, quat.w};
+		const auto largest = static_cast<uint32_t>(std::distance(
+			components.begin(),
+			std::ranges::max_element(components, {}, [](float value) { return std::abs(value); })
+		));
+
+		// Negate the whole quaternion if needed, so that the dropped component is positive
+		const float sign = components[largest] < 0.0f ? -1.0f : 1.0f;
+
+		uint64_t bits = largest;
+		for (const auto component : std::views::iota(0u, 4u))
+		{
+			if (component == largest) continue;
+
+			const float normalized = (components[component] * sign * glm::root_two<float>() + 1.0f) * 0.5f;
+			const auto quantized = std::lround(std::clamp(normalized, 0.0f, 1.0f) * 32767.0f);
+			bits = (bits << 15) | static_cast<uint64_t>(quantized);
+		}
+
+		return {
+			.data = {
+				static_cast<uint16_t>(bits >> 32),
+				static_cast<uint16_t>(bits >> 16),
+				static_cast<uint16_t>(bits)
+			}
+		};
+	}
+
+	namespace
+	{
+		FORCE_INLINE inline glm::vec3 interpolate(
+			const glm::vec3& a,
+			const glm::vec3& b,
+			float factor
+		) noexcept
+		{
+			return glm::mix(a, b, factor);
+		}
+
+		FORCE_INLINE inline glm::quat interpolate(
+			const glm::quat& a,
+			const glm::quat& b,
+			float factor
+		) noexcept
+		{
+			return glm::slerp(a, b, factor);
+		}
+
+		FORCE_INLINE inline float compute_error(const glm::vec3& a, const glm::vec3& b) noexcept
+		{
+			return glm::distance(a, b);
+		}
+
+		// Rotation angle between two rotations
+		FORCE_INLINE inline float compute_error(const glm::quat& a, const glm::quat& b) noexcept
+		{
+			return 2.0f * std::acos(std::min(1.0f, std::abs(glm::dot(a, b))));
+		}
+
+		///
+		/// @brief Select the keys to keep
+		///
+		/// @param interpolation Step or linear
+		/// @param times Key times
+		/// @param values Key values
+		/// @param tolerance Max error of a removed key
+		/// @param max_window Max keys between two kept keys
+		/// @return Indices of the keys to keep, including the first and last key
+		///
+		template <typename T>
+		std::vector<uint32_t> select_keys(
+			Interpolation interpolation,
+			std::span<const float> times,
+			std::span<const T> values,
+			float tolerance,
+			uint32_t max_window
+		) noexcept
+		{
+			const auto count = static_cast<uint32_t>(times.size());
+
+			// Check if the keys strictly between `anchor` and `end` are reproduced from `anchor` to `end`
+			const auto fits = [&](uint32_t anchor, uint32_t end) {
+				if (end - anchor > max_window) return false;
+
+				return std::ranges::all_of(std::views::iota(anchor + 1, end), [&](uint32_t key) {
+					if (interpolation == Interpolation::Step)
+						return compute_error(values[anchor], values[key]) <= tolerance;
+
+					const float factor = (times[key] - times[anchor]) / (times[end] - times[anchor]);
+					const auto value = interpolate(values[anchor], values[end], factor);
+					return compute_error(value, values[key]) <= tolerance;
+				});
+			};
+
+			std::vector<uint32_t> kept = {0};
+			uint32_t anchor = 0;
+
+			for (uint32_t end = 2; end < count; end++)
+			{
+				if (fits(anchor, end)) continue;
+
+				anchor = end - 1;
+				kept.push_back(anchor);
+			}
+
+			if (count > 1) kept.push_back(count - 1);
+
+			return kept;
+		}
+	}
+
+	template <typename T>
+	std::optional<Compressed_sampler<T>> Compressed_sampler<T>::compress(
+		const Sampler<T>& sampler,
+		float tolerance
+	) noexcept
+	{
+		if (sampler.get_interpolation() == Interpolation::Cubic) return std::nullopt;
+
+		const auto source_times = sampler.get_times();
+		const auto source_values = sampler.get_values();
+
+		/* Remove Keys */
+
+		const auto kept = select_keys(
+			sampler.get_interpolation(),
+			source_times,
+			source_values,
+			tolerance,
+			max_removal_window
+		);
+
+		Compressed_sampler result;
+		result.interpolation = sampler.get_interpolation();
+		result.times = Keyframe_times(
+			kept | std::views::transform([&](uint32_t key) { return source_times[key]; })
+			| std::ranges::to<std::vector>()
+		);
+
+		/* Quantize */
+
+		result.values.reserve(kept.size());
+
+		if constexpr (std::same_as<T, glm::quat>)
+		{
+			for (const auto key : kept) result.values.push_back(Packed_quat::pack(source_values[key]));
+		}
+		else
+		{
+			glm::vec3 range_max(std::numeric_limits<float>::lowest());
+			result.range_min = glm::vec3(std::numeric_limits<float>::max());
+
+			for (const auto key : kept)
+			{
+				result.range_min = glm::min(result.range_min, source_values[key]);
+				range_max = glm::max(range_max, source_values[key]);
+			}
+
+			result.range_scale = (range_max - result.range_min) / 65535.0f;
+			const auto inv_scale = glm::vec3(
+				result.range_scale.x > 0.0f ? 1.0f / result.range_scale.x : 0.0f,
+				result.range_scale.y > 0.0f ? 1.0f / result.range_scale.y : 0.0f,
+				result.range_scale.z > 0.0f ? 1.0f / result.range_scale.z : 0.0f
+			);
+
+			for (const auto key : kept)
+			{
+				const auto quantized = glm::round((source_values[key] - result.range_min) * inv_scale);
+				result.values.push_back(
+					Packed_vec3{
+						.data = {
+							static_cast<uint16_t>(std::clamp(quantized.x, 0.0f, 65535.0f)),
+							static_cast<uint16_t>(std::clamp(quantized.y, 0.0f, 65535.0f)),
+							static_cast<uint16_t>(std::clamp(quantized.z, 0.0f, 65535.0f))
+						}
+					}
+				);
+			}
+		}
+
+		/* Measure Error */
+
+		const auto measure_error = [&result](float time, const T& value) {
+			const auto segment = result.locate(time, nullptr);
+			const auto first = result.get_value(segment.first);
+
+			const auto decompressed = result.interpolation == Interpolation::Step
+				? first
+				: interpolate(first, result.get_value(segment.second), segment.factor);
+
+			result.max_error = std::max(result.max_error, compute_error(decompressed, value));
+		};
+
+		// Between two original keys, both curves are a single lerp or step, so for vectors the distance
+		// between them is convex and peaks at the keys
+		for (const auto [time, value] : std::views::zip(source_times, source_values))
+			measure_error(time, value);
+
+		// Slerp arcs spanning different keys can drift apart between the keys, so rotations are also sampled
+		// at the midpoints
+		if constexpr (std::same_as<T, glm::quat>)
+		{
+			if (result.interpolation == Interpolation::Linear)
+				for (const auto key : std::views::iota(1zu, source_times.size()))
+					measure_error(
+						(source_times[key - 1] + source_times[key]) * 0.5f,
+						interpolate(source_values[key - 1], source_values[key], 0.5f)
+					);
+		}
+
+		return result;
+	}
+
+	template class Compressed_sampler<glm::vec3>;
+	template class Compressed_sampler<glm::quat>;
+}
\ No newline at end of file
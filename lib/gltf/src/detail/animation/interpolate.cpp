@@ -1,11 +1,214 @@
 #include "gltf/detail/animation/interpolation.hpp"
 
+#include "util/inline.hpp"
+
+#include <cmath>
+#include <immintrin.h>
+
 namespace gltf::detail::animation
 {
-	template <>
-	glm::quat interpolate_linear(const glm::quat& a, const glm::quat& b, float at, float bt, float t) noexcept
+	static_assert(batch_size == 8, "Kernels process one AVX register of lanes");
+
+	namespace
+	{
+		FORCE_INLINE inline __m256 load(const std::array<float, batch_size>& lanes) noexcept
+		{
+			return _mm256_load_ps(lanes.data());
+		}
+
+		FORCE_INLINE inline void store(std::array<float, batch_size>& lanes, __m256 value) noexcept
+		{
+			_mm256_store_ps(lanes.data(), value);
+		}
+
+		// Hermite basis weights of a cubic spline segment
+		struct Hermite_weights
+		{
+			__m256 a, a_out_tangent, b, b_in_tangent;
+		};
+
+		template <size_t Components>
+		FORCE_INLINE inline Hermite_weights compute_hermite_weights(
+			const Segment_batch<Components>& batch
+		) noexcept
+		{
+			const __m256 t = load(batch.factor);
+			const __m256 td = load(batch.duration);
+			const __m256 t2 = _mm256_mul_ps(t, t);
+			const __m256 t3 = _mm256_mul_ps(t2, t);
+
+			const __m256 two = _mm256_set1_ps(2.0f);
+			const __m256 three = _mm256_set1_ps(3.0f);
+
+			// 2t^3 - 3t^2 + 1, t^3 - 2t^2 + t, -2t^3 + 3t^2, t^3 - t^2
+			const __m256 b = _mm256_sub_ps(_mm256_mul_ps(three, t2), _mm256_mul_ps(two, t3));
+			const __m256 a = _mm256_sub_ps(_mm256_set1_ps(1.0f), b);
+			const __m256 a_out_tangent = _mm256_add_ps(_mm256_sub_ps(t3, _mm256_mul_ps(two, t2)), t);
+			const __m256 b_in_tangent = _mm256_sub_ps(t3, t2);
+
+			return {
+				.a = a,
+				.a_out_tangent = _mm256_mul_ps(a_out_tangent, td),
+				.b = b,
+				.b_in_tangent = _mm256_mul_ps(b_in_tangent, td)
+			};
+		}
+
+		template <size_t Components>
+		FORCE_INLINE inline void apply_hermite_weights(
+			Segment_batch<Components>& batch,
+			const Hermite_weights& weights
+		) noexcept
+		{
+			for (size_t component = 0; component < Components; component++)
+			{
+				const __m256 a = load(batch.a[component]);
+				const __m256 a_out_tangent = load(batch.a_out_tangent[component]);
+				const __m256 b = load(batch.b[component]);
+				const __m256 b_in_tangent = load(batch.b_in_tangent[component]);
+
+				__m256 sum = _mm256_mul_ps(weights.a, a);
+				sum = _mm256_add_ps(sum, _mm256_mul_ps(weights.a_out_tangent, a_out_tangent));
+				sum = _mm256_add_ps(sum, _mm256_mul_ps(weights.b, b));
+				sum = _mm256_add_ps(sum, _mm256_mul_ps(weights.b_in_tangent, b_in_tangent));
+				store(batch.result[component], sum);
+			}
+		}
+
+		// Series terms of the slerp weight, see `compute_slerp_weight()`
+		constexpr size_t slerp_series_terms = 8;
+
+		// Smallest cosine of the half angle where the series stays within float precision
+		constexpr float slerp_series_min_cos = 0.5f;
+
+		///
+		/// @brief Compute the slerp weight `sin(t * theta) / sin(theta)` without trigonometry
+		/// @details Evaluates `t * (1 + b1 * (1 + b2 * (... (1 + bn))))` with
+		/// `bi = (t^2 / (i * (2i + 1)) - i / (2i + 1)) * (cos(theta) - 1)`, the series of D. Eberly's "A Fast
+		/// and Accurate Algorithm for Computing SLERP" truncated at `slerp_series_terms`. For
+		/// `cos(theta) >= slerp_series_min_cos` the truncation error is below 5e-7.
+		///
+		/// @param t Interpolation factor in `[0, 1]`
+		/// @param cos_minus_one `cos(theta) - 1`
+		/// @return Weight
+		///
+		FORCE_INLINE inline __m256 compute_slerp_weight(__m256 t, __m256 cos_minus_one) noexcept
+		{
+			const __m256 t2 = _mm256_mul_ps(t, t);
+			const __m256 one = _mm256_set1_ps(1.0f);
+
+			__m256 sum = one;
+			for (size_t i = slerp_series_terms; i > 0; i--)
+			{
+				const __m256 u = _mm256_set1_ps(1.0f / static_cast<float>(i * (2 * i + 1)));
+				const __m256 v = _mm256_set1_ps(static_cast<float>(i) / static_cast<float>(2 * i + 1));
+				const __m256 b = _mm256_mul_ps(_mm256_sub_ps(_mm256_mul_ps(u, t2), v), cos_minus_one);
+				sum = _mm256_add_ps(one, _mm256_mul_ps(b, sum));
+			}
+
+			return _mm256_mul_ps(t, sum);
+		}
+
+		FORCE_INLINE inline void normalize_result(Segment_batch<4>& batch) noexcept
+		{
+			__m256 length_squared = _mm256_setzero_ps();
+			for (const auto& component : batch.result)
+			{
+				const __m256 value = load(component);
+				length_squared = _mm256_add_ps(length_squared, _mm256_mul_ps(value, value));
+			}
+
+			const __m256 inv_length = _mm256_div_ps(_mm256_set1_ps(1.0f), _mm256_sqrt_ps(length_squared));
+			for (auto& component : batch.result) store(component, _mm256_mul_ps(load(component), inv_length));
+		}
+	}
+
+	void interpolate_linear(Segment_batch<3>& batch) noexcept
+	{
+		const __m256 b_weight = load(batch.factor);
+		const __m256 a_weight = _mm256_sub_ps(_mm256_set1_ps(1.0f), b_weight);
+
+		for (size_t component = 0; component < 3; component++)
+			store(
+				batch.result[component],
+				_mm256_add_ps(
+					_mm256_mul_ps(load(batch.a[component]), a_weight),
+					_mm256_mul_ps(load(batch.b[component]), b_weight)
+				)
+			);
+	}
+
+	void interpolate_linear(Segment_batch<4>& batch) noexcept
+	{
+		/* Shortest Path */
+
+		__m256 cos_theta = _mm256_setzero_ps();
+		for (size_t component = 0; component < 4; component++)
+			cos_theta = _mm256_add_ps(
+				cos_theta,
+				_mm256_mul_ps(load(batch.a[component]), load(batch.b[component]))
+			);
+
+		// Negate `b` where the dot product is negative, by flipping the sign bits
+		const __m256 sign = _mm256_and_ps(cos_theta, _mm256_set1_ps(-0.0f));
+		cos_theta = _mm256_xor_ps(cos_theta, sign);
+
+		/* Weights */
+
+		// `sin(t * theta) / sin(theta)` as a truncated series in `cos(theta) - 1`, which also covers the
+		// `theta -> 0` limit without a lerp fallback
+		const __m256 cos_minus_one = _mm256_sub_ps(cos_theta, _mm256_set1_ps(1.0f));
+		const __m256 b_factor = load(batch.factor);
+		const __m256 a_factor = _mm256_sub_ps(_mm256_set1_ps(1.0f), b_factor);
+
+		alignas(32) std::array<float, batch_size> a_weights, b_weights;
+		store(a_weights, compute_slerp_weight(a_factor, cos_minus_one));
+		store(b_weights, compute_slerp_weight(b_factor, cos_minus_one));
+
+		// Keyframes over 120 degrees apart are rare, their trigonometry stays scalar
+		const auto wide_lanes = _mm256_movemask_ps(
+			_mm256_cmp_ps(cos_theta, _mm256_set1_ps(slerp_series_min_cos), _CMP_LT_OQ)
+		);
+
+		if (wide_lanes != 0) [[unlikely]]
+		{
+			alignas(32) std::array<float, batch_size> cos_lanes;
+			store(cos_lanes, cos_theta);
+
+			for (size_t lane = 0; lane < batch_size; lane++)
+			{
+				if ((wide_lanes & (1 << lane)) == 0) continue;
+
+				const float angle = std::acos(cos_lanes[lane]);
+				const float inv_sin = 1.0f / std::sin(angle);
+				a_weights[lane] = std::sin((1.0f - batch.factor[lane]) * angle) * inv_sin;
+				b_weights[lane] = std::sin(batch.factor[lane] * angle) * inv_sin;
+			}
+		}
+
+		/* Blend */
+
+		const __m256 a_weight = load(a_weights);
+		const __m256 b_weight = _mm256_xor_ps(load(b_weights), sign);
+
+		for (size_t component = 0; component < 4; component++)
+			store(
+				batch.result[component],
+				_mm256_add_ps(
+					_mm256_mul_ps(load(batch.a[component]), a_weight),
+					_mm256_mul_ps(load(batch.b[component]), b_weight)
+				)
+			);
+	}
+
+	void interpolate_cubic_spline(Segment_batch<3>& batch) noexcept
+	{
+		apply_hermite_weights(batch, compute_hermite_weights(batch));
+	}
+
+	void interpolate_cubic_spline(Segment_batch<4>& batch) noexcept
 	{
-		assert(at <= t && t <= bt);
-		return glm::slerp(a, b, (t - at) / (bt - at));
+		apply_hermite_weights(batch, compute_hermite_weights(batch));
+		normalize_result(batch);
 	}
 }
\ No newline at end of file
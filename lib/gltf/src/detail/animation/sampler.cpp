@@ -9,4 +9,60 @@ namespace gltf::detail::animation
 		if (str == "CUBICSPLINE") return Interpolation::Cubic;
 		return std::nullopt;
 	}
+
+	std::vector<uint32_t> sort_keyframes(std::vector<float>& timestamps) noexcept
+	{
+		auto order =
+			std::views::iota(0u, static_cast<uint32_t>(timestamps.size())) | std::ranges::to<std::vector>();
+		std::ranges::stable_sort(order, {}, [&timestamps](uint32_t idx) { return timestamps[idx]; });
+
+		timestamps = order
+			| std::views::transform([&timestamps](uint32_t idx) { return timestamps[idx]; })
+			| std::ranges::to<std::vector>();
+
+		return order;
+	}
+
+	Keyframe_times::Keyframe_times(std::vector<float> times) noexcept :
+		times(std::move(times))
+	{
+		if (this->times.size() < segment_table_min_keyframes) return;
+
+		const float duration = this->times.back() - this->times.front();
+		if (!(duration > 0.0f)) return;
+
+		// One cell per segment on average, uniformly spaced keyframes map one-to-one
+		const auto cell_count = this->times.size() - 1;
+		segment_table_scale = static_cast<float>(cell_count) / duration;
+		segment_table.resize(cell_count);
+
+		uint32_t segment = 0;
+		for (const auto [cell, cell_segment] : segment_table | std::views::enumerate)
+		{
+			const float cell_start = this->times.front() + static_cast<float>(cell) / segment_table_scale;
+			while (segment + 2 < this->times.size() && this->times[segment + 1] <= cell_start) segment++;
+			cell_segment = segment;
+		}
+	}
+
+	uint32_t Keyframe_times::find_segment(float time) const noexcept
+	{
+		if (segment_table.empty())
+		{
+			const auto upper = std::ranges::upper_bound(times, time);
+			return static_cast<uint32_t>(std::distance(times.begin(), upper)) - 1;
+		}
+
+		const auto cell = std::min(
+			static_cast<size_t>((time - times.front()) * segment_table_scale),
+			segment_table.size() - 1
+		);
+
+		// Cell boundaries are rounded, step back if the cell starts after `time`
+		auto segment = segment_table[cell];
+		while (segment > 0 && times[segment] > time) segment--;
+		while (times[segment + 1] <= time) segment++;
+
+		return segment;
+	}
 }
\ No newline at end of file
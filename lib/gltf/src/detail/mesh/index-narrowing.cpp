@@ -0,0 +1,30 @@
+#include "gltf/detail/mesh/index-narrowing.hpp"
+
+#include <ranges>
+
+namespace gltf::detail::mesh
+{
+	std::optional<std::vector<uint16_t>> Index_narrowing::narrow(
+		std::span<const uint32_t> indices,
+		size_t vertex_count
+	) noexcept
+	{
+		if (!can_narrow(vertex_count))
+		{
+			index_bytes += indices.size_bytes();
+			return std::nullopt;
+		}
+
+		auto narrowed =
+			indices
+			| std::views::transform([](uint32_t index) { return static_cast<uint16_t>(index); })
+			| std::ranges::to<std::vector>();
+
+		if (narrowed.size() % 2 != 0) narrowed.push_back(narrowed.back());
+
+		index_bytes += narrowed.size() * sizeof(uint16_t);
+		index_bytes_saved += indices.size_bytes() - narrowed.size() * sizeof(uint16_t);
+
+		return narrowed;
+	}
+}
\ No newline at end of file
@@ -1,6 +1,7 @@
 #include "gltf/image.hpp"
 
 #include "graphics/util/quick-create.hpp"
+#include "graphics/util/upload-batcher.hpp"
 #include "image/algo/mipmap.hpp"
 #include "image/compress.hpp"
 
@@ -12,14 +13,13 @@ namespace gltf
 	using namespace detail::image;
 
 	static auto create_texture_from_mipmap_fn(
-		SDL_GPUDevice* device,
+		graphics::Upload_batcher& batcher,
 		SDL_GPUTextureFormat format,
 		const std::string& name
 	) noexcept
 	{
-		return [device, format, name](const auto& mipmap) -> std::expected<gpu::Texture, util::Error> {
-			return graphics::create_texture_from_mipmap(
-				device,
+		return [&batcher, format, name](const auto& mipmap) -> std::expected<gpu::Texture, util::Error> {
+			return batcher.create_texture_from_mipmap(
 				gpu::Texture::Format{
 					.type = SDL_GPU_TEXTURETYPE_2D,
 					.format = format,
@@ -34,14 +34,13 @@ namespace gltf
 	template <typename T>
 	static std::function<std::expected<gpu::Texture, util::Error>(const image::Image_container<T>&)>
 	create_texture_from_image_fn(
-		SDL_GPUDevice* device,
+		graphics::Upload_batcher& batcher,
 		SDL_GPUTextureFormat format,
 		const std::string& name
 	) noexcept
 	{
-		return [device, format, name](const image::Image_container<T>& image) {
-			return graphics::create_texture_from_image(
-				device,
+		return [&batcher, format, name](const image::Image_container<T>& image) {
+			return batcher.create_texture_from_image(
 				gpu::Texture::Format{
 					.type = SDL_GPU_TEXTURETYPE_2D,
 					.format = format,
@@ -54,7 +53,7 @@ namespace gltf
 	}
 
 	static std::expected<gpu::Texture, util::Error> create_color_uncompressed(
-		SDL_GPUDevice* device,
+		graphics::Upload_batcher& batcher,
 		const tinygltf::Image& image,
 		bool srgb,
 		const std::string& name
@@ -65,7 +64,7 @@ namespace gltf
 				return image::generate_mipmap(uncompressed_image);
 			})
 			.and_then(create_texture_from_mipmap_fn(
-				device,
+				batcher,
 				srgb ? SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM_SRGB : SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM,
 				name
 			))
@@ -73,7 +72,7 @@ namespace gltf
 	}
 
 	static std::expected<gpu::Texture, util::Error> create_color_bc3(
-		SDL_GPUDevice* device,
+		graphics::Upload_batcher& batcher,
 		const tinygltf::Image& image,
 		bool srgb,
 		const std::string& name
@@ -85,7 +84,7 @@ namespace gltf
 
 		if (!image_size_multiple_of_block(image_size))
 		{
-			return create_color_uncompressed(device, image, srgb, name)
+			return create_color_uncompressed(batcher, image, srgb, name)
 				.transform_error(util::Error::forward_fn());
 		}
 
@@ -93,7 +92,7 @@ namespace gltf
 		{
 			return extract_u8_rgba(image)
 				.and_then(image::compress_to_bc3)
-				.and_then(create_texture_from_image_fn<image::BC_block_8bpp>(device, format, name))
+				.and_then(create_texture_from_image_fn<image::BC_block_8bpp>(batcher, format, name))
 				.transform_error(util::Error::forward_fn());
 		}
 
@@ -102,12 +101,12 @@ namespace gltf
 				return image::generate_mipmap(uncompressed_image, {4, 4});
 			})
 			.and_then(image::Compress_mipmap(image::compress_to_bc3))
-			.and_then(create_texture_from_mipmap_fn(device, format, name))
+			.and_then(create_texture_from_mipmap_fn(batcher, format, name))
 			.transform_error(util::Error::forward_fn());
 	}
 
 	static std::expected<gpu::Texture, util::Error> create_color_bc7(
-		SDL_GPUDevice* device,
+		graphics::Upload_batcher& batcher,
 		const tinygltf::Image& image,
 		bool srgb,
 		const std::string& name
@@ -119,7 +118,7 @@ namespace gltf
 
 		if (!image_size_multiple_of_block(image_size))  // No compress, no mipmaps
 		{
-			return create_color_uncompressed(device, image, srgb, name)
+			return create_color_uncompressed(batcher, image, srgb, name)
 				.transform_error(util::Error::forward_fn());
 		}
 
@@ -127,7 +126,7 @@ namespace gltf
 		{
 			return extract_u8_rgba(image)
 				.and_then(image::compress_to_bc7)
-				.and_then(create_texture_from_image_fn<image::BC_block_8bpp>(device, format, name))
+				.and_then(create_texture_from_image_fn<image::BC_block_8bpp>(batcher, format, name))
 				.transform_error(util::Error::forward_fn());
 		}
 
@@ -136,12 +135,12 @@ namespace gltf
 				return image::generate_mipmap(uncompressed_image, {4, 4});
 			})
 			.and_then(image::Compress_mipmap(image::compress_to_bc7))
-			.and_then(create_texture_from_mipmap_fn(device, format, name))
+			.and_then(create_texture_from_mipmap_fn(batcher, format, name))
 			.transform_error(util::Error::forward_fn());
 	}
 
 	static std::expected<gpu::Texture, util::Error> create_normal_8bit(
-		SDL_GPUDevice* device,
+		graphics::Upload_batcher& batcher,
 		const tinygltf::Image& image,
 		bool compress,
 		const std::string& name
@@ -158,7 +157,7 @@ namespace gltf
 					});
 				})
 				.and_then(
-					create_texture_from_image_fn<glm::u8vec2>(device, SDL_GPU_TEXTUREFORMAT_R8G8_UNORM, name)
+					create_texture_from_image_fn<glm::u8vec2>(batcher, SDL_GPU_TEXTUREFORMAT_R8G8_UNORM, name)
 				)
 				.transform_error(util::Error::forward_fn());
 		}
@@ -172,7 +171,7 @@ namespace gltf
 					.and_then(image::compress_to_bc5)
 					.and_then(
 						create_texture_from_image_fn<image::BC_block_8bpp>(
-							device,
+							batcher,
 							SDL_GPU_TEXTUREFORMAT_BC5_RG_UNORM,
 							name
 						)
@@ -189,7 +188,7 @@ namespace gltf
 					})
 					.and_then(
 						create_texture_from_image_fn<glm::u8vec2>(
-							device,
+							batcher,
 							SDL_GPU_TEXTUREFORMAT_R8G8_UNORM,
 							name
 						)
@@ -204,7 +203,7 @@ namespace gltf
 			return extract_u8_rgba(image)
 				.transform([](const auto& img) { return image::generate_mipmap(img, {4, 4}); })
 				.and_then(image::Compress_mipmap(image::compress_to_bc5))
-				.and_then(create_texture_from_mipmap_fn(device, SDL_GPU_TEXTUREFORMAT_BC5_RG_UNORM, name))
+				.and_then(create_texture_from_mipmap_fn(batcher, SDL_GPU_TEXTUREFORMAT_BC5_RG_UNORM, name))
 				.transform_error(util::Error::forward_fn());
 		}
 		else
@@ -216,13 +215,13 @@ namespace gltf
 					});
 				})
 				.transform([](const auto& img) { return image::generate_mipmap(img); })
-				.and_then(create_texture_from_mipmap_fn(device, SDL_GPU_TEXTUREFORMAT_R8G8_UNORM, name))
+				.and_then(create_texture_from_mipmap_fn(batcher, SDL_GPU_TEXTUREFORMAT_R8G8_UNORM, name))
 				.transform_error(util::Error::forward_fn());
 		}
 	}
 
 	static std::expected<gpu::Texture, util::Error> create_normal_16bit(
-		SDL_GPUDevice* device,
+		graphics::Upload_batcher& batcher,
 		const tinygltf::Image& image,
 		bool compress,
 		const std::string& name
@@ -240,7 +239,7 @@ namespace gltf
 				})
 				.and_then(
 					create_texture_from_image_fn<glm::u16vec2>(
-						device,
+						batcher,
 						SDL_GPU_TEXTUREFORMAT_R16G16_UNORM,
 						name
 					)
@@ -262,7 +261,7 @@ namespace gltf
 					.and_then(image::compress_to_bc5)
 					.and_then(
 						create_texture_from_image_fn<image::BC_block_8bpp>(
-							device,
+							batcher,
 							SDL_GPU_TEXTUREFORMAT_BC5_RG_UNORM,
 							name
 						)
@@ -279,7 +278,7 @@ namespace gltf
 					})
 					.and_then(
 						create_texture_from_image_fn<glm::u16vec2>(
-							device,
+							batcher,
 							SDL_GPU_TEXTUREFORMAT_R16G16_UNORM,
 							name
 						)
@@ -299,7 +298,7 @@ namespace gltf
 				})
 				.transform([&](const auto& img) { return image::generate_mipmap(img, {4, 4}); })
 				.and_then(image::Compress_mipmap(image::compress_to_bc5))
-				.and_then(create_texture_from_mipmap_fn(device, SDL_GPU_TEXTUREFORMAT_BC5_RG_UNORM, name))
+				.and_then(create_texture_from_mipmap_fn(batcher, SDL_GPU_TEXTUREFORMAT_BC5_RG_UNORM, name))
 				.transform_error(util::Error::forward_fn());
 		}
 		else
@@ -310,13 +309,13 @@ namespace gltf
 						return {pixel.r, pixel.g};
 					}));
 				})
-				.and_then(create_texture_from_mipmap_fn(device, SDL_GPU_TEXTUREFORMAT_R16G16_UNORM, name))
+				.and_then(create_texture_from_mipmap_fn(batcher, SDL_GPU_TEXTUREFORMAT_R16G16_UNORM, name))
 				.transform_error(util::Error::forward_fn());
 		}
 	}
 
 	std::expected<gpu::Texture, util::Error> create_color_texture_from_image(
-		SDL_GPUDevice* device,
+		graphics::Upload_batcher& batcher,
 		const tinygltf::Image& image,
 		Color_compress_mode compress_mode,
 		bool srgb,
@@ -326,18 +325,18 @@ namespace gltf
 		switch (compress_mode)
 		{
 		case Color_compress_mode::RGBA8_raw:
-			return create_color_uncompressed(device, image, srgb, name);
+			return create_color_uncompressed(batcher, image, srgb, name);
 		case Color_compress_mode::RGBA8_BC3:
-			return create_color_bc3(device, image, srgb, name);
+			return create_color_bc3(batcher, image, srgb, name);
 		case Color_compress_mode::RGBA8_BC7:
-			return create_color_bc7(device, image, srgb, name);
+			return create_color_bc7(batcher, image, srgb, name);
 		}
 
 		std::unreachable();
 	}
 
 	std::expected<gpu::Texture, util::Error> create_normal_texture_from_image(
-		SDL_GPUDevice* device,
+		graphics::Upload_batcher& batcher,
 		const tinygltf::Image& image,
 		Normal_compress_mode compress_mode,
 		const std::string& name
@@ -349,9 +348,9 @@ namespace gltf
 		const bool compress_when_16bit = (compress_mode == Normal_compress_mode::RGn_BC5);
 
 		if (image.bits == 8 && image.pixel_type == TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE)
-			return create_normal_8bit(device, image, compress_when_8bit, name);
+			return create_normal_8bit(batcher, image, compress_when_8bit, name);
 		else if (image.bits == 16 && image.pixel_type == TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT)
-			return create_normal_16bit(device, image, compress_when_16bit, name);
+			return create_normal_16bit(batcher, image, compress_when_16bit, name);
 		else
 			return util::Error(
 				std::format(
@@ -227,7 +227,7 @@ namespace gltf
 	}
 
 	std::expected<Material_list::Image_entry, util::Error> Material_list::load_image_thread(
-		SDL_GPUDevice* device,
+		graphics::Upload_batcher& batcher,
 		const tinygltf::Image& image,
 		const Image_config& image_config,
 		Image_refcount refcount
@@ -238,7 +238,7 @@ namespace gltf
 		if (refcount.color_refcount > 0)
 		{
 			auto color_texture = gltf::create_color_texture_from_image(
-				device,
+				batcher,
 				image,
 				image_config.color_mode,
 				true,
@@ -252,7 +252,7 @@ namespace gltf
 		if (refcount.linear_refcount > 0)
 		{
 			auto linear_texture = gltf::create_color_texture_from_image(
-				device,
+				batcher,
 				image,
 				image_config.color_mode,
 				false,
@@ -266,7 +266,7 @@ namespace gltf
 		if (refcount.normal_refcount > 0)
 		{
 			auto normal_texture = gltf::create_normal_texture_from_image(
-				device,
+				batcher,
 				image,
 				image_config.normal_mode,
 				std::format("GLTF Image '{}'", image.name)
@@ -293,6 +293,7 @@ namespace gltf
 		auto progress_mutex = std::make_shared<std::mutex>();
 		auto progress_count = std::make_shared<std::atomic<size_t>>(0);
 
+		graphics::Upload_batcher upload_batcher(device);
 		dp::thread_pool thread_pool(std::thread::hardware_concurrency());
 
 		auto result_futures =
@@ -301,7 +302,7 @@ namespace gltf
 				  const auto& [image, refcount] = input;
 
 				  return thread_pool.enqueue(
-					  [device,
+					  [&upload_batcher,
 					   image_config,
 					   refcount,
 					   progress_mutex,
@@ -309,7 +310,7 @@ namespace gltf
 					   progress_callback,
 					   total,
 					   image]() {
-						  auto result = load_image_thread(device, image, image_config, refcount);
+						  auto result = load_image_thread(upload_batcher, image, image_config, refcount);
 
 						  // Update progress
 						  {
@@ -335,6 +336,9 @@ namespace gltf
 			images.emplace_back(std::move(*result));
 		}
 
+		if (const auto flush_result = upload_batcher.flush(); !flush_result)
+			return flush_result.error().forward("Upload image data failed");
+
 		return {};
 	}
 
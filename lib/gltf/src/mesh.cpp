@@ -1,10 +1,16 @@
 #include "gltf/mesh.hpp"
+#include "gltf/detail/mesh/index-narrowing.hpp"
 #include "gltf/detail/mesh/optimize.hpp"
 #include "gltf/detail/mesh/raw-primitive-list.hpp"
+#include "graphics/util/block-suballocator.hpp"
 
-#include "graphics/util/quick-create.hpp"
 #include "util/as-byte.hpp"
 #include <algorithm>
+#include <array>
+#include <cassert>
+#include <deque>
+#include <format>
+#include <meshoptimizer.h>
 #include <ranges>
 
 namespace gltf
@@ -78,6 +84,44 @@ namespace gltf
 		};
 	}
 
+	Joint_bounds Joint_bounds::from_vertices(std::span<const Rigged_shadow_vertex> vertices) noexcept
+	{
+		/* Expand Per-joint Bounds */
+
+		std::vector<glm::vec3> bound_min, bound_max;
+
+		for (const auto& vertex : vertices)
+			for (const auto influence : std::views::iota(0, 4))
+			{
+				if (vertex.joint_weights[influence] <= 0.0f) continue;
+
+				const auto joint = vertex.joint_indices[influence];
+				if (joint >= bound_min.size())
+				{
+					bound_min.resize(joint + 1, glm::vec3(std::numeric_limits<float>::max()));
+					bound_max.resize(joint + 1, glm::vec3(std::numeric_limits<float>::lowest()));
+				}
+
+				bound_min[joint] = glm::min(bound_min[joint], vertex.position);
+				bound_max[joint] = glm::max(bound_max[joint], vertex.position);
+			}
+
+		/* Compact */
+
+		Joint_bounds result;
+
+		for (const auto joint : std::views::iota(0u, static_cast<uint32_t>(bound_min.size())))
+		{
+			if (bound_min[joint].x > bound_max[joint].x) continue;  // No influence
+
+			result.joints.push_back(joint);
+			result.position_min.push_back(bound_min[joint]);
+			result.position_max.push_back(bound_max[joint]);
+		}
+
+		return result;
+	}
+
 	std::expected<Primitive, util::Error> Primitive::from_tinygltf(
 		const tinygltf::Model& model,
 		const tinygltf::Primitive& primitive
@@ -184,6 +228,8 @@ namespace gltf
 			position_max = glm::max(position_max, center + glm::vec3(min_extent));
 		}
 
+		auto joint_bounds = Joint_bounds::from_vertices(optimized_shadow_vertices);
+
 		return Rigged_primitive{
 			.vertices = std::move(optimized_vertices),
 			.indices = std::move(optimized_indices),
@@ -191,117 +237,117 @@ namespace gltf
 			.shadow_indices = std::move(optimized_shadow_indices),
 			.material = primitive.material == -1 ? std::nullopt : std::optional<uint32_t>(primitive.material),
 			.position_min = position_min,
-			.position_max = position_max
+			.position_max = position_max,
+			.joint_bounds = std::move(joint_bounds)
 		};
 	}
 
-	std::expected<Primitive_gpu, util::Error> Primitive_gpu::from_primitive(
-		SDL_GPUDevice* device,
-		const Primitive& primitive
-	) noexcept
+	std::optional<Occluder_mesh> Occluder_mesh::from_primitive(const Primitive& primitive) noexcept
 	{
-		auto vertex_buffer = graphics::create_buffer_from_data(
-			device,
-			{.vertex = true},
-			util::as_bytes(primitive.vertices),
-			"GLTF Vertex Buffer"
+		if (primitive.shadow_indices.empty()) return std::nullopt;
+
+		const auto& source_indices = primitive.shadow_indices;
+		const auto source_positions =
+			primitive.shadow_vertices
+			| std::views::transform(&Shadow_vertex::position)
+			| std::ranges::to<std::vector>();
+
+		/* Weld Vertices Split by Texcoords */
+
+		std::vector<uint32_t> remap_table(source_positions.size());
+		const auto welded_count = meshopt_generateVertexRemap(
+			remap_table.data(),
+			source_indices.data(),
+			source_indices.size(),
+			source_positions.data(),
+			source_positions.size(),
+			sizeof(glm::vec3)
 		);
 
-		auto index_buffer = graphics::create_buffer_from_data(
-			device,
-			{.index = true},
-			util::as_bytes(primitive.indices),
-			"GLTF Index Buffer"
+		std::vector<glm::vec3> positions(welded_count);
+		std::vector<uint32_t> indices(source_indices.size());
+		meshopt_remapVertexBuffer(
+			positions.data(),
+			source_positions.data(),
+			source_positions.size(),
+			sizeof(glm::vec3),
+			remap_table.data()
 		);
-
-		auto shadow_vertex_buffer = graphics::create_buffer_from_data(
-			device,
-			{.vertex = true},
-			util::as_bytes(primitive.shadow_vertices),
-			"GLTF Shadow Vertex Buffer"
+		meshopt_remapIndexBuffer(
+			indices.data(),
+			source_indices.data(),
+			source_indices.size(),
+			remap_table.data()
 		);
 
-		auto shadow_index_buffer = graphics::create_buffer_from_data(
-			device,
-			{.index = true},
-			util::as_bytes(primitive.shadow_indices),
-			"GLTF Shadow Index Buffer"
-		);
+		/* Simplify */
 
-		if (!vertex_buffer) return vertex_buffer.error().forward("Create vertex buffer failed");
-		if (!index_buffer) return index_buffer.error().forward("Create index buffer failed");
-		if (!shadow_vertex_buffer)
-			return shadow_vertex_buffer.error().forward("Create position vertex buffer failed");
-		if (!shadow_index_buffer)
-			return shadow_index_buffer.error().forward("Create position index buffer failed");
+		if (indices.size() > max_triangle_count * 3)
+		{
+			std::vector<uint32_t> simplified_indices(indices.size());
+			const auto simplified_count = meshopt_simplify(
+				simplified_indices.data(),
+				indices.data(),
+				indices.size(),
+				&positions[0].x,
+				positions.size(),
+				sizeof(glm::vec3),
+				max_triangle_count * 3,
+				max_simplify_error,
+				meshopt_SimplifyLockBorder,
+				nullptr
+			);
+			if (simplified_count == 0 || simplified_count > max_triangle_count * 3) return std::nullopt;
+			simplified_indices.resize(simplified_count);
+
+			std::vector<glm::vec3> compact_positions(positions.size());
+			const auto compact_count = meshopt_optimizeVertexFetch(
+				compact_positions.data(),
+				simplified_indices.data(),
+				simplified_indices.size(),
+				positions.data(),
+				positions.size(),
+				sizeof(glm::vec3)
+			);
+			compact_positions.resize(compact_count);
 
-		return Primitive_gpu{
-			.index_count = static_cast<uint32_t>(primitive.indices.size()),
+			positions = std::move(compact_positions);
+			indices = std::move(simplified_indices);
+		}
 
-			.vertex_buffer = std::move(*vertex_buffer),
-			.index_buffer = std::move(*index_buffer),
-			.shadow_vertex_buffer = std::move(*shadow_vertex_buffer),
-			.shadow_index_buffer = std::move(*shadow_index_buffer),
+		return Occluder_mesh{.positions = std::move(positions), .indices = std::move(indices)};
+	}
 
+	Primitive_gpu Primitive_gpu::from_primitive(
+		const Primitive& primitive,
+		const Primitive_geometry& geometry,
+		std::optional<Occluder_mesh> occluder
+	) noexcept
+	{
+		return Primitive_gpu{
+			.index_count = static_cast<uint32_t>(primitive.indices.size()),
+			.geometry = geometry,
 			.material = primitive.material,
 			.position_min = primitive.position_min,
 			.position_max = primitive.position_max,
-			.rigged = false
+			.rigged = false,
+			.occluder = std::move(occluder)
 		};
 	}
 
-	std::expected<Primitive_gpu, util::Error> Primitive_gpu::from_rigged_primitive(
-		SDL_GPUDevice* device,
-		const Rigged_primitive& primitive
+	Primitive_gpu Primitive_gpu::from_rigged_primitive(
+		const Rigged_primitive& primitive,
+		const Primitive_geometry& geometry
 	) noexcept
 	{
-		auto vertex_buffer = graphics::create_buffer_from_data(
-			device,
-			{.vertex = true},
-			util::as_bytes(primitive.vertices),
-			"GLTF Rigged Vertex Buffer"
-		);
-
-		auto index_buffer = graphics::create_buffer_from_data(
-			device,
-			{.index = true},
-			util::as_bytes(primitive.indices),
-			"GLTF Rigged Index Buffer"
-		);
-
-		auto shadow_vertex_buffer = graphics::create_buffer_from_data(
-			device,
-			{.vertex = true},
-			util::as_bytes(primitive.shadow_vertices),
-			"GLTF Rigged Shadow Vertex Buffer"
-		);
-
-		auto shadow_index_buffer = graphics::create_buffer_from_data(
-			device,
-			{.index = true},
-			util::as_bytes(primitive.shadow_indices),
-			"GLTF Rigged Shadow Index Buffer"
-		);
-
-		if (!vertex_buffer) return vertex_buffer.error().forward("Create vertex buffer failed");
-		if (!index_buffer) return index_buffer.error().forward("Create index buffer failed");
-		if (!shadow_vertex_buffer)
-			return shadow_vertex_buffer.error().forward("Create position vertex buffer failed");
-		if (!shadow_index_buffer)
-			return shadow_index_buffer.error().forward("Create position index buffer failed");
-
 		return Primitive_gpu{
 			.index_count = static_cast<uint32_t>(primitive.indices.size()),
-
-			.vertex_buffer = std::move(*vertex_buffer),
-			.index_buffer = std::move(*index_buffer),
-			.shadow_vertex_buffer = std::move(*shadow_vertex_buffer),
-			.shadow_index_buffer = std::move(*shadow_index_buffer),
-
+			.geometry = geometry,
 			.material = primitive.material,
 			.position_min = primitive.position_min,
 			.position_max = primitive.position_max,
-			.rigged = true
+			.rigged = true,
+			.joint_bounds = primitive.joint_bounds
 		};
 	}
 
@@ -334,31 +380,315 @@ namespace gltf
 			}
 		}
 
-		return Mesh{.primitives = std::move(primitives), .rigged_primitives = std::move(rigged_primitives)};
+		// Simplified here, so that it runs on the loading worker of the mesh
+		auto occluders =
+			primitives
+			| std::views::transform(&Occluder_mesh::from_primitive)
+			| std::ranges::to<std::vector>();
+
+		return Mesh{
+			.primitives = std::move(primitives),
+			.rigged_primitives = std::move(rigged_primitives),
+			.occluders = std::move(occluders)
+		};
 	}
 
-	std::expected<Mesh_gpu, util::Error> Mesh_gpu::from_mesh(SDL_GPUDevice* device, const Mesh& mesh) noexcept
+	namespace
 	{
-		std::vector<Primitive_gpu> primitives;
-		primitives.reserve(mesh.primitives.size() + mesh.rigged_primitives.size());
+		// Shared buffers of one element type, ranges are placed first and uploaded once all are placed
+		class Geometry_pool
+		{
+		  public:
+
+			Geometry_pool(gpu::Buffer::Usage usage, uint32_t element_size, std::string name) noexcept :
+				usage(usage),
+				element_size(element_size),
+				name(std::move(name)),
+				allocator(Mesh_buffers::max_buffer_size / element_size)
+			{}
+
+			// Place a range, `alignment` is in elements
+			template <typename T>
+			graphics::Block_suballocator::Allocation place(
+				std::span<const T> elements,
+				uint32_t alignment = 1
+			) noexcept
+			{
+				assert(sizeof(T) == element_size);
 
-		for (const auto& primitive : mesh.primitives)
+				const auto allocation =
+					allocator.allocate(static_cast<uint32_t>(elements.size()), alignment);
+				pending.push_back({.allocation = allocation, .data = util::as_bytes(elements)});
+
+				return allocation;
+			}
+
+			// Create the buffers and upload all placed ranges
+			std::expected<void, util::Error> upload(
+				graphics::Upload_batcher& batcher,
+				std::vector<gpu::Buffer>& buffers
+			) noexcept
+			{
+				const auto first_buffer = buffers.size();
+
+				for (const auto [block, size] : allocator.get_block_sizes() | std::views::enumerate)
+				{
+					auto buffer = gpu::Buffer::create(
+						batcher.get_device(),
+						usage,
+						size * element_size,
+						std::format("{} #{}", name, block)
+					);
+					if (!buffer) return buffer.error().forward("Create shared buffer failed");
+
+					handles.push_back(*buffer);
+					buffers.emplace_back(std::move(*buffer));
+				}
+
+				for (const auto& [allocation, data] : pending)
+				{
+					const auto& buffer = buffers[first_buffer + allocation.block];
+					const auto result =
+						batcher.upload_to_buffer(buffer, allocation.offset * element_size, data);
+					if (!result) return result.error().forward("Upload geometry failed");
+				}
+
+				return {};
+			}
+
+			// Get the range of a placement, valid after `upload()`
+			Geometry_range get_range(graphics::Block_suballocator::Allocation allocation) const noexcept
+			{
+				return {.buffer = handles[allocation.block], .first = allocation.offset};
+			}
+
+		  private:
+
+			struct Pending_upload
+			{
+				graphics::Block_suballocator::Allocation allocation;
+				std::span<const std::byte> data;
+			};
+
+			gpu::Buffer::Usage usage;
+			uint32_t element_size;
+			std::string name;
+
+			graphics::Block_suballocator allocator;
+			std::vector<Pending_upload> pending;
+			std::vector<SDL_GPUBuffer*> handles;
+		};
+
+		// Shared index buffers, lists are narrowed to 16 bits when their vertex count allows, see
+		// `Index_narrowing`
+		class Index_pools
 		{
-			auto primitive_result = Primitive_gpu::from_primitive(device, primitive);
-			if (!primitive_result) return primitive_result.error().forward("Create Primitive_gpu failed");
+		  public:
 
-			primitives.emplace_back(std::move(*primitive_result));
-		}
+			struct Placement
+			{
+				graphics::Block_suballocator::Allocation allocation;
+				SDL_GPUIndexElementSize element_size;
+			};
+
+			// Place an index list referencing `vertex_count` vertices
+			Placement place(std::span<const uint32_t> indices, size_t vertex_count) noexcept
+			{
+				auto narrowed = narrowing.narrow(indices, vertex_count);
+				if (!narrowed)
+					return {
+						.allocation = pool_32bit.place(indices),
+						.element_size = SDL_GPU_INDEXELEMENTSIZE_32BIT
+					};
+
+				// Deque keeps the narrowed lists in place until they are uploaded
+				const auto& list = narrowed_lists.emplace_back(std::move(*narrowed));
+
+				// Even offsets and padded counts keep each list on 4-byte boundaries
+				return {
+					.allocation = pool_16bit.place(std::span(list), 2),
+					.element_size = SDL_GPU_INDEXELEMENTSIZE_16BIT
+				};
+			}
+
+			// Create the buffers and upload all placed lists
+			std::expected<void, util::Error> upload(
+				graphics::Upload_batcher& batcher,
+				std::vector<gpu::Buffer>& buffers
+			) noexcept
+			{
+				if (const auto result = pool_16bit.upload(batcher, buffers); !result)
+					return result.error().forward("Upload 16-bit indices failed");
+
+				if (const auto result = pool_32bit.upload(batcher, buffers); !result)
+					return result.error().forward("Upload 32-bit indices failed");
+
+				return {};
+			}
+
+			// Get the range of a placement, valid after `upload()`
+			Geometry_range get_range(const Placement& placement) const noexcept
+			{
+				return placement.element_size == SDL_GPU_INDEXELEMENTSIZE_16BIT
+					? pool_16bit.get_range(placement.allocation)
+					: pool_32bit.get_range(placement.allocation);
+			}
+
+			uint64_t get_index_bytes() const noexcept { return narrowing.get_index_bytes(); }
+
+			uint64_t get_index_bytes_saved() const noexcept { return narrowing.get_index_bytes_saved(); }
+
+		  private:
+
+			Geometry_pool pool_16bit{{.index = true}, sizeof(uint16_t), "GLTF Index Buffer (16-bit)"};
+			Geometry_pool pool_32bit{{.index = true}, sizeof(uint32_t), "GLTF Index Buffer (32-bit)"};
+			std::deque<std::vector<uint16_t>> narrowed_lists;
+			Index_narrowing narrowing;
+		};
+
+		// Placements of the four geometry lists of a primitive
+		struct Primitive_placement
+		{
+			graphics::Block_suballocator::Allocation vertices, shadow_vertices;
+			Index_pools::Placement indices, shadow_indices;
+
+			Primitive_geometry get_geometry(
+				const Geometry_pool& vertex_pool,
+				const Geometry_pool& shadow_vertex_pool,
+				const Index_pools& index_pools
+			) const noexcept
+			{
+				return Primitive_geometry{
+					.vertices = vertex_pool.get_range(vertices),
+					.indices = index_pools.get_range(indices),
+					.shadow_vertices = shadow_vertex_pool.get_range(shadow_vertices),
+					.shadow_indices = index_pools.get_range(shadow_indices),
+					.index_element_size = indices.element_size,
+					.shadow_index_element_size = shadow_indices.element_size
+				};
+			}
+		};
+	}
+
+	std::expected<std::pair<Mesh_buffers, std::vector<Mesh_gpu>>, util::Error> Mesh_buffers::from_meshes(
+		graphics::Upload_batcher& batcher,
+		std::span<const Mesh> meshes
+	) noexcept
+	{
+		Geometry_pool vertex_pool({.vertex = true}, sizeof(Vertex), "GLTF Vertex Buffer");
+		Geometry_pool rigged_vertex_pool(
+			{.vertex = true},
+			sizeof(Rigged_vertex),
+			"GLTF Rigged Vertex Buffer"
+		);
+		Geometry_pool shadow_vertex_pool(
+			{.vertex = true},
+			sizeof(Shadow_vertex),
+			"GLTF Shadow Vertex Buffer"
+		);
+		Geometry_pool rigged_shadow_vertex_pool(
+			{.vertex = true},
+			sizeof(Rigged_shadow_vertex),
+			"GLTF Rigged Shadow Vertex Buffer"
+		);
+		Index_pools index_pools;
+
+		/* Place */
 
-		for (const auto& rigged_primitive : mesh.rigged_primitives)
+		// Same order as the primitives of `Mesh_gpu`, non-rigged primitives first
+		std::vector<Primitive_placement> placements;
+
+		for (const auto& mesh : meshes)
 		{
-			auto rigged_primitive_result = Primitive_gpu::from_rigged_primitive(device, rigged_primitive);
-			if (!rigged_primitive_result)
-				return rigged_primitive_result.error().forward("Create Rigged_Primitive_gpu failed");
+			for (const auto& primitive : mesh.primitives)
+			{
+				if (primitive.vertices.empty() || primitive.indices.empty())
+					return util::Error("Primitive has no geometry");
+
+				placements.push_back({
+					.vertices = vertex_pool.place(std::span(primitive.vertices)),
+					.shadow_vertices = shadow_vertex_pool.place(std::span(primitive.shadow_vertices)),
+					.indices = index_pools.place(primitive.indices, primitive.vertices.size()),
+					.shadow_indices =
+						index_pools.place(primitive.shadow_indices, primitive.shadow_vertices.size())
+				});
+			}
+
+			for (const auto& primitive : mesh.rigged_primitives)
+			{
+				if (primitive.vertices.empty() || primitive.indices.empty())
+					return util::Error("Rigged primitive has no geometry");
+
+				placements.push_back({
+					.vertices = rigged_vertex_pool.place(std::span(primitive.vertices)),
+					.shadow_vertices = rigged_shadow_vertex_pool.place(std::span(primitive.shadow_vertices)),
+					.indices = index_pools.place(primitive.indices, primitive.vertices.size()),
+					.shadow_indices =
+						index_pools.place(primitive.shadow_indices, primitive.shadow_vertices.size())
+				});
+			}
+		}
+
+		/* Create & Upload */
+
+		Mesh_buffers mesh_buffers;
+
+		const std::array pools =
+			{&vertex_pool, &rigged_vertex_pool, &shadow_vertex_pool, &rigged_shadow_vertex_pool};
 
-			primitives.emplace_back(std::move(*rigged_primitive_result));
+		for (auto* pool : pools)
+			if (const auto result = pool->upload(batcher, mesh_buffers.buffers); !result)
+				return result.error().forward("Upload shared buffers failed");
+
+		if (const auto result = index_pools.upload(batcher, mesh_buffers.buffers); !result)
+			return result.error().forward("Upload shared index buffers failed");
+
+		mesh_buffers.statistics = {
+			.primitives = static_cast<uint32_t>(placements.size()),
+			.primitives_16bit = static_cast<uint32_t>(std::ranges::count(
+				placements,
+				SDL_GPU_INDEXELEMENTSIZE_16BIT,
+				[](const Primitive_placement& placement) { return placement.indices.element_size; }
+			)),
+			.index_bytes = index_pools.get_index_bytes(),
+			.index_bytes_saved = index_pools.get_index_bytes_saved()
+		};
+
+		/* Create Mesh_gpu */
+
+		std::vector<Mesh_gpu> gpu_meshes;
+		gpu_meshes.reserve(meshes.size());
+		auto placement = placements.begin();
+
+		for (const auto& mesh : meshes)
+		{
+			Mesh_gpu gpu_mesh;
+			gpu_mesh.primitives.reserve(mesh.primitives.size() + mesh.rigged_primitives.size());
+
+			for (const auto [primitive, occluder] : std::views::zip(mesh.primitives, mesh.occluders))
+				gpu_mesh.primitives.push_back(
+					Primitive_gpu::from_primitive(
+						primitive,
+						(placement++)->get_geometry(vertex_pool, shadow_vertex_pool, index_pools),
+						occluder
+					)
+				);
+
+			for (const auto& primitive : mesh.rigged_primitives)
+				gpu_mesh.primitives.push_back(
+					Primitive_gpu::from_rigged_primitive(
+						primitive,
+						(placement++)->get_geometry(
+							rigged_vertex_pool,
+							rigged_shadow_vertex_pool,
+							index_pools
+						)
+					)
+				);
+
+			gpu_meshes.emplace_back(std::move(gpu_mesh));
 		}
 
-		return Mesh_gpu{.primitives = std::move(primitives)};
+		return std::pair(std::move(mesh_buffers), std::move(gpu_meshes));
 	}
 }
\ No newline at end of file
@@ -1,16 +1,43 @@
 #include "gltf/model.hpp"
 #include "gltf/skin.hpp"
 #include "graphics/culling.hpp"
+#include "util/frame-arena.hpp"
 
 #include <algorithm>
 #include <cstdint>
+#include <functional>
+#include <future>
+#include <memory_resource>
+#include <optional>
 #include <queue>
 #include <ranges>
 #include <set>
+#include <string_view>
 #include <thread_pool/thread_pool.h>
+#include <tuple>
+#include <unordered_map>
 
 namespace gltf
 {
+	// Instances placed per task in `Model::generate_instanced_drawdata()`
+	static constexpr size_t instance_chunk_size = 64;
+
+	static size_t hash_animation_keys(std::span<const Animation_key> keys) noexcept
+	{
+		size_t hash = keys.size();
+		const auto combine = [&hash](size_t value) {
+			hash ^= value + 0x9e3779b97f4a7c15ull + (hash << 6) + (hash >> 2);
+		};
+
+		for (const auto& key : keys)
+		{
+			combine(std::hash<std::variant<uint32_t, std::string_view>>()(key.animation));
+			combine(std::hash<float>()(key.time));
+		}
+
+		return hash;
+	}
+
 	// Parse root nodes from tinygltf model
 	static std::expected<std::vector<uint32_t>, util::Error> parse_root_nodes(
 		const tinygltf::Model& model
@@ -66,6 +93,86 @@ namespace gltf
 		}
 	}
 
+	void Model::compute_occluder_nodes() noexcept
+	{
+		occluder_nodes.resize(nodes.size(), false);
+
+		for (const auto [idx, node] : nodes | std::views::enumerate)
+		{
+			if (!renderable_nodes[idx] || !node.name.has_value()) continue;
+			if (!node.name->starts_with(occluder_node_prefix)) continue;
+
+			occluder_nodes[idx] = true;
+			renderable_nodes[idx] = false;
+		}
+	}
+
+	void Model::compute_animated_nodes() noexcept
+	{
+		animated_nodes.resize(nodes.size(), false);
+
+		for (const auto& animation : animations) animation_targets.append_range(animation.get_target_nodes());
+		std::erase_if(animation_targets, [this](uint32_t target_node) {
+			return target_node >= nodes.size();
+		});
+		std::ranges::sort(animation_targets);
+		animation_targets.erase(std::ranges::unique(animation_targets).begin(), animation_targets.end());
+
+		for (const auto target_node : animation_targets) animated_nodes[target_node] = true;
+
+		// Children of animated nodes move with their parents
+		for (const auto node_index : node_topo_order)
+		{
+			if (const auto parent = node_parents[node_index]; parent.has_value() && animated_nodes[*parent])
+				animated_nodes[node_index] = true;
+
+			if (animated_nodes[node_index]) animated_topo_order.push_back(node_index);
+		}
+	}
+
+	void Model::compute_instance_offsets() noexcept
+	{
+		node_instance_offsets.resize(nodes.size(), 0);
+
+		for (const auto [idx, node] : nodes | std::views::enumerate)
+		{
+			node_instance_offsets[idx] = instance_count;
+			instance_count += node.instances.size();
+		}
+	}
+
+	void Model::compute_rest_transforms() noexcept
+	{
+		rest_trs.reserve(nodes.size());
+		for (const auto& node : nodes)
+		{
+			// Overrides on matrix nodes start from the identity transform, see `Node::get_local_transform()`
+			const auto transform = std::holds_alternative<Node::Transform>(node.transform)
+				? std::get<Node::Transform>(node.transform)
+				: Node::Transform();
+			rest_trs.push_back(transform.translation, transform.rotation, transform.scale);
+		}
+
+		rest_local_matrices.resize(nodes.size());
+		graphics::compose_trs(rest_trs, rest_local_matrices);
+
+		for (const auto [node, local_matrix] : std::views::zip(nodes, rest_local_matrices))
+			if (std::holds_alternative<glm::mat4>(node.transform))
+				local_matrix = graphics::Affine_matrix::from(std::get<glm::mat4>(node.transform));
+
+		std::vector<graphics::Affine_matrix> world_matrices(nodes.size());
+		for (const auto node_index : node_topo_order)
+		{
+			const auto& local_matrix = rest_local_matrices[node_index];
+			world_matrices[node_index] = node_parents[node_index].has_value()
+				? world_matrices[*node_parents[node_index]] * local_matrix
+				: local_matrix;
+		}
+
+		rest_world_matrices.reserve(nodes.size());
+		for (const auto& world_matrix : world_matrices) rest_world_matrices.push_back(world_matrix.to_mat4());
+	}
+
 	std::expected<void, util::Error> Model::compute_topo_order() noexcept
 	{
 		node_topo_order.reserve(nodes.size());
@@ -101,7 +208,41 @@ namespace gltf
 
 	namespace detail
 	{
-		static std::expected<std::vector<Mesh_gpu>, util::Error> load_meshes(
+		static std::expected<std::vector<Node>, util::Error> load_nodes(
+			const tinygltf::Model& tinygltf_model
+		) noexcept
+		{
+			std::vector<Node> nodes;
+			nodes.reserve(tinygltf_model.nodes.size());
+
+			for (const auto& tinygltf_node : tinygltf_model.nodes)
+			{
+				auto node_result = Node::from_tinygltf(tinygltf_model, tinygltf_node);
+				if (!node_result) return node_result.error().forward("Create node from tinygltf failed");
+
+				nodes.emplace_back(std::move(*node_result));
+			}
+
+			return nodes;
+		}
+
+		static std::expected<std::vector<Light>, util::Error> load_lights(
+			const tinygltf::Model& tinygltf_model
+		) noexcept
+		{
+			std::vector<Light> lights;
+			for (const auto& [idx, tinygltf_light] : tinygltf_model.lights | std::views::enumerate)
+			{
+				auto light_result = parse_light(tinygltf_light);
+				if (!light_result)
+					return light_result.error().forward(std::format("Parse light failed at index {}", idx));
+				lights.emplace_back(*light_result);
+			}
+
+			return lights;
+		}
+
+		static std::expected<std::pair<Mesh_buffers, std::vector<Mesh_gpu>>, util::Error> load_meshes(
 			SDL_GPUDevice* device,
 			const tinygltf::Model& tinygltf_model,
 			const std::optional<std::reference_wrapper<std::atomic<Model::Load_progress>>>& progress
@@ -112,15 +253,12 @@ namespace gltf
 			dp::thread_pool thread_pool(std::thread::hardware_concurrency());
 
 			const auto task =
-				[device, &progress, &progress_count, &progress_mutex, &tinygltf_model](
+				[&progress, &progress_count, &progress_mutex, &tinygltf_model](
 					const tinygltf::Mesh& tinygltf_mesh
-				) -> std::expected<Mesh_gpu, util::Error> {
+				) -> std::expected<Mesh, util::Error> {
 				auto mesh_cpu = Mesh::from_tinygltf(tinygltf_model, tinygltf_mesh);
 				if (!mesh_cpu) return mesh_cpu.error().forward("Create mesh from tinygltf failed");
 
-				auto mesh_gpu = Mesh_gpu::from_mesh(device, *mesh_cpu);
-				if (!mesh_gpu) return mesh_gpu.error().forward("Create mesh GPU resources failed");
-
 				{
 					std::scoped_lock lock(progress_mutex);
 					progress_count++;
@@ -132,10 +270,10 @@ namespace gltf
 						};
 				}
 
-				return mesh_gpu;
+				return mesh_cpu;
 			};
 
-			std::vector<std::future<std::expected<Mesh_gpu, util::Error>>> mesh_futures =
+			std::vector<std::future<std::expected<Mesh, util::Error>>> mesh_futures =
 				tinygltf_model.meshes
 				| std::views::transform([&](const auto& tinygltf_mesh) {
 					  return thread_pool.enqueue(std::bind(task, tinygltf_mesh));
@@ -144,7 +282,7 @@ namespace gltf
 
 			thread_pool.wait_for_tasks();
 
-			std::vector<Mesh_gpu> meshes;
+			std::vector<Mesh> meshes;
 			for (auto [idx, future] : mesh_futures | std::views::enumerate)
 			{
 				auto result = future.get();
@@ -152,11 +290,20 @@ namespace gltf
 				meshes.emplace_back(std::move(*result));
 			}
 
-			return meshes;
+			// Placement needs the sizes of all meshes, so geometry is packed after all workers finish
+			graphics::Upload_batcher upload_batcher(device);
+			auto gpu_meshes = Mesh_buffers::from_meshes(upload_batcher, meshes);
+			if (!gpu_meshes) return gpu_meshes.error().forward("Create shared mesh buffers failed");
+
+			if (const auto flush_result = upload_batcher.flush(); !flush_result)
+				return flush_result.error().forward("Upload mesh data failed");
+
+			return gpu_meshes;
 		}
 
 		static std::expected<std::vector<Animation>, util::Error> load_animations(
-			const tinygltf::Model& tinygltf_model
+			const tinygltf::Model& tinygltf_model,
+			const std::optional<Animation_compression_config>& compression
 		) noexcept
 		{
 			std::vector<Animation> animations;
@@ -164,7 +311,8 @@ namespace gltf
 
 			for (const auto& tinygltf_animation : tinygltf_model.animations)
 			{
-				auto animation_result = Animation::from_tinygltf(tinygltf_model, tinygltf_animation);
+				auto animation_result =
+					Animation::from_tinygltf(tinygltf_model, tinygltf_animation, compression);
 				if (!animation_result)
 					return animation_result.error().forward("Create animation from tinygltf failed");
 
@@ -180,6 +328,7 @@ namespace gltf
 		const tinygltf::Model& tinygltf_model,
 		const Sampler_config& sampler_config,
 		const Material_list::Image_config& image_config,
+		const std::optional<Animation_compression_config>& animation_compression,
 		const std::optional<std::reference_wrapper<std::atomic<Load_progress>>>& progress
 	) noexcept
 	{
@@ -190,25 +339,11 @@ namespace gltf
 		auto root_nodes_result = parse_root_nodes(tinygltf_model);
 		if (!root_nodes_result) return root_nodes_result.error().forward("Parse root nodes failed");
 
-		std::vector<Node> nodes;
-		nodes.reserve(tinygltf_model.nodes.size());
+		auto nodes_result = detail::load_nodes(tinygltf_model);
+		if (!nodes_result) return nodes_result.error().forward("Load nodes failed");
 
-		for (const auto& tinygltf_node : tinygltf_model.nodes)
-		{
-			auto node_result = Node::from_tinygltf(tinygltf_model, tinygltf_node);
-			if (!node_result) return node_result.error().forward("Create node from tinygltf failed");
-
-			nodes.emplace_back(std::move(*node_result));
-		}
-
-		std::vector<Light> lights;
-		for (const auto& [idx, tinygltf_light] : tinygltf_model.lights | std::views::enumerate)
-		{
-			auto light_result = parse_light(tinygltf_light);
-			if (!light_result)
-				return light_result.error().forward(std::format("Parse light failed at index {}", idx));
-			lights.emplace_back(*light_result);
-		}
+		auto lights_result = detail::load_lights(tinygltf_model);
+		if (!lights_result) return lights_result.error().forward("Load lights failed");
 
 		/* Load Meshes */
 
@@ -239,7 +374,7 @@ namespace gltf
 
 		if (progress) progress->get() = {.stage = Load_stage::Animation, .progress = -1};
 
-		auto animation_result = detail::load_animations(tinygltf_model);
+		auto animation_result = detail::load_animations(tinygltf_model, animation_compression);
 		if (!animation_result) return animation_result.error().forward("Load animations failed");
 
 		/* Load Skins */
@@ -253,23 +388,20 @@ namespace gltf
 
 		if (progress) progress->get() = {.stage = Load_stage::Postprocess, .progress = -1};
 
+		auto& [mesh_buffers, meshes] = *mesh_result;
+
 		Model model(
 			std::move(*material_list_result),
-			std::move(*mesh_result),
-			std::move(nodes),
+			std::move(mesh_buffers),
+			std::move(meshes),
+			std::move(*nodes_result),
 			std::move(*animation_result),
 			std::move(*root_nodes_result),
 			std::move(*skin_collection_result),
-			std::move(lights)
+			std::move(*lights_result)
 		);
 
-		model.compute_node_parents();
-
-		auto topo_order_result = model.compute_topo_order();
-		if (!topo_order_result)
-			return topo_order_result.error().forward("Compute node topological order failed");
-
-		model.compute_renderable_nodes();
+		if (auto result = model.compute_structures(); !result) return result.error();
 
 		auto material_bind_cache_result = model.material_list.gen_material_cache();
 		if (!material_bind_cache_result) return util::Error("Generate material bind cache failed");
@@ -278,8 +410,79 @@ namespace gltf
 		return model;
 	}
 
+	std::expected<Model, util::Error> Model::from_tinygltf_headless(
+		const tinygltf::Model& tinygltf_model,
+		std::vector<Mesh_gpu> meshes,
+		const std::optional<Animation_compression_config>& animation_compression
+	) noexcept
+	{
+		if (meshes.size() != tinygltf_model.meshes.size())
+			return util::Error(
+				std::format("Expected {} meshes, got {}", tinygltf_model.meshes.size(), meshes.size())
+			);
+
+		if (std::ranges::any_of(meshes, [](const Mesh_gpu& mesh) {
+				return std::ranges::any_of(mesh.primitives, [](const Primitive_gpu& primitive) {
+					return primitive.material.has_value();
+				});
+			}))
+			return util::Error("Headless model primitives can't reference materials");
+
+		auto root_nodes_result = parse_root_nodes(tinygltf_model);
+		if (!root_nodes_result) return root_nodes_result.error().forward("Parse root nodes failed");
+
+		auto nodes_result = detail::load_nodes(tinygltf_model);
+		if (!nodes_result) return nodes_result.error().forward("Load nodes failed");
+
+		auto lights_result = detail::load_lights(tinygltf_model);
+		if (!lights_result) return lights_result.error().forward("Load lights failed");
+
+		auto animation_result = detail::load_animations(tinygltf_model, animation_compression);
+		if (!animation_result) return animation_result.error().forward("Load animations failed");
+
+		auto skin_collection_result = Skin_list::from_tinygltf(tinygltf_model);
+		if (!skin_collection_result) return skin_collection_result.error().forward("Load skins failed");
+
+		Model model(
+			Material_list(),
+			Mesh_buffers(),
+			std::move(meshes),
+			std::move(*nodes_result),
+			std::move(*animation_result),
+			std::move(*root_nodes_result),
+			std::move(*skin_collection_result),
+			std::move(*lights_result)
+		);
+
+		if (auto result = model.compute_structures(); !result) return result.error();
+
+		// Only the default binding, without textures
+		model.material_bind_cache =
+			std::make_unique<Material_cache>(std::vector<Material_gpu>(), Material_gpu());
+
+		return model;
+	}
+
+	std::expected<void, util::Error> Model::compute_structures() noexcept
+	{
+		compute_node_parents();
+
+		auto topo_order_result = compute_topo_order();
+		if (!topo_order_result)
+			return topo_order_result.error().forward("Compute node topological order failed");
+
+		compute_renderable_nodes();
+		compute_occluder_nodes();
+		compute_animated_nodes();
+		compute_instance_offsets();
+		compute_rest_transforms();
+
+		return {};
+	}
+
 	Model::Model(
 		Material_list material_list,
+		Mesh_buffers mesh_buffers,
 		std::vector<Mesh_gpu> meshes,
 		std::vector<Node> nodes,
 		std::vector<Animation> animations,
@@ -288,6 +491,7 @@ namespace gltf
 		std::vector<Light> lights
 	) noexcept :
 		material_list(std::move(material_list)),
+		mesh_buffers(std::move(mesh_buffers)),
 		meshes(std::move(meshes)),
 		nodes(std::move(nodes)),
 		animations(std::move(animations)),
@@ -296,182 +500,993 @@ namespace gltf
 		lights(std::move(lights)),
 		primitive_count(
 			std::ranges::fold_left(
-				meshes | std::views::transform([](const Mesh_gpu& mesh) { return mesh.primitives.size(); }),
+				this->meshes
+					| std::views::transform([](const Mesh_gpu& mesh) { return mesh.primitives.size(); }),
 				0zu,
 				std::plus()
 			)
+		),
+		// The calling thread works along with the pool
+		parallel_pool(
+			std::make_unique<util::Fork_join_pool>(std::max(std::thread::hardware_concurrency(), 1u) - 1)
 		)
 	{
 		for (auto [idx, animation] : this->animations | std::views::enumerate)
 			if (animation.name.has_value()) animation_name_map[*animation.name] = idx;
 	}
 
-	std::vector<Node::Transform_override> Model::compute_node_overrides(
-		std::span<const Animation_key> animation
+	std::optional<uint32_t> Model::find_animation(const Animation_key& key) const noexcept
+	{
+		uint32_t animation_index;
+
+		if (std::holds_alternative<uint32_t>(key.animation))
+			animation_index = std::get<uint32_t>(key.animation);
+		else
+		{
+			const auto it = animation_name_map.find(std::get<std::string_view>(key.animation));
+			if (it == animation_name_map.end()) return std::nullopt;
+			animation_index = it->second;
+		}
+
+		if (animation_index >= animations.size()) return std::nullopt;
+		return animation_index;
+	}
+
+	Transform_override_set Model::compute_node_overrides(
+		std::span<const Animation_key> animation,
+		std::pmr::memory_resource* resource
 	) const noexcept
 	{
-		std::vector<Node::Transform_override> node_overrides(nodes.size());
+		Transform_override_set node_overrides(animation_targets, resource);
 
 		for (const auto& key : animation)
+			if (const auto animation_index = find_animation(key); animation_index.has_value())
+				animations[*animation_index].apply(node_overrides, key.time);
+
+		return node_overrides;
+	}
+
+	graphics::Affine_matrix Model::compute_local_matrix(
+		uint32_t node_index,
+		const Transform_override_set& overrides
+	) const noexcept
+	{
+		const auto* const override = overrides.find(node_index);
+		if (override == nullptr || !override->has_override()) [[likely]]
+			return rest_local_matrices[node_index];
+
+		return graphics::Affine_matrix::from_trs(
+			override->translation.value_or(rest_trs.get_translation(node_index)),
+			override->rotation.value_or(rest_trs.get_rotation(node_index)),
+			override->scale.value_or(rest_trs.get_scale(node_index))
+		);
+	}
+
+	std::pmr::vector<glm::mat4> Model::compute_node_world_matrices(
+		const glm::mat4& model_transform,
+		const Transform_override_set& node_overrides,
+		std::pmr::memory_resource* resource
+	) const noexcept
+	{
+		/* Compose Overridden Local Matrices */
+
+		// One matrix per entry of the override set, entries without an override keep the rest matrix
+		const auto overrides = node_overrides.get_overrides();
+		graphics::Trs_arrays overridden_trs(resource);
+		overridden_trs.reserve(overrides.size());
+
+		for (const auto [node_index, override] : std::views::zip(node_overrides.get_nodes(), overrides))
+			overridden_trs.push_back(
+				override.translation.value_or(rest_trs.get_translation(node_index)),
+				override.rotation.value_or(rest_trs.get_rotation(node_index)),
+				override.scale.value_or(rest_trs.get_scale(node_index))
+			);
+
+		std::pmr::vector<graphics::Affine_matrix> overridden_matrices(overrides.size(), resource);
+		graphics::compose_trs(overridden_trs, overridden_matrices);
+
+		const auto get_local_matrix = [&](uint32_t node_index) -> const graphics::Affine_matrix& {
+			const auto* const override = node_overrides.find(node_index);
+			if (override == nullptr || !override->has_override()) return rest_local_matrices[node_index];
+			return overridden_matrices[override - overrides.data()];
+		};
+
+		/* Update Animated Nodes */
+
+		// Static nodes keep their rest world matrix, only animated subtrees are recomputed and converted
+		if (model_transform == glm::mat4(1.0f))
 		{
-			if (std::holds_alternative<uint32_t>(key.animation))
+			std::pmr::vector<glm::mat4> node_world_matrices(
+				rest_world_matrices.begin(),
+				rest_world_matrices.end(),
+				resource
+			);
+
+			for (const auto node_index : animated_topo_order)
 			{
-				const auto animation_index = std::get<uint32_t>(key.animation);
-				if (animation_index >= animations.size()) continue;
-				animations[animation_index].apply(node_overrides, key.time);
+				const auto local_matrix = get_local_matrix(node_index).to_mat4();
+				node_world_matrices[node_index] = node_parents[node_index].has_value()
+					? node_world_matrices[*node_parents[node_index]] * local_matrix
+					: local_matrix;
 			}
-			else
-			{
-				const auto& animation_name = std::get<std::string>(key.animation);
-				const auto it = animation_name_map.find(animation_name);
-				if (it == animation_name_map.end()) continue;
 
-				const auto animation_index = it->second;
-				if (animation_index >= animations.size()) continue;
-				animations[animation_index].apply(node_overrides, key.time);
-			}
+			return node_world_matrices;
 		}
 
-		return node_overrides;
+		/* Accumulate World Matrices */
+
+		const auto model_matrix = graphics::Affine_matrix::from(model_transform);
+		std::pmr::vector<graphics::Affine_matrix> world_matrices(
+			nodes.size(),
+			graphics::Affine_matrix::identity(),
+			resource
+		);
+
+		for (const auto node_index : node_topo_order)
+		{
+			const auto& parent_matrix = node_parents[node_index].has_value()
+				? world_matrices[*node_parents[node_index]]
+				: model_matrix;
+			world_matrices[node_index] = parent_matrix * get_local_matrix(node_index);
+		}
+
+		std::pmr::vector<glm::mat4> node_world_matrices(resource);
+		node_world_matrices.reserve(nodes.size());
+		for (const auto& world_matrix : world_matrices) node_world_matrices.push_back(world_matrix.to_mat4());
+
+		return node_world_matrices;
 	}
 
-	std::vector<glm::mat4> Model::compute_node_world_matrices(
-		const glm::mat4& model_transform,
-		std::span<const Node::Transform_override> node_overrides
+	std::pmr::vector<Primitive_instance> Model::compute_instances(
+		std::span<const glm::mat4> node_world_matrices,
+		std::pmr::memory_resource* resource
 	) const noexcept
 	{
-		std::vector<glm::mat4> node_world_matrices(nodes.size(), glm::mat4(1.0f));
+		std::pmr::vector<Primitive_instance> instances(instance_count, resource);
 
-		for (const auto node_index : node_topo_order)
+		for (const auto [idx, node] : nodes | std::views::enumerate)
 		{
-			const auto& node = nodes[node_index];
-
-			const auto parent_matrix =
-				node_parents[node_index]
-					.transform([&node_world_matrices](uint32_t parent_index) {
-						return std::cref(node_world_matrices[parent_index]);
-					})
-					.value_or(std::ref(model_transform));
+			if (node.instances.empty()) continue;
 
-			node_world_matrices[node_index] =
-				parent_matrix.get() * node.get_local_transform(node_overrides[node_index]);
+			compute_node_instances(
+				idx,
+				node_world_matrices[idx],
+				std::span(instances).subspan(node_instance_offsets[idx], node.instances.size())
+			);
 		}
 
-		return node_world_matrices;
+		return instances;
 	}
 
-	std::vector<Primitive_drawcall> Model::compute_drawcalls(
-		const std::vector<glm::mat4>& node_world_matrices,
+	void Model::compute_node_instances(
+		uint32_t node_index,
+		const glm::mat4& world_matrix,
+		std::span<Primitive_instance> output
+	) const noexcept
+	{
+		const auto [local_min, local_max] =
+			get_node_local_bound(node_index).value_or(std::make_pair(glm::vec3(0.0f), glm::vec3(0.0f)));
+
+		for (const auto [local_transform, instance] : std::views::zip(nodes[node_index].instances, output))
+		{
+			const auto world_transform = world_matrix * local_transform;
+			const auto [world_min, world_max] =
+				graphics::local_bound_to_world(local_min, local_max, world_transform);
+
+			instance = Primitive_instance{
+				.world_transform = world_transform,
+				.world_position_min = world_min,
+				.world_position_max = world_max
+			};
+		}
+	}
+
+	std::pmr::vector<Primitive_drawcall> Model::compute_drawcalls(
+		std::span<const glm::mat4> node_world_matrices,
+		std::span<const Primitive_instance> instances,
+		std::span<const graphics::Affine_matrix> joint_matrices,
 		std::span<const std::pair<uint32_t, float>> emission_overrides,
-		std::span<const uint32_t> hidden_nodes
+		std::span<const uint32_t> hidden_nodes,
+		std::pmr::memory_resource* resource
 	) const noexcept
 	{
-		std::vector<Primitive_drawcall> drawdata_list;
+		std::pmr::vector<Primitive_drawcall> drawdata_list(resource);
 		drawdata_list.reserve(primitive_count);
 
-		auto renderable_nodes = this->renderable_nodes;
+		std::pmr::vector<bool> renderable_nodes(
+			this->renderable_nodes.begin(),
+			this->renderable_nodes.end(),
+			resource
+		);
 		for (const auto hidden_node_index : hidden_nodes) renderable_nodes[hidden_node_index] = false;
 
-		std::vector<float> emission_override_values(nodes.size(), 1.0f);
+		std::pmr::vector<float> emission_override_values(nodes.size(), 1.0f, resource);
 		for (const auto& [material_index, emission_value] : emission_overrides)
 			emission_override_values[material_index] = emission_value;
 
 		for (const auto node_index : node_topo_order)
 		{
 			const auto& node = nodes[node_index];
-			const glm::mat4& world_matrix = node_world_matrices[node_index];
-
 			if (!renderable_nodes[node_index] || !node.mesh.has_value()) continue;
 
-			const auto& mesh = meshes[node.mesh.value()];
+			const auto offset = drawdata_list.size();
+			drawdata_list.resize(offset + meshes[node.mesh.value()].primitives.size());
+
+			compute_node_drawcalls(
+				node_index,
+				node_world_matrices,
+				instances,
+				joint_matrices,
+				emission_override_values[node_index],
+				std::span(drawdata_list).subspan(offset)
+			);
+		}
 
-			if (node.skin.has_value())  // Rigged
-			{
-				const auto [_, joints, skin_offset] = skin_list[node.skin.value()];
-
-				const auto node_positions =
-					joints
-					| std::views::transform([&node_world_matrices](uint32_t joint_index) {
-						  const auto& matrix = node_world_matrices[joint_index];
-						  const auto& col = matrix[3];
-						  return glm::vec3(col.x, col.y, col.z) / col.w;
-					  })
-					| std::ranges::to<std::vector>();
-
-				const auto world_min = std::ranges::fold_left(
-					node_positions,
-					glm::vec3(std::numeric_limits<float>::max()),
-					[](const glm::vec3& a, const glm::vec3& b) { return glm::min(a, b); }
-				);
+		return drawdata_list;
+	}
 
-				const auto world_max = std::ranges::fold_left(
-					node_positions,
-					glm::vec3(std::numeric_limits<float>::lowest()),
-					[](const glm::vec3& a, const glm::vec3& b) { return glm::max(a, b); }
-				);
+	void Model::compute_node_drawcalls(
+		uint32_t node_index,
+		std::span<const glm::mat4> node_world_matrices,
+		std::span<const Primitive_instance> instances,
+		std::span<const graphics::Affine_matrix> joint_matrices,
+		float emissive_multiplier,
+		std::span<Primitive_drawcall> output
+	) const noexcept
+	{
+		const auto& node = nodes[node_index];
+		const auto& mesh = meshes[node.mesh.value()];
+		const glm::mat4& world_matrix = node_world_matrices[node_index];
 
-				for (const auto& primitive : mesh.primitives)
+		if (node.skin.has_value())  // Rigged, instancing is ignored
+		{
+			const auto [inverse_bind_matrices, joints, skin_offset] = skin_list[node.skin.value()];
+			const auto skin_joint_matrices = joint_matrices.subspan(skin_offset, joints.size());
+
+			// Fallback for primitives without usable joint bounds: joint origins inflated by the whole mesh
+			const auto compute_loose_bound = [&](const glm::vec3& local_min, const glm::vec3& local_max) {
+				auto world_min = glm::vec3(std::numeric_limits<float>::max());
+				auto world_max = glm::vec3(std::numeric_limits<float>::lowest());
+				for (const auto joint_index : joints)
 				{
-					const auto [gen_data, local_min, local_max] = primitive.gen_drawdata();
-					const float sphere_diameter = glm::distance(local_min, local_max);
-
-					drawdata_list.emplace_back(
-						Primitive_drawcall{
-							.world_position_min = world_min - glm::vec3(sphere_diameter),
-							.world_position_max = world_max + glm::vec3(sphere_diameter),
-							.material_index = primitive.material,
-							.transform_or_joint_matrix_offset = skin_offset,
-							.primitive = gen_data,
-						}
-					);
+					const auto& col = node_world_matrices[joint_index][3];
+					const auto position = glm::vec3(col.x, col.y, col.z) / col.w;
+					world_min = glm::min(world_min, position);
+					world_max = glm::max(world_max, position);
 				}
+
+				const float sphere_diameter = glm::distance(local_min, local_max);
+				return std::make_pair(
+					world_min - glm::vec3(sphere_diameter),
+					world_max + glm::vec3(sphere_diameter)
+				);
+			};
+
+			for (const auto [primitive, drawcall] : std::views::zip(mesh.primitives, output))
+			{
+				const auto [gen_data, local_min, local_max] = primitive.gen_drawdata();
+				const auto& joint_bounds = primitive.joint_bounds;
+
+				// Joint indices are checked against the skin here, as meshes are parsed without it
+				const bool tight = !joint_bounds.joints.empty() && joint_bounds.joints.back() < joints.size();
+				const auto [world_min, world_max] = tight
+					? graphics::merge_transformed_bounds(
+						  joint_bounds.position_min,
+						  joint_bounds.position_max,
+						  joint_bounds.joints,
+						  skin_joint_matrices
+					  )
+					: compute_loose_bound(local_min, local_max);
+
+				drawcall = Primitive_drawcall{
+					.world_position_min = world_min,
+					.world_position_max = world_max,
+					.material_index = primitive.material,
+					.transform_or_joint_matrix_offset = skin_offset,
+					.joint_count = static_cast<uint32_t>(joints.size()),
+					.primitive = gen_data,
+					.is_dynamic = true
+				};
 			}
-			else  // Not Rigged
+		}
+		else if (!node.instances.empty())  // Instanced
+		{
+			const auto node_instances =
+				instances.subspan(node_instance_offsets[node_index], node.instances.size());
+
+			// All primitives share the bound of the whole mesh per instance, merge them once
+			auto world_min = glm::vec3(std::numeric_limits<float>::max());
+			auto world_max = glm::vec3(std::numeric_limits<float>::lowest());
+			for (const auto& instance : node_instances)
 			{
+				world_min = glm::min(world_min, instance.world_position_min);
+				world_max = glm::max(world_max, instance.world_position_max);
+			}
 
-				for (const auto& primitive : mesh.primitives)
+			for (const auto [primitive, drawcall] : std::views::zip(mesh.primitives, output))
+			{
+				const auto [gen_data, local_min, local_max] = primitive.gen_drawdata();
+
+				drawcall = Primitive_drawcall{
+					.world_position_min = world_min,
+					.world_position_max = world_max,
+					.material_index = primitive.material,
+					.transform_or_joint_matrix_offset = world_matrix,
+					.primitive = gen_data,
+					.instances = node_instances,
+					.emissive_multiplier = emissive_multiplier,
+					.is_dynamic = animated_nodes[node_index]
+				};
+			}
+		}
+		else  // Not Rigged
+		{
+			for (const auto [primitive, drawcall] : std::views::zip(mesh.primitives, output))
+			{
+				const auto [gen_data, local_min, local_max] = primitive.gen_drawdata();
+				const auto [world_min, world_max] =
+					graphics::local_bound_to_world(local_min, local_max, world_matrix);
+
+				drawcall = Primitive_drawcall{
+					.world_position_min = world_min,
+					.world_position_max = world_max,
+					.material_index = primitive.material,
+					.transform_or_joint_matrix_offset = world_matrix,
+					.primitive = gen_data,
+					.emissive_multiplier = emissive_multiplier,
+					.is_dynamic = animated_nodes[node_index]
+				};
+			}
+		}
+	}
+
+	std::pmr::vector<Occluder_drawcall> Model::compute_occluders(
+		std::span<const glm::mat4> node_world_matrices,
+		std::span<const uint32_t> hidden_nodes,
+		std::pmr::memory_resource* resource,
+		std::pmr::vector<uint32_t>* occluder_node_indices
+	) const noexcept
+	{
+		std::pmr::vector<Occluder_drawcall> occluder_list(resource);
+
+		std::pmr::vector<bool> hidden(nodes.size(), false, resource);
+		for (const auto hidden_node_index : hidden_nodes) hidden[hidden_node_index] = true;
+
+		const auto material_cache = material_bind_cache->ref();
+
+		for (const auto node_index : node_topo_order)
+		{
+			const auto& node = nodes[node_index];
+			const glm::mat4& world_matrix = node_world_matrices[node_index];
+			const bool tagged = occluder_nodes[node_index];
+
+			if (hidden[node_index] || !node.mesh.has_value() || node.skin.has_value()) continue;
+			if (!node.instances.empty()) continue;  // Scattered instances are rarely useful occluders
+			if (!tagged && !renderable_nodes[node_index]) continue;
+
+			for (const auto& primitive : meshes[node.mesh.value()].primitives)
+			{
+				if (!primitive.occluder.has_value()) continue;
+
+				if (!tagged)
 				{
-					const auto [gen_data, local_min, local_max] = primitive.gen_drawdata();
-					const auto [world_min, world_max] =
-						graphics::local_bound_to_world(local_min, local_max, world_matrix);
-
-					drawdata_list.emplace_back(
-						Primitive_drawcall{
-							.world_position_min = world_min,
-							.world_position_max = world_max,
-							.material_index = primitive.material,
-							.transform_or_joint_matrix_offset = world_matrix,
-							.primitive = gen_data,
-							.emissive_multiplier = emission_override_values[node_index],
-						}
+					// Only large opaque surfaces are worth rasterizing
+					const auto& pipeline_mode = material_cache[primitive.material].params.pipeline;
+					if (pipeline_mode.alpha_mode != Alpha_mode::Opaque) continue;
+
+					const auto [world_min, world_max] = graphics::local_bound_to_world(
+						primitive.position_min,
+						primitive.position_max,
+						world_matrix
 					);
+					const auto extent = world_max - world_min;
+					const auto large_axis_count = int(extent.x >= min_occluder_extent)
+						+ int(extent.y >= min_occluder_extent)
+						+ int(extent.z >= min_occluder_extent);
+					if (large_axis_count < 2) continue;
 				}
+
+				occluder_list.emplace_back(
+					Occluder_drawcall{
+						.positions = primitive.occluder->positions,
+						.indices = primitive.occluder->indices,
+						.world_transform = world_matrix
+					}
+				);
+				if (occluder_node_indices != nullptr) occluder_node_indices->push_back(node_index);
 			}
 		}
 
-		return drawdata_list;
+		return occluder_list;
+	}
+
+	std::pmr::vector<uint32_t> Model::compute_used_skins(
+		std::span<const uint32_t> hidden_nodes,
+		std::pmr::memory_resource* resource
+	) const noexcept
+	{
+		std::pmr::vector<bool> hidden(nodes.size(), false, resource);
+		for (const auto hidden_node_index : hidden_nodes) hidden[hidden_node_index] = true;
+
+		// A skin shared by several nodes is needed as long as any of them is drawn
+		std::pmr::vector<bool> used(skin_list.skin_offsets.size(), false, resource);
+		for (const auto [node_index, node] : nodes | std::views::enumerate)
+		{
+			if (!node.skin.has_value() || !node.mesh.has_value()) continue;
+			if (renderable_nodes[node_index] && !hidden[node_index]) used[*node.skin] = true;
+		}
+
+		std::pmr::vector<uint32_t> skins(resource);
+		for (const auto [skin_index, skin_used] : used | std::views::enumerate)
+			if (skin_used) skins.push_back(static_cast<uint32_t>(skin_index));
+
+		return skins;
 	}
 
 	Drawdata Model::generate_drawdata(
 		const glm::mat4& model_transform,
 		std::span<const Animation_key> animation,
 		std::span<const std::pair<uint32_t, float>> emission_overrides,
-		std::span<const uint32_t> hidden_nodes
+		std::span<const uint32_t> hidden_nodes,
+		std::pmr::memory_resource* resource
 	) const noexcept
 	{
-		const auto node_overrides = compute_node_overrides(animation);
-		auto node_world_matrices = compute_node_world_matrices(model_transform, node_overrides);
-		auto primitive_list = compute_drawcalls(node_world_matrices, emission_overrides, hidden_nodes);
-		auto joint_matrices = skin_list.compute_joint_matrices(node_world_matrices);
+		const auto node_overrides = compute_node_overrides(animation, resource);
+		auto node_world_matrices = compute_node_world_matrices(model_transform, node_overrides, resource);
+		auto instance_list = compute_instances(node_world_matrices, resource);
+		auto joint_matrices = skin_list.compute_joint_matrices(
+			node_world_matrices,
+			compute_used_skins(hidden_nodes, resource),
+			resource
+		);
+		auto primitive_list = compute_drawcalls(
+			node_world_matrices,
+			instance_list,
+			joint_matrices,
+			emission_overrides,
+			hidden_nodes,
+			resource
+		);
+		auto occluder_list = compute_occluders(node_world_matrices, hidden_nodes, resource);
 
 		return {
 			.primitive_drawcalls = std::move(primitive_list),
+			.occluders = std::move(occluder_list),
 			.node_matrices = std::move(node_world_matrices),
+			.instances = std::move(instance_list),
 			.deferred_skin_resource = joint_matrices.empty()
 				? nullptr
-				: std::make_shared<Deferred_skinning_resource>(std::move(joint_matrices)),
+				: std::allocate_shared<Deferred_skinning_resource>(
+					  std::pmr::polymorphic_allocator<>(resource),
+					  std::move(joint_matrices),
+					  skinning_mode
+				  ),
+			.material_cache = material_bind_cache->ref()
+		};
+	}
+
+	void Model::rebuild_transform_cache(
+		Transform_cache& cache,
+		const glm::mat4& model_transform,
+		std::span<const Animation_key> animation
+	) const noexcept
+	{
+		// The cache and its drawdata outlive the frame, keep them off the frame resource
+		const auto resource = std::pmr::get_default_resource();
+
+		cache.valid = true;
+		cache.model_transform = model_transform;
+
+		cache.overrides = compute_node_overrides(animation, resource);
+		cache.scratch_overrides = Transform_override_set(animation_targets);
+		cache.animation_cursors.assign(animations.size(), {});
+		cache.dirty.assign(nodes.size(), false);
+
+		cache.drawdata.emplace(
+			Drawdata{
+				.primitive_drawcalls = std::pmr::vector<Primitive_drawcall>(resource),
+				.occluders = std::pmr::vector<Occluder_drawcall>(resource),
+				.node_matrices = compute_node_world_matrices(model_transform, cache.overrides, resource),
+				.instances = std::pmr::vector<Primitive_instance>(instance_count, resource),
+				.deferred_skin_resource = skin_list.joints.empty()
+					? nullptr
+					: std::make_shared<Deferred_skinning_resource>(
+						  std::pmr::vector<graphics::Affine_matrix>(skin_list.joints.size(), resource),
+						  skinning_mode
+					  ),
+				.material_cache = material_bind_cache->ref()
+			}
+		);
+
+		const auto& world_matrices = cache.drawdata->node_matrices;
+		auto& instances = cache.drawdata->instances;
+		const auto joint_matrices = cache.get_joint_matrices();
+
+		for (const auto [idx, node] : nodes | std::views::enumerate)
+		{
+			if (node.instances.empty()) continue;
+
+			compute_node_instances(
+				idx,
+				world_matrices[idx],
+				std::span(instances).subspan(node_instance_offsets[idx], node.instances.size())
+			);
+		}
+
+		// Joints of every renderable rigged node are kept, hidden nodes are only skipped when uploading
+		const auto rigged_skins = compute_used_skins({}, resource);
+		cache.rigged_skins.assign(rigged_skins.begin(), rigged_skins.end());
+		skin_list.compute_joint_matrices(world_matrices, cache.rigged_skins, joint_matrices);
+
+		// Emission overrides are applied when filtering, cached drawcalls keep the default multiplier
+		cache.drawcalls.clear();
+		cache.drawcall_nodes.clear();
+		cache.node_drawcall_offsets.assign(nodes.size(), 0);
+		cache.rigged_nodes.clear();
+
+		for (const auto node_index : node_topo_order)
+		{
+			const auto& node = nodes[node_index];
+			if (!renderable_nodes[node_index] || !node.mesh.has_value()) continue;
+
+			const auto offset = cache.drawcalls.size();
+			const auto count = meshes[node.mesh.value()].primitives.size();
+			cache.drawcalls.resize(offset + count);
+			cache.drawcall_nodes.resize(offset + count, node_index);
+			cache.node_drawcall_offsets[node_index] = static_cast<uint32_t>(offset);
+			if (node.skin.has_value()) cache.rigged_nodes.push_back(node_index);
+
+			compute_node_drawcalls(
+				node_index,
+				world_matrices,
+				instances,
+				joint_matrices,
+				1.0f,
+				std::span(cache.drawcalls).subspan(offset, count)
+			);
+		}
+
+		std::pmr::vector<uint32_t> occluder_nodes(resource);
+		const auto occluders = compute_occluders(world_matrices, {}, resource, &occluder_nodes);
+		cache.occluders.assign(occluders.begin(), occluders.end());
+		cache.occluder_nodes.assign(occluder_nodes.begin(), occluder_nodes.end());
+
+		cache.patched_nodes.clear();
+		cache.refilter = true;
+		cache.updated_node_count = nodes.size();
+	}
+
+	void Model::update_transform_cache(
+		Transform_cache& cache,
+		const glm::mat4& model_transform,
+		std::span<const Animation_key> animation
+	) const noexcept
+	{
+		const bool stale = !cache.valid
+			|| !cache.drawdata.has_value()
+			|| cache.drawdata->node_matrices.size() != nodes.size();
+		if (stale || cache.model_transform != model_transform)
+		{
+			rebuild_transform_cache(cache, model_transform, animation);
+			return;
+		}
+
+		auto& world_matrices = cache.drawdata->node_matrices;
+		auto& instances = cache.drawdata->instances;
+		const auto joint_matrices = cache.get_joint_matrices();
+
+		/* Diff Overrides */
+
+		// Overrides only exist for animation targets, so the diff scales with animated nodes
+		auto& scratch = cache.scratch_overrides;
+		scratch.clear();
+
+		// Cursors carry the keyframe segments over from the last update, animations mostly play forward
+		for (const auto& key : animation)
+		{
+			const auto animation_index = find_animation(key);
+			if (!animation_index.has_value()) continue;
+
+			animations[*animation_index].apply(scratch, key.time, cache.animation_cursors[*animation_index]);
+		}
+
+		cache.dirty_nodes.clear();
+		for (const auto [node_index, override, applied] :
+			 std::views::zip(scratch.get_nodes(), scratch.get_overrides(), cache.overrides.get_overrides()))
+		{
+			if (override == applied) continue;
+
+			applied = override;
+			cache.dirty[node_index] = true;
+			cache.dirty_nodes.push_back(node_index);
+		}
+
+		/* Update Dirty Subtrees */
+
+		cache.updated_node_count = 0;
+		cache.patched_nodes.clear();
+
+		for (const auto root_index : cache.dirty_nodes)
+		{
+			// Subtrees under a dirty ancestor are updated along with it
+			bool covered = false;
+			for (auto parent = node_parents[root_index]; parent.has_value() && !covered;
+				 parent = node_parents[*parent])
+				covered = cache.dirty[*parent];
+			if (covered) continue;
+
+			cache.stack.push_back(root_index);
+			while (!cache.stack.empty())
+			{
+				const auto node_index = cache.stack.back();
+				cache.stack.pop_back();
+
+				const auto& node = nodes[node_index];
+				const auto& parent_matrix = node_parents[node_index].has_value()
+					? world_matrices[*node_parents[node_index]]
+					: model_transform;
+				world_matrices[node_index] =
+					parent_matrix * compute_local_matrix(node_index, cache.overrides).to_mat4();
+				cache.updated_node_count++;
+
+				if (!node.instances.empty())
+					compute_node_instances(
+						node_index,
+						world_matrices[node_index],
+						std::span(instances).subspan(node_instance_offsets[node_index], node.instances.size())
+					);
+
+				if (renderable_nodes[node_index] && node.mesh.has_value() && !node.skin.has_value())
+				{
+					compute_node_drawcalls(
+						node_index,
+						world_matrices,
+						instances,
+						joint_matrices,
+						1.0f,
+						std::span(cache.drawcalls)
+							.subspan(
+								cache.node_drawcall_offsets[node_index],
+								meshes[node.mesh.value()].primitives.size()
+							)
+					);
+					cache.patched_nodes.push_back(node_index);
+				}
+
+				cache.stack.append_range(node.children);
+			}
+		}
+
+		for (const auto node_index : cache.dirty_nodes) cache.dirty[node_index] = false;
+
+		// Rigged bounds follow joints anywhere in the tree
+		if (cache.updated_node_count == 0) return;
+
+		skin_list.compute_joint_matrices(world_matrices, cache.rigged_skins, joint_matrices);
+
+		for (const auto node_index : cache.rigged_nodes)
+			compute_node_drawcalls(
+				node_index,
+				world_matrices,
+				instances,
+				joint_matrices,
+				1.0f,
+				std::span(cache.drawcalls)
+					.subspan(
+						cache.node_drawcall_offsets[node_index],
+						meshes[nodes[node_index].mesh.value()].primitives.size()
+					)
+			);
+		cache.patched_nodes.append_range(cache.rigged_nodes);
+	}
+
+	const Drawdata& Model::generate_drawdata(
+		Transform_cache& cache,
+		const glm::mat4& model_transform,
+		std::span<const Animation_key> animation,
+		std::span<const std::pair<uint32_t, float>> emission_overrides,
+		std::span<const uint32_t> hidden_nodes
+	) const noexcept
+	{
+		update_transform_cache(cache, model_transform, animation);
+
+		auto& drawdata = *cache.drawdata;
+
+		// Copy the cached drawcalls of a node into the drawdata, with its emission override applied
+		const auto copy_node_drawcalls = [&cache](uint32_t node_index, std::span<Primitive_drawcall> output) {
+			const auto source =
+				std::span(cache.drawcalls).subspan(cache.node_drawcall_offsets[node_index], output.size());
+
+			for (const auto [drawcall, copied] : std::views::zip(source, output))
+			{
+				copied = drawcall;
+				if (!drawcall.is_rigged()) copied.emissive_multiplier = cache.emission_values[node_index];
+			}
+		};
+
+		/* Filter Drawcalls */
+
+		const bool refilter = cache.refilter
+			|| !std::ranges::equal(hidden_nodes, cache.hidden_nodes)
+			|| !std::ranges::equal(emission_overrides, cache.emission_overrides);
+
+		if (refilter)
+		{
+			cache.refilter = false;
+			cache.hidden_nodes.assign(hidden_nodes.begin(), hidden_nodes.end());
+			cache.emission_overrides.assign(emission_overrides.begin(), emission_overrides.end());
+
+			cache.hidden.assign(nodes.size(), false);
+			for (const auto hidden_node_index : hidden_nodes) cache.hidden[hidden_node_index] = true;
+
+			cache.emission_values.assign(nodes.size(), 1.0f);
+			for (const auto& [node_index, emission_value] : emission_overrides)
+				cache.emission_values[node_index] = emission_value;
+
+			drawdata.primitive_drawcalls.clear();
+			cache.filtered_drawcall_offsets.assign(nodes.size(), Transform_cache::no_drawcall);
+
+			for (const auto node_index : node_topo_order)
+			{
+				const auto& node = nodes[node_index];
+				if (!renderable_nodes[node_index] || !node.mesh.has_value() || cache.hidden[node_index])
+					continue;
+
+				const auto offset = drawdata.primitive_drawcalls.size();
+				const auto count = meshes[node.mesh.value()].primitives.size();
+				drawdata.primitive_drawcalls.resize(offset + count);
+				cache.filtered_drawcall_offsets[node_index] = static_cast<uint32_t>(offset);
+
+				copy_node_drawcalls(
+					node_index,
+					std::span(drawdata.primitive_drawcalls).subspan(offset, count)
+				);
+			}
+		}
+		else
+		{
+			// Only recomputed nodes changed, patch their drawcalls in place
+			for (const auto node_index : cache.patched_nodes)
+			{
+				const auto offset = cache.filtered_drawcall_offsets[node_index];
+				if (offset == Transform_cache::no_drawcall) continue;
+
+				const auto count = meshes[nodes[node_index].mesh.value()].primitives.size();
+				copy_node_drawcalls(
+					node_index,
+					std::span(drawdata.primitive_drawcalls).subspan(offset, count)
+				);
+			}
+		}
+
+		/* Filter Occluders */
+
+		// Occluders are few, refilter them whenever anything moved
+		if (refilter || cache.updated_node_count > 0)
+		{
+			drawdata.occluders.clear();
+			for (const auto [occluder, node_index] : std::views::zip(cache.occluders, cache.occluder_nodes))
+			{
+				if (cache.hidden[node_index]) continue;
+
+				auto& filtered = drawdata.occluders.emplace_back(occluder);
+				filtered.world_transform = drawdata.node_matrices[node_index];
+			}
+		}
+
+		// The joint palette was refreshed by the update, hidden skins are never marked for upload
+		if (drawdata.deferred_skin_resource != nullptr) drawdata.deferred_skin_resource->reset(skinning_mode);
+
+		return drawdata;
+	}
+
+	Model::Pose Model::compute_pose(
+		std::span<const Animation_key> animation,
+		std::span<const std::pair<uint32_t, float>> emission_overrides,
+		std::span<const uint32_t> hidden_nodes,
+		std::pmr::memory_resource* resource
+	) const noexcept
+	{
+		const auto node_overrides = compute_node_overrides(animation, resource);
+
+		// Move-construct the members, assigning would copy into the default resource
+		auto node_matrices = compute_node_world_matrices(glm::mat4(1.0f), node_overrides, resource);
+		auto instances = compute_instances(node_matrices, resource);
+		auto joint_matrices = skin_list.compute_joint_matrices(
+			node_matrices,
+			compute_used_skins(hidden_nodes, resource),
+			resource
+		);
+		auto drawcalls = compute_drawcalls(
+			node_matrices,
+			instances,
+			joint_matrices,
+			emission_overrides,
+			hidden_nodes,
+			resource
+		);
+		auto occluders = compute_occluders(node_matrices, hidden_nodes, resource);
+
+		Pose pose{
+			.node_matrices = std::move(node_matrices),
+			.instances = std::move(instances),
+			.drawcalls = std::move(drawcalls),
+			.occluders = std::move(occluders),
+			.joint_matrices = std::move(joint_matrices)
+		};
+
+		for (const auto& drawcall : pose.drawcalls)
+		{
+			pose.bound_min = glm::min(pose.bound_min, drawcall.world_position_min);
+			pose.bound_max = glm::max(pose.bound_max, drawcall.world_position_max);
+		}
+
+		return pose;
+	}
+
+	Drawdata Model::generate_instanced_drawdata(
+		std::span<const Model_instance> instances,
+		std::span<const glm::vec4> frustum_planes,
+		std::span<const std::pair<uint32_t, float>> emission_overrides,
+		std::span<const uint32_t> hidden_nodes,
+		std::pmr::memory_resource* resource
+	) const noexcept
+	{
+		/* Group Instances by Animation */
+
+		std::pmr::vector<std::span<const Animation_key>> pose_keys(resource);
+		std::pmr::vector<size_t> instance_poses(instances.size(), resource);
+		std::pmr::unordered_multimap<size_t, size_t> pose_lookup(resource);
+
+		for (const auto [idx, instance] : instances | std::views::enumerate)
+		{
+			const auto hash = hash_animation_keys(instance.animation);
+			const auto [begin, end] = pose_lookup.equal_range(hash);
+			const auto found = std::find_if(begin, end, [&pose_keys, &instance](const auto& entry) {
+				return std::ranges::equal(pose_keys[entry.second], instance.animation);
+			});
+
+			if (found != end)
+			{
+				instance_poses[idx] = found->second;
+				continue;
+			}
+
+			instance_poses[idx] = pose_keys.size();
+			pose_lookup.emplace(hash, pose_keys.size());
+			pose_keys.push_back(instance.animation);
+		}
+
+		/* Evaluate Poses */
+
+		// Memory resources aren't required to be thread-safe, workers share the resource through a lock. A
+		// pose makes a few dozen allocations, far fewer than its work.
+		util::Synchronized_resource pose_resource(resource);
+		std::pmr::vector<std::optional<Pose>> poses(pose_keys.size(), resource);
+		parallel_pool->parallel_for(poses.size(), 1, [&](size_t idx) {
+			poses[idx].emplace(
+				compute_pose(pose_keys[idx], emission_overrides, hidden_nodes, &pose_resource)
+			);
+		});
+
+		/* Cull and Lay Out Instances */
+
+		// Offsets of an instance's data in the combined drawdata
+		struct Layout
+		{
+			size_t drawcall = 0;
+			size_t instance = 0;
+			size_t occluder = 0;
+			size_t joint = 0;
+			bool visible = false;
+		};
+
+		std::pmr::vector<Layout> layouts(instances.size(), resource);
+		Layout total;
+
+		for (const auto [instance, pose_index, layout] : std::views::zip(instances, instance_poses, layouts))
+		{
+			const auto& pose = *poses[pose_index];
+			const auto [world_min, world_max] =
+				graphics::local_bound_to_world(pose.bound_min, pose.bound_max, instance.model_transform);
+
+			if (pose.drawcalls.empty()) continue;
+			if (!frustum_planes.empty() && !graphics::box_in_frustum(world_min, world_max, frustum_planes))
+				continue;
+
+			layout = total;
+			layout.visible = true;
+
+			total.drawcall += pose.drawcalls.size();
+			total.instance += pose.instances.size();
+			total.occluder += pose.occluders.size();
+			total.joint += pose.joint_matrices.size();
+		}
+
+		/* Place Instances */
+
+		Drawdata result{
+			.primitive_drawcalls = std::pmr::vector<Primitive_drawcall>(total.drawcall, resource),
+			.occluders = std::pmr::vector<Occluder_drawcall>(total.occluder, resource),
+			.node_matrices = std::pmr::vector<glm::mat4>(instances.size() * nodes.size(), resource),
+			.instances = std::pmr::vector<Primitive_instance>(total.instance, resource),
+			.deferred_skin_resource = nullptr,
 			.material_cache = material_bind_cache->ref()
 		};
+		std::pmr::vector<graphics::Affine_matrix> joint_matrices(total.joint, resource);
+
+		// Every task writes disjoint ranges, sized above
+		parallel_pool->parallel_for(instances.size(), instance_chunk_size, [&](size_t idx) {
+			const auto& transform = instances[idx].model_transform;
+			const auto& pose = *poses[instance_poses[idx]];
+			const auto& layout = layouts[idx];
+
+			for (const auto [node_index, node_matrix] : pose.node_matrices | std::views::enumerate)
+				result.node_matrices[idx * nodes.size() + node_index] = transform * node_matrix;
+
+			if (!layout.visible) return;
+
+			for (const auto [offset, instance] : pose.instances | std::views::enumerate)
+			{
+				const auto [world_min, world_max] = graphics::local_bound_to_world(
+					instance.world_position_min,
+					instance.world_position_max,
+					transform
+				);
+
+				result.instances[layout.instance + offset] = Primitive_instance{
+					.world_transform = transform * instance.world_transform,
+					.world_position_min = world_min,
+					.world_position_max = world_max
+				};
+			}
+
+			const auto affine_transform = graphics::Affine_matrix::from(transform);
+			for (const auto [offset, joint_matrix] : pose.joint_matrices | std::views::enumerate)
+				joint_matrices[layout.joint + offset] = affine_transform * joint_matrix;
+
+			for (const auto [offset, drawcall] : pose.drawcalls | std::views::enumerate)
+			{
+				auto& placed = result.primitive_drawcalls[layout.drawcall + offset];
+				placed = drawcall;
+
+				std::tie(placed.world_position_min, placed.world_position_max) =
+					graphics::local_bound_to_world(
+						drawcall.world_position_min,
+						drawcall.world_position_max,
+						transform
+					);
+
+				if (drawcall.is_rigged())
+					placed.transform_or_joint_matrix_offset =
+						static_cast<uint32_t>(drawcall.get_joint_matrix_offset() + layout.joint);
+				else
+					placed.transform_or_joint_matrix_offset = transform * drawcall.get_world_transform();
+
+				if (!drawcall.instances.empty())
+				{
+					const auto first = layout.instance
+						+ static_cast<size_t>(drawcall.instances.data() - pose.instances.data());
+					placed.instances = std::span(result.instances).subspan(first, drawcall.instances.size());
+				}
+			}
+
+			for (const auto [offset, occluder] : pose.occluders | std::views::enumerate)
+			{
+				auto& placed = result.occluders[layout.occluder + offset];
+				placed = occluder;
+				placed.world_transform = transform * occluder.world_transform;
+			}
+		});
+
+		if (!joint_matrices.empty())
+			result.deferred_skin_resource = std::allocate_shared<Deferred_skinning_resource>(
+				std::pmr::polymorphic_allocator<>(resource),
+				std::move(joint_matrices),
+				skinning_mode
+			);
+
+		return result;
 	}
 
 	std::optional<uint32_t> Model::find_node_by_name(const std::string& name) const noexcept
@@ -490,6 +1505,41 @@ namespace gltf
 		return std::get<0>(found[0]);
 	}
 
+	std::vector<std::pair<uint32_t, std::string>> Model::find_nodes_by_prefix(
+		std::string_view prefix
+	) const noexcept
+	{
+		std::vector<std::pair<uint32_t, std::string>> found;
+
+		for (const auto [idx, node] : nodes | std::views::enumerate)
+			if (node.name.has_value() && node.name->starts_with(prefix)) found.emplace_back(idx, *node.name);
+
+		return found;
+	}
+
+	std::optional<std::pair<glm::vec3, glm::vec3>> Model::get_node_local_bound(
+		uint32_t node_index
+	) const noexcept
+	{
+		if (node_index >= nodes.size()) return std::nullopt;
+
+		const auto& node = nodes[node_index];
+		if (!node.mesh.has_value() || node.skin.has_value()) return std::nullopt;
+
+		const auto& mesh = meshes[*node.mesh];
+		if (mesh.primitives.empty()) return std::nullopt;
+
+		auto bound_min = glm::vec3(std::numeric_limits<float>::max());
+		auto bound_max = glm::vec3(std::numeric_limits<float>::lowest());
+		for (const auto& primitive : mesh.primitives)
+		{
+			bound_min = glm::min(bound_min, primitive.position_min);
+			bound_max = glm::max(bound_max, primitive.position_max);
+		}
+
+		return std::make_pair(bound_min, bound_max);
+	}
+
 	std::optional<std::pair<uint32_t, Light>> Model::find_light_by_name(
 		const std::string& name
 	) const noexcept
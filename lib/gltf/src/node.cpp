@@ -1,10 +1,77 @@
 #include "gltf/node.hpp"
+#include "gltf/accessor.hpp"
 
 #include <algorithm>
+#include <array>
 #include <ranges>
 
 namespace gltf
 {
+	// Extract an optional instance attribute of `EXT_mesh_gpu_instancing`, empty if absent
+	template <typename T>
+	static std::expected<std::vector<T>, util::Error> extract_instance_attribute(
+		const tinygltf::Model& model,
+		const tinygltf::Value& attributes,
+		const std::string& name
+	) noexcept
+	{
+		if (!attributes.Has(name)) return std::vector<T>();
+
+		const auto& accessor_index = attributes.Get(name);
+		if (!accessor_index.IsNumber())
+			return util::Error(std::format("Instance attribute {} is not an accessor index", name));
+
+		const auto index = accessor_index.GetNumberAsInt();
+		if (index < 0 || std::cmp_greater_equal(index, model.accessors.size()))
+			return util::Error(std::format("Instance attribute {} has invalid accessor {}", name, index));
+
+		auto data_result = extract_from_accessor<T>(model, model.accessors[index]);
+		if (!data_result)
+			return data_result.error().forward(std::format("Extract instance attribute {} failed", name));
+
+		return std::move(*data_result);
+	}
+
+	// Parse `EXT_mesh_gpu_instancing` into local instance transforms
+	static std::expected<std::vector<glm::mat4>, util::Error> parse_instances(
+		const tinygltf::Model& model,
+		const tinygltf::Value& extension
+	) noexcept
+	{
+		if (!extension.Has("attributes") || !extension.Get("attributes").IsObject())
+			return util::Error("Instancing extension has no attributes");
+		const auto& attributes = extension.Get("attributes");
+
+		auto translations = extract_instance_attribute<glm::vec3>(model, attributes, "TRANSLATION");
+		if (!translations) return translations.error();
+
+		auto rotations = extract_instance_attribute<glm::quat>(model, attributes, "ROTATION");
+		if (!rotations) return rotations.error();
+
+		auto scales = extract_instance_attribute<glm::vec3>(model, attributes, "SCALE");
+		if (!scales) return scales.error();
+
+		const auto count = std::max({translations->size(), rotations->size(), scales->size()});
+		if (count == 0) return util::Error("Instancing extension has no instance attributes");
+
+		// Absent attributes default to identity, present ones must cover every instance
+		if (std::ranges::any_of(
+				std::array{translations->size(), rotations->size(), scales->size()},
+				[count](size_t size) { return size != 0 && size != count; }
+			))
+			return util::Error("Instance attributes have mismatched counts");
+
+		return std::views::iota(0zu, count)
+			| std::views::transform([&](size_t idx) {
+				  Node::Transform transform;
+				  if (!translations->empty()) transform.translation = (*translations)[idx];
+				  if (!rotations->empty()) transform.rotation = (*rotations)[idx];
+				  if (!scales->empty()) transform.scale = (*scales)[idx];
+				  return transform.to_matrix();
+			  })
+			| std::ranges::to<std::vector>();
+	}
+
 	std::expected<Node, util::Error> Node::from_tinygltf(
 		const tinygltf::Model& model,
 		const tinygltf::Node& node
@@ -84,6 +151,33 @@ namespace gltf
 			result.transform = transform;
 		}
 
+		if (const auto found = node.extensions.find("EXT_mesh_gpu_instancing");
+			found != node.extensions.end())
+		{
+			auto instances_result = parse_instances(model, found->second);
+			if (!instances_result)
+				return instances_result.error().forward("Parse instancing extension failed");
+			result.instances = std::move(*instances_result);
+		}
+
 		return result;
 	}
+
+	Node::Transform_override* Transform_override_set::find(uint32_t node_index) noexcept
+	{
+		const auto it = std::ranges::lower_bound(nodes, node_index);
+		if (it == nodes.end() || *it != node_index) return nullptr;
+
+		return &overrides[std::distance(nodes.begin(), it)];
+	}
+
+	const Node::Transform_override* Transform_override_set::find(uint32_t node_index) const noexcept
+	{
+		return const_cast<Transform_override_set*>(this)->find(node_index);
+	}
+
+	void Transform_override_set::clear() noexcept
+	{
+		std::ranges::fill(overrides, Node::Transform_override());
+	}
 }
\ No newline at end of file
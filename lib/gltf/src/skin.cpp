@@ -1,9 +1,9 @@
 #include "gltf/skin.hpp"
 #include "gltf/accessor.hpp"
-#include "util/as-byte.hpp"
 
 #include <SDL3/SDL_gpu.h>
 #include <algorithm>
+#include <functional>
 
 namespace gltf
 {
@@ -64,71 +64,167 @@ namespace gltf
 			skin_collection.skin_offsets
 				.emplace_back(skin_collection.joints.size(), skin_result->second.size());
 
-			skin_collection.inverse_bind_matrices.append_range(skin_result->first);
+			skin_collection.inverse_bind_matrices.append_range(
+				skin_result->first | std::views::transform(&graphics::Affine_matrix::from)
+			);
 			skin_collection.joints.append_range(skin_result->second);
 		}
 
 		return skin_collection;
 	}
 
-	std::vector<glm::mat4> Skin_list::compute_joint_matrices(
-		const std::vector<glm::mat4>& node_world_matrices
+	std::pmr::vector<graphics::Affine_matrix> Skin_list::compute_joint_matrices(
+		std::span<const glm::mat4> node_world_matrices,
+		std::span<const uint32_t> skins,
+		std::pmr::memory_resource* resource
+	) const noexcept
+	{
+		std::pmr::vector<graphics::Affine_matrix> joint_matrices(joints.size(), resource);
+		compute_joint_matrices(node_world_matrices, skins, joint_matrices);
+		return joint_matrices;
+	}
+
+	void Skin_list::compute_joint_matrices(
+		std::span<const glm::mat4> node_world_matrices,
+		std::span<const uint32_t> skins,
+		std::span<graphics::Affine_matrix> output
 	) const noexcept
 	{
-		std::vector<glm::mat4> joint_matrices;
-		joint_matrices.reserve(joints.size());
+		assert(output.size() == joints.size());
 
-		for (const auto [inverse_bind_matrix, joint_index] : std::views::zip(inverse_bind_matrices, joints))
+		for (const auto skin_index : skins)
 		{
-			const glm::mat4& node_world_matrix = node_world_matrices[joint_index];
-			joint_matrices.emplace_back(node_world_matrix * inverse_bind_matrix);
+			const auto [offset, length] = skin_offsets[skin_index];
+			graphics::compose_gathered(
+				node_world_matrices,
+				std::span(joints).subspan(offset, length),
+				std::span(inverse_bind_matrices).subspan(offset, length),
+				output.subspan(offset, length)
+			);
 		}
+	}
 
-		return joint_matrices;
+	void Deferred_skinning_resource::reset(Skinning_mode mode) noexcept
+	{
+		// Clearing keeps the capacity of the ranges, a steady frame doesn't allocate
+		used_ranges.clear();
+		upload_allocation.reset();
+		joint_matrices_buffer = nullptr;
+		this->mode = mode;
+	}
+
+	size_t Deferred_skinning_resource::get_used_joint_count() const noexcept
+	{
+		return std::ranges::fold_left(used_ranges | std::views::values, 0zu, std::plus());
+	}
+
+	void Deferred_skinning_resource::merge_used_ranges() noexcept
+	{
+		const auto joint_count = static_cast<uint32_t>(joint_matrices_data.size());
+
+		std::ranges::sort(used_ranges);
+
+		size_t merged_count = 0;
+		for (const auto [offset, count] : used_ranges)
+		{
+			if (offset >= joint_count) continue;
+			const auto end = std::min(offset + count, joint_count);
+
+			if (merged_count > 0)
+			{
+				auto& [last_offset, last_count] = used_ranges[merged_count - 1];
+				if (offset <= last_offset + last_count)
+				{
+					last_count = std::max(last_count, end - last_offset);
+					continue;
+				}
+			}
+
+			used_ranges[merged_count++] = {offset, end - offset};
+		}
+		used_ranges.resize(merged_count);
+	}
+
+	void Deferred_skinning_resource::pack_used_ranges(std::span<std::byte> data) const noexcept
+	{
+		assert(data.size() >= get_joint_stride() * get_used_joint_count());
+
+		if (mode == Skinning_mode::Dual_quaternion)
+		{
+			auto* output = reinterpret_cast<graphics::Dual_quaternion*>(data.data());
+			for (const auto [offset, count] : used_ranges)
+			{
+				const auto matrices = std::span(joint_matrices_data).subspan(offset, count);
+				std::ranges::transform(matrices, output, &graphics::Dual_quaternion::from);
+				output += count;
+			}
+			return;
+		}
+
+		auto* output = reinterpret_cast<graphics::Affine_matrix*>(data.data());
+		for (const auto [offset, count] : used_ranges)
+		{
+			std::ranges::copy(std::span(joint_matrices_data).subspan(offset, count), output);
+			output += count;
+		}
 	}
 
 	std::expected<void, util::Error> Deferred_skinning_resource::prepare_gpu_buffers(
 		graphics::Buffer_pool& buffer_pool,
-		graphics::Transfer_buffer_pool& transfer_pool
+		graphics::Upload_ring& upload_ring
 	) noexcept
 	{
-		if (upload_buffer || joint_matrices_buffer)
+		if (upload_allocation || joint_matrices_buffer)
 			return util::Error("GPU buffers for skin computation already prepared");
 
-		const auto upload_buffer_result = transfer_pool.acquire_buffer(
-			gpu::Transfer_buffer::Usage::Upload,
-			sizeof(glm::mat4) * joint_matrices_data.size()
-		);
-		if (!upload_buffer_result)
-			return upload_buffer_result.error().forward("Acquire transfer buffer for joint matrices failed");
+		merge_used_ranges();
 
+		/* Acquire Buffers */
+
+		// The GPU buffer keeps the full layout, as drawcalls address joints by their offset in all skins
 		const auto buffer_result = buffer_pool.acquire_buffer(
 			{.graphic_storage_read = true},
-			sizeof(glm::mat4) * joint_matrices_data.size()
+			get_joint_stride() * joint_matrices_data.size()
 		);
 		if (!buffer_result) return buffer_result.error().forward("Acquire buffer for joint matrices failed");
-
-		upload_buffer = *upload_buffer_result;
 		joint_matrices_buffer = *buffer_result;
 
-		if (const auto result = upload_buffer->upload_to_buffer(util::as_bytes(joint_matrices_data), true);
-			!result)
-			return result.error().forward("Upload node matrices to transfer buffer failed");
+		const auto used_joint_count = get_used_joint_count();
+		if (used_joint_count == 0) return {};
+
+		/* Pack Used Ranges */
+
+		const auto upload_result = upload_ring.upload(
+			static_cast<uint32_t>(get_joint_stride() * used_joint_count),
+			alignof(graphics::Affine_matrix),
+			[this](std::span<std::byte> data) { pack_used_ranges(data); }
+		);
+		if (!upload_result)
+			return upload_result.error().forward("Upload joint matrices to upload ring failed");
+		upload_allocation = *upload_result;
 
 		return {};
 	}
 
 	void Deferred_skinning_resource::upload_gpu_buffers(const gpu::Copy_pass& copy_pass) noexcept
 	{
-		assert(upload_buffer != nullptr && joint_matrices_buffer != nullptr);
-
-		copy_pass.upload_to_buffer(
-			*upload_buffer,
-			0,
-			*joint_matrices_buffer,
-			0,
-			sizeof(glm::mat4) * joint_matrices_data.size(),
-			true
-		);
+		assert(joint_matrices_buffer != nullptr);
+		if (!upload_allocation) return;
+
+		// Ranges are packed in the upload ring, and scattered back to their offsets
+		const auto stride = static_cast<uint32_t>(get_joint_stride());
+		uint32_t src_offset = 0;
+		for (const auto [offset, count] : used_ranges)
+		{
+			copy_pass.upload_to_buffer(
+				*upload_allocation->buffer,
+				upload_allocation->offset + src_offset,
+				*joint_matrices_buffer,
+				stride * offset,
+				stride * count,
+				src_offset == 0  // Cycle once, later ranges write into the same cycled buffer
+			);
+			src_offset += stride * count;
+		}
 	}
 }
\ No newline at end of file
@@ -68,6 +68,19 @@ namespace gpu
 			bool cycle
 		) const noexcept;
 
+		///
+		/// @brief Uploads data from a transfer buffer on the CPU side to a buffer on the GPU side
+		///
+		/// @param src_location Source transfer buffer location
+		/// @param dst_region Destination buffer region
+		/// @param cycle Use cycle mode
+		///
+		void upload_to_buffer(
+			const SDL_GPUTransferBufferLocation& src_location,
+			const SDL_GPUBufferRegion& dst_region,
+			bool cycle
+		) const noexcept;
+
 		///
 		/// @brief Uploads data from a transfer buffer on the CPU side to a texture on the GPU side
 		///
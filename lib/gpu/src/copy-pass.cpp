@@ -57,6 +57,16 @@ namespace gpu
 		SDL_UploadToGPUBuffer(resource, &src_location, &dst_region, cycle);
 	}
 
+	void Copy_pass::upload_to_buffer(
+		const SDL_GPUTransferBufferLocation& src_location,
+		const SDL_GPUBufferRegion& dst_region,
+		bool cycle
+	) const noexcept
+	{
+		assert(resource != nullptr);
+		SDL_UploadToGPUBuffer(resource, &src_location, &dst_region, cycle);
+	}
+
 	void Copy_pass::upload_to_texture(
 		const SDL_GPUTextureTransferInfo& src_info,
 		const SDL_GPUTextureRegion& dst_region,
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <memory_resource>
+#include <span>
+#include <vector>
+
+namespace graphics
+{
+	///
+	/// @brief Affine transform stored as the top three rows of a 4x4 matrix
+	/// @details 48 bytes instead of 64 for `glm::mat4`. The memory layout equals GLSL `mat3x4` in std140 and
+	/// std430, where the rows become columns, so shaders transform with `vec4(p, 1.0) * M`.
+	///
+	struct alignas(16) Affine_matrix
+	{
+		glm::vec4 rows[3];
+
+		static Affine_matrix identity() noexcept;
+
+		///
+		/// @brief Convert from a 4x4 matrix, the bottom row is dropped
+		///
+		/// @param matrix Affine 4x4 matrix
+		/// @return Affine matrix
+		///
+		static Affine_matrix from(const glm::mat4& matrix) noexcept;
+
+		///
+		/// @brief Compose a T*R*S transform
+		///
+		/// @param translation Translation
+		/// @param rotation Rotation, normalized
+		/// @param scale Scale
+		/// @return Affine matrix
+		///
+		static Affine_matrix from_trs(
+			const glm::vec3& translation,
+			const glm::quat& rotation,
+			const glm::vec3& scale
+		) noexcept;
+
+		glm::mat4 to_mat4() const noexcept;
+
+		// Compose transforms, `(a * b)` applies `b` first
+		Affine_matrix operator*(const Affine_matrix& other) const noexcept;
+	};
+
+	static_assert(sizeof(Affine_matrix) == 48);
+
+	///
+	/// @brief Rigid transform as a unit dual quaternion
+	/// @details 32 bytes instead of 48 for `Affine_matrix`. Only rotation and translation are represented,
+	/// converting an affine matrix drops its scale and shear. For rigid transforms, a point `p` skinned with
+	/// the dual quaternion matches the matrix within `1e-6 * (|p| + |t|)`, `t` being the translation.
+	///
+	struct alignas(16) Dual_quaternion
+	{
+		glm::vec4 real;  // Rotation, (x, y, z, w)
+		glm::vec4 dual;  // Half the translation times the rotation, `0.5 * (t, 0) * real`
+
+		///
+		/// @brief Convert from an affine matrix, scale and shear are dropped
+		///
+		/// @param matrix Affine matrix
+		/// @return Unit dual quaternion
+		///
+		static Dual_quaternion from(const Affine_matrix& matrix) noexcept;
+	};
+
+	static_assert(sizeof(Dual_quaternion) == 32);
+
+	///
+	/// @brief Compose gathered 4x4 affine matrices with affine matrices in batch
+	/// @details `output[i] = a[a_indices[i]] * b[i]`. `a` is read in its column-major layout directly, its
+	/// bottom row is ignored.
+	///
+	/// @param a Left matrices, e.g. node world matrices
+	/// @param a_indices Index into `a` of each product
+	/// @param b Right matrices, same count as `a_indices`
+	/// @param output Output matrices, same count as `a_indices`
+	///
+	void compose_gathered(
+		std::span<const glm::mat4> a,
+		std::span<const uint32_t> a_indices,
+		std::span<const Affine_matrix> b,
+		std::span<Affine_matrix> output
+	) noexcept;
+
+	///
+	/// @brief TRS transforms in structure-of-arrays form, one array per scalar component
+	/// @details Laid out for `compose_trs()`, which processes 8 transforms per iteration
+	///
+	struct Trs_arrays
+	{
+		std::pmr::vector<float> translation[3];
+		std::pmr::vector<float> rotation[4];  // x, y, z, w
+		std::pmr::vector<float> scale[3];
+
+		explicit Trs_arrays(std::pmr::memory_resource* resource = std::pmr::get_default_resource()) noexcept;
+
+		size_t size() const noexcept { return translation[0].size(); }
+
+		void reserve(size_t count) noexcept;
+
+		void clear() noexcept;
+
+		void push_back(
+			const glm::vec3& translation,
+			const glm::quat& rotation,
+			const glm::vec3& scale
+		) noexcept;
+
+		glm::vec3 get_translation(size_t index) const noexcept;
+
+		glm::quat get_rotation(size_t index) const noexcept;
+
+		glm::vec3 get_scale(size_t index) const noexcept;
+	};
+
+	///
+	/// @brief Compose T*R*S affine matrices in batch
+	///
+	/// @param trs Transforms, rotations normalized
+	/// @param output Output matrices, at least `trs.size()` elements
+	///
+	void compose_trs(const Trs_arrays& trs, std::span<Affine_matrix> output) noexcept;
+}
\ No newline at end of file
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "graphics/affine.hpp"
+
 #include <glm/fwd.hpp>
 #include <glm/glm.hpp>
 #include <span>
@@ -31,6 +33,23 @@ namespace graphics
 		const glm::mat4& world_matrix
 	) noexcept;
 
+	///
+	/// @brief Conservatively transform local AABBs, each by its own matrix, and merge them into one AABB
+	/// @details Boxes are transformed as center and extent with SSE, one box per iteration
+	///
+	/// @param local_min Local space AABB minimums
+	/// @param local_max Local space AABB maximums, same count as `local_min`
+	/// @param matrix_indices Index into `matrices` of each box, same count as `local_min`
+	/// @param matrices Transform matrices
+	/// @return Merged AABB (min, max), with `min > max` if there are no boxes
+	///
+	std::pair<glm::vec3, glm::vec3> merge_transformed_bounds(
+		std::span<const glm::vec3> local_min,
+		std::span<const glm::vec3> local_max,
+		std::span<const uint32_t> matrix_indices,
+		std::span<const Affine_matrix> matrices
+	) noexcept;
+
 	///
 	/// @brief Tell if the world-space AABB is inside the frustum defined by the planes
 	///
@@ -0,0 +1,130 @@
+#pragma once
+
+#include "util/fork-join.hpp"
+
+#include <array>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <memory>
+#include <span>
+#include <vector>
+
+namespace graphics
+{
+	///
+	/// @brief Masked software occlusion culler
+	/// @details Occluder triangles are rasterized on the CPU into a low-resolution reversed-Z depth buffer
+	/// (larger value is closer). The buffer is split into screen tiles that are rasterized in parallel with
+	/// 8-wide SIMD, after which every 8x8 block stores its farthest depth. Box queries first test against the
+	/// block hierarchy, and only fall back to per-pixel tests on blocks that don't fully occlude the box.
+	///
+	/// Usage per frame: `begin_frame()` -> `add_occluder()` * N -> `rasterize()` -> `is_occluded()` * M
+	///
+	class Occlusion_culler
+	{
+	  public:
+
+		static constexpr uint32_t width = 320;
+		static constexpr uint32_t height = 192;
+		static constexpr uint32_t tile_size = 32;
+		static constexpr uint32_t block_size = 8;
+
+		static constexpr uint32_t tile_count_x = width / tile_size;
+		static constexpr uint32_t tile_count_y = height / tile_size;
+		static constexpr uint32_t block_count_x = width / block_size;
+		static constexpr uint32_t block_count_y = height / block_size;
+
+		static_assert(width % tile_size == 0 && height % tile_size == 0);
+		static_assert(tile_size % block_size == 0 && block_size == 8);
+
+		struct Statistics
+		{
+			uint32_t occluder_triangles = 0;  // Triangles rasterized after near-plane clipping
+			uint32_t tested_boxes = 0;        // Boxes queried
+			uint32_t occluded_boxes = 0;      // Boxes found occluded
+		};
+
+		///
+		/// @brief Create an occlusion culler
+		///
+		/// @param thread_count Thread count for tile rasterization, including the calling thread
+		///
+		explicit Occlusion_culler(uint32_t thread_count = 4) noexcept;
+
+		///
+		/// @brief Start a new frame, clearing all occluders and statistics
+		///
+		/// @param camera_matrix Camera VP matrix (reversed-Z)
+		///
+		void begin_frame(const glm::mat4& camera_matrix) noexcept;
+
+		///
+		/// @brief Add an occluder mesh, clipped against the near plane and binned to tiles
+		///
+		/// @param positions Local-space vertex positions
+		/// @param indices Triangle list indices
+		/// @param world_matrix Local to world transform
+		///
+		void add_occluder(
+			std::span<const glm::vec3> positions,
+			std::span<const uint32_t> indices,
+			const glm::mat4& world_matrix
+		) noexcept;
+
+		///
+		/// @brief Rasterize all added occluders, multithreaded across screen tiles
+		///
+		void rasterize() noexcept;
+
+		///
+		/// @brief Test if a world-space AABB is fully hidden behind rasterized occluders
+		/// @note Conservative: boxes crossing the near plane or off screen are never occluded
+		///
+		/// @param box_min World-space AABB minimum
+		/// @param box_max World-space AABB maximum
+		/// @return True if the box is occluded
+		///
+		bool is_occluded(const glm::vec3& box_min, const glm::vec3& box_max) noexcept;
+
+		///
+		/// @brief Get statistics of the current frame
+		///
+		/// @return Statistics
+		///
+		const Statistics& get_statistics() const noexcept { return statistics; }
+
+	  private:
+
+		// Triangle in pixel space, edge functions are `E(x, y) = a * x + b * y + c >= 0` inside
+		struct Triangle
+		{
+			std::array<glm::vec3, 3> edges;
+			glm::vec3 depth_plane;  // Conservative depth, `z = a * x + b * y + c`
+			glm::ivec2 pixel_min;
+			glm::ivec2 pixel_max;  // Exclusive
+		};
+
+		glm::mat4 camera_matrix = glm::mat4(1.0f);
+
+		std::vector<Triangle> triangles;
+		std::array<std::vector<uint32_t>, tile_count_x * tile_count_y> tile_bins;
+
+		std::vector<float> depth_buffer;     // Per-pixel closest occluder depth
+		std::vector<float> block_min_depth;  // Per-block farthest occluder depth
+
+		Statistics statistics;
+
+		std::unique_ptr<util::Fork_join_pool> parallel_pool;
+
+		void add_triangle(const glm::vec4& v0, const glm::vec4& v1, const glm::vec4& v2) noexcept;
+		void rasterize_tile(uint32_t tile_index) noexcept;
+
+	  public:
+
+		Occlusion_culler(const Occlusion_culler&) = delete;
+		Occlusion_culler(Occlusion_culler&&) = default;
+		Occlusion_culler& operator=(const Occlusion_culler&) = delete;
+		Occlusion_culler& operator=(Occlusion_culler&&) = default;
+		~Occlusion_culler() = default;
+	};
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <memory_resource>
+#include <optional>
+#include <vector>
+
+namespace graphics
+{
+	///
+	/// @brief Room-portal graph for conservative indoor visibility
+	/// @details Rooms and portals are world-space AABBs. Starting from the room containing the eye, a flood
+	/// fill walks through open portals while narrowing the visible screen rectangle at every portal it
+	/// crosses. Rooms never reached by the flood fill are invisible.
+	///
+	class Portal_graph
+	{
+	  public:
+
+		struct Room
+		{
+			glm::vec3 min;
+			glm::vec3 max;
+		};
+
+		struct Portal
+		{
+			glm::vec3 min;
+			glm::vec3 max;
+			uint32_t room_a;
+			std::optional<uint32_t> room_b;  // `nullopt` => Connects to the outside
+		};
+
+		///
+		/// @brief Create a portal graph
+		/// @note Portals referencing out-of-range rooms are ignored
+		///
+		/// @param rooms Room list
+		/// @param portals Portal list
+		///
+		Portal_graph(std::vector<Room> rooms = {}, std::vector<Portal> portals = {}) noexcept;
+
+		///
+		/// @brief Find the room containing a point
+		///
+		/// @param point World-space point
+		/// @return Room index, or `nullopt` if the point is outside of all rooms
+		///
+		std::optional<uint32_t> find_room(const glm::vec3& point) const noexcept;
+
+		///
+		/// @brief Flood fill visible rooms from the eye position
+		///
+		/// @param camera_matrix Camera VP matrix
+		/// @param eye_position World-space eye position
+		/// @param portal_open Open state of each portal, must have the same size as the portal list
+		/// @param resource Memory resource for the result and temporaries, e.g. a frame arena
+		/// @return Visibility of each room, with one extra trailing entry for the outside
+		///
+		std::pmr::vector<bool> compute_visible_rooms(
+			const glm::mat4& camera_matrix,
+			const glm::vec3& eye_position,
+			const std::pmr::vector<bool>& portal_open,
+			std::pmr::memory_resource* resource = std::pmr::get_default_resource()
+		) const noexcept;
+
+		size_t room_count() const noexcept { return rooms.size(); }
+		size_t portal_count() const noexcept { return portals.size(); }
+
+	  private:
+
+		std::vector<Room> rooms;
+		std::vector<Portal> portals;
+		std::vector<std::vector<uint32_t>> adjacent_portals;  // Portal indices per room, outside at back
+	};
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <array>
+#include <cstdint>
 #include <glm/glm.hpp>
 
 namespace graphics
@@ -15,4 +16,21 @@ namespace graphics
 		const std::array<glm::vec3, 8>& frustum_corners,
 		const glm::vec3& view_dir
 	) noexcept;
+
+	///
+	/// @brief Find a stable square bound of the frustum, for shadow maps that don't shimmer
+	/// @details The bound encloses the bounding sphere of the corners, so its size doesn't change when the
+	/// frustum rotates. Its center is snapped to whole texels of the target resolution, so moving the frustum
+	/// shifts the bound in texel steps only.
+	///
+	/// @param frustum_corners Frustum corners in world space
+	/// @param view_dir View direction of the bound
+	/// @param resolution Resolution of the target texture
+	/// @return Stable bound
+	///
+	Smallest_bound find_stable_bound(
+		const std::array<glm::vec3, 8>& frustum_corners,
+		const glm::vec3& view_dir,
+		uint32_t resolution
+	) noexcept;
 }
\ No newline at end of file
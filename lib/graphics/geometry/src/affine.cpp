@@ -0,0 +1,265 @@
+#include "graphics/affine.hpp"
+
+#include <algorithm>
+#include <array>
+#include <immintrin.h>
+#include <ranges>
+
+namespace graphics
+{
+	Affine_matrix Affine_matrix::identity() noexcept
+	{
+		return {
+			.rows = {
+				glm::vec4(1.0f, 0.0f, 0.0f, 0.0f),
+				glm::vec4(0.0f, 1.0f, 0.0f, 0.0f),
+				glm::vec4(0.0f, 0.0f, 1.0f, 0.0f)
+			}
+		};
+	}
+
+	Affine_matrix Affine_matrix::from(const glm::mat4& matrix) noexcept
+	{
+		const auto transposed = glm::transpose(matrix);
+		return {.rows = {transposed[0], transposed[1], transposed[2]}};
+	}
+
+	Dual_quaternion Dual_quaternion::from(const Affine_matrix& matrix) noexcept
+	{
+		// Normalize the basis vectors (columns of the upper 3x3) to remove scale
+		glm::mat3 rotation_matrix;
+		for (const auto column : std::views::iota(0, 3))
+			rotation_matrix[column] = glm::normalize(
+				glm::vec3(matrix.rows[0][column], matrix.rows[1][column], matrix.rows[2][column])
+			);
+
+		const auto rotation = glm::normalize(glm::quat_cast(rotation_matrix));
+		const auto translation = glm::vec3(matrix.rows[0].w, matrix.rows[1].w, matrix.rows[2].w);
+		const auto translation_quat = glm::quat::wxyz(0.0f, translation.x, translation.y, translation.z);
+		const auto dual = translation_quat * rotation * 0.5f;
+
+		return {
+			.real = glm::vec4(rotation.x, rotation.y, rotation.z, rotation.w),
+			.dual = glm::vec4(dual.x, dual.y, dual.z, dual.w)
+		};
+	}
+
+	Affine_matrix Affine_matrix::from_trs(
+		const glm::vec3& translation,
+		const glm::quat& rotation,
+		const glm::vec3& scale
+	) noexcept
+	{
+		const auto rotation_matrix = glm::mat3_cast(rotation);
+
+		// Column j of R*S is column j of R scaled by scale[j]
+		Affine_matrix result;
+		for (const auto row : std::views::iota(0, 3))
+			result.rows[row] = glm::vec4(
+				rotation_matrix[0][row] * scale.x,
+				rotation_matrix[1][row] * scale.y,
+				rotation_matrix[2][row] * scale.z,
+				translation[row]
+			);
+
+		return result;
+	}
+
+	glm::mat4 Affine_matrix::to_mat4() const noexcept
+	{
+		return glm::transpose(glm::mat4(rows[0], rows[1], rows[2], glm::vec4(0.0f, 0.0f, 0.0f, 1.0f)));
+	}
+
+	Affine_matrix Affine_matrix::operator*(const Affine_matrix& other) const noexcept
+	{
+		const __m128 b0 = _mm_loadu_ps(&other.rows[0].x);
+		const __m128 b1 = _mm_loadu_ps(&other.rows[1].x);
+		const __m128 b2 = _mm_loadu_ps(&other.rows[2].x);
+		const __m128 w_mask = _mm_castsi128_ps(_mm_setr_epi32(0, 0, 0, -1));
+
+		// Row i = a[i][0] * b0 + a[i][1] * b1 + a[i][2] * b2 + (0, 0, 0, a[i][3])
+		Affine_matrix result;
+		for (const auto row : std::views::iota(0, 3))
+		{
+			const __m128 a = _mm_loadu_ps(&rows[row].x);
+
+			__m128 sum = _mm_and_ps(a, w_mask);
+			sum = _mm_add_ps(sum, _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(0, 0, 0, 0)), b0));
+			sum = _mm_add_ps(sum, _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(1, 1, 1, 1)), b1));
+			sum = _mm_add_ps(sum, _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 2, 2, 2)), b2));
+
+			_mm_storeu_ps(&result.rows[row].x, sum);
+		}
+
+		return result;
+	}
+
+	void compose_gathered(
+		std::span<const glm::mat4> a,
+		std::span<const uint32_t> a_indices,
+		std::span<const Affine_matrix> b,
+		std::span<Affine_matrix> output
+	) noexcept
+	{
+		const __m128 w_mask = _mm_castsi128_ps(_mm_setr_epi32(0, 0, 0, -1));
+
+		for (const auto [a_index, right, result] : std::views::zip(a_indices, b, output))
+		{
+			const auto& left = a[a_index];
+			const __m128 b0 = _mm_loadu_ps(&right.rows[0].x);
+			const __m128 b1 = _mm_loadu_ps(&right.rows[1].x);
+			const __m128 b2 = _mm_loadu_ps(&right.rows[2].x);
+
+			// Row i = a[0][i] * b0 + a[1][i] * b1 + a[2][i] * b2 + (0, 0, 0, a[3][i]), `a` is column-major
+			for (const auto row : std::views::iota(0, 3))
+			{
+				__m128 sum = _mm_and_ps(_mm_set1_ps(left[3][row]), w_mask);
+				sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(left[0][row]), b0));
+				sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(left[1][row]), b1));
+				sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(left[2][row]), b2));
+
+				_mm_storeu_ps(&result.rows[row].x, sum);
+			}
+		}
+	}
+
+	Trs_arrays::Trs_arrays(std::pmr::memory_resource* resource) noexcept :
+		translation{
+			std::pmr::vector<float>(resource),
+			std::pmr::vector<float>(resource),
+			std::pmr::vector<float>(resource)
+		},
+		rotation{
+			std::pmr::vector<float>(resource),
+			std::pmr::vector<float>(resource),
+			std::pmr::vector<float>(resource),
+			std::pmr::vector<float>(resource)
+		},
+		scale{
+			std::pmr::vector<float>(resource),
+			std::pmr::vector<float>(resource),
+			std::pmr::vector<float>(resource)
+		}
+	{}
+
+	void Trs_arrays::reserve(size_t count) noexcept
+	{
+		for (auto& array : translation) array.reserve(count);
+		for (auto& array : rotation) array.reserve(count);
+		for (auto& array : scale) array.reserve(count);
+	}
+
+	void Trs_arrays::clear() noexcept
+	{
+		for (auto& array : translation) array.clear();
+		for (auto& array : rotation) array.clear();
+		for (auto& array : scale) array.clear();
+	}
+
+	void Trs_arrays::push_back(
+		const glm::vec3& translation,
+		const glm::quat& rotation,
+		const glm::vec3& scale
+	) noexcept
+	{
+		for (const auto axis : std::views::iota(0, 3))
+		{
+			this->translation[axis].push_back(translation[axis]);
+			this->scale[axis].push_back(scale[axis]);
+		}
+
+		this->rotation[0].push_back(rotation.x);
+		this->rotation[1].push_back(rotation.y);
+		this->rotation[2].push_back(rotation.z);
+		this->rotation[3].push_back(rotation.w);
+	}
+
+	glm::vec3 Trs_arrays::get_translation(size_t index) const noexcept
+	{
+		return {translation[0][index], translation[1][index], translation[2][index]};
+	}
+
+	glm::quat Trs_arrays::get_rotation(size_t index) const noexcept
+	{
+		return glm::quat::wxyz(
+			rotation[3][index],
+			rotation[0][index],
+			rotation[1][index],
+			rotation[2][index]
+		);
+	}
+
+	glm::vec3 Trs_arrays::get_scale(size_t index) const noexcept
+	{
+		return {scale[0][index], scale[1][index], scale[2][index]};
+	}
+
+	void compose_trs(const Trs_arrays& trs, std::span<Affine_matrix> output) noexcept
+	{
+		static constexpr size_t lanes = 8;
+
+		const size_t count = trs.size();
+		const size_t batched_count = count - count % lanes;
+
+		const __m256 one = _mm256_set1_ps(1.0f);
+		const __m256 two = _mm256_set1_ps(2.0f);
+
+		for (size_t begin = 0; begin < batched_count; begin += lanes)
+		{
+			const auto load = [begin](const std::pmr::vector<float>& array) {
+				return _mm256_loadu_ps(array.data() + begin);
+			};
+
+			const __m256 qx = load(trs.rotation[0]), qy = load(trs.rotation[1]);
+			const __m256 qz = load(trs.rotation[2]), qw = load(trs.rotation[3]);
+			const __m256 sx = load(trs.scale[0]), sy = load(trs.scale[1]), sz = load(trs.scale[2]);
+
+			const __m256 xx = _mm256_mul_ps(qx, qx), yy = _mm256_mul_ps(qy, qy), zz = _mm256_mul_ps(qz, qz);
+			const __m256 xy = _mm256_mul_ps(qx, qy), xz = _mm256_mul_ps(qx, qz), yz = _mm256_mul_ps(qy, qz);
+			const __m256 wx = _mm256_mul_ps(qw, qx), wy = _mm256_mul_ps(qw, qy), wz = _mm256_mul_ps(qw, qz);
+
+			const auto diagonal = [&](__m256 a, __m256 b) {
+				return _mm256_sub_ps(one, _mm256_mul_ps(two, _mm256_add_ps(a, b)));
+			};
+			const auto plus = [&](__m256 a, __m256 b) { return _mm256_mul_ps(two, _mm256_add_ps(a, b)); };
+			const auto minus = [&](__m256 a, __m256 b) { return _mm256_mul_ps(two, _mm256_sub_ps(a, b)); };
+
+			// Rows of R*S, then translation
+			const std::array<__m256, 12> elements = {
+				_mm256_mul_ps(diagonal(yy, zz), sx),
+				_mm256_mul_ps(minus(xy, wz), sy),
+				_mm256_mul_ps(plus(xz, wy), sz),
+				load(trs.translation[0]),
+				_mm256_mul_ps(plus(xy, wz), sx),
+				_mm256_mul_ps(diagonal(xx, zz), sy),
+				_mm256_mul_ps(minus(yz, wx), sz),
+				load(trs.translation[1]),
+				_mm256_mul_ps(minus(xz, wy), sx),
+				_mm256_mul_ps(plus(yz, wx), sy),
+				_mm256_mul_ps(diagonal(xx, yy), sz),
+				load(trs.translation[2])
+			};
+
+			// Transpose lanes back into matrices
+			alignas(32) std::array<std::array<float, lanes>, 12> lanes_data;
+			for (const auto [element, data] : std::views::zip(elements, lanes_data))
+				_mm256_store_ps(data.data(), element);
+
+			for (const auto lane : std::views::iota(0zu, lanes))
+			{
+				auto& matrix = output[begin + lane];
+				for (const auto row : std::views::iota(0zu, 3zu))
+					matrix.rows[row] = glm::vec4(
+						lanes_data[row * 4 + 0][lane],
+						lanes_data[row * 4 + 1][lane],
+						lanes_data[row * 4 + 2][lane],
+						lanes_data[row * 4 + 3][lane]
+					);
+			}
+		}
+
+		for (const auto idx : std::views::iota(batched_count, count))
+			output[idx] =
+				Affine_matrix::from_trs(trs.get_translation(idx), trs.get_rotation(idx), trs.get_scale(idx));
+	}
+}
\ No newline at end of file
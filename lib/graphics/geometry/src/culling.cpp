@@ -2,7 +2,11 @@
 #include "graphics/corner.hpp"
 
 #include <algorithm>
+#include <array>
 #include <glm/common.hpp>
+#include <immintrin.h>
+#include <limits>
+#include <ranges>
 
 namespace graphics
 {
@@ -88,6 +92,59 @@ namespace graphics
 		return {world_min, world_max};
 	}
 
+	std::pair<glm::vec3, glm::vec3> merge_transformed_bounds(
+		std::span<const glm::vec3> local_min,
+		std::span<const glm::vec3> local_max,
+		std::span<const uint32_t> matrix_indices,
+		std::span<const Affine_matrix> matrices
+	) noexcept
+	{
+		const __m128 abs_mask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+
+		__m128 merged_min = _mm_set1_ps(std::numeric_limits<float>::max());
+		__m128 merged_max = _mm_set1_ps(std::numeric_limits<float>::lowest());
+
+		for (const auto [min, max, matrix_index] : std::views::zip(local_min, local_max, matrix_indices))
+		{
+			const auto& matrix = matrices[matrix_index];
+			const auto center = (min + max) * 0.5f;
+			const auto extent = (max - min) * 0.5f;
+
+			// Transpose the rows into columns, the last column is the translation
+			__m128 col0 = _mm_loadu_ps(&matrix.rows[0].x);
+			__m128 col1 = _mm_loadu_ps(&matrix.rows[1].x);
+			__m128 col2 = _mm_loadu_ps(&matrix.rows[2].x);
+			__m128 col3 = _mm_setzero_ps();
+			_MM_TRANSPOSE4_PS(col0, col1, col2, col3);
+
+			// center' = M * center, extent' = |M| * extent
+			__m128 world_center = col3;
+			world_center = _mm_add_ps(world_center, _mm_mul_ps(col0, _mm_set1_ps(center.x)));
+			world_center = _mm_add_ps(world_center, _mm_mul_ps(col1, _mm_set1_ps(center.y)));
+			world_center = _mm_add_ps(world_center, _mm_mul_ps(col2, _mm_set1_ps(center.z)));
+
+			const __m128 abs_col0 = _mm_and_ps(col0, abs_mask);
+			const __m128 abs_col1 = _mm_and_ps(col1, abs_mask);
+			const __m128 abs_col2 = _mm_and_ps(col2, abs_mask);
+
+			__m128 world_extent = _mm_mul_ps(abs_col0, _mm_set1_ps(extent.x));
+			world_extent = _mm_add_ps(world_extent, _mm_mul_ps(abs_col1, _mm_set1_ps(extent.y)));
+			world_extent = _mm_add_ps(world_extent, _mm_mul_ps(abs_col2, _mm_set1_ps(extent.z)));
+
+			merged_min = _mm_min_ps(merged_min, _mm_sub_ps(world_center, world_extent));
+			merged_max = _mm_max_ps(merged_max, _mm_add_ps(world_center, world_extent));
+		}
+
+		alignas(16) std::array<float, 4> min_lanes, max_lanes;
+		_mm_store_ps(min_lanes.data(), merged_min);
+		_mm_store_ps(max_lanes.data(), merged_max);
+
+		return {
+			glm::vec3(min_lanes[0], min_lanes[1], min_lanes[2]),
+			glm::vec3(max_lanes[0], max_lanes[1], max_lanes[2])
+		};
+	}
+
 	bool box_in_frustum(
 		const glm::vec3& box_min,
 		const glm::vec3& box_max,
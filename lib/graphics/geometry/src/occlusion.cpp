@@ -0,0 +1,327 @@
+#include "graphics/occlusion.hpp"
+#include "graphics/corner.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <immintrin.h>
+#include <ranges>
+
+namespace graphics
+{
+	// Minimum w for projected points, guards against division by near-zero
+	static constexpr float min_clip_w = 1e-5f;
+
+	// Clip space to pixel space, y pointing up
+	static glm::vec3 clip_to_pixel(const glm::vec4& clip) noexcept
+	{
+		const auto ndc = glm::vec3(clip) / clip.w;
+		return {
+			(ndc.x * 0.5f + 0.5f) * float(Occlusion_culler::width),
+			(ndc.y * 0.5f + 0.5f) * float(Occlusion_culler::height),
+			ndc.z
+		};
+	}
+
+	Occlusion_culler::Occlusion_culler(uint32_t thread_count) noexcept :
+		depth_buffer(width * height, 0.0f),
+		block_min_depth(block_count_x * block_count_y, 0.0f),
+		parallel_pool(std::make_unique<util::Fork_join_pool>(std::max(thread_count, 1u) - 1))
+	{}
+
+	void Occlusion_culler::begin_frame(const glm::mat4& camera_matrix) noexcept
+	{
+		this->camera_matrix = camera_matrix;
+
+		triangles.clear();
+		for (auto& bin : tile_bins) bin.clear();
+
+		statistics = {};
+	}
+
+	void Occlusion_culler::add_occluder(
+		std::span<const glm::vec3> positions,
+		std::span<const uint32_t> indices,
+		const glm::mat4& world_matrix
+	) noexcept
+	{
+		const auto mvp = camera_matrix * world_matrix;
+
+		for (const auto triangle : indices | std::views::chunk(3))
+		{
+			if (triangle.size() != 3) break;
+			if (std::ranges::any_of(triangle, [&positions](uint32_t i) { return i >= positions.size(); }))
+				continue;
+
+			const std::array<glm::vec4, 3> clip = {
+				mvp * glm::vec4(positions[triangle[0]], 1.0f),
+				mvp * glm::vec4(positions[triangle[1]], 1.0f),
+				mvp * glm::vec4(positions[triangle[2]], 1.0f)
+			};
+
+			// Signed distance to the near plane (reversed-Z: z <= w inside)
+			const std::array<float, 3> distances = {
+				clip[0].w - clip[0].z,
+				clip[1].w - clip[1].z,
+				clip[2].w - clip[2].z
+			};
+
+			const auto inside_count = std::ranges::count_if(distances, [](float d) { return d >= 0.0f; });
+			if (inside_count == 0) continue;
+			if (inside_count == 3)
+			{
+				add_triangle(clip[0], clip[1], clip[2]);
+				continue;
+			}
+
+			/* Clip against Near Plane */
+
+			std::array<glm::vec4, 4> polygon;
+			size_t polygon_size = 0;
+
+			for (const auto i : std::views::iota(0zu, 3zu))
+			{
+				const auto next = (i + 1) % 3;
+
+				if (distances[i] >= 0.0f) polygon[polygon_size++] = clip[i];
+				if ((distances[i] >= 0.0f) != (distances[next] >= 0.0f))
+				{
+					const float t = distances[i] / (distances[i] - distances[next]);
+					polygon[polygon_size++] = glm::mix(clip[i], clip[next], t);
+				}
+			}
+
+			add_triangle(polygon[0], polygon[1], polygon[2]);
+			if (polygon_size == 4) add_triangle(polygon[0], polygon[2], polygon[3]);
+		}
+	}
+
+	void Occlusion_culler::add_triangle(
+		const glm::vec4& v0,
+		const glm::vec4& v1,
+		const glm::vec4& v2
+	) noexcept
+	{
+		if (v0.w < min_clip_w || v1.w < min_clip_w || v2.w < min_clip_w) return;
+
+		auto p0 = clip_to_pixel(v0);
+		auto p1 = clip_to_pixel(v1);
+		auto p2 = clip_to_pixel(v2);
+
+		/* Bound */
+
+		const auto bound_min = glm::min(glm::min(glm::vec2(p0), glm::vec2(p1)), glm::vec2(p2));
+		const auto bound_max = glm::max(glm::max(glm::vec2(p0), glm::vec2(p1)), glm::vec2(p2));
+
+		const auto pixel_min = glm::clamp(
+			glm::ivec2(glm::floor(bound_min)),
+			glm::ivec2(0),
+			glm::ivec2(int(width), int(height))
+		);
+		const auto pixel_max = glm::clamp(
+			glm::ivec2(glm::ceil(bound_max)),
+			glm::ivec2(0),
+			glm::ivec2(int(width), int(height))
+		);
+		if (pixel_min.x >= pixel_max.x || pixel_min.y >= pixel_max.y) return;
+
+		/* Setup, flip to counter-clockwise */
+
+		float area = (p1.x - p0.x) * (p2.y - p0.y) - (p1.y - p0.y) * (p2.x - p0.x);
+		if (std::abs(area) < 1e-6f) return;
+		if (area < 0.0f)
+		{
+			std::swap(p1, p2);
+			area = -area;
+		}
+
+		const auto edge_function = [](const glm::vec3& a, const glm::vec3& b) {
+			const auto edge = glm::vec2(b - a);
+			return glm::vec3(-edge.y, edge.x, edge.y * a.x - edge.x * a.y);
+		};
+
+		const float depth_dx = ((p1.z - p0.z) * (p2.y - p0.y) - (p2.z - p0.z) * (p1.y - p0.y)) / area;
+		const float depth_dy = ((p2.z - p0.z) * (p1.x - p0.x) - (p1.z - p0.z) * (p2.x - p0.x)) / area;
+
+		// Offset to the farthest depth within the pixel footprint, keeps the occluder conservative
+		const float depth_bias = 0.5f * (std::abs(depth_dx) + std::abs(depth_dy));
+		const float depth_c = p0.z - depth_dx * p0.x - depth_dy * p0.y - depth_bias;
+
+		const auto triangle_index = static_cast<uint32_t>(triangles.size());
+		triangles.push_back({
+			.edges = {edge_function(p0, p1), edge_function(p1, p2), edge_function(p2, p0)},
+			.depth_plane = {depth_dx, depth_dy, depth_c},
+			.pixel_min = pixel_min,
+			.pixel_max = pixel_max,
+		});
+
+		/* Bin to Tiles */
+
+		const auto tile_min = glm::uvec2(pixel_min) / tile_size;
+		const auto tile_max = (glm::uvec2(pixel_max) + tile_size - 1u) / tile_size;
+
+		for (const auto tile_y : std::views::iota(tile_min.y, tile_max.y))
+			for (const auto tile_x : std::views::iota(tile_min.x, tile_max.x))
+				tile_bins[tile_y * tile_count_x + tile_x].push_back(triangle_index);
+
+		statistics.occluder_triangles++;
+	}
+
+	void Occlusion_culler::rasterize() noexcept
+	{
+		// Tiles cover disjoint pixels, a fork-join loop dispatches them without allocating
+		parallel_pool->parallel_for(tile_count_x * tile_count_y, 1, [this](size_t tile_index) {
+			rasterize_tile(static_cast<uint32_t>(tile_index));
+		});
+	}
+
+	void Occlusion_culler::rasterize_tile(uint32_t tile_index) noexcept
+	{
+		const int tile_x = int(tile_index % tile_count_x) * int(tile_size);
+		const int tile_y = int(tile_index / tile_count_x) * int(tile_size);
+
+		for (const auto y : std::views::iota(tile_y, tile_y + int(tile_size)))
+			std::fill_n(depth_buffer.begin() + y * width + tile_x, tile_size, 0.0f);
+
+		/* Rasterize */
+
+		const __m256 lane_offset = _mm256_setr_ps(0.5f, 1.5f, 2.5f, 3.5f, 4.5f, 5.5f, 6.5f, 7.5f);
+		const __m256 zero = _mm256_setzero_ps();
+
+		for (const auto triangle_index : tile_bins[tile_index])
+		{
+			const auto& triangle = triangles[triangle_index];
+
+			// Tile boundaries are multiples of 8, so aligned spans never leave the tile
+			const int x_begin = std::max(triangle.pixel_min.x, tile_x) & ~7;
+			const int x_end = std::min(triangle.pixel_max.x, tile_x + int(tile_size));
+			const int y_begin = std::max(triangle.pixel_min.y, tile_y);
+			const int y_end = std::min(triangle.pixel_max.y, tile_y + int(tile_size));
+
+			const __m256 edge0_a = _mm256_set1_ps(triangle.edges[0].x);
+			const __m256 edge1_a = _mm256_set1_ps(triangle.edges[1].x);
+			const __m256 edge2_a = _mm256_set1_ps(triangle.edges[2].x);
+			const __m256 depth_a = _mm256_set1_ps(triangle.depth_plane.x);
+
+			for (int y = y_begin; y < y_end; y++)
+			{
+				const float pixel_y = float(y) + 0.5f;
+
+				const auto row_value = [pixel_y](const glm::vec3& plane) {
+					return _mm256_set1_ps(plane.y * pixel_y + plane.z);
+				};
+
+				const __m256 edge0_row = row_value(triangle.edges[0]);
+				const __m256 edge1_row = row_value(triangle.edges[1]);
+				const __m256 edge2_row = row_value(triangle.edges[2]);
+				const __m256 depth_row = row_value(triangle.depth_plane);
+
+				float* const row = depth_buffer.data() + y * width;
+
+				for (int x = x_begin; x < x_end; x += 8)
+				{
+					const __m256 pixel_x = _mm256_add_ps(_mm256_set1_ps(float(x)), lane_offset);
+
+					const __m256 edge0 = _mm256_add_ps(_mm256_mul_ps(edge0_a, pixel_x), edge0_row);
+					const __m256 edge1 = _mm256_add_ps(_mm256_mul_ps(edge1_a, pixel_x), edge1_row);
+					const __m256 edge2 = _mm256_add_ps(_mm256_mul_ps(edge2_a, pixel_x), edge2_row);
+
+					const __m256 inside0 = _mm256_cmp_ps(edge0, zero, _CMP_GE_OQ);
+					const __m256 inside1 = _mm256_cmp_ps(edge1, zero, _CMP_GE_OQ);
+					const __m256 inside2 = _mm256_cmp_ps(edge2, zero, _CMP_GE_OQ);
+					const __m256 coverage = _mm256_and_ps(_mm256_and_ps(inside0, inside1), inside2);
+					if (_mm256_movemask_ps(coverage) == 0) continue;
+
+					const __m256 depth = _mm256_add_ps(_mm256_mul_ps(depth_a, pixel_x), depth_row);
+					const __m256 previous = _mm256_loadu_ps(row + x);
+					const __m256 closest = _mm256_max_ps(previous, depth);
+					_mm256_storeu_ps(row + x, _mm256_blendv_ps(previous, closest, coverage));
+				}
+			}
+		}
+
+		/* Build Block Hierarchy */
+
+		for (int block_y = tile_y; block_y < tile_y + int(tile_size); block_y += int(block_size))
+			for (int block_x = tile_x; block_x < tile_x + int(tile_size); block_x += int(block_size))
+			{
+				const float* const block_data = depth_buffer.data() + block_y * width + block_x;
+
+				__m256 block_min = _mm256_loadu_ps(block_data);
+				for (const auto y : std::views::iota(1u, block_size))
+					block_min = _mm256_min_ps(block_min, _mm256_loadu_ps(block_data + y * width));
+
+				alignas(32) std::array<float, 8> lanes;
+				_mm256_store_ps(lanes.data(), block_min);
+
+				block_min_depth[(block_y / block_size) * block_count_x + block_x / block_size] =
+					std::ranges::min(lanes);
+			}
+	}
+
+	bool Occlusion_culler::is_occluded(const glm::vec3& box_min, const glm::vec3& box_max) noexcept
+	{
+		statistics.tested_boxes++;
+
+		if (triangles.empty()) return false;
+
+		/* Project Box */
+
+		auto pixel_bound_min = glm::vec2(std::numeric_limits<float>::max());
+		auto pixel_bound_max = glm::vec2(std::numeric_limits<float>::lowest());
+		float nearest_depth = std::numeric_limits<float>::lowest();
+
+		for (const auto& corner : get_corner_points(box_min, box_max))
+		{
+			const auto clip = camera_matrix * glm::vec4(corner, 1.0f);
+			if (clip.w < min_clip_w || clip.z > clip.w) return false;  // Crosses the near plane
+
+			const auto pixel = clip_to_pixel(clip);
+			pixel_bound_min = glm::min(pixel_bound_min, glm::vec2(pixel));
+			pixel_bound_max = glm::max(pixel_bound_max, glm::vec2(pixel));
+			nearest_depth = std::max(nearest_depth, pixel.z);
+		}
+
+		const auto pixel_min =
+			glm::clamp(glm::ivec2(glm::floor(pixel_bound_min)), glm::ivec2(0), glm::ivec2(width, height));
+		const auto pixel_max =
+			glm::clamp(glm::ivec2(glm::ceil(pixel_bound_max)), glm::ivec2(0), glm::ivec2(width, height));
+		if (pixel_min.x >= pixel_max.x || pixel_min.y >= pixel_max.y) return false;
+
+		/* Hierarchical Test */
+
+		const __m256 lane_index = _mm256_setr_ps(0, 1, 2, 3, 4, 5, 6, 7);
+		const __m256 box_depth = _mm256_set1_ps(nearest_depth);
+
+		const auto block_min = pixel_min / int(block_size);
+		const auto block_max = (pixel_max + int(block_size) - 1) / int(block_size);
+
+		for (const auto block_y : std::views::iota(block_min.y, block_max.y))
+			for (const auto block_x : std::views::iota(block_min.x, block_max.x))
+			{
+				// Whole block is closer than the box
+				if (block_min_depth[block_y * block_count_x + block_x] > nearest_depth) continue;
+
+				const int x_base = block_x * int(block_size);
+				const int y_begin = std::max(block_y * int(block_size), pixel_min.y);
+				const int y_end = std::min((block_y + 1) * int(block_size), pixel_max.y);
+
+				// Lanes inside [pixel_min.x, pixel_max.x)
+				const __m256 lane_x = _mm256_add_ps(_mm256_set1_ps(float(x_base)), lane_index);
+				const __m256 lane_mask = _mm256_and_ps(
+					_mm256_cmp_ps(lane_x, _mm256_set1_ps(float(pixel_min.x)), _CMP_GE_OQ),
+					_mm256_cmp_ps(lane_x, _mm256_set1_ps(float(pixel_max.x)), _CMP_LT_OQ)
+				);
+
+				for (int y = y_begin; y < y_end; y++)
+				{
+					const __m256 depth = _mm256_loadu_ps(depth_buffer.data() + y * width + x_base);
+					const __m256 visible =
+						_mm256_and_ps(_mm256_cmp_ps(depth, box_depth, _CMP_LE_OQ), lane_mask);
+					if (_mm256_movemask_ps(visible) != 0) return false;
+				}
+			}
+
+		statistics.occluded_boxes++;
+		return true;
+	}
+}
@@ -0,0 +1,154 @@
+#include "graphics/portal.hpp"
+#include "graphics/corner.hpp"
+
+#include <algorithm>
+#include <deque>
+#include <glm/common.hpp>
+#include <queue>
+#include <ranges>
+
+namespace graphics
+{
+	namespace
+	{
+		// Screen-space rectangle in NDC
+		struct Screen_rect
+		{
+			glm::vec2 min;
+			glm::vec2 max;
+
+			bool empty() const noexcept { return glm::any(glm::greaterThanEqual(min, max)); }
+
+			bool contains(const Screen_rect& other) const noexcept
+			{
+				return glm::all(glm::lessThanEqual(min, other.min))
+					&& glm::all(glm::greaterThanEqual(max, other.max));
+			}
+
+			Screen_rect intersect(const Screen_rect& other) const noexcept
+			{
+				return {.min = glm::max(min, other.min), .max = glm::min(max, other.max)};
+			}
+
+			Screen_rect merge(const Screen_rect& other) const noexcept
+			{
+				return {.min = glm::min(min, other.min), .max = glm::max(max, other.max)};
+			}
+		};
+
+		constexpr Screen_rect full_screen_rect = {.min = glm::vec2(-1.0f), .max = glm::vec2(1.0f)};
+
+		// Project a world-space box to a screen rectangle, clipped by `clip_rect`
+		Screen_rect project_box(
+			const glm::vec3& box_min,
+			const glm::vec3& box_max,
+			const glm::mat4& camera_matrix,
+			const Screen_rect& clip_rect
+		) noexcept
+		{
+			constexpr float min_w = 1e-4f;
+
+			auto rect_min = glm::vec2(std::numeric_limits<float>::max());
+			auto rect_max = glm::vec2(std::numeric_limits<float>::lowest());
+
+			for (const auto& corner : get_corner_points(box_min, box_max))
+			{
+				const auto clip = camera_matrix * glm::vec4(corner, 1.0f);
+
+				// Box crosses the eye plane, can't narrow the rectangle conservatively
+				if (clip.w <= min_w) return clip_rect;
+
+				const auto ndc = glm::vec2(clip) / clip.w;
+				rect_min = glm::min(rect_min, ndc);
+				rect_max = glm::max(rect_max, ndc);
+			}
+
+			return clip_rect.intersect({.min = rect_min, .max = rect_max});
+		}
+
+		bool point_in_box(const glm::vec3& point, const glm::vec3& box_min, const glm::vec3& box_max) noexcept
+		{
+			return glm::all(glm::greaterThanEqual(point, box_min))
+				&& glm::all(glm::lessThanEqual(point, box_max));
+		}
+	}
+
+	Portal_graph::Portal_graph(std::vector<Room> rooms, std::vector<Portal> portals) noexcept :
+		rooms(std::move(rooms)),
+		portals(std::move(portals)),
+		adjacent_portals(this->rooms.size() + 1)
+	{
+		const auto outside_index = static_cast<uint32_t>(this->rooms.size());
+
+		for (const auto [portal_index, portal] : this->portals | std::views::enumerate)
+		{
+			if (portal.room_a >= outside_index) continue;
+			if (portal.room_b.has_value() && *portal.room_b >= outside_index) continue;
+
+			adjacent_portals[portal.room_a].push_back(portal_index);
+			adjacent_portals[portal.room_b.value_or(outside_index)].push_back(portal_index);
+		}
+	}
+
+	std::optional<uint32_t> Portal_graph::find_room(const glm::vec3& point) const noexcept
+	{
+		for (const auto [room_index, room] : rooms | std::views::enumerate)
+			if (point_in_box(point, room.min, room.max)) return room_index;
+
+		return std::nullopt;
+	}
+
+	std::pmr::vector<bool> Portal_graph::compute_visible_rooms(
+		const glm::mat4& camera_matrix,
+		const glm::vec3& eye_position,
+		const std::pmr::vector<bool>& portal_open,
+		std::pmr::memory_resource* resource
+	) const noexcept
+	{
+		const auto outside_index = static_cast<uint32_t>(rooms.size());
+		const auto start_room = find_room(eye_position).value_or(outside_index);
+
+		// Visible screen rectangle of each reached room, grows monotonically during the flood fill
+		std::pmr::vector<std::optional<Screen_rect>> room_rects(rooms.size() + 1, resource);
+		room_rects[start_room] = full_screen_rect;
+
+		using Queue_item = std::pair<uint32_t, Screen_rect>;
+		std::queue<Queue_item, std::pmr::deque<Queue_item>> process_queue{
+			std::pmr::deque<Queue_item>(resource)
+		};
+		process_queue.emplace(start_room, full_screen_rect);
+
+		while (!process_queue.empty())
+		{
+			const auto [room_index, room_rect] = process_queue.front();
+			process_queue.pop();
+
+			for (const auto portal_index : adjacent_portals[room_index])
+			{
+				if (portal_index >= portal_open.size() || !portal_open[portal_index]) continue;
+
+				const auto& portal = portals[portal_index];
+				const auto next_room =
+					portal.room_a == room_index ? portal.room_b.value_or(outside_index) : portal.room_a;
+
+				// Eye inside the portal (standing in the doorway) sees through with the full rectangle
+				const auto portal_rect = point_in_box(eye_position, portal.min, portal.max)
+					? room_rect
+					: project_box(portal.min, portal.max, camera_matrix, room_rect);
+				if (portal_rect.empty()) continue;
+
+				auto& next_rect = room_rects[next_room];
+				if (next_rect.has_value() && next_rect->contains(portal_rect)) continue;
+
+				next_rect = next_rect.has_value() ? next_rect->merge(portal_rect) : portal_rect;
+				process_queue.emplace(next_room, *next_rect);
+			}
+		}
+
+		std::pmr::vector<bool> visible_rooms(resource);
+		visible_rooms.reserve(room_rects.size());
+		for (const auto& rect : room_rects) visible_rooms.push_back(rect.has_value());
+
+		return visible_rooms;
+	}
+}
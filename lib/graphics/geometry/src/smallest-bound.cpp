@@ -1,5 +1,7 @@
 #include "graphics/smallest-bound.hpp"
 #include <algorithm>
+#include <cmath>
+#include <functional>
 #include <glm/ext/matrix_transform.hpp>
 
 #include <glm/fwd.hpp>
@@ -152,4 +154,39 @@ namespace graphics
 			.bottom = max.y
 		};
 	}
+
+	Smallest_bound find_stable_bound(
+		const std::array<glm::vec3, 8>& frustum_corners,
+		const glm::vec3& view_dir,
+		uint32_t resolution
+	) noexcept
+	{
+		// Radius quantization step, filters out floating point noise across frames
+		constexpr float radius_step = 1.0f / 16.0f;
+
+		const auto view_matrix = get_view_matrix(view_dir);
+
+		/* Bounding Sphere */
+
+		const auto center = std::ranges::fold_left(frustum_corners, glm::vec3(0.0f), std::plus()) / 8.0f;
+		const auto max_distance = std::ranges::max(
+			frustum_corners
+			| std::views::transform([&center](const glm::vec3& p) { return glm::distance(p, center); })
+		);
+		const auto radius = std::ceil(max_distance / radius_step) * radius_step;
+
+		/* Texel Snapping */
+
+		const auto texel_size = radius * 2.0f / float(resolution);
+		const auto projected_center = glm::vec2(view_matrix * glm::vec4(center, 1.0f));
+		const auto snapped_center = glm::floor(projected_center / texel_size) * texel_size;
+
+		return Smallest_bound{
+			.view_matrix = view_matrix,
+			.left = snapped_center.x - radius,
+			.right = snapped_center.x + radius,
+			.top = snapped_center.y - radius,
+			.bottom = snapped_center.y + radius
+		};
+	}
 }
\ No newline at end of file
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace graphics
+{
+	///
+	/// @brief Placement of element ranges in blocks of bounded capacity
+	/// @details Ranges are placed first-fit after the used part of each block, a new block is opened when
+	/// none has room. Blocks only grow, so after all ranges are placed the block sizes are the sizes of the
+	/// buffers to create. Counts in elements, holds no GPU resource.
+	///
+	class Block_suballocator
+	{
+	  public:
+
+		struct Allocation
+		{
+			uint32_t block;
+			uint32_t offset;  // In elements
+		};
+
+		explicit Block_suballocator(uint32_t block_capacity) noexcept :
+			block_capacity(block_capacity)
+		{}
+
+		///
+		/// @brief Place a range
+		/// @note Ranges larger than the block capacity get a block of their own
+		///
+		/// @param count Element count, greater than 0
+		/// @param alignment Alignment of the offset in elements, power of two
+		/// @return Placement of the range
+		///
+		Allocation allocate(uint32_t count, uint32_t alignment) noexcept;
+
+		// Get the used size of each block in elements
+		std::span<const uint32_t> get_block_sizes() const noexcept { return block_sizes; }
+
+		uint32_t get_block_capacity() const noexcept { return block_capacity; }
+
+	  private:
+
+		uint32_t block_capacity;
+		std::vector<uint32_t> block_sizes;
+	};
+}
\ No newline at end of file
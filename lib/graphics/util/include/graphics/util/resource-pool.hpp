@@ -0,0 +1,218 @@
+#pragma once
+
+#include "util/error.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <concepts>
+#include <cstdint>
+#include <expected>
+#include <map>
+#include <memory>
+#include <ranges>
+#include <vector>
+
+namespace graphics
+{
+	///
+	/// @brief Pool of sized resources with power-of-two size classes and LRU eviction
+	/// @details
+	/// - Requests are rounded up to a size class, so nearby sizes share resources. Requests above
+	/// `max_size_class` have no power-of-two class, they are created at their exact size and not pooled
+	/// - Resources returned by `cycle()` are pooled with the frame they were last used in. `gc()` evicts
+	/// those unused for more than `max_age` frames, then the least recently used until the pool fits the
+	/// budget
+	/// - Creation is delegated to a callback, the pool itself holds no GPU state
+	///
+	/// @tparam T Resource type
+	/// @tparam Usage Usage key, resources of different usages are never shared
+	///
+	template <typename T, typename Usage>
+		requires std::totally_ordered<Usage>
+	class Resource_pool
+	{
+	  public:
+
+		struct Config
+		{
+			uint32_t min_size_class = 256;       // Smallest size class in bytes, power of two
+			uint32_t max_age = 8;                // Frames a pooled resource may stay unused
+			uint64_t budget = 64 * 1024 * 1024;  // Max bytes of pooled (not in-use) resources
+		};
+
+		struct Statistics
+		{
+			uint32_t hits = 0;       // Acquisitions served from the pool, since the last `cycle()`
+			uint32_t misses = 0;     // Acquisitions that created a resource, since the last `cycle()`
+			uint32_t evictions = 0;  // Resources evicted by the last `gc()`
+			uint64_t pooled_bytes = 0;
+			uint64_t in_use_bytes = 0;
+		};
+
+		// Largest size class, `std::bit_ceil` of anything larger isn't representable in 32 bits
+		static constexpr uint32_t max_size_class = 1u << 31;
+
+		// A default argument can't use `Config`'s member initializers inside the enclosing class
+		Resource_pool() noexcept :
+			Resource_pool(Config())
+		{}
+
+		explicit Resource_pool(Config config) noexcept :
+			config(config)
+		{}
+
+		///
+		/// @brief Get the size class of a request, the size of the resource it gets
+		///
+		/// @param size Requested size in bytes, at most `max_size_class`
+		/// @return Size class in bytes
+		///
+		uint32_t get_size_class(uint32_t size) const noexcept
+		{
+			assert(size <= max_size_class);
+			return std::bit_ceil(std::max(size, config.min_size_class));
+		}
+
+		///
+		/// @brief Return all in-use resources to the pool and start a new frame
+		/// @note Previously acquired resources may be handed out again after this
+		///
+		void cycle() noexcept
+		{
+			frame++;
+
+			for (auto& [key, resource] : in_use)
+			{
+				statistics.pooled_bytes += key.size_class;
+				pooled[key].push_back({.resource = std::move(resource), .last_used_frame = frame - 1});
+			}
+
+			in_use.clear();
+			statistics.hits = statistics.misses = 0;
+			statistics.in_use_bytes = 0;
+		}
+
+		///
+		/// @brief Acquire a resource of at least `size` bytes
+		///
+		/// @param usage Usage of the resource
+		/// @param size Requested size in bytes
+		/// @param create Creates a resource of the given size, returns `std::expected<T, util::Error>`
+		/// @return Resource, or error if creation failed
+		///
+		template <typename F>
+			requires std::is_invocable_r_v<std::expected<T, util::Error>, F, uint32_t>
+		std::expected<std::shared_ptr<T>, util::Error> acquire(
+			Usage usage,
+			uint32_t size,
+			F&& create
+		) noexcept
+		{
+			/* Bypass Pool */
+
+			// Too large for a size class, the resource is released by its last owner instead
+			if (size > max_size_class)
+			{
+				auto result = create(size);
+				if (!result) return result.error().forward("Create unpooled resource failed");
+				statistics.misses++;
+
+				return std::make_shared<T>(std::move(*result));
+			}
+
+			/* Acquire from Pool */
+
+			const Key key{.usage = usage, .size_class = get_size_class(size)};
+
+			// Most recently used first, so that older resources age out
+			if (auto it = pooled.find(key); it != pooled.end() && !it->second.empty())
+			{
+				statistics.hits++;
+				statistics.pooled_bytes -= key.size_class;
+				statistics.in_use_bytes += key.size_class;
+
+				auto resource = std::move(it->second.back().resource);
+				it->second.pop_back();
+
+				return in_use.emplace_back(key, std::move(resource)).second;
+			}
+
+			/* Create */
+
+			auto result = create(key.size_class);
+			if (!result) return result.error().forward("Create pooled resource failed");
+			statistics.misses++;
+			statistics.in_use_bytes += key.size_class;
+
+			return in_use.emplace_back(key, std::make_shared<T>(std::move(*result))).second;
+		}
+
+		///
+		/// @brief Evict pooled resources that are too old or over budget
+		/// @note Called once per frame, after all acquisitions
+		///
+		void gc() noexcept
+		{
+			statistics.evictions = 0;
+
+			/* Evict by Age */
+
+			for (auto& [key, entries] : pooled)
+			{
+				const auto removed = std::ranges::remove_if(entries, [this](const Entry& entry) {
+					return frame - entry.last_used_frame > config.max_age;
+				});
+
+				const auto count = static_cast<uint32_t>(removed.size());
+				statistics.evictions += count;
+				statistics.pooled_bytes -= uint64_t(count) * key.size_class;
+				entries.erase(removed.begin(), removed.end());
+			}
+
+			std::erase_if(pooled, [](const auto& pair) { return pair.second.empty(); });
+
+			/* Evict by Budget */
+
+			while (statistics.pooled_bytes > config.budget)
+			{
+				// Each list is in use order, its front is the least recently used
+				const auto oldest = std::ranges::min_element(pooled, {}, [](const auto& pair) {
+					return pair.second.front().last_used_frame;
+				});
+
+				statistics.evictions++;
+				statistics.pooled_bytes -= oldest->first.size_class;
+				oldest->second.erase(oldest->second.begin());
+				if (oldest->second.empty()) pooled.erase(oldest);
+			}
+		}
+
+		const Statistics& get_statistics() const noexcept { return statistics; }
+
+	  private:
+
+		struct Key
+		{
+			Usage usage;
+			uint32_t size_class;
+
+			auto operator<=>(const Key&) const = default;
+			bool operator==(const Key&) const = default;
+		};
+
+		struct Entry
+		{
+			std::shared_ptr<T> resource;
+			uint64_t last_used_frame;
+		};
+
+		Config config;
+		uint64_t frame = 0;
+
+		std::map<Key, std::vector<Entry>> pooled;  // Each list ordered by last use, oldest first
+		std::vector<std::pair<Key, std::shared_ptr<T>>> in_use;
+
+		Statistics statistics;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <optional>
+
+namespace graphics
+{
+	///
+	/// @brief Bookkeeping of a ring of frame-scoped suballocations
+	/// @details Allocations of a frame are carved from the head of the ring. When a frame ends its range
+	/// stays in use until `release_oldest_frame()`, e.g. after its fence signals, so the head never
+	/// overtakes data the GPU may still read. Holds no GPU resource.
+	///
+	class Ring_allocator
+	{
+	  public:
+
+		explicit Ring_allocator(uint32_t capacity) noexcept :
+			capacity(capacity)
+		{}
+
+		///
+		/// @brief Allocate a range in the current frame
+		/// @note Wraps to the start of the ring if the tail end is too short, skipping the remainder
+		///
+		/// @param size Size in bytes, greater than 0
+		/// @param alignment Alignment of the offset, power of two
+		/// @return Offset of the range, or `nullopt` if no contiguous range is free
+		///
+		std::optional<uint32_t> allocate(uint32_t size, uint32_t alignment) noexcept;
+
+		// End the current frame, its allocations stay in use until released
+		void end_frame() noexcept;
+
+		///
+		/// @brief Release the allocations of the oldest ended frame
+		/// @note No-op if no frame is in flight
+		///
+		void release_oldest_frame() noexcept;
+
+		///
+		/// @brief Get the capacity of a replacement ring, for an allocation that doesn't fit with no frame
+		/// in flight
+		/// @details At least double the capacity, and enough to hold the current frame again plus the failed
+		/// allocation with its worst alignment padding, so the next frame fits in one pass
+		///
+		/// @param size Size of the failed allocation in bytes
+		/// @param alignment Alignment of the failed allocation
+		/// @return Capacity in bytes
+		///
+		uint32_t get_grown_capacity(uint32_t size, uint32_t alignment) const noexcept;
+
+		uint32_t get_capacity() const noexcept { return capacity; }
+
+		// Get the number of bytes in use, including alignment padding and skipped remainders
+		uint32_t get_used_size() const noexcept { return used_size; }
+
+		// Get the number of bytes allocated in the current frame, including padding
+		uint32_t get_frame_size() const noexcept { return frame_size; }
+
+		// Get the number of ended frames not yet released
+		size_t get_frames_in_flight() const noexcept { return frames_in_flight.size(); }
+
+	  private:
+
+		struct Frame
+		{
+			uint32_t end;   // Head at the end of the frame, the tail after release
+			uint32_t size;  // Bytes held by the frame
+		};
+
+		uint32_t capacity;
+		uint32_t head = 0;       // Start of the free range
+		uint32_t tail = 0;       // Start of the oldest range in use
+		uint32_t used_size = 0;  // Bytes between tail and head
+		uint32_t frame_size = 0;
+
+		std::deque<Frame> frames_in_flight;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstdint>
+
+namespace graphics
+{
+	///
+	/// @brief Bookkeeping of uploads packed into batches of one staging buffer each
+	/// @details Uploads are placed linearly in the staging buffer of the open batch. An upload that
+	/// doesn't fit seals the open batch, so it can be submitted, and opens a new one. Uploads larger than
+	/// the staging buffer get a dedicated buffer in the open batch. Holds no GPU resource.
+	///
+	class Staging_packer
+	{
+	  public:
+
+		struct Placement
+		{
+			uint32_t offset;       // Offset in the staging buffer of the open batch, 0 if dedicated
+			bool dedicated;        // Too large for a staging buffer, staged in a buffer of its own
+			bool sealed_previous;  // The previous batch was sealed to make room, submit it first
+		};
+
+		explicit Staging_packer(uint32_t capacity) noexcept :
+			capacity(capacity)
+		{}
+
+		///
+		/// @brief Place an upload in the open batch
+		///
+		/// @param size Size in bytes, greater than 0
+		/// @param alignment Alignment of the offset, power of two
+		/// @return Placement of the upload
+		///
+		Placement place(uint32_t size, uint32_t alignment) noexcept;
+
+		///
+		/// @brief Seal the open batch and open a new one
+		///
+		/// @return `true` if the sealed batch holds any upload, `false` if it was empty
+		///
+		bool seal() noexcept;
+
+		uint32_t get_capacity() const noexcept { return capacity; }
+
+		// Get the number of staging bytes used by the open batch, including padding
+		uint32_t get_open_size() const noexcept { return open_size; }
+
+		// Get the number of uploads in the open batch, including dedicated ones
+		uint32_t get_open_count() const noexcept { return open_count; }
+
+		// Get the number of non-empty batches sealed so far
+		uint32_t get_sealed_count() const noexcept { return sealed_count; }
+
+	  private:
+
+		uint32_t capacity;
+		uint32_t open_size = 0;
+		uint32_t open_count = 0;
+		uint32_t sealed_count = 0;
+	};
+}
\ No newline at end of file
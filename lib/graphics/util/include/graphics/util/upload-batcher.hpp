@@ -0,0 +1,196 @@
+#pragma once
+
+#include "gpu/buffer.hpp"
+#include "gpu/fence.hpp"
+#include "gpu/texture.hpp"
+#include "graphics/util/quick-create.hpp"
+#include "graphics/util/staging-packer.hpp"
+#include "util/error.hpp"
+
+#include <SDL3/SDL_gpu.h>
+#include <deque>
+#include <expected>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace graphics
+{
+	///
+	/// @brief Batched uploads for creating GPU resources at **loading stage**
+	/// @details
+	/// - Resources are created immediately, their data is packed into large staging buffers, see
+	/// `Staging_packer`. A batch is submitted in one command buffer once its staging buffer is full, instead
+	/// of one submit and wait per resource like `create_buffer_from_data`.
+	/// - A few batches may be in flight, their staging buffers are reused after their fences signal.
+	/// - Thread-safe, can be shared by loading worker threads.
+	///
+	/// @warning Contents of created resources are undefined until `flush()` returns successfully
+	///
+	class Upload_batcher
+	{
+	  public:
+
+		static constexpr uint32_t default_staging_size = 32 * 1024 * 1024;
+		static constexpr uint32_t max_batches_in_flight = 2;
+
+		struct Statistics
+		{
+			uint32_t uploads = 0;            // Uploads staged, one per buffer or texture mip level
+			uint32_t batches_submitted = 0;  // Command buffers submitted
+			uint32_t dedicated_buffers = 0;  // Uploads too large for a staging buffer
+			uint32_t fence_waits = 0;        // Blocking waits for batches in flight
+			uint64_t bytes = 0;              // Bytes uploaded, excluding padding
+		};
+
+		///
+		/// @brief Create an upload batcher, staging buffers are created on demand
+		///
+		/// @param staging_size Size of each staging buffer in bytes
+		///
+		explicit Upload_batcher(SDL_GPUDevice* device, uint32_t staging_size = default_staging_size) noexcept;
+
+		///
+		/// @brief Create a buffer and stage its data
+		///
+		/// @param usage Buffer usage
+		/// @param data Binary data
+		/// @return Created buffer, or error
+		///
+		std::expected<gpu::Buffer, util::Error> create_buffer(
+			gpu::Buffer::Usage usage,
+			std::span<const std::byte> data,
+			const std::string& name
+		) noexcept;
+
+		///
+		/// @brief Stage data for a range of an existing buffer
+		/// @warning The buffer must outlive the next `flush()`
+		///
+		/// @param buffer Destination buffer
+		/// @param offset Destination offset in bytes
+		/// @param data Binary data
+		///
+		std::expected<void, util::Error> upload_to_buffer(
+			const gpu::Buffer& buffer,
+			uint32_t offset,
+			std::span<const std::byte> data
+		) noexcept;
+
+		///
+		/// @brief Create a texture and stage its mipmap chain
+		///
+		/// @param format Texture format
+		/// @param mipmap_chain Image data of each mip level, one level for non-mipmapped textures
+		/// @return Created texture, or error
+		///
+		std::expected<gpu::Texture, util::Error> create_texture(
+			gpu::Texture::Format format,
+			std::span<const detail::Image_data> mipmap_chain,
+			const std::string& name
+		) noexcept;
+
+		// Batched version of `graphics::create_texture_from_image`
+		template <typename T>
+		std::expected<gpu::Texture, util::Error> create_texture_from_image(
+			gpu::Texture::Format format,
+			const image::Image_container<T>& image,
+			const std::string& name
+		) noexcept
+		{
+			const detail::Image_data data{.size = image.size, .pixels = util::as_bytes(image.pixels)};
+			return create_texture(format, std::span(&data, 1), name);
+		}
+
+		// Batched version of `graphics::create_texture_from_mipmap`
+		template <typename T>
+		std::expected<gpu::Texture, util::Error> create_texture_from_mipmap(
+			gpu::Texture::Format format,
+			const std::vector<image::Image_container<T>>& mipmap_chain,
+			const std::string& name
+		) noexcept
+		{
+			std::vector<detail::Image_data> chain_data;
+			chain_data.reserve(mipmap_chain.size());
+			for (const auto& level : mipmap_chain)
+				chain_data.push_back(
+					detail::Image_data{.size = level.size, .pixels = util::as_bytes(level.pixels)}
+				);
+
+			return create_texture(format, chain_data, name);
+		}
+
+		///
+		/// @brief Submit the open batch and wait for all batches to finish
+		/// @note The batcher stays usable after flushing
+		///
+		std::expected<void, util::Error> flush() noexcept;
+
+		SDL_GPUDevice* get_device() const noexcept { return device; }
+
+		Statistics get_statistics() const noexcept;
+
+		Upload_batcher(const Upload_batcher&) = delete;
+		Upload_batcher(Upload_batcher&&) = delete;
+		Upload_batcher& operator=(const Upload_batcher&) = delete;
+		Upload_batcher& operator=(Upload_batcher&&) = delete;
+
+	  private:
+
+		// Offsets in staging buffers, textures need the stricter alignment on some backends
+		static constexpr uint32_t buffer_alignment = 16;
+		static constexpr uint32_t texture_alignment = 512;
+
+		struct Buffer_copy
+		{
+			SDL_GPUTransferBufferLocation source;
+			SDL_GPUBufferRegion destination;
+		};
+
+		struct Texture_copy
+		{
+			SDL_GPUTextureTransferInfo source;
+			SDL_GPUTextureRegion destination;
+		};
+
+		struct Batch
+		{
+			std::optional<gpu::Transfer_buffer> staging_buffer;  // Created or recycled on first use
+			std::vector<gpu::Transfer_buffer> dedicated_buffers;
+
+			std::vector<Buffer_copy> buffer_copies;
+			std::vector<Texture_copy> texture_copies;
+		};
+
+		struct Submitted_batch
+		{
+			gpu::Fence fence;
+			Batch batch;
+		};
+
+		SDL_GPUDevice* device;
+		uint32_t staging_size;
+
+		mutable std::mutex mutex;  // Guards all members below
+
+		Staging_packer packer;
+		Batch open_batch;
+		std::deque<Submitted_batch> submitted_batches;
+		std::vector<gpu::Transfer_buffer> free_staging_buffers;
+
+		Statistics statistics;
+
+		// Stage data in the open batch, returns its location in a staging or dedicated buffer
+		std::expected<SDL_GPUTransferBufferLocation, util::Error> stage(
+			std::span<const std::byte> data,
+			uint32_t alignment
+		) noexcept;
+
+		// Submit the open batch and start a new one
+		std::expected<void, util::Error> submit_open_batch() noexcept;
+
+		// Wait for the oldest submitted batch and recycle its staging buffer
+		std::expected<void, util::Error> retire_oldest_batch() noexcept;
+	};
+}
\ No newline at end of file
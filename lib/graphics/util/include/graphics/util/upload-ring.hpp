@@ -0,0 +1,123 @@
+#pragma once
+
+#include "gpu/buffer.hpp"
+#include "gpu/fence.hpp"
+#include "graphics/util/ring-allocator.hpp"
+#include "util/error.hpp"
+
+#include <SDL3/SDL_gpu.h>
+#include <cstddef>
+#include <deque>
+#include <expected>
+#include <functional>
+#include <memory>
+#include <span>
+#include <vector>
+
+namespace graphics
+{
+	///
+	/// @brief Persistent upload buffer for per-frame data, suballocated as a ring
+	/// @details One transfer buffer holds the uploads of all frames in flight, see `Ring_allocator`. Each
+	/// frame ends with the fence of its command buffer, the ranges of a frame are reused only after the
+	/// fence signals. When a frame doesn't fit, the ring waits for older frames and then doubles the buffer,
+	/// so after warm-up no buffer is created per frame. Growing first waits on the fences of all frames in
+	/// flight, size the initial capacity for a typical frame to avoid that stall.
+	///
+	class Upload_ring
+	{
+	  public:
+
+		// Range of an upload in the ring
+		struct Allocation
+		{
+			std::shared_ptr<const gpu::Transfer_buffer> buffer;  // Buffer holding the range, kept alive
+			uint32_t offset;
+			uint32_t size;
+		};
+
+		struct Statistics
+		{
+			uint32_t frame_bytes = 0;      // Bytes allocated in the current frame, including padding
+			uint32_t capacity = 0;         // Size of the transfer buffer
+			uint32_t buffers_created = 0;  // Transfer buffers created in the current frame
+			uint32_t fence_waits = 0;      // Blocking waits for frames in flight in the current frame
+		};
+
+		///
+		/// @brief Create an upload ring
+		///
+		/// @param capacity Initial size of the transfer buffer in bytes
+		/// @return Upload ring, or error on failure
+		///
+		static std::expected<Upload_ring, util::Error> create(
+			SDL_GPUDevice* device,
+			uint32_t capacity
+		) noexcept;
+
+		///
+		/// @brief Release the ranges of finished frames and reset the statistics
+		/// @note Called before the first upload of a frame
+		/// @warning Not thread-safe
+		///
+		void begin_frame() noexcept;
+
+		///
+		/// @brief Allocate a range in the current frame and fill it
+		/// @warning Not thread-safe
+		///
+		/// @param size Size in bytes, greater than 0
+		/// @param alignment Alignment of the offset, power of two
+		/// @param fill Callback writing the data, called with the mapped range
+		/// @return Allocation, or error on failure
+		///
+		std::expected<Allocation, util::Error> upload(
+			uint32_t size,
+			uint32_t alignment,
+			const std::function<void(std::span<std::byte> data)>& fill
+		) noexcept;
+
+		///
+		/// @brief End the current frame
+		///
+		/// @param fence Fence of the command buffer that copies the uploads of the frame
+		///
+		void end_frame(gpu::Fence fence) noexcept;
+
+		const Statistics& get_statistics() const noexcept { return statistics; }
+
+		Upload_ring(const Upload_ring&) = delete;
+		Upload_ring(Upload_ring&&) = default;
+		Upload_ring& operator=(const Upload_ring&) = delete;
+		Upload_ring& operator=(Upload_ring&&) = default;
+
+	  private:
+
+		struct Frame
+		{
+			gpu::Fence fence;
+
+			// Buffers replaced by growth during the frame, released with the frame
+			std::vector<std::shared_ptr<const gpu::Transfer_buffer>> retired_buffers;
+		};
+
+		SDL_GPUDevice* device;
+		std::shared_ptr<const gpu::Transfer_buffer> buffer;
+		Ring_allocator allocator;
+
+		std::deque<Frame> frames_in_flight;  // Same order as the frames in `allocator`
+		std::vector<std::shared_ptr<const gpu::Transfer_buffer>> retired_buffers;
+
+		Statistics statistics;
+
+		Upload_ring(SDL_GPUDevice* device, gpu::Transfer_buffer buffer, uint32_t capacity) noexcept :
+			device(device),
+			buffer(std::make_shared<const gpu::Transfer_buffer>(std::move(buffer))),
+			allocator(capacity),
+			statistics{.capacity = capacity}
+		{}
+
+		// Allocate a range, waiting for frames in flight and growing the buffer if needed
+		std::expected<uint32_t, util::Error> allocate(uint32_t size, uint32_t alignment) noexcept;
+	};
+}
\ No newline at end of file
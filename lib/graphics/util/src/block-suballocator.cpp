@@ -0,0 +1,25 @@
+#include "graphics/util/block-suballocator.hpp"
+
+#include <cassert>
+
+namespace graphics
+{
+	Block_suballocator::Allocation Block_suballocator::allocate(uint32_t count, uint32_t alignment) noexcept
+	{
+		assert(count > 0);
+		assert(alignment > 0 && (alignment & (alignment - 1)) == 0);
+
+		for (uint32_t block = 0; block < block_sizes.size(); block++)
+		{
+			const uint64_t used = block_sizes[block];
+			const uint64_t aligned = (used + alignment - 1) & ~uint64_t(alignment - 1);
+			if (aligned + count > block_capacity) continue;
+
+			block_sizes[block] = static_cast<uint32_t>(aligned + count);
+			return {.block = block, .offset = static_cast<uint32_t>(aligned)};
+		}
+
+		block_sizes.push_back(count);
+		return {.block = static_cast<uint32_t>(block_sizes.size() - 1), .offset = 0};
+	}
+}
\ No newline at end of file
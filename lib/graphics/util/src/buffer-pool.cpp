@@ -3,80 +3,16 @@
 
 namespace graphics
 {
-	void Buffer_pool::cycle() noexcept
-	{
-		for (auto& [key, buffer] : in_use_buffers) backup_pool[key].emplace_back(std::move(buffer));
-		in_use_buffers.clear();
-	}
-
 	std::expected<std::shared_ptr<gpu::Buffer>, util::Error> Buffer_pool::acquire_buffer(
 		gpu::Buffer::Usage usage,
 		uint32_t size
 	) noexcept
 	{
-		const Pool_key key{.size = size, .usage = usage};
-
-		/* Search for available buffer */
-
-		auto find_it = backup_pool.find(key);
-		if (find_it != backup_pool.end() && !find_it->second.empty())  // Pool hit
-		{
-			auto buffer = std::move(find_it->second.back());
-			find_it->second.pop_back();
-			in_use_buffers.emplace_back(key, std::move(buffer));
-			return in_use_buffers.back().second;
-		}
-
-		/* Create new buffer */
-
-		auto buffer_result = gpu::Buffer::create(device, usage, size, "Pooled Buffer");
-		if (!buffer_result) return buffer_result.error().forward("Create buffer failed");
-
-		in_use_buffers.emplace_back(key, std::make_shared<gpu::Buffer>(std::move(buffer_result.value())));
-		return in_use_buffers.back().second;
-	}
-
-	void Buffer_pool::gc() noexcept
-	{
-		backup_pool.clear();
-	}
-
-	void Transfer_buffer_pool::cycle() noexcept
-	{
-		for (auto& [key, buffer] : in_use_buffers) backup_pool[key].emplace_back(std::move(buffer));
-		in_use_buffers.clear();
-	}
-
-	std::expected<std::shared_ptr<gpu::Transfer_buffer>, util::Error> Transfer_buffer_pool::acquire_buffer(
-		gpu::Transfer_buffer::Usage usage,
-		uint32_t size
-	) noexcept
-	{
-		const Pool_key key{.usage = usage, .size = size};
-
-		/* Search for available buffer */
+		auto result = pool.acquire(usage, size, [this, usage](uint32_t class_size) {
+			return gpu::Buffer::create(device, usage, class_size, "Pooled Buffer");
+		});
+		if (!result) return result.error().forward("Acquire pooled buffer failed");
 
-		auto find_it = backup_pool.find(key);
-		if (find_it != backup_pool.end() && !find_it->second.empty())  // Pool hit
-		{
-			auto buffer = std::move(find_it->second.back());
-			find_it->second.pop_back();
-			in_use_buffers.emplace_back(key, std::move(buffer));
-			return in_use_buffers.back().second;
-		}
-
-		/* Create new buffer */
-
-		auto buffer_result = gpu::Transfer_buffer::create(device, usage, size);
-		if (!buffer_result) return buffer_result.error().forward("Create transfer buffer failed");
-
-		in_use_buffers
-			.emplace_back(key, std::make_shared<gpu::Transfer_buffer>(std::move(buffer_result.value())));
-		return in_use_buffers.back().second;
-	}
-
-	void Transfer_buffer_pool::gc() noexcept
-	{
-		backup_pool.clear();
+		return std::move(*result);
 	}
 }
\ No newline at end of file
@@ -0,0 +1,72 @@
+#include "graphics/util/ring-allocator.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <utility>
+
+namespace graphics
+{
+	std::optional<uint32_t> Ring_allocator::allocate(uint32_t size, uint32_t alignment) noexcept
+	{
+		assert(size > 0);
+		assert(alignment > 0 && (alignment & (alignment - 1)) == 0);
+
+		// Restart from the beginning when nothing is in use, leaving the whole ring free
+		if (used_size == 0) head = tail = 0;
+
+		const auto commit = [this](uint32_t offset, uint32_t size) {
+			const auto new_head = offset + size;
+			const auto held = new_head >= head ? new_head - head : capacity - head + new_head;
+
+			used_size += held;
+			frame_size += held;
+			head = new_head == capacity ? 0 : new_head;
+
+			return offset;
+		};
+
+		const uint64_t aligned = (uint64_t(head) + alignment - 1) & ~uint64_t(alignment - 1);
+
+		if (head >= tail && (head != tail || used_size == 0))
+		{
+			// Free ranges are [head, capacity) and [0, tail)
+			if (aligned + size <= capacity) return commit(static_cast<uint32_t>(aligned), size);
+			if (size <= tail) return commit(0, size);
+
+			return std::nullopt;
+		}
+
+		// Free range is [head, tail), or none if full
+		if (aligned + size <= tail) return commit(static_cast<uint32_t>(aligned), size);
+
+		return std::nullopt;
+	}
+
+	uint32_t Ring_allocator::get_grown_capacity(uint32_t size, uint32_t alignment) const noexcept
+	{
+		const uint64_t required = uint64_t(frame_size) + size + alignment;
+
+		// `std::bit_ceil` of a value above 2^31 isn't representable in 32 bits
+		assert(required <= (1u << 31) && "Upload ring can't grow past 2 GiB");
+
+		return std::max(capacity * 2, std::bit_ceil(static_cast<uint32_t>(required)));
+	}
+
+	void Ring_allocator::end_frame() noexcept
+	{
+		frames_in_flight.push_back({.end = head, .size = std::exchange(frame_size, 0)});
+	}
+
+	void Ring_allocator::release_oldest_frame() noexcept
+	{
+		if (frames_in_flight.empty()) return;
+
+		const auto frame = frames_in_flight.front();
+		frames_in_flight.pop_front();
+
+		// A frame without allocations may hold an end from before the ring was restarted
+		if (frame.size > 0) tail = frame.end;
+		used_size -= frame.size;
+	}
+}
\ No newline at end of file
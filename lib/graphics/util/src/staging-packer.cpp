@@ -0,0 +1,38 @@
+#include "graphics/util/staging-packer.hpp"
+
+#include <cassert>
+
+namespace graphics
+{
+	Staging_packer::Placement Staging_packer::place(uint32_t size, uint32_t alignment) noexcept
+	{
+		assert(size > 0);
+		assert(alignment > 0 && (alignment & (alignment - 1)) == 0);
+
+		if (size > capacity)
+		{
+			open_count++;
+			return {.offset = 0, .dedicated = true, .sealed_previous = false};
+		}
+
+		const uint64_t aligned = (uint64_t(open_size) + alignment - 1) & ~uint64_t(alignment - 1);
+		const bool sealed_previous = aligned + size > capacity && seal();
+		const auto offset = sealed_previous ? 0 : static_cast<uint32_t>(aligned);
+
+		open_size = offset + size;
+		open_count++;
+
+		return {.offset = offset, .dedicated = false, .sealed_previous = sealed_previous};
+	}
+
+	bool Staging_packer::seal() noexcept
+	{
+		const bool non_empty = open_count > 0;
+		if (non_empty) sealed_count++;
+
+		open_size = 0;
+		open_count = 0;
+
+		return non_empty;
+	}
+}
\ No newline at end of file
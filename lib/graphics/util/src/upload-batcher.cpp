@@ -0,0 +1,234 @@
+#include "graphics/util/upload-batcher.hpp"
+#include "gpu/command-buffer.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <ranges>
+
+namespace graphics
+{
+	Upload_batcher::Upload_batcher(SDL_GPUDevice* device, uint32_t staging_size) noexcept :
+		device(device),
+		staging_size(staging_size),
+		packer(staging_size)
+	{}
+
+	std::expected<SDL_GPUTransferBufferLocation, util::Error> Upload_batcher::stage(
+		std::span<const std::byte> data,
+		uint32_t alignment
+	) noexcept
+	{
+		const auto placement = packer.place(uint32_t(data.size()), alignment);
+
+		if (placement.sealed_previous)
+			if (const auto result = submit_open_batch(); !result)
+				return result.error().forward("Submit full batch failed");
+
+		statistics.uploads++;
+		statistics.bytes += data.size();
+
+		/* Dedicated Buffer */
+
+		if (placement.dedicated)
+		{
+			auto dedicated_buffer = gpu::Transfer_buffer::create_from_data(device, data);
+			if (!dedicated_buffer) return dedicated_buffer.error().forward("Create dedicated buffer failed");
+			statistics.dedicated_buffers++;
+
+			const auto& buffer = open_batch.dedicated_buffers.emplace_back(std::move(*dedicated_buffer));
+			return SDL_GPUTransferBufferLocation{.transfer_buffer = buffer, .offset = 0};
+		}
+
+		/* Staging Buffer */
+
+		if (!open_batch.staging_buffer.has_value())
+		{
+			if (!free_staging_buffers.empty())
+			{
+				open_batch.staging_buffer = std::move(free_staging_buffers.back());
+				free_staging_buffers.pop_back();
+			}
+			else
+			{
+				auto staging_buffer =
+					gpu::Transfer_buffer::create(device, gpu::Transfer_buffer::Usage::Upload, staging_size);
+				if (!staging_buffer) return staging_buffer.error().forward("Create staging buffer failed");
+
+				open_batch.staging_buffer = std::move(*staging_buffer);
+			}
+		}
+
+		// No cycling, staging buffers are only reused after their batch finished
+		const auto transfer_result = open_batch.staging_buffer->transfer(
+			[&](void* mapped_ptr) {
+				std::memcpy(static_cast<std::byte*>(mapped_ptr) + placement.offset, data.data(), data.size());
+			},
+			false
+		);
+		if (!transfer_result) return transfer_result.error().forward("Write staging buffer failed");
+
+		return SDL_GPUTransferBufferLocation{
+			.transfer_buffer = *open_batch.staging_buffer,
+			.offset = placement.offset
+		};
+	}
+
+	std::expected<gpu::Buffer, util::Error> Upload_batcher::create_buffer(
+		gpu::Buffer::Usage usage,
+		std::span<const std::byte> data,
+		const std::string& name
+	) noexcept
+	{
+		auto buffer = gpu::Buffer::create(device, usage, data.size(), name);
+		if (!buffer) return buffer.error().forward("Create buffer failed");
+
+		if (const auto result = upload_to_buffer(*buffer, 0, data); !result)
+			return result.error().forward("Upload buffer data failed");
+
+		return buffer;
+	}
+
+	std::expected<void, util::Error> Upload_batcher::upload_to_buffer(
+		const gpu::Buffer& buffer,
+		uint32_t offset,
+		std::span<const std::byte> data
+	) noexcept
+	{
+		std::scoped_lock lock(mutex);
+
+		const auto location = stage(data, buffer_alignment);
+		if (!location) return location.error().forward("Stage buffer data failed");
+
+		open_batch.buffer_copies.push_back({
+			.source = *location,
+			.destination = {.buffer = buffer, .offset = offset, .size = uint32_t(data.size())}
+		});
+
+		return {};
+	}
+
+	std::expected<gpu::Texture, util::Error> Upload_batcher::create_texture(
+		gpu::Texture::Format format,
+		std::span<const detail::Image_data> mipmap_chain,
+		const std::string& name
+	) noexcept
+	{
+		if (mipmap_chain.empty()) return util::Error("Empty mipmap chain");
+		if (!format.supported_on(device)) return util::Error("Texture format not supported on device");
+
+		auto texture = gpu::Texture::create(
+			device,
+			format.create(mipmap_chain[0].size.x, mipmap_chain[0].size.y, 1, mipmap_chain.size()),
+			name
+		);
+		if (!texture) return texture.error().forward("Create texture failed");
+
+		std::scoped_lock lock(mutex);
+
+		for (const auto& [mip_level, image] : mipmap_chain | std::views::enumerate)
+		{
+			const auto location = stage(image.pixels, texture_alignment);
+			if (!location)
+			{
+				// Drop copies of the earlier levels, the texture is released on return
+				std::erase_if(open_batch.texture_copies, [&texture](const Texture_copy& copy) {
+					return copy.destination.texture == *texture;
+				});
+
+				return location.error().forward("Stage texture data failed");
+			}
+
+			open_batch.texture_copies.push_back({
+				.source = {
+					.transfer_buffer = location->transfer_buffer,
+					.offset = location->offset,
+					.pixels_per_row = image.size.x,
+					.rows_per_layer = image.size.y
+				},
+				.destination = {
+					.texture = *texture,
+					.mip_level = uint32_t(mip_level),
+					.layer = 0,
+					.x = 0,
+					.y = 0,
+					.z = 0,
+					.w = image.size.x,
+					.h = image.size.y,
+					.d = 1
+				}
+			});
+		}
+
+		return texture;
+	}
+
+	std::expected<void, util::Error> Upload_batcher::submit_open_batch() noexcept
+	{
+		auto batch = std::exchange(open_batch, {});
+		if (batch.buffer_copies.empty() && batch.texture_copies.empty()) return {};
+
+		auto command_buffer = gpu::Command_buffer::acquire_from(device);
+		if (!command_buffer) return command_buffer.error().forward("Acquire command buffer failed");
+
+		const auto copy_result = command_buffer->run_copy_pass([&batch](const gpu::Copy_pass& copy_pass) {
+			for (const auto& [source, destination] : batch.buffer_copies)
+				copy_pass.upload_to_buffer(source, destination, false);
+
+			for (const auto& [source, destination] : batch.texture_copies)
+				copy_pass.upload_to_texture(source, destination, false);
+		});
+		if (!copy_result) return copy_result.error().forward("Run copy pass failed");
+
+		auto fence = command_buffer->submit_and_acquire_fence();
+		if (!fence) return fence.error().forward("Submit command buffer failed");
+		statistics.batches_submitted++;
+
+		submitted_batches.push_back({.fence = std::move(*fence), .batch = std::move(batch)});
+
+		// Bound the staging memory held by batches in flight
+		while (submitted_batches.size() > max_batches_in_flight)
+			if (const auto result = retire_oldest_batch(); !result)
+				return result.error().forward("Retire batch failed");
+
+		return {};
+	}
+
+	std::expected<void, util::Error> Upload_batcher::retire_oldest_batch() noexcept
+	{
+		auto& oldest = submitted_batches.front();
+
+		if (!oldest.fence.is_signaled())
+		{
+			if (const auto result = oldest.fence.wait(); !result)
+				return result.error().forward("Wait for batch failed");
+			statistics.fence_waits++;
+		}
+
+		if (oldest.batch.staging_buffer.has_value())
+			free_staging_buffers.push_back(std::move(*oldest.batch.staging_buffer));
+
+		submitted_batches.pop_front();
+		return {};
+	}
+
+	std::expected<void, util::Error> Upload_batcher::flush() noexcept
+	{
+		std::scoped_lock lock(mutex);
+
+		packer.seal();
+		if (const auto result = submit_open_batch(); !result)
+			return result.error().forward("Submit last batch failed");
+
+		while (!submitted_batches.empty())
+			if (const auto result = retire_oldest_batch(); !result)
+				return result.error().forward("Retire batch failed");
+
+		return {};
+	}
+
+	Upload_batcher::Statistics Upload_batcher::get_statistics() const noexcept
+	{
+		std::scoped_lock lock(mutex);
+		return statistics;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,102 @@
+#include "graphics/util/upload-ring.hpp"
+
+namespace graphics
+{
+	std::expected<Upload_ring, util::Error> Upload_ring::create(
+		SDL_GPUDevice* device,
+		uint32_t capacity
+	) noexcept
+	{
+		auto buffer = gpu::Transfer_buffer::create(device, gpu::Transfer_buffer::Usage::Upload, capacity);
+		if (!buffer) return buffer.error().forward("Create upload ring buffer failed");
+
+		return Upload_ring(device, std::move(*buffer), capacity);
+	}
+
+	void Upload_ring::begin_frame() noexcept
+	{
+		while (!frames_in_flight.empty() && frames_in_flight.front().fence.is_signaled())
+		{
+			frames_in_flight.pop_front();
+			allocator.release_oldest_frame();
+		}
+
+		statistics = {.capacity = allocator.get_capacity()};
+	}
+
+	std::expected<uint32_t, util::Error> Upload_ring::allocate(uint32_t size, uint32_t alignment) noexcept
+	{
+		/* Wait for Frames in Flight */
+
+		// Older frames are retired one fence at a time until the range fits. Growth is only reached after
+		// every frame in flight has been waited on, so a frame that outgrows the ring stalls the CPU until
+		// the GPU has finished all previous frames, once per growth.
+		while (true)
+		{
+			if (const auto offset = allocator.allocate(size, alignment)) return *offset;
+			if (frames_in_flight.empty()) break;
+
+			if (const auto result = frames_in_flight.front().fence.wait(); !result)
+				return result.error().forward("Wait for frame in flight failed");
+			statistics.fence_waits++;
+
+			frames_in_flight.pop_front();
+			allocator.release_oldest_frame();
+		}
+
+		/* Grow */
+
+		// Ranges of the current frame stay in the old buffer, which lives until the frame is finished.
+		// The new buffer is sized for the whole frame, as the next frame places all of it there.
+		const auto new_capacity = allocator.get_grown_capacity(size, alignment);
+
+		auto new_buffer =
+			gpu::Transfer_buffer::create(device, gpu::Transfer_buffer::Usage::Upload, new_capacity);
+		if (!new_buffer) return new_buffer.error().forward("Grow upload ring buffer failed");
+		statistics.buffers_created++;
+		statistics.capacity = new_capacity;
+
+		retired_buffers.push_back(std::exchange(
+			buffer,
+			std::make_shared<const gpu::Transfer_buffer>(std::move(*new_buffer))
+		));
+		allocator = Ring_allocator(new_capacity);
+
+		const auto offset = allocator.allocate(size, alignment);
+		if (!offset) return util::Error("Allocate from grown upload ring failed");
+
+		return *offset;
+	}
+
+	std::expected<Upload_ring::Allocation, util::Error> Upload_ring::upload(
+		uint32_t size,
+		uint32_t alignment,
+		const std::function<void(std::span<std::byte> data)>& fill
+	) noexcept
+	{
+		const auto offset = allocate(size, alignment);
+		if (!offset) return offset.error().forward("Allocate upload range failed");
+
+		statistics.frame_bytes = allocator.get_frame_size();
+
+		// No cycling, ranges of frames in flight are left untouched
+		const auto transfer_result = buffer->transfer(
+			[&](void* mapped_ptr) {
+				fill(std::span(static_cast<std::byte*>(mapped_ptr) + *offset, size));
+			},
+			false
+		);
+		if (!transfer_result) return transfer_result.error().forward("Write upload range failed");
+
+		return Allocation{.buffer = buffer, .offset = *offset, .size = size};
+	}
+
+	void Upload_ring::end_frame(gpu::Fence fence) noexcept
+	{
+		allocator.end_frame();
+		frames_in_flight.push_back(
+			{.fence = std::move(fence), .retired_buffers = std::move(retired_buffers)}
+		);
+		retired_buffers.clear();
+	}
+}
\ No newline at end of file
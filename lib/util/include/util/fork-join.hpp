@@ -0,0 +1,112 @@
+///
+/// @file fork-join.hpp
+/// @brief Provides a fork-join worker pool for per-frame parallel loops
+///
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <ranges>
+#include <thread>
+#include <vector>
+
+namespace util
+{
+	///
+	/// @brief Persistent workers that split an index range into chunks
+	/// @details The calling thread publishes one job and works on it along with the workers, which claim
+	/// chunks from a shared counter. Jobs are type-erased into a context pointer and a function pointer, so
+	/// unlike a task queue nothing is allocated per call or per chunk.
+	///
+	class Fork_join_pool
+	{
+	  public:
+
+		///
+		/// @brief Start the workers
+		///
+		/// @param worker_count Worker threads besides the calling thread, zero runs every loop inline
+		///
+		explicit Fork_join_pool(size_t worker_count) noexcept;
+
+		~Fork_join_pool() noexcept;
+
+		Fork_join_pool(const Fork_join_pool&) = delete;
+		Fork_join_pool(Fork_join_pool&&) = delete;
+		Fork_join_pool& operator=(const Fork_join_pool&) = delete;
+		Fork_join_pool& operator=(Fork_join_pool&&) = delete;
+
+		///
+		/// @brief Run `task(idx)` for every index in `[0, count)` and wait for all of them
+		/// @note Calls from several threads are serialized
+		///
+		/// @param count Index count
+		/// @param chunk_size Indices claimed at once, a range within one chunk runs inline
+		/// @param task Task invoked with each index, must not throw
+		///
+		template <typename F>
+		void parallel_for(size_t count, size_t chunk_size, const F& task) noexcept
+		{
+			chunk_size = std::max<size_t>(chunk_size, 1);
+
+			if (count <= chunk_size || workers.empty())
+			{
+				for (const auto idx : std::views::iota(0zu, count)) task(idx);
+				return;
+			}
+
+			run(
+				Job{
+					.context = &task,
+					.invoke =
+						[](const void* context, size_t begin, size_t end) {
+							const auto& task = *static_cast<const F*>(context);
+							for (const auto idx : std::views::iota(begin, end)) task(idx);
+						},
+					.count = count,
+					.chunk_size = chunk_size
+				}
+			);
+		}
+
+		size_t get_worker_count() const noexcept { return workers.size(); }
+
+	  private:
+
+		struct Job
+		{
+			const void* context;
+			void (*invoke)(const void* context, size_t begin, size_t end);
+			size_t count;
+			size_t chunk_size;
+		};
+
+		// Publish a job, work on it and wait for the workers
+		void run(const Job& job) noexcept;
+
+		// Claim and run chunks of the current job until none are left
+		void run_chunks() noexcept;
+
+		// Worker thread loop
+		void work() noexcept;
+
+		std::mutex run_mutex;  // Serializes callers
+
+		std::mutex mutex;
+		std::condition_variable start_signal;
+		std::condition_variable done_signal;
+		const Job* job = nullptr;
+		uint64_t generation = 0;  // Incremented for every published job
+		size_t busy_workers = 0;  // Workers yet to finish the current job
+		bool stopping = false;
+		std::atomic<size_t> next_chunk = 0;
+
+		// Declared last, joined before the state above is destroyed
+		std::vector<std::jthread> workers;
+	};
+}
\ No newline at end of file
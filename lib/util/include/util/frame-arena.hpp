@@ -0,0 +1,141 @@
+///
+/// @file frame-arena.hpp
+/// @brief Provides linear arenas for frame-scoped allocations
+///
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <vector>
+
+namespace util
+{
+	///
+	/// @brief Linear memory resource that keeps its blocks across resets
+	/// @details Allocation bumps a cursor through the blocks and deallocation does nothing. `reset()` rewinds
+	/// to the first block without freeing, so a workload repeating every frame stops allocating from the heap
+	/// once the blocks cover its peak.
+	/// @note Not thread-safe, share it between threads through `Synchronized_resource`. A block that can't
+	/// be allocated terminates the program, see `do_allocate`.
+	///
+	class Linear_arena : public std::pmr::memory_resource
+	{
+	  public:
+
+		static constexpr size_t default_block_size = 1 << 20;
+
+		struct Statistics
+		{
+			size_t used = 0;                 // Bytes allocated since the last reset, including padding
+			size_t capacity = 0;             // Bytes held in blocks
+			uint32_t block_allocations = 0;  // Blocks allocated from the heap since the last reset
+		};
+
+		explicit Linear_arena(size_t block_size = default_block_size) noexcept :
+			block_size(block_size)
+		{}
+
+		Linear_arena(const Linear_arena&) = delete;
+		Linear_arena(Linear_arena&&) = delete;
+		Linear_arena& operator=(const Linear_arena&) = delete;
+		Linear_arena& operator=(Linear_arena&&) = delete;
+
+		///
+		/// @brief Rewind to the first block
+		/// @warning Everything allocated before is invalidated
+		///
+		void reset() noexcept;
+
+		const Statistics& get_statistics() const noexcept { return statistics; }
+
+	  private:
+
+		struct Block
+		{
+			std::unique_ptr<std::byte[]> data;
+			size_t size;
+		};
+
+		size_t block_size;
+		std::vector<Block> blocks;
+		size_t current_block = 0;
+		size_t cursor = 0;  // Offset in the current block
+		Statistics statistics;
+
+		void* do_allocate(size_t bytes, size_t alignment) noexcept override;
+		void do_deallocate(void* ptr, size_t bytes, size_t alignment) noexcept override;
+		bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+	};
+
+	///
+	/// @brief Serializes an upstream memory resource, so worker threads can allocate from a frame arena
+	/// @details Every allocation takes a lock, meant for workloads with few allocations per task
+	///
+	class Synchronized_resource : public std::pmr::memory_resource
+	{
+	  public:
+
+		explicit Synchronized_resource(std::pmr::memory_resource* upstream) noexcept :
+			upstream(upstream)
+		{}
+
+		Synchronized_resource(const Synchronized_resource&) = delete;
+		Synchronized_resource(Synchronized_resource&&) = delete;
+		Synchronized_resource& operator=(const Synchronized_resource&) = delete;
+		Synchronized_resource& operator=(Synchronized_resource&&) = delete;
+
+	  private:
+
+		std::pmr::memory_resource* upstream;
+		std::mutex mutex;
+
+		void* do_allocate(size_t bytes, size_t alignment) noexcept override;
+		void do_deallocate(void* ptr, size_t bytes, size_t alignment) noexcept override;
+		bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+	};
+
+	///
+	/// @brief Ring of linear arenas for frame-scoped allocations
+	/// @details Every frame allocates from its own arena, which is only rewound when its slot comes around
+	/// again `frame_count` frames later. Data still referenced by frames in flight stays valid.
+	///
+	class Frame_arena
+	{
+	  public:
+
+		static constexpr size_t frame_count = 3;
+
+		Frame_arena() = default;
+		Frame_arena(const Frame_arena&) = delete;
+		Frame_arena(Frame_arena&&) = delete;
+		Frame_arena& operator=(const Frame_arena&) = delete;
+		Frame_arena& operator=(Frame_arena&&) = delete;
+
+		///
+		/// @brief Advance to the next frame, rewinding its arena
+		///
+		/// @return Memory resource of the new frame
+		///
+		std::pmr::memory_resource* begin_frame() noexcept;
+
+		///
+		/// @brief Get the statistics of the current frame
+		///
+		/// @return Statistics of the current frame's arena
+		///
+		const Linear_arena::Statistics& get_statistics() const noexcept
+		{
+			return arenas[current].get_statistics();
+		}
+
+	  private:
+
+		std::array<Linear_arena, frame_count> arenas;
+		size_t current = 0;
+	};
+}
\ No newline at end of file
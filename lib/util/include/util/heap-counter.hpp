@@ -0,0 +1,21 @@
+///
+/// @file heap-counter.hpp
+/// @brief Provides a count of global heap allocations, for verifying allocation-free frames
+///
+
+#pragma once
+
+#include <cstdint>
+
+namespace util
+{
+	///
+	/// @brief Get the number of global `operator new` calls made so far, by all threads
+	/// @details Linking this function replaces the global allocation functions with ones that count and
+	/// forward to `malloc`. Allocations made by C libraries through `malloc` directly are not counted.
+	/// Take the difference between two calls to count the allocations of a frame.
+	///
+	/// @return Allocation count since program start
+	///
+	uint64_t get_heap_allocation_count() noexcept;
+}
\ No newline at end of file
@@ -0,0 +1,78 @@
+#include "util/fork-join.hpp"
+
+namespace util
+{
+	Fork_join_pool::Fork_join_pool(size_t worker_count) noexcept
+	{
+		workers.reserve(worker_count);
+		for (size_t i = 0; i < worker_count; i++) workers.emplace_back([this] { work(); });
+	}
+
+	Fork_join_pool::~Fork_join_pool() noexcept
+	{
+		{
+			const std::lock_guard lock(mutex);
+			stopping = true;
+		}
+
+		start_signal.notify_all();
+	}
+
+	void Fork_join_pool::run(const Job& job) noexcept
+	{
+		const std::lock_guard run_lock(run_mutex);
+
+		{
+			const std::lock_guard lock(mutex);
+			this->job = &job;
+			next_chunk.store(0, std::memory_order_relaxed);
+			busy_workers = workers.size();
+			generation++;
+		}
+
+		start_signal.notify_all();
+		run_chunks();
+
+		// Every worker takes part in every job, so none can still be reading it after this
+		std::unique_lock lock(mutex);
+		done_signal.wait(lock, [this] { return busy_workers == 0; });
+		this->job = nullptr;
+	}
+
+	void Fork_join_pool::run_chunks() noexcept
+	{
+		const auto& [context, invoke, count, chunk_size] = *job;
+		const auto chunk_count = (count + chunk_size - 1) / chunk_size;
+
+		for (auto chunk = next_chunk.fetch_add(1, std::memory_order_relaxed); chunk < chunk_count;
+			 chunk = next_chunk.fetch_add(1, std::memory_order_relaxed))
+		{
+			const auto begin = chunk * chunk_size;
+			invoke(context, begin, std::min(begin + chunk_size, count));
+		}
+	}
+
+	void Fork_join_pool::work() noexcept
+	{
+		uint64_t seen_generation = 0;
+
+		while (true)
+		{
+			{
+				std::unique_lock lock(mutex);
+				start_signal.wait(lock, [this, seen_generation] {
+					return stopping || generation != seen_generation;
+				});
+				if (stopping) return;
+
+				seen_generation = generation;
+			}
+
+			run_chunks();
+
+			// Releasing the lock publishes this worker's writes to the caller
+			const std::lock_guard lock(mutex);
+			if (--busy_workers == 0) done_signal.notify_one();
+		}
+	}
+}
\ No newline at end of file
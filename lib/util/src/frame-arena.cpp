@@ -0,0 +1,105 @@
+#include "util/frame-arena.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <new>
+#include <print>
+
+namespace util
+{
+	void Linear_arena::reset() noexcept
+	{
+		current_block = 0;
+		cursor = 0;
+		statistics.used = 0;
+		statistics.block_allocations = 0;
+	}
+
+	void* Linear_arena::do_allocate(size_t bytes, size_t alignment) noexcept
+	{
+		while (true)
+		{
+			for (; current_block < blocks.size(); current_block++, cursor = 0)
+			{
+				auto& block = blocks[current_block];
+
+				void* ptr = block.data.get() + cursor;
+				size_t space = block.size - cursor;
+				if (std::align(alignment, bytes, ptr, space) == nullptr) continue;
+
+				const auto end = static_cast<size_t>(static_cast<std::byte*>(ptr) - block.data.get()) + bytes;
+				statistics.used += end - cursor;
+				cursor = end;
+
+				return ptr;
+			}
+
+			// A memory resource reports failure by throwing, which `noexcept` turns into `std::terminate`
+			// anyway. Fail explicitly instead, with the size that couldn't be served.
+			const auto fail = [bytes](const char* reason) {
+				std::println(std::cerr, "\033[91m[Error]\033[0m Linear arena: {} ({} bytes)", reason, bytes);
+				std::abort();
+			};
+
+			if (bytes > std::numeric_limits<size_t>::max() - alignment) fail("Allocation size overflows");
+			const auto fitting_size = bytes + alignment;
+
+			// Out of blocks, grow geometrically so that a steady workload settles in a few frames. Geometric
+			// growth may ask for far more than needed, retry with a block that only fits this allocation.
+			auto size = std::max({block_size, statistics.capacity, fitting_size});
+			std::unique_ptr<std::byte[]> data(new (std::nothrow) std::byte[size]);
+			if (data == nullptr && size > fitting_size)
+			{
+				size = fitting_size;
+				data.reset(new (std::nothrow) std::byte[size]);
+			}
+			if (data == nullptr) fail("Out of memory for a new block");
+
+			blocks.emplace_back(Block{.data = std::move(data), .size = size});
+
+			statistics.capacity += size;
+			statistics.block_allocations++;
+		}
+	}
+
+	void Linear_arena::do_deallocate(
+		void* ptr [[maybe_unused]],
+		size_t bytes [[maybe_unused]],
+		size_t alignment [[maybe_unused]]
+	) noexcept
+	{
+		// Do nothing, memory is reclaimed by `reset()`
+	}
+
+	bool Linear_arena::do_is_equal(const std::pmr::memory_resource& other) const noexcept
+	{
+		return this == &other;
+	}
+
+	void* Synchronized_resource::do_allocate(size_t bytes, size_t alignment) noexcept
+	{
+		const std::lock_guard lock(mutex);
+		return upstream->allocate(bytes, alignment);
+	}
+
+	void Synchronized_resource::do_deallocate(void* ptr, size_t bytes, size_t alignment) noexcept
+	{
+		const std::lock_guard lock(mutex);
+		upstream->deallocate(ptr, bytes, alignment);
+	}
+
+	bool Synchronized_resource::do_is_equal(const std::pmr::memory_resource& other) const noexcept
+	{
+		return this == &other;
+	}
+
+	std::pmr::memory_resource* Frame_arena::begin_frame() noexcept
+	{
+		current = (current + 1) % frame_count;
+		arenas[current].reset();
+
+		return &arenas[current];
+	}
+}
\ No newline at end of file
@@ -0,0 +1,93 @@
+#include "util/heap-counter.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#ifdef _MSC_VER
+#include <malloc.h>
+#endif
+
+namespace util
+{
+	namespace
+	{
+		std::atomic<uint64_t> heap_allocation_count = 0;
+
+		void* allocate(size_t size) noexcept
+		{
+			heap_allocation_count.fetch_add(1, std::memory_order_relaxed);
+			return std::malloc(size == 0 ? 1 : size);
+		}
+
+		void* allocate_aligned(size_t size, std::align_val_t alignment) noexcept
+		{
+			heap_allocation_count.fetch_add(1, std::memory_order_relaxed);
+
+			const auto align = static_cast<size_t>(alignment);
+#ifdef _MSC_VER
+			return _aligned_malloc(size == 0 ? 1 : size, align);
+#else
+			// `aligned_alloc` requires the size to be a multiple of the alignment
+			return std::aligned_alloc(align, (std::max<size_t>(size, 1) + align - 1) / align * align);
+#endif
+		}
+
+		void free_aligned(void* ptr) noexcept
+		{
+#ifdef _MSC_VER
+			_aligned_free(ptr);
+#else
+			std::free(ptr);
+#endif
+		}
+	}
+
+	uint64_t get_heap_allocation_count() noexcept
+	{
+		return heap_allocation_count.load(std::memory_order_relaxed);
+	}
+}
+
+/* Replaced Allocation Functions */
+
+// The remaining forms (arrays, nothrow) forward to these by default
+
+void* operator new(size_t size)
+{
+	void* const ptr = util::allocate(size);
+	if (ptr == nullptr) throw std::bad_alloc();
+	return ptr;
+}
+
+void* operator new(size_t size, std::align_val_t alignment)
+{
+	void* const ptr = util::allocate_aligned(size, alignment);
+	if (ptr == nullptr) throw std::bad_alloc();
+	return ptr;
+}
+
+void operator delete(void* ptr) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t size [[maybe_unused]]) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete(void* ptr, std::align_val_t alignment [[maybe_unused]]) noexcept
+{
+	util::free_aligned(ptr);
+}
+
+void operator delete(
+	void* ptr,
+	size_t size [[maybe_unused]],
+	std::align_val_t alignment [[maybe_unused]]
+) noexcept
+{
+	util::free_aligned(ptr);
+}
\ No newline at end of file
@@ -3,15 +3,19 @@
 #include "gltf/model.hpp"
 #include "logic/camera-control.hpp"
 #include "logic/light-source.hpp"
+#include "logic/room-visibility.hpp"
 #include "render/drawdata/light.hpp"
 #include "render/light-volume.hpp"
 #include "logic/climate-viewer.hpp"
 #include "logic/day-night-cycle.hpp"
 #include "logic/section-view.hpp"
 #include "render/param.hpp"
+#include "render/statistics.hpp"
+#include "util/frame-arena.hpp"
 
 #include <glm/glm.hpp>
 #include <glm/trigonometric.hpp>
+#include <memory_resource>
 
 class Logic
 {
@@ -29,12 +33,14 @@ class Logic
 	float bloom_attenuation = 1.2f;
 	float bloom_strength = 0.05f;
 	bool use_bloom_mask = true;
+	bool use_shadow_cache = true;
 	bool show_ceiling = true;
 	float ambient_intensity = 50;
 
 	uint32_t ceiling_node_index = 0;
 
 	float csm_linear_blend = 0.56f;
+	int csm_level_count = 3;
 
 	void light_control_ui() noexcept;
 
@@ -58,8 +64,30 @@ class Logic
 
 	void antialias_control_ui() noexcept;
 
+	/* Scene Transforms */
+
+	gltf::Transform_cache transform_cache;
+
+	/* Culling */
+
+	logic::Room_visibility room_visibility;
+	bool use_room_culling = true;
+	bool use_occlusion_culling = true;
+	bool use_instancing = true;
+	bool use_instance_culling = true;
+
+	void culling_control_ui() noexcept;
+
 	/* Statistics */
 
+	render::Statistics render_statistics;
+	util::Linear_arena::Statistics frame_arena_statistics;
+	uint64_t frame_heap_allocations = 0;  // Global `operator new` calls of the last frame
+	gltf::Mesh_buffers::Statistics mesh_statistics;  // Gathered on creation
+
+	// Name and compression statistics of each animation clip, gathered on creation
+	std::vector<std::pair<std::string, gltf::Animation::Compression_statistics>> animation_statistics;
+
 	void statistic_display_ui() const noexcept;
 
 	/* Animations */
@@ -117,6 +145,8 @@ class Logic
 	uint32_t curtain_left_node_index = 0;
 	uint32_t curtain_right_node_index = 0;
 
+	gltf::Skinning_mode skinning_mode = gltf::Skinning_mode::Matrix;
+
 	void animation_control_ui() noexcept;
 
 	/* Lights */
@@ -135,8 +165,49 @@ class Logic
 
 	static std::expected<Logic, util::Error> create(SDL_GPUDevice* device, const gltf::Model& model) noexcept;
 
-	std::tuple<render::Params, std::vector<gltf::Drawdata>, std::vector<render::drawdata::Light>> logic(
+	///
+	/// @brief Run the logic of a frame
+	///
+	/// @param context SDL context
+	/// @param model Scene model
+	/// @param arena Frame arena, backs the light drawdata and per-frame temporaries
+	/// @return Render params, model drawdata and light drawdata. The model drawdata is kept in the transform
+	/// cache and valid until the next call.
+	///
+	std::tuple<render::Params, std::span<const gltf::Drawdata>, std::pmr::vector<render::drawdata::Light>>
+	logic(
 		const backend::SDL_context& context,
-		const gltf::Model& model
+		const gltf::Model& model,
+		std::pmr::memory_resource* arena
 	) noexcept;
+
+	///
+	/// @brief Update renderer statistics for display in the next frame
+	///
+	/// @param statistics Statistics of the last rendered frame
+	///
+	void set_render_statistics(const render::Statistics& statistics) noexcept
+	{
+		render_statistics = statistics;
+	}
+
+	///
+	/// @brief Update frame arena statistics for display in the next frame
+	///
+	/// @param statistics Statistics of the last frame's arena
+	///
+	void set_frame_arena_statistics(const util::Linear_arena::Statistics& statistics) noexcept
+	{
+		frame_arena_statistics = statistics;
+	}
+
+	///
+	/// @brief Update the heap allocation count for display in the next frame
+	///
+	/// @param count Global heap allocations of the last frame, see `util::get_heap_allocation_count`
+	///
+	void set_frame_heap_allocations(uint64_t count) noexcept { frame_heap_allocations = count; }
+
+	// Get the joint palette format selected in the UI, applied to the model before each frame
+	gltf::Skinning_mode get_skinning_mode() const noexcept { return skinning_mode; }
 };
\ No newline at end of file
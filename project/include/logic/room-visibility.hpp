@@ -0,0 +1,77 @@
+#pragma once
+
+#include "gltf/animation.hpp"
+#include "gltf/model.hpp"
+#include "graphics/portal.hpp"
+
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <string>
+#include <vector>
+
+namespace logic
+{
+	///
+	/// @brief Room/portal visibility of the building
+	/// @details Rooms are nodes named `Room-<name>`, portals are nodes named `Portal-<key>`. Both describe
+	/// volumes through their world transform applied to the unit cube [-1, 1]^3. A portal connects the rooms
+	/// it overlaps (or a room and the outside), and follows the door animation named `<key>` if present,
+	/// staying open otherwise. Mesh nodes fully contained in a room, and not touching any portal, belong to
+	/// that room and are hidden when the room is invisible.
+	///
+	class Room_visibility
+	{
+	  public:
+
+		// Door animations below this time are considered closed (seconds, ~1 frame of a 24fps clip)
+		static constexpr float closed_time_threshold = 1.0f / 24.0f;
+
+		///
+		/// @brief Build room visibility from the rest pose of the model
+		/// @note A model without room nodes yields an empty system that never hides anything
+		///
+		/// @param model Model to build from
+		/// @return Room visibility, or error if the room setup is invalid
+		///
+		static std::expected<Room_visibility, util::Error> create(const gltf::Model& model) noexcept;
+
+		///
+		/// @brief Compute nodes to hide for the current frame
+		///
+		/// @param camera_matrix Camera VP matrix
+		/// @param eye_position World-space eye position
+		/// @param animation_keys Current animation keys, used to find the door states
+		/// @param resource Memory resource for the result and temporaries, e.g. a frame arena
+		/// @return List of node indices in invisible rooms
+		///
+		std::pmr::vector<uint32_t> compute_hidden_nodes(
+			const glm::mat4& camera_matrix,
+			const glm::vec3& eye_position,
+			std::span<const gltf::Animation_key> animation_keys,
+			std::pmr::memory_resource* resource = std::pmr::get_default_resource()
+		) noexcept;
+
+		uint32_t get_room_count() const noexcept { return static_cast<uint32_t>(graph.room_count()); }
+		uint32_t get_visible_room_count() const noexcept { return visible_room_count; }
+
+		Room_visibility() = default;
+
+	  private:
+
+		graphics::Portal_graph graph;
+		std::vector<std::string> portal_keys;          // Door animation key of each portal
+		std::vector<std::vector<uint32_t>> room_nodes;  // Mesh nodes contained in each room
+
+		uint32_t visible_room_count = 0;
+
+		Room_visibility(
+			graphics::Portal_graph graph,
+			std::vector<std::string> portal_keys,
+			std::vector<std::vector<uint32_t>> room_nodes
+		) noexcept :
+			graph(std::move(graph)),
+			portal_keys(std::move(portal_keys)),
+			room_nodes(std::move(room_nodes))
+		{}
+	};
+}
@@ -2,11 +2,13 @@
 #include "backend/sdl.hpp"
 #include "render/drawdata/light.hpp"
 #include "render/param.hpp"
+#include "render/target/shadow.hpp"
 
 #include <algorithm>
 #include <array>
 #include <cmath>
 #include <cstdint>
+#include <format>
 #include <functional>
 #include <imgui.h>
 #include <implot.h>
@@ -22,9 +24,26 @@ void Logic::light_control_ui() noexcept
 
 	ImGui::Separator();
 	ImGui::Checkbox("脏镜头",&use_bloom_mask);
+	ImGui::Checkbox("静态阴影缓存", &use_shadow_cache);
+	ImGui::SliderInt(
+		"阴影级数",
+		&csm_level_count,
+		1,
+		static_cast<int>(render::target::Shadow::max_levels)
+	);
 	ImGui::Separator();
 }
 
+void Logic::culling_control_ui() noexcept
+{
+	ImGui::SeparatorText("剔除");
+
+	ImGui::Checkbox("房间可见性剔除", &use_room_culling);
+	ImGui::Checkbox("遮挡剔除", &use_occlusion_culling);
+	ImGui::Checkbox("自动实例化", &use_instancing);
+	ImGui::Checkbox("逐实例剔除", &use_instance_culling);
+}
+
 void Logic::statistic_display_ui() const noexcept
 {
 	const auto& io = ImGui::GetIO();
@@ -33,6 +52,114 @@ void Logic::statistic_display_ui() const noexcept
 
 	ImGui::Text("Res: (%.0f, %.0f)", io.DisplaySize.x, io.DisplaySize.y);
 	ImGui::Text("FPS: %.1f FPS", io.Framerate);
+
+	if (use_room_culling && room_visibility.get_room_count() > 0)
+		ImGui::Text(
+			"Rooms: %u / %u",
+			room_visibility.get_visible_room_count(),
+			room_visibility.get_room_count()
+		);
+
+	ImGui::Text("Nodes updated: %zu", transform_cache.get_updated_node_count());
+	ImGui::Text(
+		"Drawcalls: %u (%u draws, %u instances)",
+		render_statistics.gbuffer_drawcalls,
+		render_statistics.gbuffer_draws,
+		render_statistics.gbuffer_instances
+	);
+	if (use_occlusion_culling)
+		ImGui::Text(
+			"Occluded: %u / %u (%u tris)",
+			render_statistics.occlusion_culled,
+			render_statistics.occlusion_tested,
+			render_statistics.occluder_triangles
+		);
+	ImGui::Text("Rigged culled: %u / %u", render_statistics.rigged_culled, render_statistics.rigged_tested);
+	ImGui::Text("Joints: %u / %u", render_statistics.joints_uploaded, render_statistics.joints_total);
+	ImGui::Text(
+		"Upload: %.1f / %.1f KiB, %u waits, %u created",
+		render_statistics.upload_bytes / 1024.0,
+		render_statistics.upload_capacity / 1024.0,
+		render_statistics.upload_fence_waits,
+		render_statistics.buffers_created
+	);
+	ImGui::Text(
+		"Pool: %u hits, %u misses, %.1f KiB idle",
+		render_statistics.pool_hits,
+		render_statistics.pool_misses,
+		render_statistics.pooled_bytes / 1024.0
+	);
+
+	ImGui::Text(
+		"Binds: %u issued, %u skipped",
+		render_statistics.gbuffer_binds_issued,
+		render_statistics.gbuffer_binds_skipped
+	);
+	ImGui::Text(
+		"Shadow binds: %u issued, %u skipped",
+		render_statistics.shadow_binds_issued,
+		render_statistics.shadow_binds_skipped
+	);
+
+	for (const auto [level, cascade] : render_statistics.get_shadow_cascades() | std::views::enumerate)
+		ImGui::Text(
+			"CSM %u: %u / %u casters, %u draws%s",
+			static_cast<uint32_t>(level),
+			cascade.kept_casters,
+			cascade.candidate_casters,
+			cascade.draws,
+			cascade.static_cached ? " (cached)" : ""
+		);
+
+	ImGui::Text(
+		"Frame arena: %.1f / %.1f KiB, %u block allocs",
+		static_cast<double>(frame_arena_statistics.used) / 1024.0,
+		static_cast<double>(frame_arena_statistics.capacity) / 1024.0,
+		frame_arena_statistics.block_allocations
+	);
+	ImGui::Text("Heap allocs: %llu / frame", static_cast<unsigned long long>(frame_heap_allocations));
+
+	ImGui::Text(
+		"Indices: %u / %u prims 16-bit, %.1f KiB (-%.1f KiB)",
+		mesh_statistics.primitives_16bit,
+		mesh_statistics.primitives,
+		static_cast<double>(mesh_statistics.index_bytes) / 1024.0,
+		static_cast<double>(mesh_statistics.index_bytes_saved) / 1024.0
+	);
+
+	size_t animation_original_size = 0, animation_compressed_size = 0;
+	for (const auto& [_, statistics] : animation_statistics)
+	{
+		animation_original_size += statistics.original_size;
+		animation_compressed_size += statistics.compressed_size;
+	}
+
+	ImGui::Text(
+		"Animations: %.1f -> %.1f KiB",
+		static_cast<double>(animation_original_size) / 1024.0,
+		static_cast<double>(animation_compressed_size) / 1024.0
+	);
+
+	if (!animation_statistics.empty() && ImGui::TreeNode("Animation clips"))
+	{
+		for (const auto& [name, statistics] : animation_statistics)
+		{
+			const auto saved_size = static_cast<double>(statistics.original_size)
+				- static_cast<double>(statistics.compressed_size);
+
+			ImGui::Text(
+				"%s: -%.1f KiB, %u compressed, max err T %.4f R %.3f deg S %.4f",
+				name.c_str(),
+				saved_size / 1024.0,
+				statistics.compressed_channels,
+				statistics.max_translation_error,
+				glm::degrees(statistics.max_rotation_error),
+				statistics.max_scale_error
+			);
+		}
+
+		ImGui::TreePop();
+	}
 }
 
 void Logic::animation_control_ui() noexcept
@@ -46,6 +173,11 @@ void Logic::animation_control_ui() noexcept
 
 	ImGui::SliderFloat("右窗帘", &curtain_right_animation.target, 0.0f, 1.0f, "%.2f");
 	ImGui::Text("当前位置: %.2f", curtain_right_animation.current);
+
+	bool use_dual_quaternion = skinning_mode == gltf::Skinning_mode::Dual_quaternion;
+	if (ImGui::Checkbox("对偶四元数蒙皮", &use_dual_quaternion))
+		skinning_mode =
+			use_dual_quaternion ? gltf::Skinning_mode::Dual_quaternion : gltf::Skinning_mode::Matrix;
 }
 
 void Logic::light_source_control_ui() noexcept
@@ -140,6 +272,19 @@ std::expected<Logic, util::Error> Logic::create(SDL_GPUDevice* device, const glt
 	logic.curtain_left_node_index = *curtain_left_node_index;
 	logic.curtain_right_node_index = *curtain_right_node_index;
 
+	auto room_visibility_result = logic::Room_visibility::create(model);
+	if (!room_visibility_result)
+		return room_visibility_result.error().forward("Create room visibility failed");
+	logic.room_visibility = std::move(*room_visibility_result);
+
+	logic.mesh_statistics = model.get_mesh_statistics();
+
+	for (const auto [idx, animation] : model.get_animations() | std::views::enumerate)
+		logic.animation_statistics.emplace_back(
+			animation.name.value_or(std::format("#{}", idx)),
+			animation.get_compression_statistics()
+		);
+
 	return logic;
 }
 
@@ -166,9 +311,11 @@ Logic::Animation_metric Logic::Animation_metric::from(
 	return {.animation_index = animation_index, .distance = distance, .dot = door_dot, .puv = puv};
 }
 
-std::tuple<render::Params, std::vector<gltf::Drawdata>, std::vector<render::drawdata::Light>> Logic::logic(
+std::tuple<render::Params, std::span<const gltf::Drawdata>, std::pmr::vector<render::drawdata::Light>>
+Logic::logic(
 	const backend::SDL_context& context,
-	const gltf::Model& model
+	const gltf::Model& model,
+	std::pmr::memory_resource* arena
 ) noexcept
 {
 	struct Door_ui_state
@@ -269,6 +416,7 @@ std::tuple<render::Params, std::vector<gltf::Drawdata>, std::vector<render::draw
 		light_control_ui();
 		// antialias_control_ui();
 		section_view.control_ui();
+		culling_control_ui();
 		statistic_display_ui();
 		animation_control_ui();
 		light_source_control_ui();
@@ -309,7 +457,7 @@ std::tuple<render::Params, std::vector<gltf::Drawdata>, std::vector<render::draw
 		std::ref(curtain_right_animation),
 	});
 
-	std::vector<gltf::Animation_key> animation_keys;
+	std::pmr::vector<gltf::Animation_key> animation_keys(arena);
 	for (const auto& [_, animation_state] : animation_targets)
 	{
 		animation_keys.push_back(
@@ -342,9 +490,18 @@ std::tuple<render::Params, std::vector<gltf::Drawdata>, std::vector<render::draw
 		prev_hide_nodes_enabled = section_view.is_hide_nodes_enabled();
 	}
 
-	std::vector<uint32_t> hidden_nodes;
+	std::pmr::vector<uint32_t> hidden_nodes(arena);
 	if (prev_hide_nodes_enabled) hidden_nodes.push_back(ceiling_node_index);
-	std::vector<std::pair<uint32_t, float>> emission_overrides;
+	if (use_room_culling)
+		hidden_nodes.append_range(
+			room_visibility.compute_hidden_nodes(
+				camera_matrices.proj_matrix * camera_matrices.view_matrix,
+				camera_matrices.eye_position,
+				animation_keys,
+				arena
+			)
+		);
+	std::pmr::vector<std::pair<uint32_t, float>> emission_overrides(arena);
 	for (const auto& light_group : light_groups | std::views::values)
 	{
 		emission_overrides.append_range(
@@ -355,8 +512,14 @@ std::tuple<render::Params, std::vector<gltf::Drawdata>, std::vector<render::draw
 		);
 	}
 
-	auto main_drawdata =
-		model.generate_drawdata(glm::mat4(1.0f), animation_keys, emission_overrides, hidden_nodes);
+	// Owned by the transform cache, which keeps it across frames
+	const auto& main_drawdata = model.generate_drawdata(
+		transform_cache,
+		glm::mat4(1.0f),
+		animation_keys,
+		emission_overrides,
+		hidden_nodes
+	);
 
 	// 剖面图模式：在每个区域显示名称（用门把手节点作为区域锚点）
 	if (section_view.is_enabled())
@@ -391,7 +554,7 @@ std::tuple<render::Params, std::vector<gltf::Drawdata>, std::vector<render::draw
 		| std::views::filter([&look_cos_threshold, &look_distance_threshold](const auto& metric) {
 			  return metric.dot > look_cos_threshold && metric.distance < look_distance_threshold;
 		  })
-		| std::ranges::to<std::vector>();
+		| std::ranges::to<std::pmr::vector<Animation_metric>>(arena);
 
 	std::ranges::sort(animation_metrics, std::less(), &Animation_metric::distance);
 	if (!animation_metrics.empty())
@@ -447,10 +610,7 @@ std::tuple<render::Params, std::vector<gltf::Drawdata>, std::vector<render::draw
 				  light.volume
 			  );
 		  })
-		| std::ranges::to<std::vector>();
-
-	std::vector<gltf::Drawdata> drawdata_list;
-	drawdata_list.emplace_back(std::move(main_drawdata));
+		| std::ranges::to<std::pmr::vector<render::drawdata::Light>>(arena);
 
 	const render::Primary_light_params primary_light{
 		.direction = light_direction,
@@ -464,6 +624,7 @@ std::tuple<render::Params, std::vector<gltf::Drawdata>, std::vector<render::draw
 
 	const render::Shadow_params shadow_params{
 		.csm_linear_blend = csm_linear_blend,
+		.csm_level_count = static_cast<uint32_t>(csm_level_count),
 	};
 
 	const render::Params params{
@@ -473,8 +634,14 @@ std::tuple<render::Params, std::vector<gltf::Drawdata>, std::vector<render::draw
 		.ambient = {.intensity = glm::vec3(ambient_intensity)},
 		.bloom = bloom_params,
 		.shadow = shadow_params,
-		.function_mask = {.use_bloom_mask = use_bloom_mask}
+		.function_mask = {
+			.use_bloom_mask = use_bloom_mask,
+			.occlusion_culling = use_occlusion_culling,
+			.shadow_cache = use_shadow_cache,
+			.instancing = use_instancing,
+			.instance_culling = use_instance_culling
+		}
 	};
 
-	return std::make_tuple(params, std::move(drawdata_list), std::move(light_drawdata_list));
+	return std::make_tuple(params, std::span(&main_drawdata, 1), std::move(light_drawdata_list));
 }
@@ -0,0 +1,168 @@
+#include "logic/room-visibility.hpp"
+
+#include "graphics/culling.hpp"
+
+#include <algorithm>
+#include <format>
+#include <ranges>
+
+namespace logic
+{
+	static constexpr std::string_view room_prefix = "Room-";
+	static constexpr std::string_view portal_prefix = "Portal-";
+
+	// World-space AABB of a volume node, i.e. the node transform applied to the unit cube
+	static std::pair<glm::vec3, glm::vec3> get_volume_bound(const glm::mat4& world_matrix) noexcept
+	{
+		return graphics::local_bound_to_world(glm::vec3(-1.0f), glm::vec3(1.0f), world_matrix);
+	}
+
+	static bool box_overlap(
+		const std::pair<glm::vec3, glm::vec3>& a,
+		const std::pair<glm::vec3, glm::vec3>& b
+	) noexcept
+	{
+		return glm::all(glm::lessThanEqual(a.first, b.second))
+			&& glm::all(glm::lessThanEqual(b.first, a.second));
+	}
+
+	static bool box_contains(
+		const std::pair<glm::vec3, glm::vec3>& outer,
+		const std::pair<glm::vec3, glm::vec3>& inner
+	) noexcept
+	{
+		return glm::all(glm::lessThanEqual(outer.first, inner.first))
+			&& glm::all(glm::lessThanEqual(inner.second, outer.second));
+	}
+
+	std::expected<Room_visibility, util::Error> Room_visibility::create(const gltf::Model& model) noexcept
+	{
+		const auto room_node_list = model.find_nodes_by_prefix(room_prefix);
+		const auto portal_node_list = model.find_nodes_by_prefix(portal_prefix);
+		if (room_node_list.empty()) return Room_visibility();
+
+		// Rest pose, volume nodes are expected to be static
+		const auto rest_drawdata = model.generate_drawdata(glm::mat4(1.0f), {}, {}, {});
+		const auto& node_matrices = rest_drawdata.node_matrices;
+
+		/* Rooms */
+
+		const auto room_bounds =
+			room_node_list
+			| std::views::keys
+			| std::views::transform([&node_matrices](uint32_t node_index) {
+				  return get_volume_bound(node_matrices[node_index]);
+			  })
+			| std::ranges::to<std::vector>();
+
+		/* Portals */
+
+		std::vector<graphics::Portal_graph::Portal> portals;
+		std::vector<std::pair<glm::vec3, glm::vec3>> portal_bounds;
+		std::vector<std::string> portal_keys;
+
+		for (const auto& [node_index, name] : portal_node_list)
+		{
+			const auto portal_bound = get_volume_bound(node_matrices[node_index]);
+
+			std::vector<uint32_t> connected_rooms;
+			for (const auto [room_index, room_bound] : room_bounds | std::views::enumerate)
+				if (box_overlap(portal_bound, room_bound)) connected_rooms.push_back(room_index);
+
+			if (connected_rooms.empty())
+				return util::Error(std::format("Portal '{}' doesn't overlap any room", name));
+			if (connected_rooms.size() > 2)
+				return util::Error(std::format("Portal '{}' overlaps more than two rooms", name));
+
+			portals.push_back({
+				.min = portal_bound.first,
+				.max = portal_bound.second,
+				.room_a = connected_rooms[0],
+				.room_b = connected_rooms.size() == 2 ? std::optional(connected_rooms[1]) : std::nullopt,
+			});
+			portal_bounds.push_back(portal_bound);
+			portal_keys.emplace_back(name.substr(portal_prefix.size()));
+		}
+
+		/* Assign Mesh Nodes */
+
+		std::vector<std::vector<uint32_t>> room_nodes(room_bounds.size());
+
+		for (const auto node_index : std::views::iota(0u, static_cast<uint32_t>(model.get_node_count())))
+		{
+			const auto local_bound = model.get_node_local_bound(node_index);
+			if (!local_bound) continue;
+
+			const auto world_bound = graphics::local_bound_to_world(
+				local_bound->first,
+				local_bound->second,
+				node_matrices[node_index]
+			);
+
+			// Doors and other geometry in a portal stay visible from both sides
+			if (std::ranges::any_of(portal_bounds, [&world_bound](const auto& portal_bound) {
+					return box_overlap(world_bound, portal_bound);
+				}))
+				continue;
+
+			const auto room = std::ranges::find_if(room_bounds, [&world_bound](const auto& room_bound) {
+				return box_contains(room_bound, world_bound);
+			});
+			if (room == room_bounds.end()) continue;
+
+			room_nodes[std::distance(room_bounds.begin(), room)].push_back(node_index);
+		}
+
+		std::vector<graphics::Portal_graph::Room> rooms =
+			room_bounds
+			| std::views::transform([](const auto& bound) {
+				  return graphics::Portal_graph::Room{.min = bound.first, .max = bound.second};
+			  })
+			| std::ranges::to<std::vector>();
+
+		return Room_visibility(
+			graphics::Portal_graph(std::move(rooms), std::move(portals)),
+			std::move(portal_keys),
+			std::move(room_nodes)
+		);
+	}
+
+	std::pmr::vector<uint32_t> Room_visibility::compute_hidden_nodes(
+		const glm::mat4& camera_matrix,
+		const glm::vec3& eye_position,
+		std::span<const gltf::Animation_key> animation_keys,
+		std::pmr::memory_resource* resource
+	) noexcept
+	{
+		std::pmr::vector<uint32_t> hidden_nodes(resource);
+		if (graph.room_count() == 0) return hidden_nodes;
+
+		std::pmr::vector<bool> portal_open(resource);
+		portal_open.reserve(portal_keys.size());
+		for (const auto& key : portal_keys)
+		{
+			const auto door = std::ranges::find_if(animation_keys, [&key](const auto& animation_key) {
+				return std::holds_alternative<std::string_view>(animation_key.animation)
+					&& std::get<std::string_view>(animation_key.animation) == key;
+			});
+
+			// Portals without a door animation are always open
+			portal_open.push_back(door == animation_keys.end() || door->time > closed_time_threshold);
+		}
+
+		const auto visible_rooms =
+			graph.compute_visible_rooms(camera_matrix, eye_position, portal_open, resource);
+
+		visible_room_count = 0;
+
+		for (const auto [room_index, nodes] : room_nodes | std::views::enumerate)
+		{
+			if (visible_rooms[room_index])
+				visible_room_count++;
+			else
+				hidden_nodes.append_range(nodes);
+		}
+
+		return hidden_nodes;
+	}
+}
@@ -13,6 +13,8 @@
 #include "logic.hpp"
 #include "render.hpp"
 #include "tiny_gltf.h"
+#include "util/frame-arena.hpp"
+#include "util/heap-counter.hpp"
 #include "util/unwrap.hpp"
 
 #include "asset/my-asset.hpp"
@@ -45,6 +47,7 @@ static std::expected<gltf::Model, util::Error> create_scene_from_model(
 			gltf::Sampler_config{.anisotropy = 4.0f},
 			{.color_mode = gltf::Color_compress_mode::RGBA8_BC3,
 			 .normal_mode = gltf::Normal_compress_mode::RGn_BC5},
+			gltf::Animation_compression_config{},
 			std::ref(load_progress)
 		);
 	});
@@ -86,6 +89,9 @@ static std::expected<gltf::Model, util::Error> create_scene_from_model(
 
 static void main_logic(const backend::SDL_context& sdl_context, const std::string& model_path)
 {
+	// Declared first, the renderer keeps references into the arena until destroyed
+	util::Frame_arena frame_arena;
+
 	auto render_resource =
 		backend::display_until_task_done(
 			sdl_context,
@@ -140,8 +146,12 @@ static void main_logic(const backend::SDL_context& sdl_context, const std::strin
 
 		/*===== Logic =====*/
 
+		const auto heap_allocations_begin = util::get_heap_allocation_count();
+
 		backend::imgui_new_frame();
-		const auto [params, model_drawdata, primary_point_lights] = logic.logic(sdl_context, model);
+		auto* const arena = frame_arena.begin_frame();
+		model.set_skinning_mode(logic.get_skinning_mode());
+		const auto [params, model_drawdata, primary_point_lights] = logic.logic(sdl_context, model, arena);
 
 		// if (ImGui::Begin("Test Image"))
 		// { 	
@@ -157,6 +167,9 @@ static void main_logic(const backend::SDL_context& sdl_context, const std::strin
 		const render::Drawdata drawdata = {.models = model_drawdata, .lights = primary_point_lights};
 
 		render_resource.render(sdl_context, drawdata, params) | util::unwrap("Render frame failed");
+		logic.set_render_statistics(render_resource.get_statistics());
+		logic.set_frame_arena_statistics(frame_arena.get_statistics());
+		logic.set_frame_heap_allocations(util::get_heap_allocation_count() - heap_allocations_begin);
 	}
 }
 
@@ -5,9 +5,12 @@
 #include <glm/glm.hpp>
 
 #include "gltf/model.hpp"
+#include "graphics/occlusion.hpp"
 #include "render/drawdata/light.hpp"
 #include "render/param.hpp"
 #include "render/pipeline.hpp"
+#include "render/shadow-cache.hpp"
+#include "render/statistics.hpp"
 #include "render/target.hpp"
 
 namespace render
@@ -30,15 +33,34 @@ namespace render
 			const Params& params
 		) noexcept;
 
+		///
+		/// @brief Get statistics of the last rendered frame
+		///
+		/// @return Renderer statistics
+		///
+		const Statistics& get_statistics() const noexcept { return statistics; }
+
 	  private:
 
 		Pipeline pipeline;
 		Target target;
 
+		// Initial size of the upload ring, grows when a frame uploads more
+		static constexpr uint32_t initial_upload_ring_capacity = 4 * 1024 * 1024;
+
 		graphics::Buffer_pool buffer_pool;
-		graphics::Transfer_buffer_pool transfer_buffer_pool;
+		graphics::Upload_ring upload_ring;  // Per-frame uploads: joint palettes, instance data
+
+		graphics::Occlusion_culler occlusion_culler;
+		Shadow_cache shadow_cache;
+		Statistics statistics;
 
-		std::expected<std::tuple<drawdata::Gbuffer, drawdata::Shadow>, util::Error> prepare_drawdata(
+		// Persistent across frames, so that drawcall storage is reused
+		drawdata::Gbuffer gbuffer_drawdata;
+		drawdata::Shadow shadow_drawdata;
+
+		std::expected<void, util::Error> prepare_drawdata(
+			SDL_GPUDevice* device,
 			std::span<const gltf::Drawdata> drawdata_list,
 			const Params& params
 		) noexcept;
@@ -48,7 +70,7 @@ namespace render
 			std::span<const gltf::Drawdata> drawdata_list
 		) const noexcept;
 
-		std::expected<void, util::Error> render_gbuffer(
+		std::expected<pipeline::State_cache::Counter, util::Error> render_gbuffer(
 			const gpu::Command_buffer& command_buffer,
 			const drawdata::Gbuffer& gbuffer_drawdata,
 			const Params& params
@@ -110,12 +132,12 @@ namespace render
 			Pipeline pipeline,
 			Target target,
 			graphics::Buffer_pool buffer_pool,
-			graphics::Transfer_buffer_pool transfer_buffer_pool
+			graphics::Upload_ring upload_ring
 		) :
 			pipeline(std::move(pipeline)),
 			target(std::move(target)),
 			buffer_pool(std::move(buffer_pool)),
-			transfer_buffer_pool(std::move(transfer_buffer_pool))
+			upload_ring(std::move(upload_ring))
 		{}
 
 	  public:
@@ -0,0 +1,155 @@
+#pragma once
+
+#include "gltf/material.hpp"
+
+#include <cstdint>
+#include <optional>
+#include <ranges>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace render::drawdata
+{
+	///
+	/// @brief Packed 64-bit draw sort key
+	/// @details Bit layout, from the most significant bit:
+	/// - `[63:60]` Pipeline slot, see `get_pipeline_slot()`
+	/// - `[59:48]` Resource set index
+	/// - `[47:32]` Material index, relative to the resource set
+	/// - `[31:0]` Depth, as an order-preserving bit pattern
+	///
+	/// Sorting by the key groups drawcalls by pipeline, then by model and material, then by depth.
+	///
+	namespace draw_key
+	{
+		constexpr size_t pipeline_slot_count = 16;
+
+		///
+		/// @brief Get the flat pipeline slot of a pipeline mode
+		///
+		/// @param mode Pipeline mode
+		/// @param rigged Whether the pipeline is for rigged primitives
+		/// @return Pipeline slot, less than `pipeline_slot_count`
+		///
+		constexpr uint32_t get_pipeline_slot(const gltf::Pipeline_mode& mode, bool rigged) noexcept
+		{
+			return (static_cast<uint32_t>(mode.alpha_mode) << 2)
+				| (static_cast<uint32_t>(mode.double_sided) << 1)
+				| static_cast<uint32_t>(rigged);
+		}
+
+		///
+		/// @brief Convert a depth value to key bits
+		///
+		/// @param depth Depth value
+		/// @param descending Sort larger depth first
+		/// @return Depth key bits
+		///
+		uint32_t encode_depth(float depth, bool descending) noexcept;
+
+		///
+		/// @brief Pack a draw key
+		///
+		/// @param pipeline_slot Pipeline slot
+		/// @param resource_set_index Resource set index, wraps beyond 12 bits
+		/// @param material_index Material index, wraps beyond 16 bits
+		/// @param depth_bits Depth key bits from `encode_depth()`
+		/// @return Packed key
+		///
+		constexpr uint64_t encode(
+			uint32_t pipeline_slot,
+			size_t resource_set_index,
+			std::optional<uint32_t> material_index,
+			uint32_t depth_bits
+		) noexcept
+		{
+			return (static_cast<uint64_t>(pipeline_slot & 0xF) << 60)
+				| (static_cast<uint64_t>(resource_set_index & 0xFFF) << 48)
+				| (static_cast<uint64_t>(material_index.value_or(0xFFFF) & 0xFFFF) << 32)
+				| static_cast<uint64_t>(depth_bits);
+		}
+
+		///
+		/// @brief Extract the pipeline slot from a key
+		///
+		/// @param key Packed key
+		/// @return Pipeline slot
+		///
+		constexpr uint32_t get_pipeline_slot(uint64_t key) noexcept
+		{
+			return static_cast<uint32_t>(key >> 60);
+		}
+	}
+
+	// Key and item index pair of a draw list
+	struct Sort_entry
+	{
+		uint64_t key;
+		uint32_t index;
+	};
+
+	///
+	/// @brief Sort entries by key with LSD radix sort, stable
+	/// @note Byte passes where all keys share the same digit are skipped
+	///
+	/// @param entries Entries to sort
+	/// @param scratch Scratch buffer, resized to the size of `entries`
+	///
+	void radix_sort(std::vector<Sort_entry>& entries, std::vector<Sort_entry>& scratch) noexcept;
+
+	///
+	/// @brief Flat draw list sorted by packed keys
+	/// @details Storage is kept across `clear()`, so a list reused every frame doesn't allocate in steady
+	/// state.
+	///
+	/// @tparam T Item type
+	///
+	template <typename T>
+	class Draw_list
+	{
+	  public:
+
+		void clear() noexcept
+		{
+			items.clear();
+			entries.clear();
+		}
+
+		void push(uint64_t key, T item) noexcept
+		{
+			entries.push_back(Sort_entry{.key = key, .index = static_cast<uint32_t>(items.size())});
+			items.push_back(std::move(item));
+		}
+
+		void sort() noexcept { radix_sort(entries, scratch); }
+
+		size_t size() const noexcept { return items.size(); }
+
+		bool empty() const noexcept { return items.empty(); }
+
+		// Get an item by its index, see `Sort_entry::index`
+		const T& operator[](uint32_t index) const noexcept { return items[index]; }
+
+		// Get the entries, in sorted order after `sort()`
+		std::span<const Sort_entry> get_entries() const noexcept { return entries; }
+
+		///
+		/// @brief Get a view of (key, item) pairs, in sorted order after `sort()`
+		///
+		/// @return View of `std::pair<uint64_t, const T&>`
+		///
+		auto sorted() const noexcept
+		{
+			return entries | std::views::transform([this](const Sort_entry& entry) {
+					   return std::pair<uint64_t, const T&>(entry.key, items[entry.index]);
+				   });
+		}
+
+	  private:
+
+		std::vector<T> items;
+		std::vector<Sort_entry> entries;
+		std::vector<Sort_entry> scratch;
+	};
+}
\ No newline at end of file
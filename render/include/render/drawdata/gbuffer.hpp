@@ -2,6 +2,11 @@
 
 #include "gltf/material.hpp"
 #include "gltf/model.hpp"
+#include "graphics/occlusion.hpp"
+#include "render/drawdata/draw-list.hpp"
+#include "render/drawdata/instancing.hpp"
+
+#include <optional>
 
 namespace render::drawdata
 {
@@ -11,7 +16,10 @@ namespace render::drawdata
 		{
 			gltf::Primitive_drawcall drawcall;
 			size_t resource_set_index;
-			float max_z;
+
+			// Instances left after per-instance culling, range into `visible_instances`. `nullopt` => All
+			// instances of the drawcall.
+			std::optional<Instance_range> instance_subset = std::nullopt;
 		};
 
 		struct Resource
@@ -20,9 +28,14 @@ namespace render::drawdata
 			std::shared_ptr<gltf::Deferred_skinning_resource> deferred_skinning_resource;
 		};
 
-		std::map<std::pair<gltf::Pipeline_mode, bool>, std::vector<Drawcall>> drawcalls;
+		Draw_list<Drawcall> drawcalls;  // Sorted front to back within each pipeline and material
 		std::vector<Resource> resource_sets;
 
+		std::vector<Instance_batch> batches;  // Instanced draws in draw order, see `batch()`
+		Instance_buffer instances;            // Instance data, indexed by `Instance_batch::instances`
+
+		std::vector<gltf::Primitive_instance> visible_instances;  // Instances kept by per-instance culling
+
 		glm::mat4 camera_matrix;
 		glm::vec3 eye_position;
 		glm::vec3 eye_to_nearplane;
@@ -31,19 +44,37 @@ namespace render::drawdata
 		float min_z = 1;      // Minimum Z value
 		float near_distance;  // Distance from eye to near plane
 
+		uint32_t rigged_tested = 0;  // Rigged drawcalls tested for culling
+		uint32_t rigged_culled = 0;  // Rigged drawcalls culled
+
 		///
-		/// @brief Create drawdata with camera matrix
+		/// @brief Clear all drawcalls and set up the camera for a new frame
+		/// @note Storage is kept for reuse
 		///
 		/// @param camera_matrix Camera matrix
+		/// @param eye_position Eye position
 		///
-		Gbuffer(const glm::mat4& camera_matrix, const glm::vec3& eye_position) noexcept;
+		void reset(const glm::mat4& camera_matrix, const glm::vec3& eye_position) noexcept;
 
 		///
 		/// @brief Add glTF drawdata
 		///
 		/// @param drawdata glTF drawdata
+		/// @param occlusion_culler Rasterized occlusion culler, or `nullptr` to skip occlusion culling
+		/// @param cull_instances Also cull GPU instances one by one, otherwise only their combined bound
 		///
-		void append(const gltf::Drawdata& drawdata) noexcept;
+		void append(
+			const gltf::Drawdata& drawdata,
+			graphics::Occlusion_culler* occlusion_culler = nullptr,
+			bool cull_instances = true
+		) noexcept;
+
+		///
+		/// @brief Get the total number of drawcalls
+		///
+		/// @return Drawcall count
+		///
+		size_t get_drawcall_count() const noexcept;
 
 		///
 		/// @brief Get maximum z depth
@@ -64,5 +95,19 @@ namespace render::drawdata
 		///
 		///
 		void sort() noexcept;
+
+		///
+		/// @brief Group sorted drawcalls into instanced batches, and fill the instance data
+		/// @note Must be called after `sort()`
+		///
+		/// @param merge Merge drawcalls sharing pipeline, material and primitive. Otherwise every drawcall
+		/// becomes its own batch.
+		///
+		void batch(bool merge) noexcept;
+
+	  private:
+
+		Instance_batcher batcher;
+		std::vector<uint32_t> instance_items;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,274 @@
+#pragma once
+
+#include "gltf/model.hpp"
+#include "gpu/buffer.hpp"
+#include "gpu/copy-pass.hpp"
+#include "graphics/affine.hpp"
+#include "graphics/util/upload-ring.hpp"
+#include "render/drawdata/draw-list.hpp"
+#include "util/error.hpp"
+
+#include <SDL3/SDL_gpu.h>
+#include <cstdint>
+#include <expected>
+#include <functional>
+#include <glm/glm.hpp>
+#include <memory>
+#include <optional>
+#include <ranges>
+#include <span>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+namespace render::drawdata
+{
+	// Per-instance data, std430 layout of `Instance` in the glTF vertex shaders
+	struct alignas(16) Instance_data
+	{
+		graphics::Affine_matrix model;  // `mat3x4` in the shaders
+		float emissive_multiplier;
+		float padding[3];
+
+		///
+		/// @brief Get the instance data of a drawcall
+		///
+		/// @param drawcall Primitive drawcall
+		/// @param model Model matrix of the instance
+		/// @return Instance data
+		///
+		static Instance_data from(const gltf::Primitive_drawcall& drawcall, const glm::mat4& model) noexcept;
+	};
+
+	static_assert(sizeof(Instance_data) == 64);
+
+	// Range of instances in an instance buffer
+	struct Instance_range
+	{
+		uint32_t first;
+		uint32_t count;
+	};
+
+	// Instanced draw of drawcalls sharing pipeline, material and primitive
+	struct Instance_batch
+	{
+		uint64_t key;         // Draw key of the first drawcall
+		uint32_t item_index;  // Draw list item of the first drawcall, provides primitive and material
+		Instance_range instances;
+	};
+
+	// Geometry identity of a primitive, drawcalls are only merged if these are equal
+	struct Instance_key
+	{
+		SDL_GPUBuffer* vertex_buffer;
+		int32_t vertex_offset;
+		SDL_GPUBuffer* index_buffer;
+		uint32_t first_index;
+		uint32_t index_count;
+
+		bool operator==(const Instance_key&) const noexcept = default;
+
+		///
+		/// @brief Get the instance key of a primitive
+		///
+		/// @param primitive Primitive binding
+		/// @param shadow Use the position-only shadow buffers
+		/// @return Instance key
+		///
+		static Instance_key from(const gltf::Primitive_mesh_binding& primitive, bool shadow) noexcept;
+	};
+
+	///
+	/// @brief Groups sorted draw lists into instanced batches
+	/// @details Drawcalls are merged when the upper 32 bits of their keys (pipeline, resource set and
+	/// material) and their instance keys are equal. Batches are emitted in the order of their first drawcall,
+	/// so the pipeline grouping of the sorted list is kept, and instances within a batch keep the sorted
+	/// order.
+	/// The batcher only keeps lookup storage, which is reused across calls.
+	///
+	class Instance_batcher
+	{
+	  public:
+
+		///
+		/// @brief Append the batches of a sorted draw list
+		///
+		/// @param list Sorted draw list
+		/// @param get_key Get the instance key of an item, `nullopt` => Never merged (e.g. rigged primitives)
+		/// @param batches Output batches, appended. Instance ranges index into `instance_items`.
+		/// @param instance_items Output draw list item indices of all instances, appended
+		///
+		template <typename T, typename F>
+			requires std::is_invocable_r_v<std::optional<Instance_key>, F, const T&>
+		void batch(
+			const Draw_list<T>& list,
+			F&& get_key,
+			std::vector<Instance_batch>& batches,
+			std::vector<uint32_t>& instance_items
+		) noexcept
+		{
+			const auto entries = list.get_entries();
+			const auto first_batch = batches.size();
+
+			lookup.clear();
+			entry_batches.resize(entries.size());
+
+			// Assign entries to batches, counting instances
+
+			for (const auto [entry, entry_batch] : std::views::zip(entries, entry_batches))
+			{
+				const auto key = std::invoke(get_key, list[entry.index]);
+
+				if (key.has_value())
+				{
+					const auto lookup_key = Lookup_key{.run = entry.key >> 32, .instance = *key};
+					const auto [it, inserted] = lookup.try_emplace(lookup_key, batches.size());
+
+					if (!inserted)
+					{
+						entry_batch = it->second;
+						batches[entry_batch].instances.count++;
+						continue;
+					}
+				}
+
+				entry_batch = batches.size();
+				batches.push_back(
+					Instance_batch{
+						.key = entry.key,
+						.item_index = entry.index,
+						.instances = {.first = 0, .count = 1}
+					}
+				);
+			}
+
+			// Allocate instance ranges, then scatter
+
+			auto offset = static_cast<uint32_t>(instance_items.size());
+			for (auto& batch : batches | std::views::drop(first_batch))
+			{
+				batch.instances.first = offset;
+				offset += batch.instances.count;
+				batch.instances.count = 0;
+			}
+
+			instance_items.resize(offset);
+			for (const auto [entry, entry_batch] : std::views::zip(entries, entry_batches))
+			{
+				auto& range = batches[entry_batch].instances;
+				instance_items[range.first + range.count++] = entry.index;
+			}
+		}
+
+	  private:
+
+		struct Lookup_key
+		{
+			uint64_t run;
+			Instance_key instance;
+
+			bool operator==(const Lookup_key&) const noexcept = default;
+		};
+
+		struct Lookup_hash
+		{
+			size_t operator()(const Lookup_key& key) const noexcept;
+		};
+
+		std::unordered_map<Lookup_key, size_t, Lookup_hash> lookup;
+		std::vector<size_t> entry_batches;
+	};
+
+	///
+	/// @brief Per-frame instance data and its GPU storage buffer
+	/// @details Filled on the CPU, then uploaded through the buffer pools like the deferred skinning buffers.
+	///
+	class Instance_buffer
+	{
+	  public:
+
+		void clear() noexcept { instances.clear(); }
+
+		///
+		/// @brief Push the instance data of a drawcall
+		///
+		/// @param drawcall Primitive drawcall
+		/// @param drawcall_instances GPU instances to draw, empty => A single instance at the world transform
+		///
+		void push(
+			const gltf::Primitive_drawcall& drawcall,
+			std::span<const gltf::Primitive_instance> drawcall_instances
+		) noexcept;
+
+		///
+		/// @brief Fill the instance data of batches from `Instance_batcher`
+		/// @details Ranges are rewritten from ranges of `instance_items` to ranges of the instance data, as a
+		/// drawcall may carry several GPU instances.
+		///
+		/// @param batches Batches to fill
+		/// @param instance_items Draw list item indices from the batcher
+		/// @param push_item Push the instance data of a draw list item, see `push()`
+		///
+		template <typename F>
+			requires std::is_invocable_v<F, uint32_t>
+		void fill(
+			std::span<Instance_batch> batches,
+			std::span<const uint32_t> instance_items,
+			F&& push_item
+		) noexcept
+		{
+			for (auto& batch : batches)
+			{
+				const auto first = static_cast<uint32_t>(instances.size());
+				for (const auto item : instance_items.subspan(batch.instances.first, batch.instances.count))
+					std::invoke(push_item, item);
+
+				batch.instances = {.first = first, .count = static_cast<uint32_t>(instances.size()) - first};
+			}
+		}
+
+		size_t size() const noexcept { return instances.size(); }
+
+		///
+		/// @brief Write the instance data to the upload ring, and grow the storage buffer if needed
+		/// @note The storage buffer persists across frames and only grows, to the next power of two
+		///
+		/// @param device GPU device, for growing the storage buffer
+		/// @param upload_ring Upload ring of the frame
+		/// @return Void on success, or error on failure
+		///
+		std::expected<void, util::Error> prepare_gpu_buffers(
+			SDL_GPUDevice* device,
+			graphics::Upload_ring& upload_ring
+		) noexcept;
+
+		///
+		/// @brief Upload the instance data to the storage buffer
+		///
+		/// @param copy_pass Copy pass
+		///
+		void upload_gpu_buffers(const gpu::Copy_pass& copy_pass) const noexcept;
+
+		///
+		/// @brief Get the storage buffer
+		///
+		/// @return Storage buffer, or `nullptr` if there are no instances
+		///
+		const gpu::Buffer* get_buffer() const noexcept
+		{
+			return upload_allocation.has_value() ? &*buffer : nullptr;
+		}
+
+		// Get the number of storage buffers created by the last `prepare_gpu_buffers()`, 0 or 1
+		uint32_t get_created_buffer_count() const noexcept { return created_buffer_count; }
+
+	  private:
+
+		std::vector<Instance_data> instances;
+		std::optional<graphics::Upload_ring::Allocation> upload_allocation;
+
+		std::optional<gpu::Buffer> buffer;  // Persistent, holds `buffer_capacity` bytes
+		uint32_t buffer_capacity = 0;
+		uint32_t created_buffer_count = 0;
+	};
+}
\ No newline at end of file
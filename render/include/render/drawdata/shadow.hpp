@@ -3,6 +3,9 @@
 #include "gltf/material.hpp"
 #include "gltf/model.hpp"
 #include "graphics/smallest-bound.hpp"
+#include "render/drawdata/draw-list.hpp"
+#include "render/drawdata/instancing.hpp"
+#include "render/shadow-cache.hpp"
 
 namespace render::drawdata
 {
@@ -12,7 +15,6 @@ namespace render::drawdata
 		{
 			gltf::Primitive_drawcall drawcall;
 			size_t resource_set_index;
-			float min_z;
 		};
 
 		struct Resource
@@ -21,39 +23,85 @@ namespace render::drawdata
 			std::shared_ptr<gltf::Deferred_skinning_resource> deferred_skinning_resource;
 		};
 
+		// Caster candidate inside the side planes of a cascade, before receiver-aware culling
+		struct Caster
+		{
+			gltf::Primitive_drawcall drawcall;
+			size_t resource_set_index;
+			glm::vec3 light_min, light_max;  // Bound in light view space
+		};
+
 		struct CSM_level_data
 		{
-			std::map<std::pair<gltf::Pipeline_mode, bool>, std::vector<Drawcall>> drawcalls;
+			Draw_list<Drawcall> drawcalls;          // Static casters
+			Draw_list<Drawcall> dynamic_drawcalls;  // Dynamic casters, composited on top of the static cache
+			std::vector<Instance_batch> batches;          // Instanced draws of `drawcalls`
+			std::vector<Instance_batch> dynamic_batches;  // Instanced draws of `dynamic_drawcalls`
 			std::vector<Resource> resource_sets;
+			std::vector<Caster> candidates;
 
 			graphics::Smallest_bound smallest_bound;
-			std::array<glm::vec4, 4> frustum_planes;
+			std::array<glm::vec4, 4> frustum_planes;   // Side planes of the cascade box
+			std::array<glm::vec4, 6> receiver_planes;  // Planes of the camera sub-frustum
+
+			// Light view space bound of the camera sub-frustum
+			glm::vec3 subfrustum_min, subfrustum_max;
+
+			// Light view space bound of receivers visible in the camera sub-frustum
+			glm::vec3 receiver_min = glm::vec3(std::numeric_limits<float>::max());
+			glm::vec3 receiver_max = glm::vec3(std::numeric_limits<float>::lowest());
 
 			float near = std::numeric_limits<float>::max();
 			float far = std::numeric_limits<float>::lowest();
 
+			size_t candidate_count = 0;  // Casters inside the side planes
+			size_t kept_count = 0;       // Casters kept after receiver-aware culling
+
+			uint64_t static_signature = 0;  // Signature of the kept static casters
+
+			// Cache plan, `nullopt` => Caching disabled, render all casters into the shadow map directly
+			std::optional<Shadow_cache::Level_plan> cache_plan = std::nullopt;
+
+			// Clear all per-frame data, keeping storage
+			void clear() noexcept;
+
 			void append(const gltf::Drawdata& drawdata) noexcept;
 
+			// Keep only casters whose shadow, extruded along the light, can reach a visible receiver.
+			// Near/far are fitted to the kept casters.
+			void cull_casters() noexcept;
+
 			glm::mat4 get_vp_matrix() const noexcept;
 
+			Shadow_cache::Level_key get_cache_key() const noexcept;
+
 			void sort() noexcept;
 		};
 
-		std::array<CSM_level_data, 3> csm_levels;
+		// Ratio between quantized shadow distance steps
+		static constexpr float distance_step_ratio = 1.25f;
+
+		std::vector<CSM_level_data> csm_levels;
+		glm::vec3 light_direction;
+
+		Instance_buffer instances;  // Instance data of all cascades, indexed by `Instance_batch::instances`
 
 		///
-		/// @brief Create a drawdata for shadow rendering
+		/// @brief Clear all drawcalls and fit the cascades for a new frame
+		/// @note Storage is kept for reuse
 		///
 		/// @param camera_matrix Camera matrix
 		/// @param light_direction Light direction
 		/// @param min_z Minimum Z in view space
 		/// @param linear_blend_ratio Linear blend ratio for CSM levels
+		/// @param level_resolutions Shadow map resolution of each CSM level, also defines the level count
 		///
-		Shadow(
+		void reset(
 			const glm::mat4& camera_matrix,
 			const glm::vec3& light_direction,
 			float min_z,
-			float linear_blend_ratio
+			float linear_blend_ratio,
+			std::span<const uint32_t> level_resolutions
 		) noexcept;
 
 		///
@@ -63,6 +111,21 @@ namespace render::drawdata
 		///
 		void append(const gltf::Drawdata& drawdata) noexcept;
 
+		///
+		/// @brief Cull casters that can't shadow any visible receiver
+		/// @note Must be called after all drawdata is appended, and before rendering
+		///
+		void cull_casters() noexcept;
+
+		///
+		/// @brief Look up the static shadow cache, and record the plan of each cascade
+		/// @note Must be called after `cull_casters()`. Without it, all casters are rendered directly. The
+		/// plan is committed to the cache by the renderer once the shadow pass is recorded.
+		///
+		/// @param cache Shadow cache
+		///
+		void apply_cache(Shadow_cache& cache) noexcept;
+
 		///
 		/// @brief Compute view-projection matrix
 		///
@@ -76,5 +139,21 @@ namespace render::drawdata
 		///
 		///
 		void sort() noexcept;
+
+		///
+		/// @brief Group sorted drawcalls of all cascades into instanced batches, and fill the instance data
+		/// @note Must be called after `sort()`
+		///
+		/// @param merge Merge drawcalls sharing pipeline, material and primitive. Otherwise every drawcall
+		/// becomes its own batch.
+		///
+		void batch(bool merge) noexcept;
+
+	  private:
+
+		Instance_batcher batcher;
+		std::vector<uint32_t> instance_items;
+		std::vector<float> z_series;                      // CSM split depths, `reset()` scratch
+		std::vector<Shadow_cache::Level_key> cache_keys;  // Cascade states, `apply_cache()` scratch
 	};
 }
\ No newline at end of file
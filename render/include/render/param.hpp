@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <glm/glm.hpp>
 
 namespace render
@@ -43,6 +44,7 @@ namespace render
 	struct Shadow_params
 	{
 		float csm_linear_blend = 0.56;
+		uint32_t csm_level_count = 3;  // Clamped to [1, target::Shadow::max_levels]
 	};
 
 	struct Sky_params
@@ -56,6 +58,10 @@ namespace render
 	{
 		bool ssgi = true;
 		bool use_bloom_mask = true;
+		bool occlusion_culling = true;
+		bool shadow_cache = true;
+		bool instancing = true;
+		bool instance_culling = true;
 	};
 
 	struct Params
@@ -61,12 +61,17 @@ namespace render
 	///
 	/// @param command_buffer Command Buffer
 	/// @param shadow_target Shadow Target
+	/// @param level CSM level index
+	/// @param static_cache Render into the static cache texture instead of the shadow map
+	/// @param clear Clear the depth texture, otherwise load the existing content
 	/// @return Acquired Render Pass
 	///
 	std::expected<gpu::Render_pass, util::Error> acquire_shadow_pass(
 		const gpu::Command_buffer& command_buffer,
 		const target::Shadow& shadow_target,
-		size_t level
+		size_t level,
+		bool static_cache = false,
+		bool clear = true
 	) noexcept;
 
 	///
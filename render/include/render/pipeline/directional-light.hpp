@@ -5,6 +5,7 @@
 #include "render/target/gbuffer.hpp"
 #include "render/target/shadow.hpp"
 
+#include <array>
 #include <glm/glm.hpp>
 
 namespace render::pipeline
@@ -16,12 +17,11 @@ namespace render::pipeline
 		struct Params
 		{
 			glm::mat4 camera_matrix_inv;
-			glm::mat4 shadow_matrix_level0;
-			glm::mat4 shadow_matrix_level1;
-			glm::mat4 shadow_matrix_level2;
+			std::array<glm::mat4, target::Shadow::max_levels> shadow_matrices;
 			alignas(16) glm::vec3 eye_position;
 			alignas(16) glm::vec3 light_direction;
 			alignas(16) glm::vec3 light_color;  // in reference luminance
+			uint32_t shadow_level_count;
 		};
 
 		static std::expected<Directional_light, util::Error> create(SDL_GPUDevice* device) noexcept;
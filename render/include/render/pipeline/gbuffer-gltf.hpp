@@ -9,14 +9,18 @@
 #include "render/drawdata/gbuffer.hpp"
 #include "render/pipeline/gltf-pipeline.hpp"
 
+#include <array>
 #include <expected>
 
 namespace render::pipeline
 {
 	class Gbuffer_gltf
 	{
-		// (Pipeline Mode, Rigged) -> Pipeline Instance
-		std::map<std::pair<gltf::Pipeline_mode, bool>, std::unique_ptr<Gltf_pipeline>> pipelines;
+		// Pipeline slot -> Pipeline Instance, see `drawdata::draw_key::get_pipeline_slot()`
+		using Pipeline_table =
+			std::array<std::unique_ptr<Gltf_pipeline>, drawdata::draw_key::pipeline_slot_count>;
+
+		Pipeline_table pipelines;
 
 		struct alignas(64) Frag_param
 		{
@@ -31,15 +35,16 @@ namespace render::pipeline
 			static Frag_param from(const gltf::Material_params::Factor& factor) noexcept;
 		};
 
-		struct Per_object_param
+		struct Rigged_param
 		{
+			alignas(4) uint32_t joint_matrix_offset;
 			alignas(4) float emissive_multiplier;
 
-			static Per_object_param from(const gltf::Primitive_drawcall& drawcall) noexcept;
+			static Rigged_param from(const gltf::Primitive_drawcall& drawcall) noexcept;
 		};
 
 		Gbuffer_gltf(
-			std::map<std::pair<gltf::Pipeline_mode, bool>, std::unique_ptr<Gltf_pipeline>> pipelines
+			Pipeline_table pipelines
 		) noexcept :
 			pipelines(std::move(pipelines))
 		{}
@@ -61,27 +66,24 @@ namespace render::pipeline
 			Pipeline_normal& operator=(const Pipeline_normal&) = delete;
 			Pipeline_normal& operator=(Pipeline_normal&&) = default;
 
-			void bind(
-				const gpu::Command_buffer& command_buffer,
-				const gpu::Render_pass& render_pass,
-				const glm::mat4& camera_matrix
-			) const noexcept override;
+			void bind(State_cache& state, const glm::mat4& camera_matrix) const noexcept override;
 
-			void set_material(
-				const gpu::Command_buffer& command_buffer,
-				const gpu::Render_pass& render_pass,
-				const gltf::Material_gpu& material
-			) const noexcept override;
+			void set_material(State_cache& state, const gltf::Material_gpu& material) const noexcept override;
 
 			void set_skin(
-				const gpu::Render_pass& render_pass,
+				State_cache& state,
 				const gltf::Deferred_skinning_resource& skinning_resource
 			) const noexcept override;
 
+			void set_instances(
+				State_cache& state,
+				const gpu::Buffer& instance_buffer
+			) const noexcept override;
+
 			void draw(
-				const gpu::Command_buffer& command_buffer,
-				const gpu::Render_pass& render_pass,
-				const gltf::Primitive_drawcall& drawcall
+				State_cache& state,
+				const gltf::Primitive_drawcall& drawcall,
+				const drawdata::Instance_range& instances
 			) const noexcept override;
 		};
 
@@ -102,27 +104,24 @@ namespace render::pipeline
 			Pipeline_rigged& operator=(const Pipeline_rigged&) = delete;
 			Pipeline_rigged& operator=(Pipeline_rigged&&) = default;
 
-			void bind(
-				const gpu::Command_buffer& command_buffer,
-				const gpu::Render_pass& render_pass,
-				const glm::mat4& camera_matrix
-			) const noexcept override;
+			void bind(State_cache& state, const glm::mat4& camera_matrix) const noexcept override;
 
-			void set_material(
-				const gpu::Command_buffer& command_buffer,
-				const gpu::Render_pass& render_pass,
-				const gltf::Material_gpu& material
-			) const noexcept override;
+			void set_material(State_cache& state, const gltf::Material_gpu& material) const noexcept override;
 
 			void set_skin(
-				const gpu::Render_pass& render_pass,
+				State_cache& state,
 				const gltf::Deferred_skinning_resource& skinning_resource
 			) const noexcept override;
 
+			void set_instances(
+				State_cache& state,
+				const gpu::Buffer& instance_buffer
+			) const noexcept override;
+
 			void draw(
-				const gpu::Command_buffer& command_buffer,
-				const gpu::Render_pass& render_pass,
-				const gltf::Primitive_drawcall& drawcall
+				State_cache& state,
+				const gltf::Primitive_drawcall& drawcall,
+				const drawdata::Instance_range& instances
 			) const noexcept override;
 		};
 
@@ -135,7 +134,8 @@ namespace render::pipeline
 
 		static std::expected<Gbuffer_gltf, util::Error> create(SDL_GPUDevice* device) noexcept;
 
-		void render(
+		// Render drawcalls into the G-buffer pass, returns the bind counter of the pass
+		State_cache::Counter render(
 			const gpu::Command_buffer& command_buffer,
 			const gpu::Render_pass& gbuffer_pass,
 			const drawdata::Gbuffer& drawdata
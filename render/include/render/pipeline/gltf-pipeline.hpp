@@ -5,6 +5,8 @@
 #include "gltf/skin.hpp"
 #include "gpu/command-buffer.hpp"
 #include "gpu/render-pass.hpp"
+#include "render/drawdata/instancing.hpp"
+#include "render/pipeline/state-cache.hpp"
 
 namespace render::pipeline
 {
@@ -19,53 +21,52 @@ namespace render::pipeline
 		virtual ~Gltf_pipeline() = default;
 
 		///
-		/// @brief Bind the pipeline to the command buffer and render pass
+		/// @brief Bind the pipeline to the render pass
 		///
-		/// @param command_buffer Command buffer
-		/// @param render_pass Render pass
+		/// @param state State cache of the render pass
 		/// @param camera_matrix Camera matrix
 		///
-		virtual void bind(
-			const gpu::Command_buffer& command_buffer,
-			const gpu::Render_pass& render_pass,
-			const glm::mat4& camera_matrix
-		) const noexcept = 0;
+		virtual void bind(State_cache& state, const glm::mat4& camera_matrix) const noexcept = 0;
 
 		///
 		/// @brief Set a material for the pipeline
 		///
-		/// @param command_buffer Command buffer
-		/// @param render_pass Render pass
+		/// @param state State cache of the render pass
 		/// @param material glTF Material
 		///
-		virtual void set_material(
-			const gpu::Command_buffer& command_buffer,
-			const gpu::Render_pass& render_pass,
-			const gltf::Material_gpu& material
-		) const noexcept = 0;
+		virtual void set_material(State_cache& state, const gltf::Material_gpu& material) const noexcept = 0;
 
 		///
 		/// @brief Set a skinning resource for the pipeline
 		///
-		/// @param render_pass Render pass
+		/// @param state State cache of the render pass
 		/// @param skinning_resource Skinning resource
 		///
 		virtual void set_skin(
-			const gpu::Render_pass& render_pass,
+			State_cache& state,
 			const gltf::Deferred_skinning_resource& skinning_resource
 		) const noexcept = 0;
 
 		///
-		/// @brief Draw the primitive drawcall
+		/// @brief Set the instance storage buffer for the pipeline
+		///
+		/// @param state State cache of the render pass
+		/// @param instance_buffer Instance buffer, see `drawdata::Instance_buffer`
+		///
+		virtual void set_instances(State_cache& state, const gpu::Buffer& instance_buffer) const noexcept = 0;
+
+		///
+		/// @brief Draw the primitive drawcall, instanced
+		/// @note Rigged pipelines are never instanced, and draw the drawcall itself once
 		///
-		/// @param command_buffer Command buffer
-		/// @param render_pass Render pass
-		/// @param drawcall Primitive drawcall
+		/// @param state State cache of the render pass
+		/// @param drawcall Primitive drawcall, the first drawcall of the batch
+		/// @param instances Instance range in the instance buffer
 		///
 		virtual void draw(
-			const gpu::Command_buffer& command_buffer,
-			const gpu::Render_pass& render_pass,
-			const gltf::Primitive_drawcall& drawcall
+			State_cache& state,
+			const gltf::Primitive_drawcall& drawcall,
+			const drawdata::Instance_range& instances
 		) const noexcept = 0;
 	};
 }
\ No newline at end of file
@@ -9,15 +9,21 @@
 #include "render/pipeline/gltf-pipeline.hpp"
 #include "render/target/shadow.hpp"
 
+#include <array>
+#include <span>
+
 namespace render::pipeline
 {
 	class Shadow_gltf
 	{
-		// (Pipeline Mode, Rigged) -> Pipeline Instance
-		std::map<std::pair<gltf::Pipeline_mode, bool>, std::unique_ptr<Gltf_pipeline>> pipelines;
+		// Pipeline slot -> Pipeline Instance, see `drawdata::draw_key::get_pipeline_slot()`
+		using Pipeline_table =
+			std::array<std::unique_ptr<Gltf_pipeline>, drawdata::draw_key::pipeline_slot_count>;
+
+		Pipeline_table pipelines;
 
 		Shadow_gltf(
-			std::map<std::pair<gltf::Pipeline_mode, bool>, std::unique_ptr<Gltf_pipeline>> pipelines
+			Pipeline_table pipelines
 		) noexcept :
 			pipelines(std::move(pipelines))
 		{}
@@ -45,27 +51,24 @@ namespace render::pipeline
 			Pipeline_normal& operator=(const Pipeline_normal&) = delete;
 			Pipeline_normal& operator=(Pipeline_normal&&) = default;
 
-			void bind(
-				const gpu::Command_buffer& command_buffer,
-				const gpu::Render_pass& render_pass,
-				const glm::mat4& camera_matrix
-			) const noexcept override;
+			void bind(State_cache& state, const glm::mat4& camera_matrix) const noexcept override;
 
-			void set_material(
-				const gpu::Command_buffer& command_buffer,
-				const gpu::Render_pass& render_pass,
-				const gltf::Material_gpu& material
-			) const noexcept override;
+			void set_material(State_cache& state, const gltf::Material_gpu& material) const noexcept override;
 
 			void set_skin(
-				const gpu::Render_pass& render_pass,
+				State_cache& state,
 				const gltf::Deferred_skinning_resource& skinning_resource
 			) const noexcept override;
 
+			void set_instances(
+				State_cache& state,
+				const gpu::Buffer& instance_buffer
+			) const noexcept override;
+
 			void draw(
-				const gpu::Command_buffer& command_buffer,
-				const gpu::Render_pass& render_pass,
-				const gltf::Primitive_drawcall& drawcall
+				State_cache& state,
+				const gltf::Primitive_drawcall& drawcall,
+				const drawdata::Instance_range& instances
 			) const noexcept override;
 		};
 
@@ -86,30 +89,35 @@ namespace render::pipeline
 			Pipeline_rigged& operator=(const Pipeline_rigged&) = delete;
 			Pipeline_rigged& operator=(Pipeline_rigged&&) = default;
 
-			void bind(
-				const gpu::Command_buffer& command_buffer,
-				const gpu::Render_pass& render_pass,
-				const glm::mat4& camera_matrix
-			) const noexcept override;
+			void bind(State_cache& state, const glm::mat4& camera_matrix) const noexcept override;
 
-			void set_material(
-				const gpu::Command_buffer& command_buffer,
-				const gpu::Render_pass& render_pass,
-				const gltf::Material_gpu& material
-			) const noexcept override;
+			void set_material(State_cache& state, const gltf::Material_gpu& material) const noexcept override;
 
 			void set_skin(
-				const gpu::Render_pass& render_pass,
+				State_cache& state,
 				const gltf::Deferred_skinning_resource& skinning_resource
 			) const noexcept override;
 
+			void set_instances(
+				State_cache& state,
+				const gpu::Buffer& instance_buffer
+			) const noexcept override;
+
 			void draw(
-				const gpu::Command_buffer& command_buffer,
-				const gpu::Render_pass& render_pass,
-				const gltf::Primitive_drawcall& drawcall
+				State_cache& state,
+				const gltf::Primitive_drawcall& drawcall,
+				const drawdata::Instance_range& instances
 			) const noexcept override;
 		};
 
+		void render_drawcalls(
+			State_cache& state,
+			const drawdata::Shadow::CSM_level_data& level_data,
+			const drawdata::Draw_list<drawdata::Shadow::Drawcall>& drawcalls,
+			std::span<const drawdata::Instance_batch> batches,
+			const gpu::Buffer* instance_buffer
+		) const noexcept;
+
 	  public:
 
 		Shadow_gltf(const Shadow_gltf&) = delete;
@@ -119,7 +127,8 @@ namespace render::pipeline
 
 		static std::expected<Shadow_gltf, util::Error> create(SDL_GPUDevice* device) noexcept;
 
-		std::expected<void, util::Error> render(
+		// Render all cascades, returns the bind counter summed over all shadow passes
+		std::expected<State_cache::Counter, util::Error> render(
 			const gpu::Command_buffer& command_buffer,
 			const target::Shadow& shadow_target,
 			const drawdata::Shadow& drawdata
@@ -0,0 +1,280 @@
+#pragma once
+
+#include "gpu/command-buffer.hpp"
+#include "gpu/render-pass.hpp"
+
+#include <SDL3/SDL_gpu.h>
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <utility>
+
+namespace render::pipeline
+{
+	///
+	/// @brief Redundant state filter between glTF pipelines and a render pass
+	/// @details Forwards binds and uniform pushes to the command buffer and render pass, skipping those
+	/// identical to the last ones issued. Uniform and binding slots are compared by content, so consecutive
+	/// drawcalls sharing a material or a skin don't rebind anything. Binding a different pipeline drops all
+	/// cached state. Calls that pass the filter go to a `State_cache::Target`, by default one wrapping a
+	/// command buffer and a render pass.
+	///
+	class State_cache
+	{
+	  public:
+
+		///
+		/// @brief Receiver of the binds, uniform pushes and draws let through by a State_cache
+		///
+		class Target
+		{
+		  public:
+
+			virtual ~Target() = default;
+
+			virtual void bind_pipeline(SDL_GPUGraphicsPipeline* pipeline) noexcept = 0;
+			virtual void push_uniform_to_vertex(uint32_t slot, std::span<const std::byte> data) noexcept = 0;
+			virtual void push_uniform_to_fragment(
+				uint32_t slot,
+				std::span<const std::byte> data
+			) noexcept = 0;
+			virtual void bind_fragment_samplers(
+				uint32_t first_slot,
+				std::span<const SDL_GPUTextureSamplerBinding> bindings
+			) noexcept = 0;
+			virtual void bind_vertex_storage_buffer(uint32_t slot, SDL_GPUBuffer* buffer) noexcept = 0;
+			virtual void bind_vertex_buffer(uint32_t slot, const SDL_GPUBufferBinding& binding) noexcept = 0;
+			virtual void bind_index_buffer(
+				const SDL_GPUBufferBinding& binding,
+				SDL_GPUIndexElementSize element_size
+			) noexcept = 0;
+			virtual void set_stencil_reference(uint8_t reference) noexcept = 0;
+			virtual void draw_indexed(
+				uint32_t index_count,
+				uint32_t index_offset,
+				uint32_t instance_count,
+				uint32_t instance_offset,
+				int32_t vertex_offset
+			) noexcept = 0;
+		};
+
+		struct Counter
+		{
+			uint32_t issued = 0;   // Binds and uniform pushes forwarded to the GPU
+			uint32_t skipped = 0;  // Binds and uniform pushes filtered as redundant
+
+			Counter& operator+=(const Counter& other) noexcept
+			{
+				issued += other.issued;
+				skipped += other.skipped;
+				return *this;
+			}
+		};
+
+		///
+		/// @brief Create a state cache forwarding to a custom target
+		///
+		/// @param target Target receiving the filtered calls, must outlive the cache
+		///
+		explicit State_cache(Target& target) noexcept :
+			target(target)
+		{}
+
+		///
+		/// @brief Create a state cache forwarding to a command buffer and a render pass
+		///
+		/// @param command_buffer Command buffer receiving uniform pushes
+		/// @param render_pass Render pass receiving binds and draws
+		///
+		State_cache(const gpu::Command_buffer& command_buffer, const gpu::Render_pass& render_pass) noexcept :
+			pass_target(std::in_place, command_buffer, render_pass),
+			target(*pass_target)
+		{}
+
+		State_cache(const State_cache&) = delete;
+		State_cache(State_cache&&) = delete;
+		State_cache& operator=(const State_cache&) = delete;
+		State_cache& operator=(State_cache&&) = delete;
+
+		///
+		/// @brief Bind a graphics pipeline, dropping all cached state if it differs from the bound one
+		///
+		/// @param pipeline Graphics pipeline
+		///
+		void bind_pipeline(SDL_GPUGraphicsPipeline* pipeline) noexcept;
+
+		///
+		/// @brief Push uniform data to the vertex shader
+		///
+		/// @param slot Slot
+		/// @param data Data byte span
+		///
+		void push_uniform_to_vertex(uint32_t slot, std::span<const std::byte> data) noexcept;
+
+		///
+		/// @brief Push uniform data to the fragment shader
+		///
+		/// @param slot Slot
+		/// @param data Data byte span
+		///
+		void push_uniform_to_fragment(uint32_t slot, std::span<const std::byte> data) noexcept;
+
+		///
+		/// @brief Bind samplers for the fragment shader
+		///
+		/// @param first_slot First binding slot
+		/// @param bindings Sampler binding information
+		///
+		void bind_fragment_samplers(
+			uint32_t first_slot,
+			std::span<const SDL_GPUTextureSamplerBinding> bindings
+		) noexcept;
+
+		///
+		/// @brief Bind some fragment samplers
+		///
+		/// @param first_slot First binding slot
+		/// @param bindings Binding packs, the first one is bound to first_slot, and so on
+		///
+		template <std::convertible_to<SDL_GPUTextureSamplerBinding>... Args>
+			requires(sizeof...(Args) > 0)
+		void bind_fragment_samplers(uint32_t first_slot, Args&&... bindings) noexcept
+		{
+			const std::array<SDL_GPUTextureSamplerBinding, sizeof...(bindings)> binding_arr = {
+				std::forward<Args>(bindings)...
+			};
+			bind_fragment_samplers(first_slot, binding_arr);
+		}
+
+		///
+		/// @brief Bind a storage buffer for the vertex shader
+		///
+		/// @param slot Binding slot
+		/// @param buffer Buffer
+		///
+		void bind_vertex_storage_buffer(uint32_t slot, SDL_GPUBuffer* buffer) noexcept;
+
+		///
+		/// @brief Bind a vertex buffer
+		///
+		/// @param slot Binding slot
+		/// @param binding Binding information
+		///
+		void bind_vertex_buffer(uint32_t slot, const SDL_GPUBufferBinding& binding) noexcept;
+
+		///
+		/// @brief Bind an index buffer
+		///
+		/// @param binding Buffer information
+		/// @param element_size Size of index elements in the buffer
+		///
+		void bind_index_buffer(
+			const SDL_GPUBufferBinding& binding,
+			SDL_GPUIndexElementSize element_size
+		) noexcept;
+
+		///
+		/// @brief Set the stencil reference value
+		///
+		/// @param reference Stencil reference
+		///
+		void set_stencil_reference(uint8_t reference) noexcept;
+
+		///
+		/// @brief Draw indexed primitives, always forwarded
+		///
+		void draw_indexed(
+			uint32_t index_count,
+			uint32_t index_offset,
+			uint32_t instance_count,
+			uint32_t instance_offset,
+			int32_t vertex_offset
+		) const noexcept;
+
+		///
+		/// @brief Get the bind counter since construction
+		///
+		/// @return Issued and skipped counts
+		///
+		const Counter& get_counter() const noexcept { return counter; }
+
+	  private:
+
+		static constexpr size_t uniform_slot_count = 4;
+		static constexpr size_t uniform_capacity = 128;
+		static constexpr size_t sampler_slot_count = 8;
+		static constexpr size_t buffer_slot_count = 4;
+
+		struct Uniform_slot
+		{
+			std::array<std::byte, uniform_capacity> data;
+			size_t size = 0;  // 0 => Unknown
+		};
+
+		// Target forwarding to a command buffer and a render pass
+		class Pass_target final : public Target
+		{
+		  public:
+
+			Pass_target(
+				const gpu::Command_buffer& command_buffer,
+				const gpu::Render_pass& render_pass
+			) noexcept :
+				command_buffer(command_buffer),
+				render_pass(render_pass)
+			{}
+
+			void bind_pipeline(SDL_GPUGraphicsPipeline* pipeline) noexcept override;
+			void push_uniform_to_vertex(uint32_t slot, std::span<const std::byte> data) noexcept override;
+			void push_uniform_to_fragment(uint32_t slot, std::span<const std::byte> data) noexcept override;
+			void bind_fragment_samplers(
+				uint32_t first_slot,
+				std::span<const SDL_GPUTextureSamplerBinding> bindings
+			) noexcept override;
+			void bind_vertex_storage_buffer(uint32_t slot, SDL_GPUBuffer* buffer) noexcept override;
+			void bind_vertex_buffer(uint32_t slot, const SDL_GPUBufferBinding& binding) noexcept override;
+			void bind_index_buffer(
+				const SDL_GPUBufferBinding& binding,
+				SDL_GPUIndexElementSize element_size
+			) noexcept override;
+			void set_stencil_reference(uint8_t reference) noexcept override;
+			void draw_indexed(
+				uint32_t index_count,
+				uint32_t index_offset,
+				uint32_t instance_count,
+				uint32_t instance_offset,
+				int32_t vertex_offset
+			) noexcept override;
+
+		  private:
+
+			const gpu::Command_buffer& command_buffer;
+			const gpu::Render_pass& render_pass;
+		};
+
+		std::optional<Pass_target> pass_target;
+		Target& target;
+
+		SDL_GPUGraphicsPipeline* pipeline = nullptr;
+		std::array<Uniform_slot, uniform_slot_count> vertex_uniforms;
+		std::array<Uniform_slot, uniform_slot_count> fragment_uniforms;
+		std::array<std::optional<SDL_GPUTextureSamplerBinding>, sampler_slot_count> fragment_samplers;
+		std::array<SDL_GPUBuffer*, buffer_slot_count> vertex_storage_buffers{};
+		std::array<std::optional<SDL_GPUBufferBinding>, buffer_slot_count> vertex_buffers;
+		std::optional<std::pair<SDL_GPUBufferBinding, SDL_GPUIndexElementSize>> index_buffer;
+		std::optional<uint8_t> stencil_reference;
+
+		Counter counter;
+
+		// Count a bind, returns true if it must be issued
+		bool record(bool changed) noexcept;
+
+		// Update a cached uniform slot, returns true if the data changed
+		static bool update_uniform(Uniform_slot& slot, std::span<const std::byte> data) noexcept;
+
+		void invalidate() noexcept;
+	};
+}
\ No newline at end of file
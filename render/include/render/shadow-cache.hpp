@@ -0,0 +1,106 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace render
+{
+	///
+	/// @brief Bookkeeping for cached static shadow cascades
+	/// @details Static casters of each cascade are rendered into a cache texture, which is only regenerated
+	/// when the light direction turns past a threshold, when the fitted bound of the cascade changes, or when
+	/// its static caster set changes. Every other frame the cached depth is reused, and dynamic casters are
+	/// composited on top of a copy of it. This class only decides what to do, and holds no GPU resources.
+	///
+	/// A plan only becomes the cached state once `commit()` confirms the static passes were recorded. A
+	/// frame that is skipped, e.g. while the window is minimized, is planned again the next frame.
+	///
+	class Shadow_cache
+	{
+	  public:
+
+		struct Config
+		{
+			float light_angle_threshold = glm::radians(0.05f);  // Max light direction drift, in radians
+			float bound_tolerance = 1.0f / 4096.0f;             // Max bound drift, relative to the extent
+		};
+
+		// Cascade state of the current frame
+		struct Level_key
+		{
+			glm::mat4 vp_matrix;          // Fitted VP matrix
+			std::array<float, 6> bound;   // Fitted bound: left, right, bottom, top, near, far
+			uint64_t static_signature;    // Signature of the static caster set
+			bool has_dynamic;             // Whether any dynamic caster is present
+		};
+
+		// Work to do for a cascade in the current frame
+		struct Level_plan
+		{
+			bool render_static;   // Re-render static casters into the cache texture
+			bool copy_static;     // Copy the cache texture into the shadow map
+			glm::mat4 vp_matrix;  // VP matrix for rendering dynamic casters and sampling the shadow map
+		};
+
+		explicit Shadow_cache(Config config) noexcept :
+			config(config)
+		{}
+
+		Shadow_cache() noexcept :
+			Shadow_cache(Config())
+		{}
+
+		///
+		/// @brief Plan the cascades of the current frame against the committed cache state
+		/// @note The plan is pending until `commit()`
+		///
+		/// @param light_direction Normalized light direction
+		/// @param levels Cascade states, one per cascade
+		/// @return Plan for each cascade, valid until the next `update()`
+		///
+		std::span<const Level_plan> update(
+			const glm::vec3& light_direction,
+			std::span<const Level_key> levels
+		) noexcept;
+
+		///
+		/// @brief Make the last `update()` the cached state, once its static passes have been recorded
+		///
+		void commit() noexcept;
+
+		///
+		/// @brief Invalidate all cascades, forcing a full re-render on the next update
+		///
+		void invalidate() noexcept;
+
+	  private:
+
+		struct Level_cache
+		{
+			glm::mat4 vp_matrix;
+			std::array<float, 6> bound;
+			uint64_t static_signature;
+			bool had_dynamic;  // Dynamic casters were composited into the shadow map last frame
+		};
+
+		struct State
+		{
+			std::optional<glm::vec3> light_direction;
+			std::vector<std::optional<Level_cache>> levels;
+		};
+
+		Config config;
+
+		State committed;  // Matches the contents of the cache textures
+		State pending;    // Planned by the last `update()`, not yet rendered
+
+		std::vector<Level_plan> plans;  // Plans of the last `update()`, storage kept across frames
+
+		bool bound_changed(const std::array<float, 6>& cached, const std::array<float, 6>& current)
+			const noexcept;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <span>
+
+namespace render
+{
+	// Per-frame renderer statistics, for display and profiling
+	struct Statistics
+	{
+		uint32_t gbuffer_drawcalls = 0;  // G-buffer drawcalls after culling
+		uint32_t gbuffer_draws = 0;      // G-buffer draws issued after instancing
+		uint32_t gbuffer_instances = 0;  // G-buffer instances drawn, including glTF GPU instances
+
+		uint32_t rigged_tested = 0;  // Rigged G-buffer drawcalls tested against the frustum and occluders
+		uint32_t rigged_culled = 0;  // Rigged G-buffer drawcalls culled
+
+		uint32_t joints_uploaded = 0;  // Joint matrices uploaded, only those of drawn skins
+		uint32_t joints_total = 0;     // Joint matrices in all skinning resources
+
+		/* Uploads */
+
+		uint32_t upload_bytes = 0;        // Bytes written to the upload ring
+		uint32_t upload_capacity = 0;     // Size of the upload ring
+		uint32_t upload_fence_waits = 0;  // Blocking waits for frames in flight to free upload ring space
+		uint32_t buffers_created = 0;     // GPU and transfer buffers created for per-frame data
+
+		uint32_t pool_hits = 0;     // Buffer pool acquisitions served from pooled buffers
+		uint32_t pool_misses = 0;   // Buffer pool acquisitions that created a buffer
+		uint64_t pooled_bytes = 0;  // Bytes of idle buffers kept by the buffer pool
+
+		/* Occlusion Culling */
+
+		uint32_t occluder_triangles = 0;  // Occluder triangles rasterized
+		uint32_t occlusion_tested = 0;    // Drawcalls tested against occluders
+		uint32_t occlusion_culled = 0;    // Drawcalls rejected as occluded
+
+		/* Shadow */
+
+		struct Shadow_cascade
+		{
+			uint32_t candidate_casters = 0;  // Casters inside the cascade box
+			uint32_t kept_casters = 0;       // Casters left after receiver-aware culling
+			uint32_t draws = 0;              // Draws after instancing, including cached static casters
+			bool static_cached = false;      // Static casters reused from the cache
+		};
+
+		static constexpr size_t max_shadow_cascades = 4;  // Matches `target::Shadow::max_levels`
+
+		std::array<Shadow_cascade, max_shadow_cascades> shadow_cascades{};
+		uint32_t shadow_cascade_count = 0;  // Cascades in use, the first `shadow_cascade_count` entries
+
+		/* State Cache */
+
+		uint32_t gbuffer_binds_issued = 0;   // G-buffer binds and uniform pushes issued
+		uint32_t gbuffer_binds_skipped = 0;  // G-buffer binds and uniform pushes skipped as redundant
+		uint32_t shadow_binds_issued = 0;    // Shadow binds and uniform pushes issued, all cascades
+		uint32_t shadow_binds_skipped = 0;   // Shadow binds and uniform pushes skipped as redundant
+
+		std::span<const Shadow_cascade> get_shadow_cascades() const noexcept
+		{
+			return std::span(shadow_cascades).first(shadow_cascade_count);
+		}
+	};
+}
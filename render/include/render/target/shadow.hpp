@@ -2,6 +2,7 @@
 
 #include "graphics/util/smart-texture.hpp"
 #include <SDL3/SDL_gpu.h>
+#include <vector>
 
 namespace render::target
 {
@@ -12,8 +13,16 @@ namespace render::target
 	/// Format: `D32@FLOAT`
 	/// - `D32`: 32-bit Floating Point Depth
 	///
+	/// #### Static Depth Texture
+	/// Same format as the depth texture, holds the cached depth of static casters
+	///
+	/// One texture of each kind per CSM level, up to `max_levels`. Level 0 uses the full resolution, level 1
+	/// uses 3/4 of it, and all further levels use 1/2.
+	///
 	struct Shadow
 	{
+		static constexpr size_t max_levels = 4;
+
 		/* Formats */
 
 		// Depth Texture Format
@@ -23,14 +32,46 @@ namespace render::target
 			.usage = {.sampler = true, .depth_stencil_target = true}
 		};
 
+		// Static cache texture format, only rendered and copied from
+		static constexpr gpu::Texture::Format static_depth_format{
+			.type = SDL_GPU_TEXTURETYPE_2D,
+			.format = SDL_GPU_TEXTUREFORMAT_D32_FLOAT,
+			.usage = {.depth_stencil_target = true}
+		};
+
 		/* Textures (CSM) */
 
-		graphics::Auto_texture depth_texture_level0{depth_format, "Shadowmap Level 0 Texture"};
-		graphics::Auto_texture depth_texture_level1{depth_format, "Shadowmap Level 1 Texture"};
-		graphics::Auto_texture depth_texture_level2{depth_format, "Shadowmap Level 2 Texture"};
+		std::vector<graphics::Auto_texture> depth_textures;
+
+		/* Textures (Static Cache) */
+
+		std::vector<graphics::Auto_texture> static_depth_textures;
+
+		Shadow() noexcept;
 
 		/* Resize */
 
-		std::expected<void, util::Error> resize(SDL_GPUDevice* device, glm::u32vec2 size) noexcept;
+		std::expected<void, util::Error> resize(SDL_GPUDevice* device, uint32_t resolution) noexcept;
+
+		///
+		/// @brief Get the shadow map texture of a CSM level
+		///
+		/// @param level CSM level index
+		/// @param static_cache Get the static cache texture instead
+		/// @return Texture, or `nullptr` if the level is invalid
+		///
+		const graphics::Auto_texture* get_level_texture(
+			size_t level,
+			bool static_cache = false
+		) const noexcept;
+
+		///
+		/// @brief Get the resolution of a CSM level
+		///
+		/// @param resolution Resolution of level 0
+		/// @param level CSM level index
+		/// @return Resolution of the level
+		///
+		static uint32_t get_level_resolution(uint32_t resolution, size_t level) noexcept;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,84 @@
+#ifndef _SKINNING_GLSL_
+#define _SKINNING_GLSL_
+
+// Joint palette formats, see `gltf::Skinning_mode`
+#define SKINNING_MODE_MATRIX 0
+#define SKINNING_MODE_DUAL_QUATERNION 1
+
+// Joint palette, 3 vec4 per joint in matrix mode (rows of `graphics::Affine_matrix`),
+// 2 vec4 per joint in dual quaternion mode (real, dual of `graphics::Dual_quaternion`)
+layout(std430, set = 0, binding = 0) readonly buffer Joints
+{
+    vec4 joint_data[];
+};
+
+// Blended skinning transform of a vertex
+struct Skin_transform
+{
+    mat3x4 matrix;  // Matrix mode only
+    vec4 real;      // Dual quaternion mode only
+    vec4 dual;      // Dual quaternion mode only
+};
+
+Skin_transform blend_skin(uvec4 joints, vec4 weights, uint offset, uint mode)
+{
+    Skin_transform skin;
+    skin.matrix = mat3x4(0.0);
+    skin.real = vec4(0.0);
+    skin.dual = vec4(0.0);
+
+    if (mode == SKINNING_MODE_DUAL_QUATERNION)
+    {
+        // Align all rotations to the hemisphere of the first one, `q` and `-q` are the same rotation
+        vec4 pivot = joint_data[(joints.x + offset) * 2];
+
+        for (int i = 0; i < 4; i++)
+        {
+            uint base = (joints[i] + offset) * 2;
+            vec4 joint_real = joint_data[base];
+            float weight = dot(joint_real, pivot) < 0.0 ? -weights[i] : weights[i];
+
+            skin.real += joint_real * weight;
+            skin.dual += joint_data[base + 1] * weight;
+        }
+
+        float inv_length = 1.0 / length(skin.real);
+        skin.real *= inv_length;
+        skin.dual *= inv_length;
+    }
+    else
+    {
+        for (int i = 0; i < 4; i++)
+        {
+            uint base = (joints[i] + offset) * 3;
+            skin.matrix += mat3x4(joint_data[base], joint_data[base + 1], joint_data[base + 2]) * weights[i];
+        }
+    }
+
+    return skin;
+}
+
+// Transform a direction, not normalized
+vec3 skin_vector(Skin_transform skin, uint mode, vec3 v)
+{
+    if (mode == SKINNING_MODE_DUAL_QUATERNION)
+        return v + 2.0 * cross(skin.real.xyz, cross(skin.real.xyz, v) + skin.real.w * v);
+
+    return vec4(v, 0.0) * skin.matrix;
+}
+
+// Transform a position
+vec3 skin_point(Skin_transform skin, uint mode, vec3 p)
+{
+    if (mode == SKINNING_MODE_DUAL_QUATERNION)
+    {
+        // Translation `t = 2 * dual * conjugate(real)`
+        vec3 translation = 2.0
+            * (skin.real.w * skin.dual.xyz - skin.dual.w * skin.real.xyz + cross(skin.real.xyz, skin.dual.xyz));
+        return skin_vector(skin, mode, p) + translation;
+    }
+
+    return vec4(p, 1.0) * skin.matrix;
+}
+
+#endif
\ No newline at end of file
@@ -2,6 +2,10 @@
 
 #version 460
 
+#extension GL_GOOGLE_include_directive : enable
+
+#include "../common/skinning.glsl"
+
 layout(location = 0) in vec3 in_pos;
 layout(location = 1) in vec3 in_normal;
 layout(location = 2) in vec3 in_tangent;
@@ -13,11 +17,7 @@ layout(location = 0) out vec2 out_uv;
 layout(location = 1) out vec3 out_normal;
 layout(location = 2) out vec3 out_tangent;
 layout(location = 3) out vec3 out_bitangent;
-
-layout(std140, set = 0, binding = 0) readonly buffer Joints
-{
-    mat4 joint_matrices[];
-};
+layout(location = 4) flat out float out_emissive_multiplier;
 
 layout(std140, set = 1, binding = 0) uniform Transform
 {
@@ -27,31 +27,30 @@ layout(std140, set = 1, binding = 0) uniform Transform
 layout(std140, set = 1, binding = 1) uniform Joint_param
 {
     uint offset;
+    float emissive_multiplier;
 } joint_params;
 
+layout(std140, set = 1, binding = 2) uniform Skin_param
+{
+    uint mode;  // See `gltf::Skinning_mode`
+} skin_params;
+
 void main()
 {
     out_uv = in_uv;
+    out_emissive_multiplier = joint_params.emissive_multiplier;
 
-    mat4 joint_matrix_0 = joint_matrices[in_joint_indices.x + joint_params.offset];
-    mat4 joint_matrix_1 = joint_matrices[in_joint_indices.y + joint_params.offset];
-    mat4 joint_matrix_2 = joint_matrices[in_joint_indices.z + joint_params.offset];
-    mat4 joint_matrix_3 = joint_matrices[in_joint_indices.w + joint_params.offset];
-
-    mat4 skin_matrix =
-        joint_matrix_0 * in_joint_weights.x +
-            joint_matrix_1 * in_joint_weights.y +
-            joint_matrix_2 * in_joint_weights.z +
-            joint_matrix_3 * in_joint_weights.w;
+    Skin_transform skin =
+        blend_skin(in_joint_indices, in_joint_weights, joint_params.offset, skin_params.mode);
 
-    out_normal = (skin_matrix * vec4(in_normal, 0.0f)).xyz;
+    out_normal = skin_vector(skin, skin_params.mode, in_normal);
     out_normal = normalize(out_normal);
 
-    out_tangent = (skin_matrix * vec4(in_tangent, 0.0f)).xyz;
+    out_tangent = skin_vector(skin, skin_params.mode, in_tangent);
     out_tangent = normalize(out_tangent);
 
     out_bitangent = cross(out_normal, out_tangent);
     out_tangent = cross(out_bitangent, out_normal);
 
-    gl_Position = transform.VP * skin_matrix * vec4(in_pos, 1.0f);
+    gl_Position = transform.VP * vec4(skin_point(skin, skin_params.mode, in_pos), 1.0f);
 }
@@ -11,6 +11,7 @@ layout(location = 0) in vec2 in_uv;
 layout(location = 1) in vec3 in_normal;
 layout(location = 2) in vec3 in_tangent;
 layout(location = 3) in vec3 in_bitangent;
+layout(location = 4) flat in float in_emissive_multiplier;
 
 layout(location = 0) out vec4 out_albedo;
 layout(location = 1) out uvec2 out_light_info;
@@ -33,13 +34,6 @@ layout(std140, set = 3, binding = 0) uniform Material
     float occlusion_strength;
 };
 
-
-layout(std140, set = 3, binding = 1) uniform Perobject
-{
-    float emissive_multiplier;
-};
-
-
 void main()
 {
     /* Texture Fetch */
@@ -81,6 +75,6 @@ void main()
 
     /* Emissive */
 
-    vec3 emissive = emissive_tex_sample * emissive_factor * emissive_multiplier;
+    vec3 emissive = emissive_tex_sample * emissive_factor * in_emissive_multiplier;
     out_light_buffer = vec4(emissive, smoothstep(0.0, 1.0, dot(emissive, vec3(0.2, 0.7, 0.1)) * 3));
 }
@@ -11,29 +11,45 @@ layout(location = 0) out vec2 out_uv;
 layout(location = 1) out vec3 out_normal;
 layout(location = 2) out vec3 out_tangent;
 layout(location = 3) out vec3 out_bitangent;
+layout(location = 4) flat out float out_emissive_multiplier;
+
+struct Instance
+{
+    mat3x4 M;  // Rows of the affine model matrix, transform with `vec4(p, 1.0) * M`
+    float emissive_multiplier;
+};
+
+layout(std430, set = 0, binding = 0) readonly buffer Instances
+{
+    Instance instances[];
+};
 
 layout(std140, set = 1, binding = 0) uniform Transform
 {
     mat4 VP;
 } transform;
 
-layout(std140, set = 1, binding = 1) uniform Model
+layout(std140, set = 1, binding = 1) uniform Instance_param
 {
-    mat4 M;
-} model;
+    uint offset;
+} instance_param;
 
 void main()
 {
+    Instance instance = instances[instance_param.offset + gl_InstanceIndex];
+    mat3x4 M = instance.M;
+
     out_uv = in_uv;
+    out_emissive_multiplier = instance.emissive_multiplier;
 
-    out_normal = (model.M * vec4(in_normal, 0.0f)).xyz;
+    out_normal = vec4(in_normal, 0.0f) * M;
     out_normal = normalize(out_normal);
 
-    out_tangent = (model.M * vec4(in_tangent, 0.0f)).xyz;
+    out_tangent = vec4(in_tangent, 0.0f) * M;
     out_tangent = normalize(out_tangent);
 
     out_bitangent = cross(out_normal, out_tangent);
     out_tangent = cross(out_bitangent, out_normal);
 
-    gl_Position = transform.VP * model.M * vec4(in_pos, 1.0f);
+    gl_Position = transform.VP * vec4(vec4(in_pos, 1.0f) * M, 1.0f);
 }
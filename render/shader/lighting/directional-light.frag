@@ -17,16 +17,18 @@ layout(set = 2, binding = 2) uniform sampler2D depth_tex;
 layout(set = 2, binding = 3) uniform sampler2DShadow shadow_tex_level0;
 layout(set = 2, binding = 4) uniform sampler2DShadow shadow_tex_level1;
 layout(set = 2, binding = 5) uniform sampler2DShadow shadow_tex_level2;
+layout(set = 2, binding = 6) uniform sampler2DShadow shadow_tex_level3;
 
 layout(location = 0) out vec4 out_light_buffer;
 
 layout(std140, set = 3, binding = 0) uniform Param
 {
     mat4 VP_inv;
-    mat4 shadow_VP_levels[3];
+    mat4 shadow_VP_levels[4];
     vec3 eye_position;
     vec3 direction;
     vec3 intensity;
+    uint shadow_level_count;
 };
 
 bool try_csm_level(vec3 world_pos, const uint level, out float shadow_mult)
@@ -52,6 +54,11 @@ bool try_csm_level(vec3 world_pos, const uint level, out float shadow_mult)
             shadow_mult = texture(shadow_tex_level2, vec3(shadow_uv, shadow_clip_space_pos.z + 0.001)).r;
             return true;
         }
+        else if (level == 3)
+        {
+            shadow_mult = texture(shadow_tex_level3, vec3(shadow_uv, shadow_clip_space_pos.z + 0.001)).r;
+            return true;
+        }
         else
             return false;
     }
@@ -86,9 +93,8 @@ void main()
 
     float shadow_mult = 1.0;
 
-    if (!try_csm_level(world_pos.xyz, 0, shadow_mult))
-        if (!try_csm_level(world_pos.xyz, 1, shadow_mult))
-            try_csm_level(world_pos.xyz, 2, shadow_mult);
+    for (uint level = 0; level < shadow_level_count; level++)
+        if (try_csm_level(world_pos.xyz, level, shadow_mult)) break;
 
     /* Color Calculation */
 
@@ -4,17 +4,29 @@
 
 layout(location = 0) in vec3 in_pos;
 
+struct Instance
+{
+    mat3x4 M;  // Rows of the affine model matrix, transform with `vec4(p, 1.0) * M`
+    float emissive_multiplier;
+};
+
+layout(std430, set = 0, binding = 0) readonly buffer Instances
+{
+    Instance instances[];
+};
+
 layout(std140, set = 1, binding = 0) uniform Camera
 {
     mat4 VP;
 } camera;
 
-layout(std140, set = 1, binding = 1) uniform Transform
+layout(std140, set = 1, binding = 1) uniform Instance_param
 {
-    mat4 M;
-} transform;
+    uint offset;
+} instance_param;
 
 void main()
 {
-    gl_Position = camera.VP * transform.M * vec4(in_pos, 1.0f);
+    mat3x4 M = instances[instance_param.offset + gl_InstanceIndex].M;
+    gl_Position = camera.VP * vec4(vec4(in_pos, 1.0f) * M, 1.0f);
 }
@@ -0,0 +1,58 @@
+#include "render/drawdata/draw-list.hpp"
+
+#include <array>
+#include <bit>
+#include <utility>
+
+namespace render::drawdata
+{
+	uint32_t draw_key::encode_depth(float depth, bool descending) noexcept
+	{
+		// Flip the sign bit of positive values and all bits of negative values, so that the unsigned order
+		// matches the float order
+		const auto bits = std::bit_cast<uint32_t>(depth);
+		const auto ordered = (bits & 0x80000000u) != 0 ? ~bits : bits | 0x80000000u;
+
+		return descending ? ~ordered : ordered;
+	}
+
+	void radix_sort(std::vector<Sort_entry>& entries, std::vector<Sort_entry>& scratch) noexcept
+	{
+		constexpr size_t digit_bits = 8;
+		constexpr size_t digit_count = 1 << digit_bits;
+		constexpr size_t pass_count = 64 / digit_bits;
+
+		if (entries.size() <= 1) return;
+
+		scratch.resize(entries.size());
+
+		// Histograms of all passes in one sweep
+		std::array<std::array<uint32_t, digit_count>, pass_count> histograms{};
+		for (const auto& entry : entries)
+			for (size_t pass = 0; pass < pass_count; pass++)
+				histograms[pass][(entry.key >> (pass * digit_bits)) & (digit_count - 1)]++;
+
+		auto* source = &entries;
+		auto* target = &scratch;
+
+		for (size_t pass = 0; pass < pass_count; pass++)
+		{
+			auto& histogram = histograms[pass];
+			const auto shift = pass * digit_bits;
+
+			// All keys share this digit, the pass wouldn't change the order
+			const auto first_digit = ((*source)[0].key >> shift) & (digit_count - 1);
+			if (histogram[first_digit] == source->size()) continue;
+
+			uint32_t offset = 0;
+			for (auto& count : histogram) offset += std::exchange(count, offset);
+
+			for (const auto& entry : *source)
+				(*target)[histogram[(entry.key >> shift) & (digit_count - 1)]++] = entry;
+
+			std::swap(source, target);
+		}
+
+		if (source != &entries) entries.swap(scratch);
+	}
+}
\ No newline at end of file
@@ -3,14 +3,25 @@
 #include "graphics/culling.hpp"
 
 #include <algorithm>
+#include <optional>
 #include <ranges>
 
 namespace render::drawdata
 {
-	Gbuffer::Gbuffer(const glm::mat4& camera_matrix, const glm::vec3& eye_position) noexcept :
-		camera_matrix(camera_matrix),
-		eye_position(eye_position)
+	void Gbuffer::reset(const glm::mat4& camera_matrix, const glm::vec3& eye_position) noexcept
 	{
+		this->camera_matrix = camera_matrix;
+		this->eye_position = eye_position;
+
+		drawcalls.clear();
+		resource_sets.clear();
+		batches.clear();
+		visible_instances.clear();
+		instances.clear();
+		min_z = 1;
+		rigged_tested = 0;
+		rigged_culled = 0;
+
 		frustum_planes = graphics::compute_frustum_planes(camera_matrix);
 
 		glm::vec4 near_plane_pos_homo(0.0, 0.0, 1.0, 1.0);
@@ -20,7 +31,11 @@ namespace render::drawdata
 		eye_to_nearplane = glm::normalize(eye_to_nearplane);
 	}
 
-	void Gbuffer::append(const gltf::Drawdata& drawdata) noexcept
+	void Gbuffer::append(
+		const gltf::Drawdata& drawdata,
+		graphics::Occlusion_culler* occlusion_culler,
+		bool cull_instances
+	) noexcept
 	{
 		const auto current_resource_set_idx = resource_sets.size();
 		resource_sets.emplace_back(
@@ -30,14 +45,22 @@ namespace render::drawdata
 			}
 		);
 
+		const auto box_visible = [this, occlusion_culler](const glm::vec3& min, const glm::vec3& max) {
+			if (!graphics::box_in_frustum(min, max, frustum_planes)) return false;
+			return occlusion_culler == nullptr || !occlusion_culler->is_occluded(min, max);
+		};
+
 		auto visible_nonrigged_drawcalls =
-			drawdata.primitive_drawcalls | std::views::filter([this](const auto& drawcall) -> bool {
-				return graphics::box_in_frustum(
-					drawcall.world_position_min,
-					drawcall.world_position_max,
-					frustum_planes
-				);
-			});
+			drawdata.primitive_drawcalls
+			| std::views::filter([this, &box_visible](const auto& drawcall) -> bool {
+				  const bool visible = box_visible(drawcall.world_position_min, drawcall.world_position_max);
+				  if (drawcall.is_rigged())
+				  {
+					  rigged_tested++;
+					  if (!visible) rigged_culled++;
+				  }
+				  return visible;
+			  });
 
 		/* Process Non-rigged Drawcalls */
 
@@ -54,8 +77,26 @@ namespace render::drawdata
 
 		for (const auto& drawcall : visible_nonrigged_drawcalls)
 		{
+			std::optional<Instance_range> instance_subset;
+			if (cull_instances && !drawcall.instances.empty())
+			{
+				const auto first = static_cast<uint32_t>(visible_instances.size());
+				for (const auto& instance : drawcall.instances)
+					if (box_visible(instance.world_position_min, instance.world_position_max))
+						visible_instances.push_back(instance);
+
+				const auto count = static_cast<uint32_t>(visible_instances.size()) - first;
+				if (count == 0) continue;
+				instance_subset = Instance_range{.first = first, .count = count};
+			}
+
+			if (drawcall.is_rigged() && drawdata.deferred_skin_resource != nullptr)
+				drawdata.deferred_skin_resource->mark_used(
+					drawcall.get_joint_matrix_offset(),
+					drawcall.joint_count
+				);
+
 			const auto& pipeline_mode = drawdata.material_cache[drawcall.material_index].params.pipeline;
-			auto& target = drawcalls[std::pair(pipeline_mode, drawcall.is_rigged())];
 
 			const auto [local_min_z, local_max_z] = std::ranges::minmax(
 				graphics::get_corner_points(drawcall.world_position_min, drawcall.world_position_max)
@@ -66,12 +107,20 @@ namespace render::drawdata
 			);
 			min_z = std::min(local_min_z.z, min_z);
 
-			if (target.empty()) target.reserve(1024);
-			target.emplace_back(
+			// Reversed-Z, larger Z is closer
+			const auto key = draw_key::encode(
+				draw_key::get_pipeline_slot(pipeline_mode, drawcall.is_rigged()),
+				current_resource_set_idx,
+				drawcall.material_index,
+				draw_key::encode_depth(local_max_z.z, true)
+			);
+
+			drawcalls.push(
+				key,
 				Drawcall{
 					.drawcall = drawcall,
 					.resource_set_index = current_resource_set_idx,
-					.max_z = local_max_z.z
+					.instance_subset = instance_subset
 				}
 			);
 		}
@@ -79,8 +128,39 @@ namespace render::drawdata
 
 	void Gbuffer::sort() noexcept
 	{
-		for (auto& drawcalls_vec : drawcalls | std::views::values)
-			std::ranges::sort(drawcalls_vec, std::greater{}, &Drawcall::max_z);
+		drawcalls.sort();
+	}
+
+	void Gbuffer::batch(bool merge) noexcept
+	{
+		batches.clear();
+		instance_items.clear();
+		instances.clear();
+
+		batcher.batch(
+			drawcalls,
+			[merge](const Drawcall& drawcall) -> std::optional<Instance_key> {
+				if (!merge || drawcall.drawcall.is_rigged()) return std::nullopt;
+				return Instance_key::from(drawcall.drawcall.primitive, false);
+			},
+			batches,
+			instance_items
+		);
+
+		instances.fill(batches, instance_items, [this](uint32_t item) {
+			const auto& [drawcall, set_idx, instance_subset] = drawcalls[item];
+			const auto drawcall_instances =
+				instance_subset.has_value()
+				? std::span(visible_instances).subspan(instance_subset->first, instance_subset->count)
+				: drawcall.instances;
+
+			instances.push(drawcall, drawcall_instances);
+		});
+	}
+
+	size_t Gbuffer::get_drawcall_count() const noexcept
+	{
+		return drawcalls.size();
 	}
 
 	float Gbuffer::get_min_z() const noexcept
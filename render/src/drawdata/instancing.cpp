@@ -0,0 +1,128 @@
+#include "render/drawdata/instancing.hpp"
+#include "util/as-byte.hpp"
+
+#include <algorithm>
+#include <bit>
+
+namespace render::drawdata
+{
+	Instance_data Instance_data::from(
+		const gltf::Primitive_drawcall& drawcall,
+		const glm::mat4& model
+	) noexcept
+	{
+		return Instance_data{
+			.model = graphics::Affine_matrix::from(model),
+			.emissive_multiplier = drawcall.emissive_multiplier,
+			.padding = {0, 0, 0}
+		};
+	}
+
+	Instance_key Instance_key::from(const gltf::Primitive_mesh_binding& primitive, bool shadow) noexcept
+	{
+		if (shadow)
+			return Instance_key{
+				.vertex_buffer = primitive.shadow_vertex_buffer_binding.buffer,
+				.vertex_offset = primitive.shadow_vertex_offset,
+				.index_buffer = primitive.shadow_index_buffer_binding.buffer,
+				.first_index = primitive.shadow_first_index,
+				.index_count = primitive.index_count
+			};
+
+		return Instance_key{
+			.vertex_buffer = primitive.vertex_buffer_binding.buffer,
+			.vertex_offset = primitive.vertex_offset,
+			.index_buffer = primitive.index_buffer_binding.buffer,
+			.first_index = primitive.first_index,
+			.index_count = primitive.index_count
+		};
+	}
+
+	size_t Instance_batcher::Lookup_hash::operator()(const Lookup_key& key) const noexcept
+	{
+		// FNV-1a over the fields
+		uint64_t hash = 0xcbf29ce484222325ull;
+		const auto combine = [&hash](uint64_t value) {
+			hash ^= value;
+			hash *= 0x100000001b3ull;
+		};
+
+		combine(key.run);
+		combine(std::bit_cast<uintptr_t>(key.instance.vertex_buffer));
+		combine(std::bit_cast<uint32_t>(key.instance.vertex_offset));
+		combine(std::bit_cast<uintptr_t>(key.instance.index_buffer));
+		combine(key.instance.first_index);
+		combine(key.instance.index_count);
+
+		return static_cast<size_t>(hash);
+	}
+
+	void Instance_buffer::push(
+		const gltf::Primitive_drawcall& drawcall,
+		std::span<const gltf::Primitive_instance> drawcall_instances
+	) noexcept
+	{
+		if (drawcall_instances.empty())
+		{
+			// Rigged pipelines don't read the instance data, only keep the slot
+			const auto model = drawcall.is_rigged() ? glm::mat4(1.0f) : drawcall.get_world_transform();
+			instances.push_back(Instance_data::from(drawcall, model));
+			return;
+		}
+
+		for (const auto& instance : drawcall_instances)
+			instances.push_back(Instance_data::from(drawcall, instance.world_transform));
+	}
+
+	std::expected<void, util::Error> Instance_buffer::prepare_gpu_buffers(
+		SDL_GPUDevice* device,
+		graphics::Upload_ring& upload_ring
+	) noexcept
+	{
+		upload_allocation.reset();
+		created_buffer_count = 0;
+
+		if (instances.empty()) return {};
+
+		const auto size = static_cast<uint32_t>(sizeof(Instance_data) * instances.size());
+
+		if (size > buffer_capacity)
+		{
+			const auto capacity = std::bit_ceil(size);
+
+			auto buffer_result =
+				gpu::Buffer::create(device, {.graphic_storage_read = true}, capacity, "Instance Buffer");
+			if (!buffer_result) return buffer_result.error().forward("Create buffer for instances failed");
+
+			buffer = std::move(*buffer_result);
+			buffer_capacity = capacity;
+			created_buffer_count = 1;
+		}
+
+		const auto instance_bytes = util::as_bytes(instances);
+		auto upload_result =
+			upload_ring.upload(size, alignof(Instance_data), [&instance_bytes](std::span<std::byte> data) {
+				std::ranges::copy(instance_bytes, data.begin());
+			});
+		if (!upload_result)
+			return upload_result.error().forward("Upload instance data to upload ring failed");
+
+		upload_allocation = std::move(*upload_result);
+
+		return {};
+	}
+
+	void Instance_buffer::upload_gpu_buffers(const gpu::Copy_pass& copy_pass) const noexcept
+	{
+		if (!upload_allocation) return;
+
+		copy_pass.upload_to_buffer(
+			*upload_allocation->buffer,
+			upload_allocation->offset,
+			*buffer,
+			0,
+			upload_allocation->size,
+			true
+		);
+	}
+}
\ No newline at end of file
@@ -4,44 +4,84 @@
 #include "graphics/smallest-bound.hpp"
 
 #include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <optional>
 #include <ranges>
+#include <span>
 
 namespace render::drawdata
 {
+	// FNV-1a, folds a trivially copyable value into the hash
+	template <typename T>
+	static void hash_combine(uint64_t& hash, const T& value) noexcept
+	{
+		for (const auto byte : std::as_bytes(std::span(&value, 1)))
+		{
+			hash ^= std::to_integer<uint64_t>(byte);
+			hash *= 0x100000001b3ull;
+		}
+	}
+
 	static glm::vec3 homo_transform(const glm::mat4& mat, const glm::vec3& vec) noexcept
 	{
 		const glm::vec4 homo = mat * glm::vec4(vec, 1.0f);
 		return glm::vec3(homo) / homo.w;
 	}
 
-	Shadow::Shadow(
+	void Shadow::reset(
 		const glm::mat4& camera_matrix,
 		const glm::vec3& light_direction,
 		float min_z,
-		float linear_blend_ratio
+		float linear_blend_ratio,
+		std::span<const uint32_t> level_resolutions
 	) noexcept
 	{
+		this->light_direction = light_direction;
+
+		csm_levels.resize(level_resolutions.size());
+		for (auto& level : csm_levels) level.clear();
+		instances.clear();
+
 		const auto camera_mat_inv = glm::inverse(camera_matrix);
+		const auto level_count = level_resolutions.size();
 
-		// Compute CSM split points
+		// Quantize the shadow distance to coarse steps, so that cascades don't resize with every change of
+		// the visible geometry
 
 		const glm::vec3 near_world_pos = homo_transform(camera_mat_inv, {0, 0, 1}),
-						far_world_pos = homo_transform(camera_mat_inv, {0, 0, min_z});
-		const glm::vec3 linear_split1_world_pos = glm::mix(near_world_pos, far_world_pos, 0.3333),
-						linear_split2_world_pos = glm::mix(near_world_pos, far_world_pos, 0.6667);
-		const float log_split1_z = glm::mix(1.0f, min_z, 0.3333),
-					log_split2_z = glm::mix(1.0f, min_z, 0.6667);
-		const glm::vec3 log_split1_world_pos = homo_transform(camera_mat_inv, {0, 0, log_split1_z}),
-						log_split2_world_pos = homo_transform(camera_mat_inv, {0, 0, log_split2_z});
-		const glm::vec3
-			split1_world_pos = glm::mix(log_split1_world_pos, linear_split1_world_pos, linear_blend_ratio),
-			split2_world_pos = glm::mix(log_split2_world_pos, linear_split2_world_pos, linear_blend_ratio);
-		const float split1_z = homo_transform(camera_matrix, split1_world_pos).z,
-					split2_z = homo_transform(camera_matrix, split2_world_pos).z;
-
-		const std::array<float, 4> z_series = {1.0f, split1_z, split2_z, min_z};
-
-		for (auto [level, z_pair] : std::views::zip(csm_levels, z_series | std::views::adjacent<2>))
+						raw_far_world_pos = homo_transform(camera_mat_inv, {0, 0, min_z});
+		const auto shadow_distance = glm::distance(near_world_pos, raw_far_world_pos);
+		const auto distance_step_count = std::ceil(std::log(shadow_distance) / std::log(distance_step_ratio));
+		const auto quantized_distance = std::pow(distance_step_ratio, distance_step_count);
+
+		const glm::vec3 far_world_pos = shadow_distance > 1e-4f
+			? glm::mix(near_world_pos, raw_far_world_pos, quantized_distance / shadow_distance)
+			: raw_far_world_pos;
+		const float far_z = std::max(homo_transform(camera_matrix, far_world_pos).z, 0.0f);
+
+		// Compute CSM split points
+
+		z_series.clear();
+		z_series.push_back(1.0f);
+
+		for (const auto split_index : std::views::iota(1zu, level_count))
+		{
+			const auto t = float(split_index) / float(level_count);
+
+			const glm::vec3 linear_split_world_pos = glm::mix(near_world_pos, far_world_pos, t),
+							log_split_world_pos =
+								homo_transform(camera_mat_inv, {0, 0, glm::mix(1.0f, far_z, t)});
+			const glm::vec3 split_world_pos =
+				glm::mix(log_split_world_pos, linear_split_world_pos, linear_blend_ratio);
+
+			z_series.push_back(homo_transform(camera_matrix, split_world_pos).z);
+		}
+
+		z_series.push_back(far_z);
+
+		for (auto [level, z_pair, resolution] :
+			 std::views::zip(csm_levels, z_series | std::views::adjacent<2>, level_resolutions))
 		{
 			const auto [z_near, z_far] = z_pair;
 
@@ -50,7 +90,7 @@ namespace render::drawdata
 				camera_mat_inv
 			);
 
-			level.smallest_bound = graphics::find_smallest_bound(corners, light_direction);
+			level.smallest_bound = graphics::find_stable_bound(corners, light_direction, resolution);
 
 			const auto temp_vp_matrix =
 				glm::ortho(
@@ -67,9 +107,48 @@ namespace render::drawdata
 				graphics::compute_frustum_planes(temp_vp_matrix) | std::views::take(4),
 				level.frustum_planes.begin()
 			);
+
+			// Remap [z_far, z_near] of the camera to [-1, 1], then extract the sub-frustum planes
+			auto subfrustum_remap = glm::mat4(1.0f);
+			subfrustum_remap[2][2] = 2.0f / (z_near - z_far);
+			subfrustum_remap[3][2] = -(z_near + z_far) / (z_near - z_far);
+			level.receiver_planes = graphics::compute_frustum_planes(subfrustum_remap * camera_matrix);
+
+			const auto corners_light_view =
+				graphics::transform_corner_points(corners, level.smallest_bound.view_matrix);
+			level.subfrustum_min = std::ranges::fold_left(
+				corners_light_view,
+				glm::vec3(std::numeric_limits<float>::max()),
+				[](const glm::vec3& a, const glm::vec3& b) { return glm::min(a, b); }
+			);
+			level.subfrustum_max = std::ranges::fold_left(
+				corners_light_view,
+				glm::vec3(std::numeric_limits<float>::lowest()),
+				[](const glm::vec3& a, const glm::vec3& b) { return glm::max(a, b); }
+			);
 		}
 	}
 
+	void Shadow::CSM_level_data::clear() noexcept
+	{
+		drawcalls.clear();
+		dynamic_drawcalls.clear();
+		batches.clear();
+		dynamic_batches.clear();
+		resource_sets.clear();
+		candidates.clear();
+
+		receiver_min = glm::vec3(std::numeric_limits<float>::max());
+		receiver_max = glm::vec3(std::numeric_limits<float>::lowest());
+		near = std::numeric_limits<float>::max();
+		far = std::numeric_limits<float>::lowest();
+
+		candidate_count = 0;
+		kept_count = 0;
+		static_signature = 0;
+		cache_plan = std::nullopt;
+	}
+
 	void Shadow::CSM_level_data::append(const gltf::Drawdata& drawdata) noexcept
 	{
 		const auto current_resource_set_idx = resource_sets.size();
@@ -89,36 +168,120 @@ namespace render::drawdata
 				);
 			});
 
-		/* Process Non-rigged Drawcalls */
+		/* Collect Candidates & Receivers */
 
 		for (const auto& drawcall : visible_drawcalls)
 		{
-			const auto& pipeline_mode = drawdata.material_cache[drawcall.material_index].params.pipeline;
-			auto& target = drawcalls[std::pair(pipeline_mode, drawcall.is_rigged())];
+			const auto [light_min, light_max] = graphics::local_bound_to_world(
+				drawcall.world_position_min,
+				drawcall.world_position_max,
+				smallest_bound.view_matrix
+			);
 
-			const auto corners_world =
-				graphics::get_corner_points(drawcall.world_position_min, drawcall.world_position_max);
-			const auto corners_light_view =
-				graphics::transform_corner_points(corners_world, smallest_bound.view_matrix);
+			const bool is_receiver = graphics::box_in_frustum(
+				drawcall.world_position_min,
+				drawcall.world_position_max,
+				receiver_planes
+			);
 
-			const auto [min_z, max_z] = std::ranges::minmax(corners_light_view, {}, &glm::vec3::z);
-			near = std::min(near, -max_z.z);
-			far = std::max(far, -min_z.z);
+			if (is_receiver)
+			{
+				receiver_min = glm::min(receiver_min, light_min);
+				receiver_max = glm::max(receiver_max, light_max);
+			}
 
-			if (target.empty()) target.reserve(1024);
+			if (candidates.empty()) candidates.reserve(1024);
 
-			target.emplace_back(
-				Drawcall{
+			candidates.emplace_back(
+				Caster{
 					.drawcall = drawcall,
 					.resource_set_index = current_resource_set_idx,
-					.min_z = -min_z.z
+					.light_min = light_min,
+					.light_max = light_max
 				}
 			);
 		}
 	}
 
+	void Shadow::CSM_level_data::cull_casters() noexcept
+	{
+		// Receivers clipped to the cascade. Light comes from -Z in light view space, so a caster can only
+		// shadow the receivers if it overlaps them in XY and reaches above the lowest receiver point.
+		const auto clipped_receiver_min = glm::max(receiver_min, subfrustum_min);
+		const auto clipped_receiver_max = glm::min(receiver_max, subfrustum_max);
+
+		const auto shadows_receivers = [&clipped_receiver_min, &clipped_receiver_max](const Caster& caster) {
+			return caster.light_min.x <= clipped_receiver_max.x
+				&& caster.light_max.x >= clipped_receiver_min.x
+				&& caster.light_min.y <= clipped_receiver_max.y
+				&& caster.light_max.y >= clipped_receiver_min.y
+				&& caster.light_min.z <= clipped_receiver_max.z;
+		};
+
+		candidate_count = candidates.size();
+		kept_count = 0;
+		static_signature = 0xcbf29ce484222325ull;
+
+		for (const auto& caster : candidates | std::views::filter(shadows_receivers))
+		{
+			const auto& material_cache = resource_sets[caster.resource_set_index].material_cache;
+			const auto& pipeline_mode = material_cache[caster.drawcall.material_index].params.pipeline;
+			const auto key = draw_key::encode(
+				draw_key::get_pipeline_slot(pipeline_mode, caster.drawcall.is_rigged()),
+				caster.resource_set_index,
+				caster.drawcall.material_index,
+				draw_key::encode_depth(-caster.light_min.z, false)
+			);
+			auto& target = caster.drawcall.is_dynamic ? dynamic_drawcalls : drawcalls;
+
+			if (!caster.drawcall.is_dynamic)
+			{
+				hash_combine(static_signature, caster.drawcall.world_position_min);
+				hash_combine(static_signature, caster.drawcall.world_position_max);
+				hash_combine(static_signature, caster.drawcall.material_index.value_or(UINT32_MAX));
+				hash_combine(static_signature, caster.drawcall.primitive.index_count);
+				hash_combine(static_signature, caster.drawcall.instances.size());
+			}
+
+			near = std::min(near, -caster.light_max.z);
+			far = std::max(far, -caster.light_min.z);
+
+			const auto& resource_set = resource_sets[caster.resource_set_index];
+			if (caster.drawcall.is_rigged() && resource_set.deferred_skinning_resource != nullptr)
+				resource_set.deferred_skinning_resource->mark_used(
+					caster.drawcall.get_joint_matrix_offset(),
+					caster.drawcall.joint_count
+				);
+
+			target.push(
+				key,
+				Drawcall{.drawcall = caster.drawcall, .resource_set_index = caster.resource_set_index}
+			);
+
+			kept_count++;
+		}
+
+		candidates.clear();
+
+		// Nothing to render, keep a valid projection
+		if (kept_count == 0)
+		{
+			near = 0.0f;
+			far = 1.0f;
+			return;
+		}
+
+		// Quantize near/far outwards, so that small caster changes don't change the projection
+		const auto depth_step = (smallest_bound.right - smallest_bound.left) / 16.0f;
+		near = std::floor(near / depth_step) * depth_step;
+		far = std::ceil(far / depth_step) * depth_step;
+	}
+
 	glm::mat4 Shadow::CSM_level_data::get_vp_matrix() const noexcept
 	{
+		// Cached static depth was rendered with an older matrix
+		if (cache_plan.has_value()) return cache_plan->vp_matrix;
+
 		const auto projection_matrix = glm::ortho(
 			smallest_bound.left,
 			smallest_bound.right,
@@ -131,10 +294,27 @@ namespace render::drawdata
 		return projection_matrix * smallest_bound.view_matrix;
 	}
 
+	Shadow_cache::Level_key Shadow::CSM_level_data::get_cache_key() const noexcept
+	{
+		return Shadow_cache::Level_key{
+			.vp_matrix = get_vp_matrix(),
+			.bound = {
+				smallest_bound.left,
+				smallest_bound.right,
+				smallest_bound.bottom,
+				smallest_bound.top,
+				near,
+				far
+			},
+			.static_signature = static_signature,
+			.has_dynamic = !dynamic_drawcalls.empty()
+		};
+	}
+
 	void Shadow::CSM_level_data::sort() noexcept
 	{
-		for (auto& drawcall_vec : drawcalls | std::views::values)
-			std::ranges::sort(drawcall_vec, {}, &Drawcall::min_z);
+		drawcalls.sort();
+		dynamic_drawcalls.sort();
 	}
 
 	void Shadow::append(const gltf::Drawdata& drawdata) noexcept
@@ -142,6 +322,21 @@ namespace render::drawdata
 		for (auto& level : csm_levels) level.append(drawdata);
 	}
 
+	void Shadow::cull_casters() noexcept
+	{
+		for (auto& level : csm_levels) level.cull_casters();
+	}
+
+	void Shadow::apply_cache(Shadow_cache& cache) noexcept
+	{
+		cache_keys.clear();
+		for (const auto& level : csm_levels) cache_keys.push_back(level.get_cache_key());
+
+		const auto plans = cache.update(light_direction, cache_keys);
+
+		for (auto [level, plan] : std::views::zip(csm_levels, plans)) level.cache_plan = plan;
+	}
+
 	void Shadow::sort() noexcept
 	{
 		for (auto& level : csm_levels) level.sort();
@@ -151,4 +346,34 @@ namespace render::drawdata
 	{
 		return csm_levels[level].get_vp_matrix();
 	}
+
+	void Shadow::batch(bool merge) noexcept
+	{
+		const auto get_key = [merge](const Drawcall& drawcall) -> std::optional<Instance_key> {
+			if (!merge || drawcall.drawcall.is_rigged()) return std::nullopt;
+			return Instance_key::from(drawcall.drawcall.primitive, true);
+		};
+
+		// Instance data of all cascades share one buffer
+		const auto batch_list = [this, &get_key](const auto& list, auto& list_batches) {
+			instance_items.clear();
+			batcher.batch(list, get_key, list_batches, instance_items);
+
+			instances.fill(list_batches, instance_items, [this, &list](uint32_t item) {
+				const auto& drawcall = list[item].drawcall;
+				instances.push(drawcall, drawcall.instances);
+			});
+		};
+
+		instances.clear();
+
+		for (auto& level : csm_levels)
+		{
+			level.batches.clear();
+			level.dynamic_batches.clear();
+
+			batch_list(level.drawcalls, level.batches);
+			batch_list(level.dynamic_drawcalls, level.dynamic_batches);
+		}
+	}
 }
\ No newline at end of file
@@ -121,33 +121,22 @@ namespace render
 	std::expected<gpu::Render_pass, util::Error> acquire_shadow_pass(
 		const gpu::Command_buffer& command_buffer,
 		const target::Shadow& shadow_target,
-		size_t level
+		size_t level,
+		bool static_cache,
+		bool clear
 	) noexcept
 	{
-		SDL_GPUTexture* depth_texture;
-		switch (level)
-		{
-		case 0:
-			depth_texture = *shadow_target.depth_texture_level0;
-			break;
-		case 1:
-			depth_texture = *shadow_target.depth_texture_level1;
-			break;
-		case 2:
-			depth_texture = *shadow_target.depth_texture_level2;
-			break;
-		default:
-			return util::Error("Invalid CSM level index");
-		}
+		const auto* depth_texture = shadow_target.get_level_texture(level, static_cache);
+		if (depth_texture == nullptr) return util::Error("Invalid CSM level index");
 
 		const auto depth_stencil_target_info = SDL_GPUDepthStencilTargetInfo{
-			.texture = depth_texture,
+			.texture = **depth_texture,
 			.clear_depth = 0.0f,
-			.load_op = SDL_GPU_LOADOP_CLEAR,
+			.load_op = clear ? SDL_GPU_LOADOP_CLEAR : SDL_GPU_LOADOP_LOAD,
 			.store_op = SDL_GPU_STOREOP_STORE,
 			.stencil_load_op = SDL_GPU_LOADOP_DONT_CARE,
 			.stencil_store_op = SDL_GPU_STOREOP_DONT_CARE,
-			.cycle = true,
+			.cycle = clear,
 			.clear_stencil = 0,
 			.mip_level = 0,
 			.layer = 0
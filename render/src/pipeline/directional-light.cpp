@@ -37,7 +37,7 @@ namespace render::pipeline
 			device,
 			shader_asset::directional_light_frag,
 			gpu::Graphics_shader::Stage::Fragment,
-			6,
+			3 + target::Shadow::max_levels,
 			0,
 			0,
 			1
@@ -82,10 +82,12 @@ namespace render::pipeline
 			gbuffer.albedo_texture->bind_with_sampler(sampler),
 			gbuffer.lighting_info_texture->bind_with_sampler(sampler),
 			gbuffer.depth_value_texture.current().bind_with_sampler(sampler),
-			shadow.depth_texture_level0->bind_with_sampler(shadow_sampler),
-			shadow.depth_texture_level1->bind_with_sampler(shadow_sampler),
-			shadow.depth_texture_level2->bind_with_sampler(shadow_sampler)
+			shadow.depth_textures[0]->bind_with_sampler(shadow_sampler),
+			shadow.depth_textures[1]->bind_with_sampler(shadow_sampler),
+			shadow.depth_textures[2]->bind_with_sampler(shadow_sampler),
+			shadow.depth_textures[3]->bind_with_sampler(shadow_sampler)
 		};
+		static_assert(target::Shadow::max_levels == 4, "Update shadow sampler bindings");
 
 		command_buffer.push_uniform_to_fragment(0, util::as_bytes(params));
 
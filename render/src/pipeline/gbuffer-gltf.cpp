@@ -11,7 +11,9 @@
 #include "util/as-byte.hpp"
 
 #include <SDL3/SDL_gpu.h>
+#include <cassert>
 #include <expected>
+#include <optional>
 #include <ranges>
 
 namespace render::pipeline
@@ -201,7 +203,7 @@ namespace render::pipeline
 			gpu::Graphics_shader::Stage::Vertex,
 			0,
 			0,
-			0,
+			1,
 			2
 		);
 	}
@@ -217,7 +219,7 @@ namespace render::pipeline
 			0,
 			0,
 			1,
-			2
+			3
 		);
 	}
 
@@ -232,7 +234,7 @@ namespace render::pipeline
 			5,
 			0,
 			0,
-			2
+			1
 		);
 	}
 
@@ -247,7 +249,7 @@ namespace render::pipeline
 			5,
 			0,
 			0,
-			2
+			1
 		);
 	}
 
@@ -308,7 +310,7 @@ namespace render::pipeline
 		if (!fragment_mask_shader)
 			return fragment_mask_shader.error().forward("Create fragment mask shader failed");
 
-		std::map<std::pair<gltf::Pipeline_mode, bool>, std::unique_ptr<Gltf_pipeline>> pipeline_result;
+		Pipeline_table pipeline_result;
 
 		for (const auto [alpha_mode, double_sided, rigged] : std::views::cartesian_product(
 				 std::array{gltf::Alpha_mode::Opaque, gltf::Alpha_mode::Mask, gltf::Alpha_mode::Blend},
@@ -340,52 +342,45 @@ namespace render::pipeline
 				);
 
 			if (rigged)
-				pipeline_result.emplace(
-					std::pair(pipeline_cfg, rigged),
-					std::make_unique<Pipeline_rigged>(pipeline_cfg, std::move(*pipeline))
-				);
+				pipeline_result[drawdata::draw_key::get_pipeline_slot(pipeline_cfg, rigged)] =
+					std::make_unique<Pipeline_rigged>(pipeline_cfg, std::move(*pipeline));
 			else
-				pipeline_result.emplace(
-					std::pair(pipeline_cfg, rigged),
-					std::make_unique<Pipeline_normal>(pipeline_cfg, std::move(*pipeline))
-				);
+				pipeline_result[drawdata::draw_key::get_pipeline_slot(pipeline_cfg, rigged)] =
+					std::make_unique<Pipeline_normal>(pipeline_cfg, std::move(*pipeline));
 		}
 
 		return Gbuffer_gltf(std::move(pipeline_result));
 	}
 
 	void Gbuffer_gltf::Pipeline_normal::bind(
-		const gpu::Command_buffer& command_buffer [[maybe_unused]],
-		const gpu::Render_pass& render_pass,
+		State_cache& state,
 		const glm::mat4& camera_matrix
 	) const noexcept
 	{
-		render_pass.bind_pipeline(pipeline);
-		command_buffer.push_uniform_to_vertex(0, util::as_bytes(camera_matrix));
-		render_pass.set_stencil_reference(0x01);
+		state.bind_pipeline(pipeline);
+		state.push_uniform_to_vertex(0, util::as_bytes(camera_matrix));
+		state.set_stencil_reference(0x01);
 	}
 
 	void Gbuffer_gltf::Pipeline_rigged::bind(
-		const gpu::Command_buffer& command_buffer [[maybe_unused]],
-		const gpu::Render_pass& render_pass,
+		State_cache& state,
 		const glm::mat4& camera_matrix
 	) const noexcept
 	{
-		render_pass.bind_pipeline(pipeline);
-		command_buffer.push_uniform_to_vertex(0, util::as_bytes(camera_matrix));
-		render_pass.set_stencil_reference(0x01);
+		state.bind_pipeline(pipeline);
+		state.push_uniform_to_vertex(0, util::as_bytes(camera_matrix));
+		state.set_stencil_reference(0x01);
 	}
 
 	void Gbuffer_gltf::Pipeline_normal::set_material(
-		const gpu::Command_buffer& command_buffer,
-		const gpu::Render_pass& render_pass,
+		State_cache& state,
 		const gltf::Material_gpu& material
 	) const noexcept
 	{
 		const auto frag_param = Frag_param::from(material.params.factor);
 
-		command_buffer.push_uniform_to_fragment(0, util::as_bytes(frag_param));
-		render_pass.bind_fragment_samplers(
+		state.push_uniform_to_fragment(0, util::as_bytes(frag_param));
+		state.bind_fragment_samplers(
 			0,
 			material.base_color,
 			material.normal,
@@ -396,15 +391,14 @@ namespace render::pipeline
 	}
 
 	void Gbuffer_gltf::Pipeline_rigged::set_material(
-		const gpu::Command_buffer& command_buffer,
-		const gpu::Render_pass& render_pass,
+		State_cache& state,
 		const gltf::Material_gpu& material
 	) const noexcept
 	{
 		const auto frag_param = Frag_param::from(material.params.factor);
 
-		command_buffer.push_uniform_to_fragment(0, util::as_bytes(frag_param));
-		render_pass.bind_fragment_samplers(
+		state.push_uniform_to_fragment(0, util::as_bytes(frag_param));
+		state.bind_fragment_samplers(
 			0,
 			material.base_color,
 			material.normal,
@@ -415,7 +409,7 @@ namespace render::pipeline
 	}
 
 	void Gbuffer_gltf::Pipeline_normal::set_skin(
-		const gpu::Render_pass& render_pass [[maybe_unused]],
+		State_cache& state [[maybe_unused]],
 		const gltf::Deferred_skinning_resource& skinning_resource [[maybe_unused]]
 	) const noexcept
 	{
@@ -423,82 +417,119 @@ namespace render::pipeline
 	}
 
 	void Gbuffer_gltf::Pipeline_rigged::set_skin(
-		const gpu::Render_pass& render_pass [[maybe_unused]],
-		const gltf::Deferred_skinning_resource& skinning_resource [[maybe_unused]]
+		State_cache& state,
+		const gltf::Deferred_skinning_resource& skinning_resource
+	) const noexcept
+	{
+		state.bind_vertex_storage_buffer(0, *skinning_resource.joint_matrices_buffer);
+
+		// Palette format, see `gltf::Skinning_mode` and `skinning.glsl`
+		const auto mode = static_cast<uint32_t>(skinning_resource.mode);
+		state.push_uniform_to_vertex(2, util::as_bytes(mode));
+	}
+
+	void Gbuffer_gltf::Pipeline_normal::set_instances(
+		State_cache& state,
+		const gpu::Buffer& instance_buffer
+	) const noexcept
+	{
+		state.bind_vertex_storage_buffer(0, instance_buffer);
+	}
+
+	void Gbuffer_gltf::Pipeline_rigged::set_instances(
+		State_cache& state [[maybe_unused]],
+		const gpu::Buffer& instance_buffer [[maybe_unused]]
 	) const noexcept
 	{
-		render_pass.bind_vertex_storage_buffers(0, *skinning_resource.joint_matrices_buffer);
+		// Do nothing for rigged pipelines, slot 0 holds the joint matrices
 	}
 
 	void Gbuffer_gltf::Pipeline_normal::draw(
-		const gpu::Command_buffer& command_buffer,
-		const gpu::Render_pass& render_pass,
-		const gltf::Primitive_drawcall& drawcall
+		State_cache& state,
+		const gltf::Primitive_drawcall& drawcall,
+		const drawdata::Instance_range& instances
 	) const noexcept
 	{
-		const auto per_object_param = Per_object_param::from(drawcall);
-		command_buffer.push_uniform_to_fragment(1, util::as_bytes(per_object_param));
-		const auto transform = drawcall.get_world_transform();
-		command_buffer.push_uniform_to_vertex(1, util::as_bytes(transform));
-
-		render_pass.bind_vertex_buffers(0, drawcall.primitive.vertex_buffer_binding);
-		render_pass
-			.bind_index_buffer(drawcall.primitive.index_buffer_binding, SDL_GPU_INDEXELEMENTSIZE_32BIT);
-		render_pass.draw_indexed(drawcall.primitive.index_count, 0, 1, 0, 0);
+		// Instances are indexed from the pushed offset, base instance isn't portable for `gl_InstanceIndex`
+		state.push_uniform_to_vertex(1, util::as_bytes(instances.first));
+
+		const auto& primitive = drawcall.primitive;
+		state.bind_vertex_buffer(0, primitive.vertex_buffer_binding);
+		state.bind_index_buffer(primitive.index_buffer_binding, primitive.index_element_size);
+		state.draw_indexed(
+			primitive.index_count,
+			primitive.first_index,
+			instances.count,
+			0,
+			primitive.vertex_offset
+		);
 	}
 
 	void Gbuffer_gltf::Pipeline_rigged::draw(
-		const gpu::Command_buffer& command_buffer,
-		const gpu::Render_pass& render_pass,
-		const gltf::Primitive_drawcall& drawcall
+		State_cache& state,
+		const gltf::Primitive_drawcall& drawcall,
+		const drawdata::Instance_range& instances [[maybe_unused]]
 	) const noexcept
 	{
-		const auto per_object_param = Per_object_param::from(drawcall);
-		command_buffer.push_uniform_to_fragment(1, util::as_bytes(per_object_param));
-		command_buffer.push_uniform_to_vertex(1, util::as_bytes(drawcall.get_joint_matrix_offset()));
-
-		render_pass.bind_vertex_buffers(0, drawcall.primitive.vertex_buffer_binding);
-		render_pass
-			.bind_index_buffer(drawcall.primitive.index_buffer_binding, SDL_GPU_INDEXELEMENTSIZE_32BIT);
-		render_pass.draw_indexed(drawcall.primitive.index_count, 0, 1, 0, 0);
+		assert(instances.count == 1);
+
+		const auto rigged_param = Rigged_param::from(drawcall);
+		state.push_uniform_to_vertex(1, util::as_bytes(rigged_param));
+
+		const auto& primitive = drawcall.primitive;
+		state.bind_vertex_buffer(0, primitive.vertex_buffer_binding);
+		state.bind_index_buffer(primitive.index_buffer_binding, primitive.index_element_size);
+		state.draw_indexed(primitive.index_count, primitive.first_index, 1, 0, primitive.vertex_offset);
 	}
 
-	void Gbuffer_gltf::render(
+	State_cache::Counter Gbuffer_gltf::render(
 		const gpu::Command_buffer& command_buffer,
 		const gpu::Render_pass& gbuffer_pass,
 		const drawdata::Gbuffer& drawdata
 	) const noexcept
 	{
 		command_buffer.push_debug_group("Gbuffer Pass");
-		for (const auto& [pipeline_cfg, drawcalls] : drawdata.drawcalls)
-		{
-			const auto& draw_pipeline = pipelines.at(pipeline_cfg);
+		State_cache state(command_buffer, gbuffer_pass);
+		const Gltf_pipeline* draw_pipeline = nullptr;
+		std::optional<uint32_t> bound_slot;
+
+		const auto* const instance_buffer = drawdata.instances.get_buffer();
 
-			draw_pipeline->bind(command_buffer, gbuffer_pass, drawdata.camera_matrix);
+		for (const auto& batch : drawdata.batches)
+		{
+			const auto& [drawcall, set_idx] = drawdata.drawcalls[batch.item_index];
 
-			for (const auto& [drawcall, set_idx, _] : drawcalls)
+			// Batches are ordered by pipeline slot first, only rebind when the slot changes
+			const auto slot = drawdata::draw_key::get_pipeline_slot(batch.key);
+			if (slot != bound_slot)
 			{
-				const auto& resource_set = drawdata.resource_sets[set_idx];
+				draw_pipeline = pipelines[slot].get();
+				draw_pipeline->bind(state, drawdata.camera_matrix);
+				if (instance_buffer != nullptr) draw_pipeline->set_instances(state, *instance_buffer);
+				bound_slot = slot;
+			}
 
-				draw_pipeline->set_material(
-					command_buffer,
-					gbuffer_pass,
-					resource_set.material_cache[drawcall.material_index]
-				);
+			const auto& resource_set = drawdata.resource_sets[set_idx];
 
-				if (resource_set.deferred_skinning_resource != nullptr)
-					draw_pipeline->set_skin(gbuffer_pass, *resource_set.deferred_skinning_resource);
+			draw_pipeline->set_material(state, resource_set.material_cache[drawcall.material_index]);
 
-				draw_pipeline->draw(command_buffer, gbuffer_pass, drawcall);
-			}
+			if (resource_set.deferred_skinning_resource != nullptr)
+				draw_pipeline->set_skin(state, *resource_set.deferred_skinning_resource);
+
+			draw_pipeline->draw(state, drawcall, batch.instances);
 		}
 		command_buffer.pop_debug_group();
+
+		return state.get_counter();
 	}
 
-	Gbuffer_gltf::Per_object_param Gbuffer_gltf::Per_object_param::from(
+	Gbuffer_gltf::Rigged_param Gbuffer_gltf::Rigged_param::from(
 		const gltf::Primitive_drawcall& drawcall
 	) noexcept
 	{
-		return Per_object_param{.emissive_multiplier = drawcall.emissive_multiplier};
+		return Rigged_param{
+			.joint_matrix_offset = drawcall.get_joint_matrix_offset(),
+			.emissive_multiplier = drawcall.emissive_multiplier
+		};
 	}
 }
\ No newline at end of file
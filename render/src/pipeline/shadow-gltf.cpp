@@ -16,6 +16,8 @@
 #include "util/as-byte.hpp"
 
 #include <SDL3/SDL_gpu.h>
+#include <cassert>
+#include <optional>
 #include <ranges>
 #include <span>
 
@@ -121,7 +123,7 @@ namespace render::pipeline
 				gpu::Graphics_shader::Stage::Vertex,
 				0,
 				0,
-				0,
+				1,
 				2
 			);
 
@@ -131,7 +133,7 @@ namespace render::pipeline
 				gpu::Graphics_shader::Stage::Vertex,
 				0,
 				0,
-				0,
+				1,
 				2
 			);
 
@@ -142,7 +144,7 @@ namespace render::pipeline
 				0,
 				0,
 				1,
-				2
+				3
 			);
 
 			auto vertex_rigged_mask_shader = gpu::Graphics_shader::create(
@@ -152,7 +154,7 @@ namespace render::pipeline
 				0,
 				0,
 				1,
-				2
+				3
 			);
 
 			auto fragment_shader = gpu::Graphics_shader::create(
@@ -252,7 +254,7 @@ namespace render::pipeline
 		auto shaders = Shaders::create(device);
 		if (!shaders) return shaders.error().forward("Create Shadow shaders failed");
 
-		std::map<std::pair<gltf::Pipeline_mode, bool>, std::unique_ptr<Gltf_pipeline>> pipeline_result;
+		Pipeline_table pipeline_result;
 
 		for (const auto [alpha_mode, double_sided, rigged] : std::views::cartesian_product(
 				 std::array{gltf::Alpha_mode::Opaque, gltf::Alpha_mode::Mask, gltf::Alpha_mode::Blend},
@@ -276,43 +278,30 @@ namespace render::pipeline
 				);
 
 			if (rigged)
-				pipeline_result.emplace(
-					std::pair(pipeline_cfg, rigged),
-					std::make_unique<Pipeline_rigged>(pipeline_cfg, std::move(*pipeline))
-				);
+				pipeline_result[drawdata::draw_key::get_pipeline_slot(pipeline_cfg, rigged)] =
+					std::make_unique<Pipeline_rigged>(pipeline_cfg, std::move(*pipeline));
 			else
-				pipeline_result.emplace(
-					std::pair(pipeline_cfg, rigged),
-					std::make_unique<Pipeline_normal>(pipeline_cfg, std::move(*pipeline))
-				);
+				pipeline_result[drawdata::draw_key::get_pipeline_slot(pipeline_cfg, rigged)] =
+					std::make_unique<Pipeline_normal>(pipeline_cfg, std::move(*pipeline));
 		}
 
 		return Shadow_gltf(std::move(pipeline_result));
 	}
 
-	void Shadow_gltf::Pipeline_normal::bind(
-		const gpu::Command_buffer& command_buffer,
-		const gpu::Render_pass& render_pass,
-		const glm::mat4& camera_matrix
-	) const noexcept
+	void Shadow_gltf::Pipeline_normal::bind(State_cache& state, const glm::mat4& camera_matrix) const noexcept
 	{
-		render_pass.bind_pipeline(pipeline);
-		command_buffer.push_uniform_to_vertex(0, util::as_bytes(camera_matrix));
+		state.bind_pipeline(pipeline);
+		state.push_uniform_to_vertex(0, util::as_bytes(camera_matrix));
 	}
 
-	void Shadow_gltf::Pipeline_rigged::bind(
-		const gpu::Command_buffer& command_buffer,
-		const gpu::Render_pass& render_pass,
-		const glm::mat4& camera_matrix
-	) const noexcept
+	void Shadow_gltf::Pipeline_rigged::bind(State_cache& state, const glm::mat4& camera_matrix) const noexcept
 	{
-		render_pass.bind_pipeline(pipeline);
-		command_buffer.push_uniform_to_vertex(0, util::as_bytes(camera_matrix));
+		state.bind_pipeline(pipeline);
+		state.push_uniform_to_vertex(0, util::as_bytes(camera_matrix));
 	}
 
 	void Shadow_gltf::Pipeline_normal::set_material(
-		const gpu::Command_buffer& command_buffer,
-		const gpu::Render_pass& render_pass,
+		State_cache& state,
 		const gltf::Material_gpu& material
 	) const noexcept
 	{
@@ -324,14 +313,13 @@ namespace render::pipeline
 			};
 			const std::array textures = {material.base_color};
 
-			command_buffer.push_uniform_to_fragment(0, util::as_bytes(frag_param));
-			render_pass.bind_fragment_samplers(0, textures);
+			state.push_uniform_to_fragment(0, util::as_bytes(frag_param));
+			state.bind_fragment_samplers(0, textures);
 		}
 	}
 
 	void Shadow_gltf::Pipeline_rigged::set_material(
-		const gpu::Command_buffer& command_buffer,
-		const gpu::Render_pass& render_pass,
+		State_cache& state,
 		const gltf::Material_gpu& material
 	) const noexcept
 	{
@@ -343,13 +331,13 @@ namespace render::pipeline
 			};
 			const std::array textures = {material.base_color};
 
-			command_buffer.push_uniform_to_fragment(0, util::as_bytes(frag_param));
-			render_pass.bind_fragment_samplers(0, textures);
+			state.push_uniform_to_fragment(0, util::as_bytes(frag_param));
+			state.bind_fragment_samplers(0, textures);
 		}
 	}
 
 	void Shadow_gltf::Pipeline_normal::set_skin(
-		const gpu::Render_pass& render_pass [[maybe_unused]],
+		State_cache& state [[maybe_unused]],
 		const gltf::Deferred_skinning_resource& skinning_resource [[maybe_unused]]
 	) const noexcept
 	{
@@ -357,87 +345,223 @@ namespace render::pipeline
 	}
 
 	void Shadow_gltf::Pipeline_rigged::set_skin(
-		const gpu::Render_pass& render_pass,
+		State_cache& state,
 		const gltf::Deferred_skinning_resource& skinning_resource
 	) const noexcept
 	{
-		render_pass.bind_vertex_storage_buffers(0, *skinning_resource.joint_matrices_buffer);
+		state.bind_vertex_storage_buffer(0, *skinning_resource.joint_matrices_buffer);
+
+		// Palette format, see `gltf::Skinning_mode` and `skinning.glsl`
+		const auto mode = static_cast<uint32_t>(skinning_resource.mode);
+		state.push_uniform_to_vertex(2, util::as_bytes(mode));
 	}
 
-	void Shadow_gltf::Pipeline_normal::draw(
-		const gpu::Command_buffer& command_buffer,
-		const gpu::Render_pass& render_pass,
-		const gltf::Primitive_drawcall& drawcall
+	void Shadow_gltf::Pipeline_normal::set_instances(
+		State_cache& state,
+		const gpu::Buffer& instance_buffer
 	) const noexcept
 	{
-		const auto world_transform = drawcall.get_world_transform();
+		state.bind_vertex_storage_buffer(0, instance_buffer);
+	}
+
+	void Shadow_gltf::Pipeline_rigged::set_instances(
+		State_cache& state [[maybe_unused]],
+		const gpu::Buffer& instance_buffer [[maybe_unused]]
+	) const noexcept
+	{
+		// Do nothing, slot 0 holds the joint matrices
+	}
 
-		command_buffer.push_uniform_to_vertex(1, util::as_bytes(world_transform));
-		render_pass.bind_vertex_buffers(0, drawcall.primitive.shadow_vertex_buffer_binding);
-		render_pass.bind_index_buffer(
-			drawcall.primitive.shadow_index_buffer_binding,
-			SDL_GPU_INDEXELEMENTSIZE_32BIT
+	void Shadow_gltf::Pipeline_normal::draw(
+		State_cache& state,
+		const gltf::Primitive_drawcall& drawcall,
+		const drawdata::Instance_range& instances
+	) const noexcept
+	{
+		state.push_uniform_to_vertex(1, util::as_bytes(instances.first));
+
+		const auto& primitive = drawcall.primitive;
+		state.bind_vertex_buffer(0, primitive.shadow_vertex_buffer_binding);
+		state.bind_index_buffer(primitive.shadow_index_buffer_binding, primitive.shadow_index_element_size);
+		state.draw_indexed(
+			primitive.index_count,
+			primitive.shadow_first_index,
+			instances.count,
+			0,
+			primitive.shadow_vertex_offset
 		);
-		render_pass.draw_indexed(drawcall.primitive.index_count, 0, 1, 0, 0);
 	}
 
 	void Shadow_gltf::Pipeline_rigged::draw(
-		const gpu::Command_buffer& command_buffer,
-		const gpu::Render_pass& render_pass,
-		const gltf::Primitive_drawcall& drawcall
+		State_cache& state,
+		const gltf::Primitive_drawcall& drawcall,
+		const drawdata::Instance_range& instances [[maybe_unused]]
 	) const noexcept
 	{
-		command_buffer.push_uniform_to_vertex(1, util::as_bytes(drawcall.get_joint_matrix_offset()));
-
-		render_pass.bind_vertex_buffers(0, drawcall.primitive.shadow_vertex_buffer_binding);
-		render_pass.bind_index_buffer(
-			drawcall.primitive.shadow_index_buffer_binding,
-			SDL_GPU_INDEXELEMENTSIZE_32BIT
+		assert(instances.count == 1);
+
+		state.push_uniform_to_vertex(1, util::as_bytes(drawcall.get_joint_matrix_offset()));
+
+		const auto& primitive = drawcall.primitive;
+		state.bind_vertex_buffer(0, primitive.shadow_vertex_buffer_binding);
+		state.bind_index_buffer(primitive.shadow_index_buffer_binding, primitive.shadow_index_element_size);
+		state.draw_indexed(
+			primitive.index_count,
+			primitive.shadow_first_index,
+			1,
+			0,
+			primitive.shadow_vertex_offset
 		);
-		render_pass.draw_indexed(drawcall.primitive.index_count, 0, 1, 0, 0);
 	}
 
-	std::expected<void, util::Error> Shadow_gltf::render(
+	void Shadow_gltf::render_drawcalls(
+		State_cache& state,
+		const drawdata::Shadow::CSM_level_data& level_data,
+		const drawdata::Draw_list<drawdata::Shadow::Drawcall>& drawcalls,
+		std::span<const drawdata::Instance_batch> batches,
+		const gpu::Buffer* instance_buffer
+	) const noexcept
+	{
+		const Gltf_pipeline* draw_pipeline = nullptr;
+		std::optional<uint32_t> bound_slot;
+
+		for (const auto& batch : batches)
+		{
+			const auto& [drawcall, set_idx] = drawcalls[batch.item_index];
+
+			// Batches are ordered by pipeline slot first, only rebind when the slot changes
+			const auto slot = drawdata::draw_key::get_pipeline_slot(batch.key);
+			if (slot != bound_slot)
+			{
+				draw_pipeline = pipelines[slot].get();
+				draw_pipeline->bind(state, level_data.get_vp_matrix());
+				if (instance_buffer != nullptr) draw_pipeline->set_instances(state, *instance_buffer);
+				bound_slot = slot;
+			}
+
+			const auto& resource_set = level_data.resource_sets[set_idx];
+
+			draw_pipeline->set_material(state, resource_set.material_cache[drawcall.material_index]);
+
+			if (resource_set.deferred_skinning_resource != nullptr)
+				draw_pipeline->set_skin(state, *resource_set.deferred_skinning_resource);
+
+			draw_pipeline->draw(state, drawcall, batch.instances);
+		}
+	}
+
+	std::expected<State_cache::Counter, util::Error> Shadow_gltf::render(
 		const gpu::Command_buffer& command_buffer,
 		const target::Shadow& shadow_target,
 		const drawdata::Shadow& drawdata
 	) const noexcept
 	{
 		command_buffer.push_debug_group("Shadow Pass");
+		State_cache::Counter counter;
+		const auto* const instance_buffer = drawdata.instances.get_buffer();
+
 		for (const auto [level, level_data] : drawdata.csm_levels | std::views::enumerate)
 		{
-			auto shadow_pass_result = acquire_shadow_pass(command_buffer, shadow_target, level);
-			if (!shadow_pass_result)
-				return shadow_pass_result.error().forward("Acquire shadow render pass failed");
-			auto shadow_pass = std::move(*shadow_pass_result);
+			/* Uncached */
 
-			for (const auto& [pipeline_cfg, drawcalls] : level_data.drawcalls)
+			if (!level_data.cache_plan.has_value())
 			{
-				const auto& draw_pipeline = pipelines.at(pipeline_cfg);
+				auto shadow_pass_result = acquire_shadow_pass(command_buffer, shadow_target, level);
+				if (!shadow_pass_result)
+					return shadow_pass_result.error().forward("Acquire shadow render pass failed");
+				auto shadow_pass = std::move(*shadow_pass_result);
+
+				State_cache state(command_buffer, shadow_pass);
+				render_drawcalls(
+					state,
+					level_data,
+					level_data.drawcalls,
+					level_data.batches,
+					instance_buffer
+				);
+				render_drawcalls(
+					state,
+					level_data,
+					level_data.dynamic_drawcalls,
+					level_data.dynamic_batches,
+					instance_buffer
+				);
+				counter += state.get_counter();
 
-				draw_pipeline->bind(command_buffer, shadow_pass, level_data.get_vp_matrix());
+				shadow_pass.end();
+				continue;
+			}
 
-				for (const auto& [drawcall, set_idx, _] : drawcalls)
-				{
-					const auto& resource_set = level_data.resource_sets[set_idx];
+			const auto& plan = *level_data.cache_plan;
 
-					draw_pipeline->set_material(
-						command_buffer,
-						shadow_pass,
-						resource_set.material_cache[drawcall.material_index]
-					);
+			/* Static Casters */
+
+			if (plan.render_static)
+			{
+				auto static_pass_result = acquire_shadow_pass(command_buffer, shadow_target, level, true);
+				if (!static_pass_result)
+					return static_pass_result.error().forward("Acquire static shadow render pass failed");
+				auto static_pass = std::move(*static_pass_result);
+
+				State_cache state(command_buffer, static_pass);
+				render_drawcalls(
+					state,
+					level_data,
+					level_data.drawcalls,
+					level_data.batches,
+					instance_buffer
+				);
+				counter += state.get_counter();
+
+				static_pass.end();
+			}
 
-					if (resource_set.deferred_skinning_resource != nullptr)
-						draw_pipeline->set_skin(shadow_pass, *resource_set.deferred_skinning_resource);
+			/* Restore Static Depth */
 
-					draw_pipeline->draw(command_buffer, shadow_pass, drawcall);
-				}
+			if (plan.copy_static)
+			{
+				const auto& static_texture = *shadow_target.get_level_texture(level, true);
+				const auto& shadow_texture = *shadow_target.get_level_texture(level);
+				const auto size = static_texture.get_size();
+
+				const auto copy_result = command_buffer.run_copy_pass([&](const gpu::Copy_pass& copy_pass) {
+					copy_pass.copy_texture_to_texture(
+						{.texture = *static_texture, .mip_level = 0, .layer = 0, .x = 0, .y = 0, .z = 0},
+						{.texture = *shadow_texture, .mip_level = 0, .layer = 0, .x = 0, .y = 0, .z = 0},
+						size.x,
+						size.y,
+						1,
+						true
+					);
+				});
+				if (!copy_result) return copy_result.error().forward("Copy static shadow depth failed");
 			}
 
-			shadow_pass.end();
+			/* Dynamic Casters */
+
+			if (!level_data.dynamic_drawcalls.empty())
+			{
+				auto dynamic_pass_result =
+					acquire_shadow_pass(command_buffer, shadow_target, level, false, false);
+				if (!dynamic_pass_result)
+					return dynamic_pass_result.error().forward("Acquire dynamic shadow render pass failed");
+				auto dynamic_pass = std::move(*dynamic_pass_result);
+
+				State_cache state(command_buffer, dynamic_pass);
+				render_drawcalls(
+					state,
+					level_data,
+					level_data.dynamic_drawcalls,
+					level_data.dynamic_batches,
+					instance_buffer
+				);
+				counter += state.get_counter();
+
+				dynamic_pass.end();
+			}
 		}
 		command_buffer.pop_debug_group();
 
-		return {};
+		return counter;
 	}
 }
\ No newline at end of file
@@ -0,0 +1,227 @@
+#include "render/pipeline/state-cache.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <ranges>
+
+namespace render::pipeline
+{
+	static bool same_binding(
+		const SDL_GPUTextureSamplerBinding& a,
+		const SDL_GPUTextureSamplerBinding& b
+	) noexcept
+	{
+		return a.texture == b.texture && a.sampler == b.sampler;
+	}
+
+	static bool same_binding(const SDL_GPUBufferBinding& a, const SDL_GPUBufferBinding& b) noexcept
+	{
+		return a.buffer == b.buffer && a.offset == b.offset;
+	}
+
+	bool State_cache::record(bool changed) noexcept
+	{
+		if (changed)
+			counter.issued++;
+		else
+			counter.skipped++;
+
+		return changed;
+	}
+
+	bool State_cache::update_uniform(Uniform_slot& slot, std::span<const std::byte> data) noexcept
+	{
+		// Too large to cache, always push
+		if (data.size() > uniform_capacity)
+		{
+			slot.size = 0;
+			return true;
+		}
+
+		if (slot.size == data.size() && std::memcmp(slot.data.data(), data.data(), data.size()) == 0)
+			return false;
+
+		std::ranges::copy(data, slot.data.begin());
+		slot.size = data.size();
+		return true;
+	}
+
+	void State_cache::invalidate() noexcept
+	{
+		for (auto& slot : vertex_uniforms) slot.size = 0;
+		for (auto& slot : fragment_uniforms) slot.size = 0;
+		fragment_samplers.fill(std::nullopt);
+		vertex_storage_buffers.fill(nullptr);
+		vertex_buffers.fill(std::nullopt);
+		index_buffer.reset();
+		stencil_reference.reset();
+	}
+
+	void State_cache::bind_pipeline(SDL_GPUGraphicsPipeline* pipeline) noexcept
+	{
+		if (!record(pipeline != this->pipeline)) return;
+
+		// Conservatively drop everything, bindings aren't guaranteed to survive a pipeline switch
+		invalidate();
+		this->pipeline = pipeline;
+		target.bind_pipeline(pipeline);
+	}
+
+	void State_cache::push_uniform_to_vertex(uint32_t slot, std::span<const std::byte> data) noexcept
+	{
+		const bool changed = slot >= uniform_slot_count || update_uniform(vertex_uniforms[slot], data);
+		if (record(changed)) target.push_uniform_to_vertex(slot, data);
+	}
+
+	void State_cache::push_uniform_to_fragment(uint32_t slot, std::span<const std::byte> data) noexcept
+	{
+		const bool changed = slot >= uniform_slot_count || update_uniform(fragment_uniforms[slot], data);
+		if (record(changed)) target.push_uniform_to_fragment(slot, data);
+	}
+
+	void State_cache::bind_fragment_samplers(
+		uint32_t first_slot,
+		std::span<const SDL_GPUTextureSamplerBinding> bindings
+	) noexcept
+	{
+		bool changed = first_slot + bindings.size() > sampler_slot_count;
+
+		if (!changed)
+			for (const auto [binding, cached] :
+				 std::views::zip(bindings, fragment_samplers | std::views::drop(first_slot)))
+			{
+				if (cached.has_value() && same_binding(*cached, binding)) continue;
+
+				cached = binding;
+				changed = true;
+			}
+
+		if (record(changed)) target.bind_fragment_samplers(first_slot, bindings);
+	}
+
+	void State_cache::bind_vertex_storage_buffer(uint32_t slot, SDL_GPUBuffer* buffer) noexcept
+	{
+		bool changed = true;
+
+		if (slot < buffer_slot_count)
+		{
+			changed = vertex_storage_buffers[slot] != buffer;
+			vertex_storage_buffers[slot] = buffer;
+		}
+
+		if (record(changed)) target.bind_vertex_storage_buffer(slot, buffer);
+	}
+
+	void State_cache::bind_vertex_buffer(uint32_t slot, const SDL_GPUBufferBinding& binding) noexcept
+	{
+		bool changed = true;
+
+		if (slot < buffer_slot_count)
+		{
+			changed = !vertex_buffers[slot].has_value() || !same_binding(*vertex_buffers[slot], binding);
+			vertex_buffers[slot] = binding;
+		}
+
+		if (record(changed)) target.bind_vertex_buffer(slot, binding);
+	}
+
+	void State_cache::bind_index_buffer(
+		const SDL_GPUBufferBinding& binding,
+		SDL_GPUIndexElementSize element_size
+	) noexcept
+	{
+		const bool changed = !index_buffer.has_value()
+			|| !same_binding(index_buffer->first, binding)
+			|| index_buffer->second != element_size;
+		index_buffer = std::pair(binding, element_size);
+
+		if (record(changed)) target.bind_index_buffer(binding, element_size);
+	}
+
+	void State_cache::set_stencil_reference(uint8_t reference) noexcept
+	{
+		const bool changed = stencil_reference != reference;
+		stencil_reference = reference;
+
+		if (record(changed)) target.set_stencil_reference(reference);
+	}
+
+	void State_cache::draw_indexed(
+		uint32_t index_count,
+		uint32_t index_offset,
+		uint32_t instance_count,
+		uint32_t instance_offset,
+		int32_t vertex_offset
+	) const noexcept
+	{
+		target.draw_indexed(index_count, index_offset, instance_count, instance_offset, vertex_offset);
+	}
+
+	/* Pass Target */
+
+	void State_cache::Pass_target::bind_pipeline(SDL_GPUGraphicsPipeline* pipeline) noexcept
+	{
+		SDL_BindGPUGraphicsPipeline(render_pass, pipeline);
+	}
+
+	void State_cache::Pass_target::push_uniform_to_vertex(
+		uint32_t slot,
+		std::span<const std::byte> data
+	) noexcept
+	{
+		command_buffer.push_uniform_to_vertex(slot, data);
+	}
+
+	void State_cache::Pass_target::push_uniform_to_fragment(
+		uint32_t slot,
+		std::span<const std::byte> data
+	) noexcept
+	{
+		command_buffer.push_uniform_to_fragment(slot, data);
+	}
+
+	void State_cache::Pass_target::bind_fragment_samplers(
+		uint32_t first_slot,
+		std::span<const SDL_GPUTextureSamplerBinding> bindings
+	) noexcept
+	{
+		render_pass.bind_fragment_samplers(first_slot, bindings);
+	}
+
+	void State_cache::Pass_target::bind_vertex_storage_buffer(uint32_t slot, SDL_GPUBuffer* buffer) noexcept
+	{
+		render_pass.bind_vertex_storage_buffers(slot, buffer);
+	}
+
+	void State_cache::Pass_target::bind_vertex_buffer(
+		uint32_t slot,
+		const SDL_GPUBufferBinding& binding
+	) noexcept
+	{
+		render_pass.bind_vertex_buffers(slot, binding);
+	}
+
+	void State_cache::Pass_target::bind_index_buffer(
+		const SDL_GPUBufferBinding& binding,
+		SDL_GPUIndexElementSize element_size
+	) noexcept
+	{
+		render_pass.bind_index_buffer(binding, element_size);
+	}
+
+	void State_cache::Pass_target::set_stencil_reference(uint8_t reference) noexcept
+	{
+		render_pass.set_stencil_reference(reference);
+	}
+
+	void State_cache::Pass_target::draw_indexed(
+		uint32_t index_count,
+		uint32_t index_offset,
+		uint32_t instance_count,
+		uint32_t instance_offset,
+		int32_t vertex_offset
+	) noexcept
+	{
+		render_pass.draw_indexed(index_count, index_offset, instance_count, instance_offset, vertex_offset);
+	}
+}
\ No newline at end of file
@@ -12,6 +12,7 @@
 #include "render/pipeline/tonemapping.hpp"
 #include "util/error.hpp"
 
+#include <algorithm>
 #include <ranges>
 
 namespace render
@@ -24,15 +25,19 @@ namespace render
 		auto target = Target::create(sdl_context.device);
 		if (!target) return target.error().forward("Create target failed");
 
+		auto upload_ring = graphics::Upload_ring::create(sdl_context.device, initial_upload_ring_capacity);
+		if (!upload_ring) return upload_ring.error().forward("Create upload ring failed");
+
 		return Renderer(
 			std::move(*pipeline),
 			std::move(*target),
 			graphics::Buffer_pool(sdl_context.device),
-			graphics::Transfer_buffer_pool(sdl_context.device)
+			std::move(*upload_ring)
 		);
 	}
 
-	std::expected<std::tuple<drawdata::Gbuffer, drawdata::Shadow>, util::Error> Renderer::prepare_drawdata(
+	std::expected<void, util::Error> Renderer::prepare_drawdata(
+		SDL_GPUDevice* device,
 		std::span<const gltf::Drawdata> drawdata_list,
 		const Params& params
 	) noexcept
@@ -43,36 +48,135 @@ namespace render
 
 		const auto camera_matrix = params.camera.proj_matrix * params.camera.view_matrix;
 
-		drawdata::Gbuffer gbuffer_drawdata(camera_matrix, params.camera.eye_position);
-		for (const auto& drawdata : drawdata_list) gbuffer_drawdata.append(drawdata);
+		/* Occlusion Culling */
+
+		const bool use_occlusion_culling = params.function_mask.occlusion_culling;
+		if (use_occlusion_culling)
+		{
+			occlusion_culler.begin_frame(camera_matrix);
+
+			for (const auto& drawdata : drawdata_list)
+				for (const auto& occluder : drawdata.occluders)
+					occlusion_culler
+						.add_occluder(occluder.positions, occluder.indices, occluder.world_transform);
+
+			occlusion_culler.rasterize();
+		}
+
+		gbuffer_drawdata.reset(camera_matrix, params.camera.eye_position);
+		for (const auto& drawdata : drawdata_list)
+			gbuffer_drawdata.append(
+				drawdata,
+				use_occlusion_culling ? &occlusion_culler : nullptr,
+				params.function_mask.instance_culling
+			);
+
+		const auto occlusion_statistics = use_occlusion_culling
+			? occlusion_culler.get_statistics()
+			: graphics::Occlusion_culler::Statistics();
+		statistics = {
+			.gbuffer_drawcalls = static_cast<uint32_t>(gbuffer_drawdata.get_drawcall_count()),
+			.rigged_tested = gbuffer_drawdata.rigged_tested,
+			.rigged_culled = gbuffer_drawdata.rigged_culled,
+			.occluder_triangles = occlusion_statistics.occluder_triangles,
+			.occlusion_tested = occlusion_statistics.tested_boxes,
+			.occlusion_culled = occlusion_statistics.occluded_boxes
+		};
+
+		const auto csm_level_count =
+			std::clamp<size_t>(params.shadow.csm_level_count, 1, target::Shadow::max_levels);
 
-		drawdata::Shadow shadow_drawdata(
+		std::array<uint32_t, target::Shadow::max_levels> csm_level_resolution_array;
+		std::ranges::copy(
+			target.shadow_target.depth_textures
+				| std::views::take(csm_level_count)
+				| std::views::transform([](const auto& texture) { return texture.get_size().x; }),
+			csm_level_resolution_array.begin()
+		);
+		const auto csm_level_resolutions = std::span(csm_level_resolution_array).first(csm_level_count);
+
+		shadow_drawdata.reset(
 			camera_matrix,
 			params.primary_light.direction,
 			gbuffer_drawdata.get_min_z(),
-			params.shadow.csm_linear_blend
+			params.shadow.csm_linear_blend,
+			csm_level_resolutions
 		);
 		for (const auto& drawdata : drawdata_list) shadow_drawdata.append(drawdata);
+		shadow_drawdata.cull_casters();
+
+		if (params.function_mask.shadow_cache)
+			shadow_drawdata.apply_cache(shadow_cache);
+		else
+			shadow_cache.invalidate();
 
 		gbuffer_drawdata.sort();
 		shadow_drawdata.sort();
 
-		transfer_buffer_pool.cycle();
+		/* Instancing */
+
+		gbuffer_drawdata.batch(params.function_mask.instancing);
+		shadow_drawdata.batch(params.function_mask.instancing);
+
+		statistics.gbuffer_draws = static_cast<uint32_t>(gbuffer_drawdata.batches.size());
+		statistics.gbuffer_instances = static_cast<uint32_t>(gbuffer_drawdata.instances.size());
+		static_assert(Statistics::max_shadow_cascades == target::Shadow::max_levels);
+		statistics.shadow_cascade_count = static_cast<uint32_t>(shadow_drawdata.csm_levels.size());
+		std::ranges::copy(
+			shadow_drawdata.csm_levels
+				| std::views::transform([](const drawdata::Shadow::CSM_level_data& level) {
+					  return Statistics::Shadow_cascade{
+						  .candidate_casters = static_cast<uint32_t>(level.candidate_count),
+						  .kept_casters = static_cast<uint32_t>(level.kept_count),
+						  .draws = static_cast<uint32_t>(level.batches.size() + level.dynamic_batches.size()),
+						  .static_cached = level.cache_plan.has_value() && !level.cache_plan->render_static
+					  };
+				  }),
+			statistics.shadow_cascades.begin()
+		);
+
+		upload_ring.begin_frame();
 		buffer_pool.cycle();
 
 		for (const auto& deferred_data : deferred_resources)
 		{
-			const auto prepare_result = deferred_data->prepare_gpu_buffers(buffer_pool, transfer_buffer_pool);
+			const auto prepare_result = deferred_data->prepare_gpu_buffers(buffer_pool, upload_ring);
 			if (!prepare_result) return prepare_result.error().forward("Prepare skinning buffers failed");
+
+			statistics.joints_uploaded += static_cast<uint32_t>(deferred_data->get_used_joint_count());
+			statistics.joints_total += static_cast<uint32_t>(deferred_data->joint_matrices_data.size());
 		}
 
-		transfer_buffer_pool.gc();
+		const auto prepare_gbuffer_instances_result =
+			gbuffer_drawdata.instances.prepare_gpu_buffers(device, upload_ring);
+		if (!prepare_gbuffer_instances_result)
+			return prepare_gbuffer_instances_result.error().forward("Prepare gbuffer instance buffer failed");
+
+		const auto prepare_shadow_instances_result =
+			shadow_drawdata.instances.prepare_gpu_buffers(device, upload_ring);
+		if (!prepare_shadow_instances_result)
+			return prepare_shadow_instances_result.error().forward("Prepare shadow instance buffer failed");
+
 		buffer_pool.gc();
 
-		return std::make_tuple(std::move(gbuffer_drawdata), std::move(shadow_drawdata));
+		const auto& upload_statistics = upload_ring.get_statistics();
+		statistics.upload_bytes = upload_statistics.frame_bytes;
+		statistics.upload_capacity = upload_statistics.capacity;
+		statistics.upload_fence_waits = upload_statistics.fence_waits;
+		const auto& pool_statistics = buffer_pool.get_statistics();
+		statistics.pool_hits = pool_statistics.hits;
+		statistics.pool_misses = pool_statistics.misses;
+		statistics.pooled_bytes = pool_statistics.pooled_bytes;
+
+		statistics.buffers_created = upload_statistics.buffers_created
+			+ pool_statistics.misses
+			+ gbuffer_drawdata.instances.get_created_buffer_count()
+			+ shadow_drawdata.instances.get_created_buffer_count();
+
+		return {};
 	}
 
-	std::expected<void, util::Error> Renderer::render_gbuffer(
+	std::expected<pipeline::State_cache::Counter, util::Error> Renderer::render_gbuffer(
 		const gpu::Command_buffer& command_buffer,
 		const drawdata::Gbuffer& gbuffer_drawdata,
 		const Params& params [[maybe_unused]]
@@ -81,9 +185,8 @@ namespace render
 		auto gbuffer_pass =
 			acquire_gbuffer_pass(command_buffer, target.gbuffer_target, target.light_buffer_target);
 		if (!gbuffer_pass) return gbuffer_pass.error().forward("Acquire gbuffer pass failed");
-		{
+		const auto bind_counter =
 			pipeline.gbuffer_gltf.render(command_buffer, *gbuffer_pass, gbuffer_drawdata);
-		}
 		gbuffer_pass->end();
 
 		const auto copy_depth_result = pipeline.depth_to_color_copier.copy(
@@ -93,7 +196,7 @@ namespace render
 		);
 		if (!copy_depth_result) return copy_depth_result.error().forward("Copy depth to color failed");
 
-		return {};
+		return bind_counter;
 	}
 
 	std::expected<void, util::Error> Renderer::copy_resources(
@@ -108,12 +211,15 @@ namespace render
 		backend::imgui_upload_data(command_buffer);
 
 		const auto copy_deferred_result =
-			command_buffer.run_copy_pass([&deferred_resources](const gpu::Copy_pass& copy_pass) {
+			command_buffer.run_copy_pass([this, &deferred_resources](const gpu::Copy_pass& copy_pass) {
 				for (const auto& deferred_data : deferred_resources)
 					deferred_data->upload_gpu_buffers(copy_pass);
+
+				gbuffer_drawdata.instances.upload_gpu_buffers(copy_pass);
+				shadow_drawdata.instances.upload_gpu_buffers(copy_pass);
 			});
 		if (!copy_deferred_result)
-			return copy_deferred_result.error().forward("Copy deferred skinning buffers failed");
+			return copy_deferred_result.error().forward("Copy deferred skinning and instance buffers failed");
 
 		return {};
 	}
@@ -148,14 +254,18 @@ namespace render
 		glm::u32vec2 swapchain_size
 	) const noexcept
 	{
+		std::array<glm::mat4, target::Shadow::max_levels> shadow_matrices;
+		shadow_matrices.fill(glm::mat4(1.0f));
+		for (const auto level : std::views::iota(0zu, shadow_drawdata.csm_levels.size()))
+			shadow_matrices[level] = shadow_drawdata.get_vp_matrix(level);
+
 		const pipeline::Directional_light::Params dirlight_params = {
 			.camera_matrix_inv = glm::inverse(params.camera.proj_matrix * params.camera.view_matrix),
-			.shadow_matrix_level0 = shadow_drawdata.get_vp_matrix(0),
-			.shadow_matrix_level1 = shadow_drawdata.get_vp_matrix(1),
-			.shadow_matrix_level2 = shadow_drawdata.get_vp_matrix(2),
+			.shadow_matrices = shadow_matrices,
 			.eye_position = params.camera.eye_position,
 			.light_direction = params.primary_light.direction,
-			.light_color = params.primary_light.intensity / REF_LUMINANCE
+			.light_color = params.primary_light.intensity / REF_LUMINANCE,
+			.shadow_level_count = static_cast<uint32_t>(shadow_drawdata.csm_levels.size())
 		};
 
 		const pipeline::Ambient_light::Param ambient_light_params = {
@@ -355,9 +465,8 @@ namespace render
 	{
 		/* Preparation */
 
-		auto prepare_result = prepare_drawdata(drawdata.models, params);
+		const auto prepare_result = prepare_drawdata(sdl_context.device, drawdata.models, params);
 		if (!prepare_result) return prepare_result.error().forward("Prepare drawdata failed");
-		const auto [gbuffer_drawdata, shadow_drawdata] = std::move(*prepare_result);
 
 		/* Acquire Command Buffer */
 
@@ -374,8 +483,9 @@ namespace render
 
 		if (swapchain_texture == nullptr)
 		{
-			if (const auto result = command_buffer->submit(); !result)
-				return result.error().forward("Submit command buffer failed");
+			auto fence = command_buffer->submit_and_acquire_fence();
+			if (!fence) return fence.error().forward("Submit command buffer failed");
+			upload_ring.end_frame(std::move(*fence));
 
 			return {};
 		}
@@ -394,6 +504,8 @@ namespace render
 
 		const auto gbuffer_result = render_gbuffer(*command_buffer, gbuffer_drawdata, params);
 		if (!gbuffer_result) return gbuffer_result.error().forward("Render G-buffer failed");
+		statistics.gbuffer_binds_issued = gbuffer_result->issued;
+		statistics.gbuffer_binds_skipped = gbuffer_result->skipped;
 
 		const auto hiz_result =
 			pipeline.hiz_generator.generate(*command_buffer, target.gbuffer_target, swapchain_size);
@@ -402,6 +514,11 @@ namespace render
 		const auto shadow_result =
 			pipeline.shadow_gltf.render(*command_buffer, target.shadow_target, shadow_drawdata);
 		if (!shadow_result) return shadow_result.error().forward("Render shadow failed");
+		statistics.shadow_binds_issued = shadow_result->issued;
+		statistics.shadow_binds_skipped = shadow_result->skipped;
+
+		// Static cascades are recorded, a frame returning before this point is planned again
+		if (params.function_mask.shadow_cache) shadow_cache.commit();
 
 		const auto ao_result = render_ao(*command_buffer, params);
 		if (!ao_result) return ao_result.error().forward("Render AO failed");
@@ -441,8 +558,10 @@ namespace render
 		const auto imgui_result = render_imgui(*command_buffer, swapchain_texture);
 		if (!imgui_result) return imgui_result.error().forward("Render ImGui failed");
 
-		const auto submit_result = command_buffer->submit();
-		if (!submit_result) return submit_result.error().forward("Submit command buffer failed");
+		// The fence guards the upload ring ranges copied by this frame
+		auto fence = command_buffer->submit_and_acquire_fence();
+		if (!fence) return fence.error().forward("Submit command buffer failed");
+		upload_ring.end_frame(std::move(*fence));
 
 		return {};
 	}
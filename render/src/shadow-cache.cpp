@@ -0,0 +1,86 @@
+#include "render/shadow-cache.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <ranges>
+
+namespace render
+{
+	std::span<const Shadow_cache::Level_plan> Shadow_cache::update(
+		const glm::vec3& light_direction,
+		std::span<const Level_key> levels
+	) noexcept
+	{
+		const bool light_changed =
+			!committed.light_direction.has_value()
+			|| std::acos(std::clamp(glm::dot(*committed.light_direction, light_direction), -1.0f, 1.0f))
+				> config.light_angle_threshold;
+
+		// Start from the committed state, copy-assigning keeps the capacity of the pending levels
+		pending.light_direction = light_changed ? light_direction : committed.light_direction;
+		pending.levels = committed.levels;
+		if (pending.levels.size() != levels.size()) pending.levels.assign(levels.size(), std::nullopt);
+
+		plans.clear();
+
+		for (const auto [key, cached] : std::views::zip(levels, pending.levels))
+		{
+			const bool render_static = light_changed
+				|| !cached.has_value()
+				|| cached->static_signature != key.static_signature
+				|| bound_changed(cached->bound, key.bound);
+			const bool had_dynamic = cached.has_value() && cached->had_dynamic;
+
+			if (render_static)
+				cached = Level_cache{
+					.vp_matrix = key.vp_matrix,
+					.bound = key.bound,
+					.static_signature = key.static_signature,
+					.had_dynamic = key.has_dynamic
+				};
+			else
+				cached->had_dynamic = key.has_dynamic;
+
+			// Shadow map still equals the cache if no dynamic caster is composited last frame or this frame
+			plans.push_back(
+				Level_plan{
+					.render_static = render_static,
+					.copy_static = render_static || had_dynamic || key.has_dynamic,
+					.vp_matrix = cached->vp_matrix
+				}
+			);
+		}
+
+		return plans;
+	}
+
+	void Shadow_cache::commit() noexcept
+	{
+		committed.light_direction = pending.light_direction;
+		committed.levels = pending.levels;
+	}
+
+	void Shadow_cache::invalidate() noexcept
+	{
+		committed = {};
+		pending = {};
+	}
+
+	bool Shadow_cache::bound_changed(
+		const std::array<float, 6>& cached,
+		const std::array<float, 6>& current
+	) const noexcept
+	{
+		// Compare (left, right), (bottom, top) and (near, far) pairs against their own extent
+		for (const auto i : std::views::iota(0zu, 3zu))
+		{
+			const auto extent = std::abs(cached[i * 2 + 1] - cached[i * 2]);
+			const auto tolerance = config.bound_tolerance * extent;
+
+			if (std::abs(cached[i * 2] - current[i * 2]) > tolerance) return true;
+			if (std::abs(cached[i * 2 + 1] - current[i * 2 + 1]) > tolerance) return true;
+		}
+
+		return false;
+	}
+}
\ No newline at end of file
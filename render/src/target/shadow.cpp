@@ -1,18 +1,60 @@
 #include "render/target/shadow.hpp"
 
+#include <format>
+#include <ranges>
+
 namespace render::target
 {
-	std::expected<void, util::Error> Shadow::resize(SDL_GPUDevice* device, glm::u32vec2 size) noexcept
+	Shadow::Shadow() noexcept
+	{
+		depth_textures.reserve(max_levels);
+		static_depth_textures.reserve(max_levels);
+
+		for (const auto level : std::views::iota(0zu, max_levels))
+		{
+			depth_textures.emplace_back(depth_format, std::format("Shadowmap Level {} Texture", level));
+			static_depth_textures
+				.emplace_back(static_depth_format, std::format("Static Shadowmap Level {}", level));
+		}
+	}
+
+	std::expected<void, util::Error> Shadow::resize(SDL_GPUDevice* device, uint32_t resolution) noexcept
 	{
-		if (auto result = depth_texture_level0.resize(device, size); !result)
-			return result.error().forward("Resize Shadow depth texture failed");
+		for (const auto [level, depth_texture, static_depth_texture] :
+			 std::views::zip(std::views::iota(0zu), depth_textures, static_depth_textures))
+		{
+			const auto size = glm::u32vec2(get_level_resolution(resolution, level));
 
-		if (auto result = depth_texture_level1.resize(device, size * 3u / 4u); !result)
-			return result.error().forward("Resize Shadow depth texture level 1 failed");
+			if (auto result = depth_texture.resize(device, size); !result)
+				return result.error().forward(
+					std::format("Resize Shadow depth texture level {} failed", level)
+				);
 
-		if (auto result = depth_texture_level2.resize(device, size / 2u); !result)
-			return result.error().forward("Resize Shadow depth texture level 2 failed");
+			if (auto result = static_depth_texture.resize(device, size); !result)
+				return result.error().forward(
+					std::format("Resize static Shadow depth texture level {} failed", level)
+				);
+		}
 
 		return {};
 	}
+
+	const graphics::Auto_texture* Shadow::get_level_texture(size_t level, bool static_cache) const noexcept
+	{
+		if (level >= max_levels) return nullptr;
+		return static_cache ? &static_depth_textures[level] : &depth_textures[level];
+	}
+
+	uint32_t Shadow::get_level_resolution(uint32_t resolution, size_t level) noexcept
+	{
+		switch (level)
+		{
+		case 0:
+			return resolution;
+		case 1:
+			return resolution * 3 / 4;
+		default:
+			return resolution / 2;
+		}
+	}
 }
\ No newline at end of file
@@ -0,0 +1,63 @@
+#include "gltf/detail/mesh/index-narrowing.hpp"
+
+#include <gtest/gtest.h>
+#include <vector>
+
+namespace
+{
+	using gltf::detail::mesh::Index_narrowing;
+
+	TEST(Index_narrowing, NarrowsUpTo65536Vertices)
+	{
+		EXPECT_TRUE(Index_narrowing::can_narrow(65535));
+		EXPECT_TRUE(Index_narrowing::can_narrow(65536));
+		EXPECT_FALSE(Index_narrowing::can_narrow(65537));
+	}
+
+	TEST(Index_narrowing, KeepsIndexValuesAtTheLimit)
+	{
+		Index_narrowing narrowing;
+
+		// The last vertex of a 65536 vertex primitive has index 65535, the largest 16-bit value
+		const std::vector<uint32_t> indices = {0, 65534, 65535, 65535, 1, 0};
+		const auto narrowed = narrowing.narrow(indices, 65536);
+		ASSERT_TRUE(narrowed.has_value());
+		EXPECT_EQ(*narrowed, (std::vector<uint16_t>{0, 65534, 65535, 65535, 1, 0}));
+
+		const auto below_limit = narrowing.narrow(std::vector<uint32_t>{65534, 0}, 65535);
+		ASSERT_TRUE(below_limit.has_value());
+		EXPECT_EQ(*below_limit, (std::vector<uint16_t>{65534, 0}));
+
+		EXPECT_FALSE(narrowing.narrow(std::vector<uint32_t>{65536, 0, 1}, 65537).has_value());
+	}
+
+	TEST(Index_narrowing, PadsOddCountsWithTheLastIndex)
+	{
+		Index_narrowing narrowing;
+
+		const auto narrowed = narrowing.narrow(std::vector<uint32_t>{4, 5, 6}, 7);
+		ASSERT_TRUE(narrowed.has_value());
+		EXPECT_EQ(*narrowed, (std::vector<uint16_t>{4, 5, 6, 6}));
+		EXPECT_EQ(narrowed->size() * sizeof(uint16_t) % 4, 0u);
+	}
+
+	TEST(Index_narrowing, AccountsIndexBytesAndSavings)
+	{
+		Index_narrowing narrowing;
+
+		// 6 indices narrowed, 24 bytes become 12
+		narrowing.narrow(std::vector<uint32_t>(6, 0), 65536);
+		EXPECT_EQ(narrowing.get_index_bytes(), 12u);
+		EXPECT_EQ(narrowing.get_index_bytes_saved(), 12u);
+
+		// 3 indices narrowed and padded, 12 bytes become 8
+		narrowing.narrow(std::vector<uint32_t>(3, 0), 100);
+		EXPECT_EQ(narrowing.get_index_bytes(), 20u);
+		EXPECT_EQ(narrowing.get_index_bytes_saved(), 16u);
+
+		// 6 indices kept in 32 bits, nothing saved
+		narrowing.narrow(std::vector<uint32_t>(6, 0), 65537);
+		EXPECT_EQ(narrowing.get_index_bytes(), 44u);
+		EXPECT_EQ(narrowing.get_index_bytes_saved(), 16u);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,282 @@
+#include "gltf/model.hpp"
+
+#include <array>
+#include <cstring>
+#include <glm/gtc/matrix_transform.hpp>
+#include <gtest/gtest.h>
+#include <ranges>
+#include <span>
+#include <vector>
+
+namespace
+{
+	constexpr float tolerance = 1e-3f;
+
+	// More instances than one parallel chunk, so that placement is split across workers
+	constexpr uint32_t instance_count = 200;
+
+	// Node chain 0 -> 1 -> 2 -> 3. Nodes 0 and 3 draw mesh 0, node 1 draws mesh 1 and is lifted by the
+	// "Lift" animation, node 2 has no mesh.
+	tinygltf::Model make_tinygltf_model()
+	{
+		tinygltf::Model model;
+		model.meshes.resize(2);
+		model.nodes.resize(4);
+		model.scenes.emplace_back().nodes = {0};
+
+		model.nodes[0].mesh = 0;
+		model.nodes[0].children = {1};
+		model.nodes[0].translation = {1.0, 0.0, 0.0};
+
+		model.nodes[1].mesh = 1;
+		model.nodes[1].children = {2};
+		model.nodes[1].rotation = {0.0, 0.3826834, 0.0, 0.9238795};  // 45 degrees about Y
+		model.nodes[1].scale = {2.0, 1.0, 0.5};
+
+		model.nodes[2].children = {3};
+		model.nodes[2].translation = {0.0, 0.0, 3.0};
+
+		model.nodes[3].mesh = 0;
+		model.nodes[3].rotation = {0.3826834, 0.0, 0.0, 0.9238795};  // 45 degrees about X
+
+		// Linear translation of node 1 from the origin to (0, 4, 0) over one second
+		const std::array<float, 2> times = {0.0f, 1.0f};
+		const std::array<float, 6> translations = {0.0f, 0.0f, 0.0f, 0.0f, 4.0f, 0.0f};
+
+		auto& buffer = model.buffers.emplace_back().data;
+		buffer.resize(sizeof(times) + sizeof(translations));
+		std::memcpy(buffer.data(), times.data(), sizeof(times));
+		std::memcpy(buffer.data() + sizeof(times), translations.data(), sizeof(translations));
+
+		for (const auto& [offset, size, type, count] : {
+				 std::tuple{size_t(0), sizeof(times), TINYGLTF_TYPE_SCALAR, size_t(2)},
+				 std::tuple{sizeof(times), sizeof(translations), TINYGLTF_TYPE_VEC3, size_t(2)}
+			 })
+		{
+			tinygltf::BufferView buffer_view;
+			buffer_view.buffer = 0;
+			buffer_view.byteOffset = offset;
+			buffer_view.byteLength = size;
+			model.bufferViews.push_back(buffer_view);
+
+			tinygltf::Accessor accessor;
+			accessor.bufferView = static_cast<int>(model.bufferViews.size() - 1);
+			accessor.componentType = TINYGLTF_COMPONENT_TYPE_FLOAT;
+			accessor.type = type;
+			accessor.count = count;
+			model.accessors.push_back(accessor);
+		}
+
+		tinygltf::AnimationSampler sampler;
+		sampler.input = 0;
+		sampler.output = 1;
+
+		tinygltf::AnimationChannel channel;
+		channel.sampler = 0;
+		channel.target_node = 1;
+		channel.target_path = "translation";
+
+		tinygltf::Animation animation;
+		animation.name = "Lift";
+		animation.samplers.push_back(sampler);
+		animation.channels.push_back(channel);
+		model.animations.push_back(animation);
+
+		return model;
+	}
+
+	gltf::Primitive_gpu make_primitive(const glm::vec3& position_min, const glm::vec3& position_max)
+	{
+		gltf::Primitive_gpu primitive{};
+		primitive.index_count = 36;
+		primitive.position_min = position_min;
+		primitive.position_max = position_max;
+		primitive.rigged = false;
+		return primitive;
+	}
+
+	std::expected<gltf::Model, util::Error> make_model()
+	{
+		std::vector<gltf::Mesh_gpu> meshes(2);
+		meshes[0].primitives.push_back(make_primitive(glm::vec3(-1.0f), glm::vec3(1.0f)));
+		meshes[1].primitives.push_back(
+			make_primitive(glm::vec3(-0.5f, 0.0f, -0.5f), glm::vec3(0.5f, 2.0f, 0.5f))
+		);
+		meshes[1].primitives.push_back(make_primitive(glm::vec3(0.0f), glm::vec3(1.0f, 0.25f, 3.0f)));
+
+		return gltf::Model::from_tinygltf_headless(make_tinygltf_model(), std::move(meshes));
+	}
+
+	// Rest pose, and two animation states each shared by a third of the instances
+	const std::array first_key = {gltf::Animation_key{.animation = 0u, .time = 0.25f}};
+	const std::array second_key = {
+		gltf::Animation_key{.animation = std::string_view("Lift"), .time = 0.75f}
+	};
+
+	std::vector<gltf::Model_instance> make_instances(bool rotate)
+	{
+		std::vector<gltf::Model_instance> instances;
+
+		for (const auto idx : std::views::iota(0u, instance_count))
+		{
+			const auto position = glm::vec3(float(idx % 20) * 6.0f, 0.0f, -float(idx / 20) * 6.0f);
+			const auto scale = glm::vec3(1.0f + 0.01f * float(idx));
+			auto transform = glm::scale(glm::translate(glm::mat4(1.0f), position), scale);
+			if (rotate) transform = glm::rotate(transform, 0.1f * float(idx), glm::vec3(0.3f, 1.0f, 0.2f));
+
+			std::span<const gltf::Animation_key> animation;
+			if (idx % 3 == 1) animation = first_key;
+			if (idx % 3 == 2) animation = second_key;
+			instances.push_back({.model_transform = transform, .animation = animation});
+		}
+
+		return instances;
+	}
+
+	void expect_near(const glm::vec3& actual, const glm::vec3& expected, uint32_t instance)
+	{
+		for (const auto axis : std::views::iota(0, 3))
+			EXPECT_NEAR(actual[axis], expected[axis], tolerance)
+				<< "Instance " << instance << ", axis " << axis;
+	}
+
+	void expect_near(const glm::mat4& actual, const glm::mat4& expected, uint32_t instance)
+	{
+		for (const auto column : std::views::iota(0, 4))
+			for (const auto row : std::views::iota(0, 4))
+				EXPECT_NEAR(actual[column][row], expected[column][row], tolerance) << "Instance " << instance;
+	}
+
+	// Whether the bound of `outer` contains the bound of `inner`
+	bool contains(const gltf::Primitive_drawcall& outer, const gltf::Primitive_drawcall& inner)
+	{
+		const auto inner_min = inner.world_position_min + tolerance;
+		const auto inner_max = inner.world_position_max - tolerance;
+		return glm::all(glm::lessThanEqual(outer.world_position_min, inner_min))
+			&& glm::all(glm::greaterThanEqual(outer.world_position_max, inner_max));
+	}
+
+	///
+	/// @brief Compare instanced drawdata with the drawdata of each instance generated on its own
+	///
+	/// @param exact_bounds Instanced bounds must equal the per-instance bounds. Otherwise they must only
+	/// contain them, as the pose bound is transformed as a box.
+	///
+	void expect_matches_per_instance(
+		const gltf::Model& model,
+		std::span<const gltf::Model_instance> instances,
+		const gltf::Drawdata& instanced,
+		const std::vector<bool>& visible,
+		bool exact_bounds
+	)
+	{
+		const auto node_count = model.get_node_count();
+		ASSERT_EQ(instanced.node_matrices.size(), instances.size() * node_count);
+
+		size_t drawcall_offset = 0;
+		for (const auto [idx, instance] : instances | std::views::enumerate)
+		{
+			const auto instance_index = static_cast<uint32_t>(idx);
+			const auto reference =
+				model.generate_drawdata(instance.model_transform, instance.animation, {}, {});
+
+			// Node matrices of every instance, culled or not
+			for (const auto [node, matrix] : reference.node_matrices | std::views::enumerate)
+				expect_near(instanced.node_matrices[idx * node_count + node], matrix, instance_index);
+
+			if (!visible[idx]) continue;
+
+			ASSERT_LE(
+				drawcall_offset + reference.primitive_drawcalls.size(),
+				instanced.primitive_drawcalls.size()
+			);
+			for (const auto& expected : reference.primitive_drawcalls)
+			{
+				const auto& actual = instanced.primitive_drawcalls[drawcall_offset++];
+				expect_near(actual.get_world_transform(), expected.get_world_transform(), instance_index);
+
+				if (exact_bounds)
+				{
+					expect_near(actual.world_position_min, expected.world_position_min, instance_index);
+					expect_near(actual.world_position_max, expected.world_position_max, instance_index);
+				}
+				else
+				{
+					EXPECT_TRUE(contains(actual, expected)) << "Instance " << instance_index;
+				}
+			}
+		}
+
+		EXPECT_EQ(drawcall_offset, instanced.primitive_drawcalls.size());
+	}
+
+	TEST(Instanced_drawdata, MatchesPerInstanceDrawdata)
+	{
+		const auto model = make_model();
+		ASSERT_TRUE(model.has_value());
+
+		const auto instances = make_instances(false);
+		const auto drawdata = model->generate_instanced_drawdata(instances, {}, {}, {});
+
+		// 4 drawcalls per instance, all visible without frustum planes
+		EXPECT_EQ(drawdata.primitive_drawcalls.size(), instance_count * 4zu);
+
+		// Translation and uniform scale keep the pose bound exact
+		expect_matches_per_instance(*model, instances, drawdata, std::vector(instances.size(), true), true);
+	}
+
+	TEST(Instanced_drawdata, RotatedBoundsContainPerInstanceBounds)
+	{
+		const auto model = make_model();
+		ASSERT_TRUE(model.has_value());
+
+		const auto instances = make_instances(true);
+		const auto drawdata = model->generate_instanced_drawdata(instances, {}, {}, {});
+
+		expect_matches_per_instance(*model, instances, drawdata, std::vector(instances.size(), true), false);
+	}
+
+	TEST(Instanced_drawdata, CullsInstancesOutsideTheFrustum)
+	{
+		const auto model = make_model();
+		ASSERT_TRUE(model.has_value());
+
+		// Keep instances whose bound reaches x <= 40, a few columns of every row
+		const std::array planes = {glm::vec4(-1.0f, 0.0f, 0.0f, 40.0f)};
+		const auto instances = make_instances(false);
+		const auto drawdata = model->generate_instanced_drawdata(instances, planes, {}, {});
+
+		std::vector<bool> visible;
+		for (const auto& instance : instances)
+		{
+			const auto reference =
+				model->generate_drawdata(instance.model_transform, instance.animation, {}, {});
+			const auto bound_min = std::ranges::fold_left(
+				reference.primitive_drawcalls,
+				glm::vec3(std::numeric_limits<float>::max()),
+				[](const glm::vec3& bound, const gltf::Primitive_drawcall& drawcall) {
+					return glm::min(bound, drawcall.world_position_min);
+				}
+			);
+			visible.push_back(bound_min.x <= 40.0f);
+		}
+
+		const auto visible_count = static_cast<size_t>(std::ranges::count(visible, true));
+		EXPECT_GT(visible_count, 0u);
+		EXPECT_LT(visible_count, instance_count);
+		EXPECT_EQ(drawdata.primitive_drawcalls.size(), visible_count * 4);
+
+		expect_matches_per_instance(*model, instances, drawdata, visible, true);
+	}
+
+	TEST(Instanced_drawdata, RejectsMismatchedMeshes)
+	{
+		EXPECT_FALSE(gltf::Model::from_tinygltf_headless(make_tinygltf_model(), {}).has_value());
+
+		std::vector<gltf::Mesh_gpu> meshes(2);
+		meshes[0].primitives.push_back(make_primitive(glm::vec3(-1.0f), glm::vec3(1.0f)));
+		meshes[0].primitives[0].material = 0;
+		const auto model = gltf::Model::from_tinygltf_headless(make_tinygltf_model(), std::move(meshes));
+		EXPECT_FALSE(model.has_value());
+	}
+}
\ No newline at end of file
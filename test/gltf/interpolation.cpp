@@ -0,0 +1,124 @@
+#include "gltf/detail/animation/interpolation.hpp"
+
+#include <cmath>
+#include <gtest/gtest.h>
+#include <random>
+#include <ranges>
+
+namespace
+{
+	namespace animation = gltf::detail::animation;
+
+	// Unit quaternion rotated `angle` radians away from `base` about a random axis
+	glm::quat rotate_by(const glm::quat& base, float angle, std::mt19937& generator)
+	{
+		std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+		const auto axis = glm::normalize(
+			glm::vec3(distribution(generator), distribution(generator), distribution(generator))
+		);
+		return glm::normalize(glm::angleAxis(angle, axis) * base);
+	}
+
+	void set_lane(
+		std::array<std::array<float, animation::batch_size>, 4>& lanes,
+		size_t lane,
+		const glm::quat& value
+	)
+	{
+		lanes[0][lane] = value.x;
+		lanes[1][lane] = value.y;
+		lanes[2][lane] = value.z;
+		lanes[3][lane] = value.w;
+	}
+
+	// Largest component difference from `glm::slerp` over batches of keyframes `angle` radians apart
+	float compute_slerp_error(float angle)
+	{
+		std::mt19937 generator(7);
+		std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+		float max_error = 0.0f;
+
+		for (int iteration = 0; iteration < 256; iteration++)
+		{
+			animation::Segment_batch<4> batch{};
+			std::array<glm::quat, animation::batch_size> expected;
+
+			for (const auto lane : std::views::iota(0zu, animation::batch_size))
+			{
+				const auto a = glm::normalize(
+					glm::quat::wxyz(
+						distribution(generator),
+						distribution(generator),
+						distribution(generator),
+						distribution(generator)
+					)
+				);
+
+				// Every other lane takes the long way round, the kernel must flip it back
+				auto b = rotate_by(a, angle, generator);
+				if (lane % 2 == 1) b = -b;
+
+				const auto factor = (distribution(generator) + 1.0f) * 0.5f;
+				set_lane(batch.a, lane, a);
+				set_lane(batch.b, lane, b);
+				batch.factor[lane] = factor;
+
+				expected[lane] = glm::slerp(a, b, factor);
+			}
+
+			animation::interpolate_linear(batch);
+
+			for (const auto [lane, value] : expected | std::views::enumerate)
+				for (const auto component : std::views::iota(0, 4))
+				{
+					const auto error = std::abs(batch.result[component][lane] - value[component]);
+					max_error = std::max(max_error, error);
+				}
+		}
+
+		return max_error;
+	}
+
+	TEST(Interpolation, SlerpMatchesGlmForCloseKeyframes)
+	{
+		// Identical and nearly identical rotations take glm's lerp fallback
+		for (const float angle : {0.0f, 1e-4f, 0.01f, 0.2f, 1.0f})
+			EXPECT_LT(compute_slerp_error(angle), 2e-6f) << "Angle " << angle;
+	}
+
+	TEST(Interpolation, SlerpMatchesGlmForWideKeyframes)
+	{
+		// Around the 120 degree threshold between the series and the trigonometry fallback
+		for (const float angle : {2.0f, 2.09f, 2.1f, 3.0f})
+			EXPECT_LT(compute_slerp_error(angle), 2e-6f) << "Angle " << angle;
+	}
+
+	TEST(Interpolation, CubicSplineMatchesHermiteBasis)
+	{
+		animation::Segment_batch<3> batch{};
+		for (const auto lane : std::views::iota(0zu, animation::batch_size))
+			for (const auto component : std::views::iota(0zu, 3zu))
+			{
+				batch.a[component][lane] = float(lane) + float(component);
+				batch.b[component][lane] = float(component) - float(lane);
+				batch.a_out_tangent[component][lane] = 0.5f * float(lane);
+				batch.b_in_tangent[component][lane] = -2.0f;
+				batch.factor[lane] = float(lane) / float(animation::batch_size - 1);
+				batch.duration[lane] = 0.25f;
+			}
+
+		animation::interpolate_cubic_spline(batch);
+
+		for (const auto lane : std::views::iota(0zu, animation::batch_size))
+			for (const auto component : std::views::iota(0zu, 3zu))
+			{
+				const float t = batch.factor[lane], t2 = t * t, t3 = t2 * t;
+				const float expected = (2 * t3 - 3 * t2 + 1) * batch.a[component][lane]
+					+ (t3 - 2 * t2 + t) * batch.duration[lane] * batch.a_out_tangent[component][lane]
+					+ (-2 * t3 + 3 * t2) * batch.b[component][lane]
+					+ (t3 - t2) * batch.duration[lane] * batch.b_in_tangent[component][lane];
+
+				EXPECT_NEAR(batch.result[component][lane], expected, 1e-5f);
+			}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,87 @@
+#include "graphics/util/block-suballocator.hpp"
+
+#include <gtest/gtest.h>
+#include <vector>
+
+namespace
+{
+	constexpr uint32_t block_capacity = 1000;
+
+	std::vector<uint32_t> get_block_sizes(const graphics::Block_suballocator& allocator)
+	{
+		return {allocator.get_block_sizes().begin(), allocator.get_block_sizes().end()};
+	}
+
+	TEST(Block_suballocator, PlacesRangesBackToBack)
+	{
+		graphics::Block_suballocator allocator(block_capacity);
+
+		const auto first = allocator.allocate(100, 1);
+		const auto second = allocator.allocate(200, 1);
+		EXPECT_EQ(first.block, 0u);
+		EXPECT_EQ(first.offset, 0u);
+		EXPECT_EQ(second.block, 0u);
+		EXPECT_EQ(second.offset, 100u);
+		EXPECT_EQ(get_block_sizes(allocator), std::vector<uint32_t>{300});
+	}
+
+	TEST(Block_suballocator, AlignsOffsets)
+	{
+		graphics::Block_suballocator allocator(block_capacity);
+
+		allocator.allocate(3, 1);
+		EXPECT_EQ(allocator.allocate(5, 2).offset, 4u);
+		EXPECT_EQ(allocator.allocate(1, 16).offset, 16u);
+		EXPECT_EQ(get_block_sizes(allocator), std::vector<uint32_t>{17});
+	}
+
+	TEST(Block_suballocator, OpensNewBlockAtCapacity)
+	{
+		graphics::Block_suballocator allocator(block_capacity);
+
+		EXPECT_EQ(allocator.allocate(600, 1).block, 0u);
+		EXPECT_EQ(allocator.allocate(400, 1).block, 0u);  // Exactly full
+
+		const auto next = allocator.allocate(1, 1);
+		EXPECT_EQ(next.block, 1u);
+		EXPECT_EQ(next.offset, 0u);
+
+		// Padding counts against the capacity too
+		EXPECT_EQ(allocator.allocate(998, 1).block, 1u);
+		EXPECT_EQ(allocator.allocate(1, 4).block, 2u);
+		EXPECT_EQ(get_block_sizes(allocator), (std::vector<uint32_t>{1000, 999, 1}));
+	}
+
+	TEST(Block_suballocator, FillsEarlierBlocksFirst)
+	{
+		graphics::Block_suballocator allocator(block_capacity);
+
+		allocator.allocate(900, 1);
+		allocator.allocate(500, 1);  // Block 1
+
+		// First fit, block 0 still has room for small ranges
+		const auto small = allocator.allocate(50, 1);
+		EXPECT_EQ(small.block, 0u);
+		EXPECT_EQ(small.offset, 900u);
+
+		const auto medium = allocator.allocate(300, 1);
+		EXPECT_EQ(medium.block, 1u);
+		EXPECT_EQ(medium.offset, 500u);
+	}
+
+	TEST(Block_suballocator, GivesOversizedRangesTheirOwnBlock)
+	{
+		graphics::Block_suballocator allocator(block_capacity);
+
+		allocator.allocate(10, 1);
+
+		const auto oversized = allocator.allocate(2500, 4);
+		EXPECT_EQ(oversized.block, 1u);
+		EXPECT_EQ(oversized.offset, 0u);
+
+		// The oversized block is never shared, later ranges go to blocks within capacity
+		EXPECT_EQ(allocator.allocate(10, 1).block, 0u);
+		EXPECT_EQ(allocator.allocate(995, 1).block, 2u);
+		EXPECT_EQ(get_block_sizes(allocator), (std::vector<uint32_t>{20, 2500, 995}));
+	}
+}
\ No newline at end of file
@@ -0,0 +1,186 @@
+#include "graphics/affine.hpp"
+
+#include <array>
+#include <cmath>
+#include <gtest/gtest.h>
+#include <random>
+#include <ranges>
+
+namespace
+{
+	///
+	/// Skinning on the CPU, mirroring `blend_skin` and `skin_point` in `shader/common/skinning.glsl`
+	///
+
+	glm::vec3 skin_matrix(
+		std::span<const graphics::Affine_matrix> joints,
+		std::span<const float> weights,
+		const glm::vec3& point
+	) noexcept
+	{
+		const glm::vec4 homogeneous(point, 1.0f);
+		glm::vec3 result(0.0f);
+		for (const auto [joint, weight] : std::views::zip(joints, weights))
+			result += weight
+				* glm::vec3(
+					glm::dot(joint.rows[0], homogeneous),
+					glm::dot(joint.rows[1], homogeneous),
+					glm::dot(joint.rows[2], homogeneous)
+				);
+		return result;
+	}
+
+	glm::vec3 skin_dual_quaternion(
+		std::span<const graphics::Dual_quaternion> joints,
+		std::span<const float> weights,
+		const glm::vec3& point
+	) noexcept
+	{
+		glm::vec4 real(0.0f), dual(0.0f);
+		for (const auto [joint, weight] : std::views::zip(joints, weights))
+		{
+			const float aligned_weight = glm::dot(joint.real, joints[0].real) < 0.0f ? -weight : weight;
+			real += joint.real * aligned_weight;
+			dual += joint.dual * aligned_weight;
+		}
+
+		const float inv_length = 1.0f / glm::length(real);
+		real *= inv_length;
+		dual *= inv_length;
+
+		const glm::vec3 axis(real), dual_axis(dual);
+		const auto translation = 2.0f * (real.w * dual_axis - dual.w * axis + glm::cross(axis, dual_axis));
+		return point + 2.0f * glm::cross(axis, glm::cross(axis, point) + real.w * point) + translation;
+	}
+
+	// Rotation of `angle` radians about `axis` through `pivot`
+	graphics::Affine_matrix rotate_about(const glm::vec3& pivot, const glm::vec3& axis, float angle) noexcept
+	{
+		const auto rotation = glm::angleAxis(angle, axis);
+		return graphics::Affine_matrix::from_trs(pivot - rotation * pivot, rotation, glm::vec3(1.0f));
+	}
+
+	///
+	/// Dual quaternion skinning evaluates in float a rotation and a translation that matrix skinning
+	/// evaluates as one product, both round differently. For rigid joints the results stay within
+	/// `tolerance * (|p| + |t|)` for a point `p` and joint translation `t`, about 8 float epsilons. The
+	/// worst case measured over the random joints below is about a third of it.
+	///
+	constexpr float tolerance = 1e-6f;
+
+	float error_bound(const glm::vec3& point, const graphics::Affine_matrix& joint) noexcept
+	{
+		const glm::vec3 translation(joint.rows[0].w, joint.rows[1].w, joint.rows[2].w);
+		return tolerance * (glm::length(point) + glm::length(translation));
+	}
+
+	struct Random_rigid
+	{
+		std::mt19937 generator{11};
+		std::uniform_real_distribution<float> distribution{-1.0f, 1.0f};
+
+		glm::vec3 vec3(float scale) noexcept
+		{
+			const glm::vec3 unit(distribution(generator), distribution(generator), distribution(generator));
+			return scale * unit;
+		}
+
+		graphics::Affine_matrix joint() noexcept
+		{
+			const auto rotation = glm::normalize(
+				glm::quat::wxyz(
+					distribution(generator),
+					distribution(generator),
+					distribution(generator),
+					distribution(generator)
+				)
+			);
+			return graphics::Affine_matrix::from_trs(vec3(10.0f), rotation, glm::vec3(1.0f));
+		}
+	};
+
+	TEST(Dual_quaternion, RigidJointMatchesMatrixSkinning)
+	{
+		Random_rigid random;
+		constexpr std::array weights = {1.0f};
+
+		for (int iteration = 0; iteration < 1000; iteration++)
+		{
+			const std::array joints = {random.joint()};
+			const std::array dual_quaternions = {graphics::Dual_quaternion::from(joints[0])};
+			const auto point = random.vec3(2.0f);
+
+			const auto expected = skin_matrix(joints, weights, point);
+			const auto actual = skin_dual_quaternion(dual_quaternions, weights, point);
+
+			EXPECT_LE(glm::length(actual - expected), error_bound(point, joints[0]))
+				<< "Iteration " << iteration;
+		}
+	}
+
+	TEST(Dual_quaternion, BlendedIdenticalJointsMatchMatrixSkinning)
+	{
+		Random_rigid random;
+		constexpr std::array weights = {0.1f, 0.2f, 0.3f, 0.4f};
+
+		for (int iteration = 0; iteration < 1000; iteration++)
+		{
+			const auto joint = random.joint();
+			const std::array joints = {joint, joint, joint, joint};
+			auto dual_quaternions = std::array<graphics::Dual_quaternion, 4>();
+			std::ranges::fill(dual_quaternions, graphics::Dual_quaternion::from(joint));
+
+			// `q` and `-q` are the same transform, blending must align them to one hemisphere
+			dual_quaternions[2].real = -dual_quaternions[2].real;
+			dual_quaternions[2].dual = -dual_quaternions[2].dual;
+
+			const auto point = random.vec3(2.0f);
+			const auto expected = skin_matrix(joints, weights, point);
+			const auto actual = skin_dual_quaternion(dual_quaternions, weights, point);
+
+			EXPECT_LE(glm::length(actual - expected), error_bound(point, joint))
+				<< "Iteration " << iteration;
+		}
+	}
+
+	TEST(Dual_quaternion, BlendedTwistMatchesMatrixSkinningOfBlendedAngle)
+	{
+		// A forearm twisting about its own axis, the vertex sits between the elbow and the wrist
+		const glm::vec3 pivot(0.3f, 1.2f, -0.4f), axis = glm::normalize(glm::vec3(1.0f, 0.2f, 0.1f));
+		const auto point = pivot + glm::vec3(0.0f, 0.05f, 0.04f);
+		const auto radius = glm::length(glm::cross(point - pivot, axis));
+
+		for (const float angle : {0.1f, 1.0f, 2.0f, 3.0f})
+			for (const float weight : {0.25f, 0.5f, 0.75f})
+			{
+				const std::array joints = {rotate_about(pivot, axis, 0.0f), rotate_about(pivot, axis, angle)};
+				const std::array dual_quaternions = {
+					graphics::Dual_quaternion::from(joints[0]),
+					graphics::Dual_quaternion::from(joints[1])
+				};
+				const std::array weights = {1.0f - weight, weight};
+
+				// The normalized blend of the two rotations is a rotation about the same axis
+				const float half_angle = angle * 0.5f;
+				const float blended_angle = 2.0f
+					* std::atan2(
+						weight * std::sin(half_angle),
+						1.0f - weight + weight * std::cos(half_angle)
+					);
+				const std::array blended_joint = {rotate_about(pivot, axis, blended_angle)};
+				constexpr std::array single_weight = {1.0f};
+
+				const auto expected = skin_matrix(blended_joint, single_weight, point);
+				const auto actual = skin_dual_quaternion(dual_quaternions, weights, point);
+				EXPECT_LE(glm::length(actual - expected), error_bound(point, blended_joint[0]))
+					<< "Angle " << angle << ", weight " << weight;
+
+				// Blending keeps the distance to the axis, matrix skinning pulls the vertex towards it
+				const auto linear = skin_matrix(joints, weights, point);
+				const auto blended_radius = glm::length(glm::cross(actual - pivot, axis));
+				const auto linear_radius = glm::length(glm::cross(linear - pivot, axis));
+				EXPECT_NEAR(blended_radius, radius, radius * 1e-5f);
+				EXPECT_LT(linear_radius, blended_radius);
+			}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,100 @@
+#include "graphics/portal.hpp"
+#include "util/frame-arena.hpp"
+#include "util/heap-counter.hpp"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <gtest/gtest.h>
+#include <memory_resource>
+
+namespace
+{
+	// Three 10m rooms in a row along +X, joined by doorways in the walls at X = 10 and X = 20
+	graphics::Portal_graph make_corridor()
+	{
+		const auto make_room = [](float x) {
+			return graphics::Portal_graph::Room{.min = glm::vec3(x, 0.0f, 0.0f), .max = glm::vec3(x + 10.0f)};
+		};
+
+		const auto make_door = [](float x, uint32_t room) {
+			return graphics::Portal_graph::Portal{
+				.min = glm::vec3(x - 0.1f, 0.0f, 4.0f),
+				.max = glm::vec3(x + 0.1f, 3.0f, 6.0f),
+				.room_a = room,
+				.room_b = room + 1
+			};
+		};
+
+		return graphics::Portal_graph(
+			{make_room(0.0f), make_room(10.0f), make_room(20.0f)},
+			{make_door(10.0f, 0), make_door(20.0f, 1)}
+		);
+	}
+
+	glm::mat4 make_camera(const glm::vec3& eye, const glm::vec3& direction)
+	{
+		const auto projection = glm::perspective(glm::radians(60.0f), 1.0f, 0.1f, 100.0f);
+		return projection * glm::lookAt(eye, eye + direction, glm::vec3(0.0f, 1.0f, 0.0f));
+	}
+
+	TEST(Portal_graph, SeesThroughOpenDoors)
+	{
+		const auto graph = make_corridor();
+		const glm::vec3 eye(5.0f, 1.5f, 5.0f);
+		const std::pmr::vector<bool> portal_open = {true, true};
+
+		const auto visible = graph.compute_visible_rooms(make_camera(eye, {1, 0, 0}), eye, portal_open);
+
+		ASSERT_EQ(visible.size(), 4u);
+		EXPECT_TRUE(visible[0]);
+		EXPECT_TRUE(visible[1]);
+		EXPECT_TRUE(visible[2]);
+		EXPECT_FALSE(visible[3]);  // Outside
+	}
+
+	TEST(Portal_graph, ClosedDoorHidesRoomsBehind)
+	{
+		const auto graph = make_corridor();
+		const glm::vec3 eye(5.0f, 1.5f, 5.0f);
+		const std::pmr::vector<bool> portal_open = {false, true};
+
+		const auto visible = graph.compute_visible_rooms(make_camera(eye, {1, 0, 0}), eye, portal_open);
+
+		EXPECT_TRUE(visible[0]);
+		EXPECT_FALSE(visible[1]);
+		EXPECT_FALSE(visible[2]);
+	}
+
+	TEST(Portal_graph, DoorOutsideViewHidesRoom)
+	{
+		const auto graph = make_corridor();
+		const glm::vec3 eye(5.0f, 1.5f, 1.0f);
+		const std::pmr::vector<bool> portal_open = {true, true};
+
+		// Looking along +Z, the first doorway is about 60 degrees to the side
+		const auto visible = graph.compute_visible_rooms(make_camera(eye, {0, 0, 1}), eye, portal_open);
+
+		EXPECT_TRUE(visible[0]);
+		EXPECT_FALSE(visible[1]);
+	}
+
+	TEST(Portal_graph, ArenaBackedQueryAllocatesNothing)
+	{
+		const auto graph = make_corridor();
+		const glm::vec3 eye(5.0f, 1.5f, 5.0f);
+		const auto camera_matrix = make_camera(eye, {1, 0, 0});
+
+		util::Linear_arena arena;
+		const auto run = [&] {
+			arena.reset();
+			std::pmr::vector<bool> portal_open({true, true}, &arena);
+			return graph.compute_visible_rooms(camera_matrix, eye, portal_open, &arena)[2];
+		};
+
+		ASSERT_TRUE(run());
+
+		const auto begin = util::get_heap_allocation_count();
+		for (int frame = 0; frame < 10; frame++) EXPECT_TRUE(run());
+		EXPECT_EQ(util::get_heap_allocation_count() - begin, 0u);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,170 @@
+#include "graphics/util/resource-pool.hpp"
+
+#include <gtest/gtest.h>
+#include <memory>
+#include <vector>
+
+namespace
+{
+	enum class Fake_usage
+	{
+		Vertex,
+		Index
+	};
+
+	struct Fake_resource
+	{
+		uint32_t size;
+	};
+
+	using Pool = graphics::Resource_pool<Fake_resource, Fake_usage>;
+
+	// Records the sizes it was asked to create, and fails on demand
+	struct Fake_allocator
+	{
+		std::vector<uint32_t> created_sizes;
+		bool fail = false;
+
+		auto callback() noexcept
+		{
+			return [this](uint32_t size) -> std::expected<Fake_resource, util::Error> {
+				if (fail) return util::Error("Out of memory");
+				created_sizes.push_back(size);
+				return Fake_resource{.size = size};
+			};
+		}
+	};
+
+	std::shared_ptr<Fake_resource> acquire(
+		Pool& pool,
+		Fake_allocator& allocator,
+		uint32_t size,
+		Fake_usage usage = Fake_usage::Vertex
+	)
+	{
+		auto result = pool.acquire(usage, size, allocator.callback());
+		EXPECT_TRUE(result.has_value());
+		return result.value_or(nullptr);
+	}
+
+	TEST(Resource_pool, RoundsRequestsUpToSizeClasses)
+	{
+		Pool pool(Pool::Config{.min_size_class = 256});
+		Fake_allocator allocator;
+
+		EXPECT_EQ(pool.get_size_class(1), 256u);
+		EXPECT_EQ(pool.get_size_class(256), 256u);
+		EXPECT_EQ(pool.get_size_class(257), 512u);
+		EXPECT_EQ(pool.get_size_class(5000), 8192u);
+		EXPECT_EQ(pool.get_size_class(Pool::max_size_class), Pool::max_size_class);
+
+		EXPECT_EQ(acquire(pool, allocator, 300)->size, 512u);
+		EXPECT_EQ(allocator.created_sizes, std::vector<uint32_t>{512});
+		EXPECT_EQ(pool.get_statistics().in_use_bytes, 512u);
+	}
+
+	TEST(Resource_pool, ReusesResourcesOfTheSameClassAndUsage)
+	{
+		Pool pool;
+		Fake_allocator allocator;
+
+		const auto first = acquire(pool, allocator, 1000);
+		const auto second = acquire(pool, allocator, 1000);
+		EXPECT_NE(first, second);  // Both in use in this frame
+
+		pool.cycle();
+
+		// Same size class, served from the pool, most recently used first
+		EXPECT_EQ(acquire(pool, allocator, 600), second);
+		EXPECT_EQ(acquire(pool, allocator, 1024), first);
+		EXPECT_EQ(pool.get_statistics().hits, 2u);
+		EXPECT_EQ(pool.get_statistics().misses, 0u);
+		EXPECT_EQ(pool.get_statistics().pooled_bytes, 0u);
+
+		// Another usage or size class never shares
+		acquire(pool, allocator, 1000, Fake_usage::Index);
+		acquire(pool, allocator, 2000);
+		EXPECT_EQ(pool.get_statistics().misses, 2u);
+		EXPECT_EQ(allocator.created_sizes.size(), 4u);
+	}
+
+	TEST(Resource_pool, FailedCreationIsNotCountedInUse)
+	{
+		Pool pool;
+		Fake_allocator allocator;
+		allocator.fail = true;
+
+		EXPECT_FALSE(pool.acquire(Fake_usage::Vertex, 1000, allocator.callback()).has_value());
+		EXPECT_EQ(pool.get_statistics().in_use_bytes, 0u);
+		EXPECT_EQ(pool.get_statistics().misses, 0u);
+
+		pool.cycle();
+		EXPECT_EQ(pool.get_statistics().pooled_bytes, 0u);
+	}
+
+	TEST(Resource_pool, EvictsResourcesUnusedForMaxAge)
+	{
+		Pool pool(Pool::Config{.max_age = 2});
+		Fake_allocator allocator;
+
+		const auto resource = acquire(pool, allocator, 1024);
+		pool.cycle();
+
+		// Unused for 2 frames, still pooled
+		pool.cycle();
+		pool.gc();
+		EXPECT_EQ(pool.get_statistics().evictions, 0u);
+		EXPECT_EQ(pool.get_statistics().pooled_bytes, 1024u);
+
+		pool.cycle();
+		pool.gc();
+		EXPECT_EQ(pool.get_statistics().evictions, 1u);
+		EXPECT_EQ(pool.get_statistics().pooled_bytes, 0u);
+		EXPECT_NE(acquire(pool, allocator, 1024), resource);
+	}
+
+	TEST(Resource_pool, EvictsLeastRecentlyUsedOverBudget)
+	{
+		Pool pool(Pool::Config{.budget = 1024});
+		Fake_allocator allocator;
+
+		// Frame 0 uses a vertex and an index resource
+		const auto vertex = acquire(pool, allocator, 512);
+		const auto index = acquire(pool, allocator, 512, Fake_usage::Index);
+		pool.cycle();
+		pool.gc();
+		EXPECT_EQ(pool.get_statistics().evictions, 0u);
+
+		// Frame 1 uses the vertex resource and a second one, the index resource is now the oldest
+		EXPECT_EQ(acquire(pool, allocator, 512), vertex);
+		const auto second_vertex = acquire(pool, allocator, 512);
+		pool.cycle();
+		EXPECT_EQ(pool.get_statistics().pooled_bytes, 1536u);
+
+		pool.gc();
+		EXPECT_EQ(pool.get_statistics().evictions, 1u);
+		EXPECT_EQ(pool.get_statistics().pooled_bytes, 1024u);
+
+		// Both vertex resources survived, the index resource is created again
+		EXPECT_EQ(acquire(pool, allocator, 512), second_vertex);
+		EXPECT_EQ(acquire(pool, allocator, 512), vertex);
+		EXPECT_NE(acquire(pool, allocator, 512, Fake_usage::Index), index);
+		EXPECT_EQ(pool.get_statistics().hits, 2u);
+		EXPECT_EQ(pool.get_statistics().misses, 1u);
+	}
+
+	TEST(Resource_pool, BypassesPoolAboveMaxSizeClass)
+	{
+		Pool pool;
+		Fake_allocator allocator;
+
+		const auto size = Pool::max_size_class + 1;
+		EXPECT_EQ(acquire(pool, allocator, size)->size, size);
+		EXPECT_EQ(pool.get_statistics().in_use_bytes, 0u);
+
+		pool.cycle();
+		EXPECT_EQ(pool.get_statistics().pooled_bytes, 0u);
+		acquire(pool, allocator, size);
+		EXPECT_EQ(allocator.created_sizes, std::vector<uint32_t>({size, size}));
+	}
+}
\ No newline at end of file
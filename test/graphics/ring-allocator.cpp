@@ -0,0 +1,115 @@
+#include "graphics/util/ring-allocator.hpp"
+
+#include <gtest/gtest.h>
+#include <optional>
+#include <ranges>
+
+namespace
+{
+	constexpr uint32_t capacity = 1024;
+
+	TEST(Ring_allocator, AllocatesFramesBackToBack)
+	{
+		graphics::Ring_allocator ring(capacity);
+
+		EXPECT_EQ(ring.allocate(100, 4), 0u);
+		EXPECT_EQ(ring.allocate(100, 64), 128u);  // 28 bytes of padding
+		EXPECT_EQ(ring.get_frame_size(), 228u);
+		ring.end_frame();
+
+		EXPECT_EQ(ring.allocate(10, 1), 228u);
+		EXPECT_EQ(ring.get_frame_size(), 10u);
+		EXPECT_EQ(ring.get_used_size(), 238u);
+	}
+
+	TEST(Ring_allocator, WrapsAroundPastTheTailEnd)
+	{
+		graphics::Ring_allocator ring(capacity);
+
+		ASSERT_EQ(ring.allocate(600, 1), 0u);
+		ring.end_frame();
+		ASSERT_EQ(ring.allocate(300, 1), 600u);
+		ring.end_frame();
+		ring.release_oldest_frame();
+
+		// 124 bytes remain at the end, too short, so the range restarts at 0 and the remainder is held
+		EXPECT_EQ(ring.allocate(200, 1), 0u);
+		EXPECT_EQ(ring.get_frame_size(), 324u);
+		EXPECT_EQ(ring.get_used_size(), 624u);
+
+		// Free space now ends at the tail of the frame in flight
+		EXPECT_EQ(ring.allocate(400, 1), 200u);
+		EXPECT_EQ(ring.allocate(1, 1), std::nullopt);
+	}
+
+	TEST(Ring_allocator, ReusesRangesOnlyAfterFenceRetirement)
+	{
+		graphics::Ring_allocator ring(capacity);
+
+		// Three frames in flight fill the ring
+		for (const auto frame : std::views::iota(0u, 3u))
+		{
+			EXPECT_EQ(ring.allocate(300, 1), frame * 300);
+			ring.end_frame();
+		}
+		EXPECT_EQ(ring.get_frames_in_flight(), 3u);
+		EXPECT_EQ(ring.allocate(300, 1), std::nullopt);
+
+		// Retiring the oldest frame frees exactly its range, the others are untouched
+		ring.release_oldest_frame();
+		EXPECT_EQ(ring.get_frames_in_flight(), 2u);
+		EXPECT_EQ(ring.get_used_size(), 600u);
+		EXPECT_EQ(ring.allocate(300, 1), 0u);
+		EXPECT_EQ(ring.allocate(1, 1), std::nullopt);
+		ring.end_frame();
+
+		// Frames retire in order, the tail follows
+		ring.release_oldest_frame();
+		EXPECT_EQ(ring.allocate(300, 1), 300u);
+		ring.end_frame();
+
+		while (ring.get_frames_in_flight() > 0) ring.release_oldest_frame();
+		EXPECT_EQ(ring.get_used_size(), 0u);
+
+		// Nothing in use, the whole ring is free again
+		EXPECT_EQ(ring.allocate(capacity, 1), 0u);
+	}
+
+	TEST(Ring_allocator, RetiresEmptyFrames)
+	{
+		graphics::Ring_allocator ring(capacity);
+
+		ASSERT_EQ(ring.allocate(500, 1), 0u);
+		ring.end_frame();
+		ring.end_frame();  // Nothing uploaded in this frame
+
+		ring.release_oldest_frame();
+		ring.release_oldest_frame();
+		ring.release_oldest_frame();  // No-op with nothing in flight
+		EXPECT_EQ(ring.get_used_size(), 0u);
+		EXPECT_EQ(ring.get_frames_in_flight(), 0u);
+	}
+
+	TEST(Ring_allocator, GrownCapacityHoldsTheWholeFrame)
+	{
+		graphics::Ring_allocator ring(capacity);
+
+		// A frame larger than the ring, with nothing in flight
+		ASSERT_EQ(ring.allocate(700, 4), 0u);
+		ASSERT_EQ(ring.allocate(200, 16), 704u);
+		ASSERT_EQ(ring.allocate(300, 256), std::nullopt);
+
+		// Doubling is enough here
+		const auto grown_capacity = ring.get_grown_capacity(300, 256);
+		EXPECT_EQ(grown_capacity, capacity * 2);
+
+		// The next frame repeats all of its allocations in the grown ring
+		graphics::Ring_allocator grown(grown_capacity);
+		EXPECT_TRUE(grown.allocate(700, 4).has_value());
+		EXPECT_TRUE(grown.allocate(200, 16).has_value());
+		EXPECT_TRUE(grown.allocate(300, 256).has_value());
+
+		// An allocation far larger than the ring grows past doubling
+		EXPECT_EQ(ring.get_grown_capacity(10000, 4), 16384u);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,145 @@
+#include "graphics/smallest-bound.hpp"
+
+#include <array>
+#include <cmath>
+#include <glm/ext/matrix_transform.hpp>
+#include <gtest/gtest.h>
+#include <ranges>
+
+namespace
+{
+	constexpr uint32_t resolution = 2048;
+
+	// Corners of a camera sub-frustum, a truncated pyramid looking down -Z from `eye`
+	std::array<glm::vec3, 8> make_frustum(const glm::vec3& eye) noexcept
+	{
+		std::array<glm::vec3, 8> corners;
+		for (const auto i : std::views::iota(0, 8))
+		{
+			const float depth = (i & 4) ? 30.0f : 2.0f;
+			const float half = depth * 0.6f;
+			corners[i] = eye
+				+ glm::vec3((i & 1) ? half : -half, (i & 2) ? half * 0.5f : -half * 0.5f, -depth);
+		}
+		return corners;
+	}
+
+	std::array<glm::vec3, 8> translate(std::array<glm::vec3, 8> corners, const glm::vec3& offset) noexcept
+	{
+		for (auto& corner : corners) corner += offset;
+		return corners;
+	}
+
+	// World-space offset that moves the projection on the bound's view plane by `offset`
+	glm::vec3 view_plane_offset(const graphics::Smallest_bound& bound, glm::vec2 offset) noexcept
+	{
+		return glm::transpose(glm::mat3(bound.view_matrix)) * glm::vec3(offset, 0.0f);
+	}
+
+	float texel_size(const graphics::Smallest_bound& bound) noexcept
+	{
+		return (bound.right - bound.left) / float(resolution);
+	}
+
+	// Projected center of the corners on the bound's view plane, in texels
+	glm::vec2 center_in_texels(const std::array<glm::vec3, 8>& corners, const graphics::Smallest_bound& bound)
+		noexcept
+	{
+		glm::vec3 center(0.0f);
+		for (const auto& corner : corners) center += corner / 8.0f;
+		return glm::vec2(bound.view_matrix * glm::vec4(center, 1.0f)) / texel_size(bound);
+	}
+
+	class Stable_bound : public testing::TestWithParam<glm::vec3>
+	{
+	  protected:
+
+		// Frustum whose projected center sits a quarter texel into a texel cell
+		std::array<glm::vec3, 8> make_aligned_frustum() const noexcept
+		{
+			const auto frustum = make_frustum({3.7f, 1.2f, -5.3f});
+			const auto bound = graphics::find_stable_bound(frustum, GetParam(), resolution);
+
+			const auto center = center_in_texels(frustum, bound);
+			const auto target = glm::floor(center) + 0.25f;
+
+			return translate(frustum, view_plane_offset(bound, (target - center) * texel_size(bound)));
+		}
+	};
+}
+
+TEST_P(Stable_bound, SubTexelMotionKeepsBound)
+{
+	const auto frustum = make_aligned_frustum();
+	const auto bound = graphics::find_stable_bound(frustum, GetParam(), resolution);
+	const auto texel = texel_size(bound);
+
+	for (const auto offset : {glm::vec2(0.5f, 0.0f), glm::vec2(0.0f, 0.5f), glm::vec2(0.6f, 0.6f)})
+	{
+		const auto moved_frustum = translate(frustum, view_plane_offset(bound, offset * texel));
+		const auto moved = graphics::find_stable_bound(moved_frustum, GetParam(), resolution);
+
+		EXPECT_EQ(moved.left, bound.left);
+		EXPECT_EQ(moved.right, bound.right);
+		EXPECT_EQ(moved.top, bound.top);
+		EXPECT_EQ(moved.bottom, bound.bottom);
+	}
+}
+
+TEST_P(Stable_bound, FullTexelMotionShiftsByOneTexel)
+{
+	const auto frustum = make_aligned_frustum();
+	const auto bound = graphics::find_stable_bound(frustum, GetParam(), resolution);
+	const auto texel = texel_size(bound);
+	const auto tolerance = texel * 1e-2f;
+
+	const auto moved_x = graphics::find_stable_bound(
+		translate(frustum, view_plane_offset(bound, {texel, 0.0f})),
+		GetParam(),
+		resolution
+	);
+	EXPECT_NEAR(moved_x.left - bound.left, texel, tolerance);
+	EXPECT_NEAR(moved_x.right - bound.right, texel, tolerance);
+	EXPECT_EQ(moved_x.top, bound.top);
+
+	const auto moved_y = graphics::find_stable_bound(
+		translate(frustum, view_plane_offset(bound, {0.0f, -texel})),
+		GetParam(),
+		resolution
+	);
+	EXPECT_NEAR(moved_y.top - bound.top, -texel, tolerance);
+	EXPECT_NEAR(moved_y.bottom - bound.bottom, -texel, tolerance);
+	EXPECT_EQ(moved_y.left, bound.left);
+}
+
+TEST_P(Stable_bound, SizeIsRotationInvariant)
+{
+	const auto frustum = make_frustum({3.7f, 1.2f, -5.3f});
+	const auto bound = graphics::find_stable_bound(frustum, GetParam(), resolution);
+
+	glm::vec3 center(0.0f);
+	for (const auto& corner : frustum) center += corner / 8.0f;
+
+	for (const auto angle : {0.3f, 1.1f, 2.5f})
+	{
+		// Turn the camera around the center of its sub-frustum
+		const auto rotation = glm::mat3(glm::rotate(glm::mat4(1.0f), angle, glm::vec3(0.2f, 1.0f, 0.1f)));
+
+		auto rotated = frustum;
+		for (auto& corner : rotated) corner = center + rotation * (corner - center);
+
+		const auto rotated_bound = graphics::find_stable_bound(rotated, GetParam(), resolution);
+		EXPECT_EQ(rotated_bound.right - rotated_bound.left, bound.right - bound.left);
+		EXPECT_EQ(rotated_bound.bottom - rotated_bound.top, bound.bottom - bound.top);
+	}
+}
+
+INSTANTIATE_TEST_SUITE_P(
+	LightDirections,
+	Stable_bound,
+	testing::Values(
+		glm::vec3(0.0f, 0.0f, -1.0f),
+		glm::normalize(glm::vec3(0.4f, -1.0f, 0.3f)),
+		glm::vec3(0.0f, -1.0f, 0.0f)
+	)
+);
\ No newline at end of file
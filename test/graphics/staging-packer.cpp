@@ -0,0 +1,99 @@
+#include "graphics/util/staging-packer.hpp"
+
+#include <gtest/gtest.h>
+#include <ranges>
+
+namespace
+{
+	constexpr uint32_t capacity = 256;
+
+	TEST(Staging_packer, AlignsOffsets)
+	{
+		graphics::Staging_packer packer(capacity);
+
+		EXPECT_EQ(packer.place(10, 1).offset, 0u);
+		EXPECT_EQ(packer.place(8, 16).offset, 16u);
+		EXPECT_EQ(packer.place(4, 4).offset, 24u);
+		EXPECT_EQ(packer.place(1, 64).offset, 64u);
+		EXPECT_EQ(packer.get_open_size(), 65u);
+		EXPECT_EQ(packer.get_open_count(), 4u);
+	}
+
+	TEST(Staging_packer, FillsBatchToCapacity)
+	{
+		graphics::Staging_packer packer(capacity);
+
+		EXPECT_EQ(packer.place(200, 1).offset, 0u);
+
+		const auto last = packer.place(56, 8);
+		EXPECT_EQ(last.offset, 200u);
+		EXPECT_FALSE(last.sealed_previous);
+		EXPECT_EQ(packer.get_open_size(), capacity);
+		EXPECT_EQ(packer.get_sealed_count(), 0u);
+	}
+
+	TEST(Staging_packer, SealsBatchWhenUploadDoesNotFit)
+	{
+		graphics::Staging_packer packer(capacity);
+		ASSERT_EQ(packer.place(250, 1).offset, 0u);
+
+		// 4 bytes would fit unaligned, but padding to 8 moves it past the end
+		const auto placement = packer.place(4, 8);
+		EXPECT_TRUE(placement.sealed_previous);
+		EXPECT_FALSE(placement.dedicated);
+		EXPECT_EQ(placement.offset, 0u);
+		EXPECT_EQ(packer.get_sealed_count(), 1u);
+		EXPECT_EQ(packer.get_open_size(), 4u);
+		EXPECT_EQ(packer.get_open_count(), 1u);
+	}
+
+	TEST(Staging_packer, SplitsUploadsIntoBatches)
+	{
+		graphics::Staging_packer packer(capacity);
+
+		// 5 uploads of 48 bytes fit in a batch, 240 bytes with 16 byte alignment
+		uint32_t batch_uploads = 0;
+		for (const auto upload : std::views::iota(0u, 23u))
+		{
+			const auto placement = packer.place(48, 16);
+			EXPECT_EQ(placement.sealed_previous, upload > 0 && upload % 5 == 0) << "Upload " << upload;
+			if (placement.sealed_previous) batch_uploads = 0;
+
+			EXPECT_EQ(placement.offset, batch_uploads * 48) << "Upload " << upload;
+			EXPECT_LE(placement.offset + 48, capacity);
+			batch_uploads++;
+		}
+
+		EXPECT_EQ(packer.get_sealed_count(), 4u);
+		EXPECT_EQ(packer.get_open_count(), 3u);
+		EXPECT_TRUE(packer.seal());
+		EXPECT_EQ(packer.get_sealed_count(), 5u);
+	}
+
+	TEST(Staging_packer, StagesOversizedUploadsInDedicatedBuffers)
+	{
+		graphics::Staging_packer packer(capacity);
+		ASSERT_EQ(packer.place(100, 1).offset, 0u);
+
+		// Joins the open batch without using or sealing its staging buffer
+		const auto placement = packer.place(capacity + 1, 4);
+		EXPECT_TRUE(placement.dedicated);
+		EXPECT_FALSE(placement.sealed_previous);
+		EXPECT_EQ(packer.get_open_size(), 100u);
+		EXPECT_EQ(packer.get_open_count(), 2u);
+
+		EXPECT_EQ(packer.place(100, 1).offset, 100u);
+	}
+
+	TEST(Staging_packer, SealingAnEmptyBatchCountsNothing)
+	{
+		graphics::Staging_packer packer(capacity);
+
+		EXPECT_FALSE(packer.seal());
+		EXPECT_EQ(packer.get_sealed_count(), 0u);
+
+		packer.place(capacity + 1, 1);
+		EXPECT_TRUE(packer.seal());  // A batch of only dedicated uploads is still submitted
+		EXPECT_EQ(packer.get_sealed_count(), 1u);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,159 @@
+#include "render/drawdata/instancing.hpp"
+
+#include <gtest/gtest.h>
+#include <optional>
+#include <vector>
+
+namespace
+{
+	using render::drawdata::Draw_list;
+	using render::drawdata::Instance_batch;
+	using render::drawdata::Instance_batcher;
+	using render::drawdata::Instance_key;
+
+	namespace draw_key = render::drawdata::draw_key;
+
+	struct Fake_item
+	{
+		std::optional<Instance_key> key;  // nullopt => Never merged
+	};
+
+	// Geometry of a fake primitive, identified by its first index
+	Instance_key make_geometry(uint32_t id) noexcept
+	{
+		return Instance_key{
+			.vertex_buffer = reinterpret_cast<SDL_GPUBuffer*>(uintptr_t(16)),
+			.vertex_offset = 0,
+			.index_buffer = reinterpret_cast<SDL_GPUBuffer*>(uintptr_t(32)),
+			.first_index = id * 36,
+			.index_count = 36
+		};
+	}
+
+	uint64_t make_key(uint32_t pipeline_slot, uint32_t material, float depth) noexcept
+	{
+		return draw_key::encode(pipeline_slot, 0, material, draw_key::encode_depth(depth, false));
+	}
+
+	const auto get_key = [](const Fake_item& item) {
+		return item.key;
+	};
+
+	struct Batch_result
+	{
+		std::vector<Instance_batch> batches;
+		std::vector<uint32_t> instance_items;
+
+		std::span<const uint32_t> instances_of(const Instance_batch& batch) const noexcept
+		{
+			return std::span(instance_items).subspan(batch.instances.first, batch.instances.count);
+		}
+	};
+
+	Batch_result run_batcher(Instance_batcher& batcher, Draw_list<Fake_item>& list) noexcept
+	{
+		Batch_result result;
+		list.sort();
+		batcher.batch(list, get_key, result.batches, result.instance_items);
+		return result;
+	}
+}
+
+TEST(Instance_batcher, GroupsByMaterialAndGeometry)
+{
+	Instance_batcher batcher;
+	Draw_list<Fake_item> list;
+
+	list.push(make_key(0, 0, 3.0f), {make_geometry(0)});  // 0: Batch A
+	list.push(make_key(0, 0, 1.0f), {make_geometry(0)});  // 1: Batch A
+	list.push(make_key(0, 0, 2.0f), {make_geometry(1)});  // 2: Other geometry
+	list.push(make_key(0, 1, 4.0f), {make_geometry(0)});  // 3: Other material
+	list.push(make_key(1, 0, 5.0f), {make_geometry(0)});  // 4: Other pipeline
+	list.push(make_key(0, 0, 6.0f), {make_geometry(0)});  // 5: Batch A
+	list.push(make_key(0, 0, 7.0f), {std::nullopt});      // 6: Never merged
+	list.push(make_key(0, 0, 8.0f), {std::nullopt});      // 7: Never merged
+
+	const auto result = run_batcher(batcher, list);
+
+	ASSERT_EQ(result.batches.size(), 6u);
+	EXPECT_EQ(result.instance_items.size(), list.size());
+
+	const auto& batch_a = result.batches[0];
+	EXPECT_EQ(batch_a.item_index, 1u);
+	EXPECT_EQ(batch_a.key, make_key(0, 0, 1.0f));
+	EXPECT_EQ(batch_a.instances.count, 3u);
+
+	for (const auto& batch : result.batches | std::views::drop(1)) EXPECT_EQ(batch.instances.count, 1u);
+}
+
+TEST(Instance_batcher, KeepsSortedOrder)
+{
+	Instance_batcher batcher;
+	Draw_list<Fake_item> list;
+
+	// Pushed out of depth order, and interleaved with a second geometry
+	const auto depths = std::array{5.0f, 2.0f, 9.0f, 1.0f, 7.0f, 3.0f};
+	for (const auto [index, depth] : std::views::enumerate(depths))
+		list.push(make_key(0, 0, depth), {make_geometry(index % 2)});
+
+	const auto result = run_batcher(batcher, list);
+
+	// Batches follow their first drawcall in sorted order: geometry 1 has the nearest item (depth 1)
+	ASSERT_EQ(result.batches.size(), 2u);
+	EXPECT_EQ(result.batches[0].item_index, 3u);
+	EXPECT_EQ(result.batches[1].item_index, 0u);
+
+	// Instances within a batch are sorted by depth, and ranges are contiguous
+	EXPECT_EQ(result.batches[0].instances.first, 0u);
+	EXPECT_EQ(result.batches[1].instances.first, 3u);
+	EXPECT_TRUE(std::ranges::equal(result.instances_of(result.batches[0]), std::array{3u, 1u, 5u}));
+	EXPECT_TRUE(std::ranges::equal(result.instances_of(result.batches[1]), std::array{0u, 4u, 2u}));
+}
+
+TEST(Instance_batcher, ReducesDrawCount)
+{
+	Instance_batcher batcher;
+	Draw_list<Fake_item> list;
+
+	constexpr uint32_t geometry_count = 4;
+	constexpr uint32_t material_count = 2;
+	constexpr uint32_t copies = 25;
+
+	for (const auto i : std::views::iota(0u, geometry_count * material_count * copies))
+	{
+		const auto geometry = make_geometry(i / material_count % geometry_count);
+		list.push(make_key(0, i % material_count, float(i)), {geometry});
+	}
+
+	const auto result = run_batcher(batcher, list);
+
+	// One instanced draw per (material, geometry) pair instead of one draw per drawcall
+	EXPECT_EQ(list.size(), 200u);
+	EXPECT_EQ(result.batches.size(), geometry_count * material_count);
+	EXPECT_EQ(result.instance_items.size(), list.size());
+	for (const auto& batch : result.batches) EXPECT_EQ(batch.instances.count, copies);
+}
+
+TEST(Instance_batcher, AppendsAcrossLists)
+{
+	Instance_batcher batcher;
+	Draw_list<Fake_item> first, second;
+
+	for (const auto depth : {1.0f, 2.0f, 3.0f}) first.push(make_key(0, 0, depth), {make_geometry(0)});
+	for (const auto depth : {1.0f, 2.0f}) second.push(make_key(0, 0, depth), {make_geometry(0)});
+	first.sort();
+	second.sort();
+
+	std::vector<Instance_batch> batches;
+	std::vector<uint32_t> instance_items;
+	batcher.batch(first, get_key, batches, instance_items);
+	batcher.batch(second, get_key, batches, instance_items);
+
+	// Lookup storage is reset per list, so batches of the second list never merge into the first
+	ASSERT_EQ(batches.size(), 2u);
+	EXPECT_EQ(batches[0].instances.first, 0u);
+	EXPECT_EQ(batches[0].instances.count, 3u);
+	EXPECT_EQ(batches[1].instances.first, 3u);
+	EXPECT_EQ(batches[1].instances.count, 2u);
+	EXPECT_EQ(instance_items.size(), 5u);
+}
\ No newline at end of file
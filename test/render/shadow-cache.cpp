@@ -0,0 +1,206 @@
+#include "render/shadow-cache.hpp"
+
+#include <array>
+#include <cmath>
+#include <gtest/gtest.h>
+#include <ranges>
+#include <span>
+#include <vector>
+
+namespace
+{
+	constexpr glm::vec3 sun_direction = {0.0f, -1.0f, 0.0f};
+
+	render::Shadow_cache::Level_key make_level(float extent, bool has_dynamic = false) noexcept
+	{
+		return {
+			.vp_matrix = glm::mat4(1.0f),
+			.bound = {-extent, extent, -extent, extent, 0.0f, extent * 2.0f},
+			.static_signature = 1,
+			.has_dynamic = has_dynamic
+		};
+	}
+
+	// Plan a frame whose static passes are all recorded
+	std::vector<render::Shadow_cache::Level_plan> update_and_commit(
+		render::Shadow_cache& cache,
+		const glm::vec3& light_direction,
+		std::span<const render::Shadow_cache::Level_key> levels
+	) noexcept
+	{
+		const auto plans = cache.update(light_direction, levels);
+		cache.commit();
+		return {plans.begin(), plans.end()};
+	}
+
+	// Rotate the sun direction around the Z axis
+	glm::vec3 tilt(float angle) noexcept
+	{
+		return {std::sin(angle), -std::cos(angle), 0.0f};
+	}
+}
+
+TEST(Shadow_cache, RendersEveryLevelOnFirstUpdate)
+{
+	render::Shadow_cache cache;
+	const std::array levels = {make_level(10.0f), make_level(40.0f)};
+
+	const auto plans = update_and_commit(cache, sun_direction, levels);
+
+	ASSERT_EQ(plans.size(), 2u);
+	for (const auto& plan : plans)
+	{
+		EXPECT_TRUE(plan.render_static);
+		EXPECT_TRUE(plan.copy_static);
+	}
+}
+
+TEST(Shadow_cache, ReusesUnchangedLevels)
+{
+	render::Shadow_cache cache;
+	const std::array levels = {make_level(10.0f), make_level(40.0f)};
+
+	update_and_commit(cache, sun_direction, levels);
+	const auto plans = update_and_commit(cache, sun_direction, levels);
+
+	for (const auto& plan : plans)
+	{
+		EXPECT_FALSE(plan.render_static);
+		EXPECT_FALSE(plan.copy_static);
+	}
+}
+
+TEST(Shadow_cache, LightMovePastThresholdInvalidatesAllLevels)
+{
+	const render::Shadow_cache::Config config{.light_angle_threshold = glm::radians(1.0f)};
+	render::Shadow_cache cache(config);
+	const std::array levels = {make_level(10.0f), make_level(40.0f)};
+
+	update_and_commit(cache, sun_direction, levels);
+
+	// Drifts below the threshold keep the cache, accumulated against the cached direction
+	const auto small_drift = update_and_commit(cache, tilt(glm::radians(0.5f)), levels);
+	for (const auto& plan : small_drift) EXPECT_FALSE(plan.render_static);
+
+	const auto large_drift = update_and_commit(cache, tilt(glm::radians(1.5f)), levels);
+	for (const auto& plan : large_drift) EXPECT_TRUE(plan.render_static);
+
+	const auto settled = update_and_commit(cache, tilt(glm::radians(1.5f)), levels);
+	for (const auto& plan : settled) EXPECT_FALSE(plan.render_static);
+}
+
+TEST(Shadow_cache, StaticCasterChangeInvalidatesItsLevel)
+{
+	render::Shadow_cache cache;
+	std::array levels = {make_level(10.0f), make_level(40.0f)};
+
+	update_and_commit(cache, sun_direction, levels);
+
+	levels[1].static_signature = 2;
+	const auto plans = update_and_commit(cache, sun_direction, levels);
+
+	EXPECT_FALSE(plans[0].render_static);
+	EXPECT_TRUE(plans[1].render_static);
+	EXPECT_TRUE(plans[1].copy_static);
+}
+
+TEST(Shadow_cache, DynamicCasterCompositesWithoutRerender)
+{
+	render::Shadow_cache cache;
+	std::array levels = {make_level(10.0f)};
+
+	update_and_commit(cache, sun_direction, levels);
+
+	// A door starts moving inside the cascade
+	levels[0].has_dynamic = true;
+	const auto moving = update_and_commit(cache, sun_direction, levels);
+	EXPECT_FALSE(moving[0].render_static);
+	EXPECT_TRUE(moving[0].copy_static);
+
+	// The shadow map still holds last frame's dynamic casters, so it is restored once more
+	levels[0].has_dynamic = false;
+	const auto stopped = update_and_commit(cache, sun_direction, levels);
+	EXPECT_FALSE(stopped[0].render_static);
+	EXPECT_TRUE(stopped[0].copy_static);
+
+	const auto idle = update_and_commit(cache, sun_direction, levels);
+	EXPECT_FALSE(idle[0].copy_static);
+}
+
+TEST(Shadow_cache, CascadeRefitInvalidatesItsLevel)
+{
+	const render::Shadow_cache::Config config{.bound_tolerance = 1.0f / 1024.0f};
+	render::Shadow_cache cache(config);
+	std::array levels = {make_level(10.0f), make_level(40.0f)};
+
+	update_and_commit(cache, sun_direction, levels);
+
+	// Drift within tolerance of the extent (20) keeps the cache
+	levels[0].bound[0] += 0.01f;
+	const auto within = update_and_commit(cache, sun_direction, levels);
+	EXPECT_FALSE(within[0].render_static);
+
+	levels[0].bound[0] += 0.5f;
+	const auto refit = update_and_commit(cache, sun_direction, levels);
+	EXPECT_TRUE(refit[0].render_static);
+	EXPECT_FALSE(refit[1].render_static);
+}
+
+TEST(Shadow_cache, LevelCountChangeAndInvalidateRerender)
+{
+	render::Shadow_cache cache;
+	const std::array two_levels = {make_level(10.0f), make_level(40.0f)};
+	const std::array three_levels = {make_level(10.0f), make_level(40.0f), make_level(160.0f)};
+
+	update_and_commit(cache, sun_direction, two_levels);
+
+	const auto resized = update_and_commit(cache, sun_direction, three_levels);
+	for (const auto& plan : resized) EXPECT_TRUE(plan.render_static);
+
+	cache.invalidate();
+	const auto invalidated = update_and_commit(cache, sun_direction, three_levels);
+	for (const auto& plan : invalidated) EXPECT_TRUE(plan.render_static);
+}
+
+TEST(Shadow_cache, SkippedFrameIsPlannedAgain)
+{
+	render::Shadow_cache cache;
+	std::array levels = {make_level(10.0f), make_level(40.0f)};
+
+	// The first frame is skipped before its static passes are recorded, e.g. while minimized
+	cache.update(sun_direction, levels);
+	const auto first = update_and_commit(cache, sun_direction, levels);
+	for (const auto& plan : first) EXPECT_TRUE(plan.render_static);
+
+	levels[1].static_signature = 2;
+	const auto skipped = cache.update(sun_direction, levels);
+	EXPECT_FALSE(skipped[0].render_static);
+	EXPECT_TRUE(skipped[1].render_static);
+
+	// The cache texture still holds the old casters
+	const auto retried = update_and_commit(cache, sun_direction, levels);
+	EXPECT_FALSE(retried[0].render_static);
+	EXPECT_TRUE(retried[1].render_static);
+
+	const auto settled = update_and_commit(cache, sun_direction, levels);
+	EXPECT_FALSE(settled[1].render_static);
+}
+
+TEST(Shadow_cache, PlanStorageIsReused)
+{
+	render::Shadow_cache cache;
+	const std::array levels = {make_level(10.0f), make_level(40.0f)};
+
+	const auto first = cache.update(sun_direction, levels);
+	cache.commit();
+	const auto* const first_data = first.data();
+
+	// Same cascade count, the plans are written into the same storage every frame
+	for (const auto frame : std::views::iota(0, 3))
+	{
+		const auto plans = cache.update(sun_direction, levels);
+		cache.commit();
+		EXPECT_EQ(plans.data(), first_data) << "Frame " << frame;
+		EXPECT_EQ(plans.size(), 2u);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,208 @@
+#include "render/pipeline/state-cache.hpp"
+#include "util/as-byte.hpp"
+
+#include <algorithm>
+#include <array>
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+namespace
+{
+	using render::pipeline::State_cache;
+
+	// Target logging the name of every call it receives
+	class Recording_target final : public State_cache::Target
+	{
+	  public:
+
+		std::vector<std::string> calls;
+
+		size_t count(const std::string& name) const noexcept { return std::ranges::count(calls, name); }
+
+		void bind_pipeline(SDL_GPUGraphicsPipeline*) noexcept override { calls.emplace_back("pipeline"); }
+
+		void push_uniform_to_vertex(uint32_t, std::span<const std::byte>) noexcept override
+		{
+			calls.emplace_back("vertex_uniform");
+		}
+
+		void push_uniform_to_fragment(uint32_t, std::span<const std::byte>) noexcept override
+		{
+			calls.emplace_back("fragment_uniform");
+		}
+
+		void bind_fragment_samplers(uint32_t, std::span<const SDL_GPUTextureSamplerBinding>) noexcept override
+		{
+			calls.emplace_back("samplers");
+		}
+
+		void bind_vertex_storage_buffer(uint32_t, SDL_GPUBuffer*) noexcept override
+		{
+			calls.emplace_back("storage_buffer");
+		}
+
+		void bind_vertex_buffer(uint32_t, const SDL_GPUBufferBinding&) noexcept override
+		{
+			calls.emplace_back("vertex_buffer");
+		}
+
+		void bind_index_buffer(const SDL_GPUBufferBinding&, SDL_GPUIndexElementSize) noexcept override
+		{
+			calls.emplace_back("index_buffer");
+		}
+
+		void set_stencil_reference(uint8_t) noexcept override { calls.emplace_back("stencil"); }
+
+		void draw_indexed(uint32_t, uint32_t, uint32_t, uint32_t, int32_t) noexcept override
+		{
+			calls.emplace_back("draw");
+		}
+	};
+
+	// Opaque handles, never dereferenced
+	template <typename T>
+	T* fake_handle(uintptr_t id) noexcept
+	{
+		return reinterpret_cast<T*>(id * 16);
+	}
+
+	struct Fake_material
+	{
+		std::array<float, 4> factors;
+		SDL_GPUTexture* texture;
+	};
+
+	// Same call sequence a glTF pipeline records for one drawcall
+	void record_drawcall(
+		State_cache& state,
+		SDL_GPUGraphicsPipeline* pipeline,
+		const Fake_material& material,
+		SDL_GPUBuffer* vertex_buffer
+	) noexcept
+	{
+		const auto camera = std::array{1.0f, 0.0f, 0.0f, 1.0f};
+		const auto sampler = fake_handle<SDL_GPUSampler>(1);
+
+		state.bind_pipeline(pipeline);
+		state.push_uniform_to_vertex(0, util::as_bytes(camera));
+		state.set_stencil_reference(0x01);
+		state.push_uniform_to_fragment(0, util::as_bytes(material.factors));
+		state.bind_fragment_samplers(
+			0,
+			SDL_GPUTextureSamplerBinding{.texture = material.texture, .sampler = sampler}
+		);
+		state.bind_vertex_buffer(0, SDL_GPUBufferBinding{.buffer = vertex_buffer, .offset = 0});
+		state.bind_index_buffer(
+			SDL_GPUBufferBinding{.buffer = vertex_buffer, .offset = 0},
+			SDL_GPU_INDEXELEMENTSIZE_32BIT
+		);
+		state.draw_indexed(36, 0, 1, 0, 0);
+	}
+}
+
+TEST(State_cache, SharedStateIsBoundOnce)
+{
+	Recording_target target;
+	State_cache state(target);
+
+	const auto pipeline = fake_handle<SDL_GPUGraphicsPipeline>(1);
+	const Fake_material material{
+		.factors = {1.0f, 1.0f, 1.0f, 1.0f},
+		.texture = fake_handle<SDL_GPUTexture>(1)
+	};
+	const auto vertex_buffer = fake_handle<SDL_GPUBuffer>(1);
+
+	for (int i = 0; i < 10; i++) record_drawcall(state, pipeline, material, vertex_buffer);
+
+	// 7 state calls per drawcall, only the first drawcall issues them
+	EXPECT_EQ(target.calls.size(), 7u + 10u);
+	EXPECT_EQ(target.count("pipeline"), 1u);
+	EXPECT_EQ(target.count("samplers"), 1u);
+	EXPECT_EQ(target.count("draw"), 10u);
+	EXPECT_EQ(state.get_counter().issued, 7u);
+	EXPECT_EQ(state.get_counter().skipped, 7u * 9u);
+}
+
+TEST(State_cache, ChangedStateIsForwarded)
+{
+	Recording_target target;
+	State_cache state(target);
+
+	const auto pipeline = fake_handle<SDL_GPUGraphicsPipeline>(1);
+	const auto vertex_buffer = fake_handle<SDL_GPUBuffer>(1);
+	const Fake_material red{.factors = {1.0f, 0.0f, 0.0f, 1.0f}, .texture = fake_handle<SDL_GPUTexture>(1)};
+	const Fake_material green{.factors = {0.0f, 1.0f, 0.0f, 1.0f}, .texture = fake_handle<SDL_GPUTexture>(1)};
+	const Fake_material textured{
+		.factors = {0.0f, 1.0f, 0.0f, 1.0f},
+		.texture = fake_handle<SDL_GPUTexture>(2)
+	};
+
+	record_drawcall(state, pipeline, red, vertex_buffer);
+	record_drawcall(state, pipeline, green, vertex_buffer);
+	record_drawcall(state, pipeline, textured, vertex_buffer);
+	record_drawcall(state, pipeline, textured, fake_handle<SDL_GPUBuffer>(2));
+
+	EXPECT_EQ(target.count("fragment_uniform"), 2u);
+	EXPECT_EQ(target.count("samplers"), 2u);
+	EXPECT_EQ(target.count("vertex_buffer"), 2u);
+	EXPECT_EQ(target.count("index_buffer"), 2u);
+	EXPECT_EQ(target.count("vertex_uniform"), 1u);
+	EXPECT_EQ(state.get_counter().issued, 7u + 1u + 1u + 2u);
+	EXPECT_EQ(state.get_counter().skipped, 7u * 4u - state.get_counter().issued);
+}
+
+TEST(State_cache, PipelineSwitchDropsCachedState)
+{
+	Recording_target target;
+	State_cache state(target);
+
+	const Fake_material material{
+		.factors = {1.0f, 1.0f, 1.0f, 1.0f},
+		.texture = fake_handle<SDL_GPUTexture>(1)
+	};
+	const auto vertex_buffer = fake_handle<SDL_GPUBuffer>(1);
+
+	record_drawcall(state, fake_handle<SDL_GPUGraphicsPipeline>(1), material, vertex_buffer);
+	record_drawcall(state, fake_handle<SDL_GPUGraphicsPipeline>(2), material, vertex_buffer);
+
+	EXPECT_EQ(target.calls.size(), 2u * (7u + 1u));
+	EXPECT_EQ(state.get_counter().skipped, 0u);
+}
+
+TEST(State_cache, UncachedSlotsAreAlwaysForwarded)
+{
+	Recording_target target;
+	State_cache state(target);
+
+	const std::array<std::byte, 256> large_uniform{};
+	const auto buffer = fake_handle<SDL_GPUBuffer>(1);
+
+	for (int i = 0; i < 3; i++)
+	{
+		state.push_uniform_to_vertex(1, large_uniform);
+		state.bind_vertex_storage_buffer(7, buffer);
+	}
+
+	EXPECT_EQ(target.count("vertex_uniform"), 3u);
+	EXPECT_EQ(target.count("storage_buffer"), 3u);
+	EXPECT_EQ(state.get_counter().skipped, 0u);
+}
+
+TEST(State_cache, UniformsAreComparedByContent)
+{
+	Recording_target target;
+	State_cache state(target);
+
+	const auto first = std::array{1.0f, 2.0f};
+	const auto second = std::array{1.0f, 2.0f};
+	const auto third = std::array{1.0f, 2.0f, 3.0f};
+
+	state.push_uniform_to_fragment(0, util::as_bytes(first));
+	state.push_uniform_to_fragment(0, util::as_bytes(second));
+	state.push_uniform_to_fragment(0, util::as_bytes(third));
+	state.push_uniform_to_fragment(1, util::as_bytes(third));
+
+	EXPECT_EQ(target.count("fragment_uniform"), 3u);
+	EXPECT_EQ(state.get_counter().skipped, 1u);
+}
\ No newline at end of file
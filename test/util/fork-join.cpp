@@ -0,0 +1,58 @@
+#include "util/fork-join.hpp"
+#include "util/heap-counter.hpp"
+
+#include <atomic>
+#include <gtest/gtest.h>
+#include <vector>
+
+namespace
+{
+	class Fork_join_pool : public testing::TestWithParam<size_t>
+	{};
+
+	TEST_P(Fork_join_pool, VisitsEveryIndexOnce)
+	{
+		util::Fork_join_pool pool(GetParam());
+		std::vector<std::atomic<uint32_t>> visits(1000);
+
+		for (const size_t chunk_size : {1zu, 7zu, 64zu, 5000zu})
+		{
+			for (auto& visit : visits) visit = 0;
+
+			pool.parallel_for(visits.size(), chunk_size, [&visits](size_t idx) {
+				visits[idx].fetch_add(1, std::memory_order_relaxed);
+			});
+
+			for (const auto& visit : visits) ASSERT_EQ(visit.load(), 1u) << "Chunk size " << chunk_size;
+		}
+	}
+
+	TEST_P(Fork_join_pool, DispatchAllocatesNothing)
+	{
+		util::Fork_join_pool pool(GetParam());
+		std::atomic<uint64_t> sum = 0;
+
+		const auto run = [&] {
+			pool.parallel_for(256, 4, [&sum](size_t idx) { sum.fetch_add(idx, std::memory_order_relaxed); });
+		};
+
+		run();
+
+		const auto begin = util::get_heap_allocation_count();
+		for (int i = 0; i < 100; i++) run();
+		EXPECT_EQ(util::get_heap_allocation_count() - begin, 0u);
+
+		EXPECT_EQ(sum.load(), 101u * (255u * 256u / 2));
+	}
+
+	TEST_P(Fork_join_pool, HandlesEmptyRange)
+	{
+		util::Fork_join_pool pool(GetParam());
+		bool called = false;
+
+		pool.parallel_for(0, 1, [&called](size_t) { called = true; });
+		EXPECT_FALSE(called);
+	}
+
+	INSTANTIATE_TEST_SUITE_P(Worker_count, Fork_join_pool, testing::Values(0zu, 1zu, 3zu, 8zu));
+}
\ No newline at end of file
@@ -0,0 +1,116 @@
+#include "util/fork-join.hpp"
+#include "util/frame-arena.hpp"
+#include "util/heap-counter.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <gtest/gtest.h>
+#include <memory>
+#include <memory_resource>
+#include <ranges>
+#include <span>
+#include <vector>
+
+namespace
+{
+	// Per-frame workload of pmr containers with mixed sizes
+	void run_frame(std::pmr::memory_resource* resource, size_t scale)
+	{
+		std::pmr::vector<uint32_t> indices(resource);
+		for (uint32_t i = 0; i < 1000 * scale; i++) indices.push_back(i);
+
+		std::pmr::vector<std::pmr::vector<float>> nested(resource);
+		for (size_t i = 0; i < 16; i++) nested.emplace_back(256 * scale, 1.0f);
+
+		const std::pmr::vector<double> large(100'000, 0.0, resource);
+		ASSERT_EQ(large.size(), 100'000u);
+	}
+
+	TEST(Heap_counter, CountsGlobalNew)
+	{
+		const auto begin = util::get_heap_allocation_count();
+		const auto values = std::make_unique<std::vector<int>>(100);
+		EXPECT_EQ(util::get_heap_allocation_count() - begin, 2u);  // The vector and its storage
+	}
+
+	TEST(Linear_arena, SteadyFramesAllocateNothing)
+	{
+		util::Frame_arena frame_arena;
+
+		// Blocks grow over the first frames of each slot
+		for (size_t frame = 0; frame < util::Frame_arena::frame_count * 2; frame++)
+			run_frame(frame_arena.begin_frame(), 4);
+
+		for (size_t frame = 0; frame < 10; frame++)
+		{
+			const auto begin = util::get_heap_allocation_count();
+			run_frame(frame_arena.begin_frame(), 4);
+			const auto allocations = util::get_heap_allocation_count() - begin;
+
+			EXPECT_EQ(allocations, 0u);
+			EXPECT_EQ(frame_arena.get_statistics().block_allocations, 0u);
+		}
+	}
+
+	TEST(Linear_arena, SmallerFramesReuseBlocks)
+	{
+		util::Linear_arena arena(1024);
+
+		run_frame(&arena, 4);
+		const auto capacity = arena.get_statistics().capacity;
+
+		arena.reset();
+		run_frame(&arena, 1);
+
+		EXPECT_EQ(arena.get_statistics().capacity, capacity);
+		EXPECT_EQ(arena.get_statistics().block_allocations, 0u);
+		EXPECT_LE(arena.get_statistics().used, capacity);
+	}
+
+	TEST(Linear_arena, AlignsAndFitsOversizedAllocations)
+	{
+		util::Linear_arena arena(256);
+
+		const auto* small = arena.allocate(3, 1);
+		const auto* aligned = arena.allocate(64, 64);
+		const auto* oversized = arena.allocate(4096, 16);
+
+		EXPECT_NE(small, nullptr);
+		EXPECT_EQ(reinterpret_cast<uintptr_t>(aligned) % 64, 0u);
+		EXPECT_EQ(reinterpret_cast<uintptr_t>(oversized) % 16, 0u);
+		EXPECT_GE(arena.get_statistics().capacity, 4096u + 256u);
+	}
+
+	TEST(Synchronized_resource, WorkersShareArena)
+	{
+		util::Linear_arena arena;
+		util::Fork_join_pool pool(3);
+
+		constexpr size_t task_count = 64;
+		std::array<uint32_t*, task_count> allocations{};
+
+		const auto run = [&] {
+			arena.reset();
+			util::Synchronized_resource resource(&arena);
+
+			pool.parallel_for(task_count, 1, [&](size_t idx) {
+				auto* const values = static_cast<uint32_t*>(resource.allocate(sizeof(uint32_t) * 16, 4));
+				std::ranges::fill(std::span(values, 16), static_cast<uint32_t>(idx));
+				allocations[idx] = values;
+			});
+		};
+
+		run();
+
+		const auto begin = util::get_heap_allocation_count();
+		run();
+		EXPECT_EQ(util::get_heap_allocation_count() - begin, 0u);
+
+		// Every task got its own range, none was overwritten by another
+		for (const auto [idx, values] : allocations | std::views::enumerate)
+			EXPECT_TRUE(std::ranges::all_of(std::span(values, 16), [idx](uint32_t value) {
+				return value == static_cast<uint32_t>(idx);
+			}));
+	}
+}
\ No newline at end of file
@@ -0,0 +1,12 @@
+-- Unit Tests (device-free), run with `xmake test`
+target("test")
+	set_kind("binary")
+	set_default(false)
+	set_languages("c++23")
+
+	add_files("**.cpp")
+	add_packages("gtest")
+
+	add_deps("render")
+
+	add_tests("default")
\ No newline at end of file
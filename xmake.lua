@@ -42,4 +42,8 @@ add_requireconfs("imgui.libsdl3", {override=true, version="main"})
 add_requireconfs("implot-new.imgui", {override=true, version="v1.92.1-docking", configs={sdl3=true, sdl3_gpu=true, wchar32=true}})
 add_requireconfs("implot-new.imgui.libsdl3", {override=true, version="main"})
 
-includes("project", "lib", "render")
+-- Test & benchmark packages
+add_requires("gtest", {configs={main=true}})
+add_requires("benchmark")
+
+includes("project", "lib", "render", "test", "bench")